@@ -0,0 +1,79 @@
+#define ENABLE_MODULE_FRAME_CODEC
+#include "Kinematrix.h"
+
+// Binary telemetry between two boards: payload + CRC-32, COBS encoded, one 0x00 after every frame
+#define LINK_RX_PIN   16
+#define LINK_TX_PIN   17
+#define LINK_BAUD     2000000
+
+struct Telemetry {
+  uint32_t uptime;
+  int16_t temperature;
+  uint16_t battery;
+};
+
+uint8_t txFrame[FRAME_COBS_MAX_ENCODED(sizeof(Telemetry) + 4) + 1];
+uint8_t rxFrame[FRAME_COBS_MAX_ENCODED(sizeof(Telemetry) + 4)];
+FrameParser parser;
+
+void sendTelemetry(const Telemetry &telemetry) {
+  // the payload goes in behind the COBS overhead so it can be encoded in place
+  uint8_t *payload = txFrame + FRAME_COBS_OVERHEAD(sizeof(Telemetry) + 4);
+  memcpy(payload, &telemetry, sizeof(Telemetry));
+  uint32_t crc = FrameCrc::crc32(payload, sizeof(Telemetry));
+  memcpy(payload + sizeof(Telemetry), &crc, 4);
+
+  size_t length = FrameCobs::encode(payload, sizeof(Telemetry) + 4, txFrame);
+  txFrame[length++] = FRAME_COBS_DELIMITER;
+  Serial2.write(txFrame, length);
+}
+
+void handleFrame(const uint8_t *frame, uint16_t length) {
+  if (length != sizeof(Telemetry) + 4) return;
+
+  uint32_t crc;
+  memcpy(&crc, frame + sizeof(Telemetry), 4);
+  if (crc != FrameCrc::crc32(frame, sizeof(Telemetry))) {
+    Serial.println("CRC error");
+    return;
+  }
+
+  Telemetry telemetry;
+  memcpy(&telemetry, frame, sizeof(Telemetry));
+  Serial.print("uptime ");
+  Serial.print(telemetry.uptime);
+  Serial.print(" temperature ");
+  Serial.print(telemetry.temperature / 10.0);
+  Serial.print(" battery ");
+  Serial.println(telemetry.battery);
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial2.begin(LINK_BAUD, SERIAL_8N1, LINK_RX_PIN, LINK_TX_PIN);
+  parser.begin(rxFrame, sizeof(rxFrame), FRAME_MODE_COBS);
+}
+
+void loop() {
+  static uint32_t lastSend = 0;
+  if (millis() - lastSend >= 10) {
+    lastSend = millis();
+    Telemetry telemetry = {millis(), (int16_t) (temperatureRead() * 10), (uint16_t) analogRead(34)};
+    sendTelemetry(telemetry);
+  }
+
+  // whatever the UART holds is pushed in one go, the parser stops at the end of each frame
+  uint8_t chunk[64];
+  int available = Serial2.available();
+  while (available > 0) {
+    int received = Serial2.readBytes(chunk, available < (int) sizeof(chunk) ? available : sizeof(chunk));
+    available -= received;
+
+    size_t offset = 0;
+    while (offset < (size_t) received) {
+      FrameStatus status;
+      offset += parser.push(chunk + offset, received - offset, status);
+      if (status == FRAME_READY) handleFrame(parser.frame(), parser.length());
+    }
+  }
+}
@@ -0,0 +1,279 @@
+// Checks the shared frame codec against the bit by bit routines it replaces and reports the
+// throughput of every codec on this machine.
+//
+//   g++ -std=c++11 -O2 -I. FrameCodecBenchmark.cpp -o FrameCodecBenchmark
+//   ./FrameCodecBenchmark
+//
+// Add -DARDUINO to measure the single table path used on AVR and ESP8266.
+
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "../../../../../../lib/modules/communication/codec/frame-codec.h"
+
+#define BENCH_BLOCK  4096
+#define BENCH_BYTES  (64UL * 1024 * 1024)
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("FAILED line %d: %s\n", __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+// the per bit loops CeriaSerial, NemaSerial and CeriaDisplayDWIN used before
+static uint16_t bitwiseModbus(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF) {
+    while (length--) {
+        crc ^= *data++;
+        for (uint8_t j = 0; j < 8; j++) crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+    return crc;
+}
+
+static uint16_t bitwiseCcitt(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF) {
+    while (length--) {
+        crc ^= *data++ << 8;
+        for (uint8_t j = 0; j < 8; j++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+static uint32_t bitwiseCrc32(const uint8_t *data, size_t length) {
+    uint32_t crc = 0xFFFFFFFF;
+    while (length--) {
+        crc ^= *data++;
+        for (uint8_t j = 0; j < 8; j++) crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+    return ~crc;
+}
+
+class MemoryStream : public Stream {
+public:
+    std::vector<uint8_t> data;
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    size_t write(uint8_t c) override {
+        data.push_back(c);
+        return 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        data.insert(data.end(), buffer, buffer + size);
+        return size;
+    }
+};
+
+static double seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static volatile uint32_t sink;
+
+template<typename F>
+static void bench(const char *name, unsigned long bytes, F run) {
+    double start = seconds();
+    for (unsigned long done = 0; done < bytes; done += BENCH_BLOCK) run();
+    double elapsed = seconds() - start;
+    printf("  %-28s %8.1f MB/s\n", name, bytes / elapsed / 1e6);
+}
+
+static void checkCrc(std::vector<uint8_t> &random) {
+    const uint8_t check[] = "123456789";
+    CHECK(FrameCrc::crc16Modbus(check, 9) == 0x4B37);
+    CHECK(FrameCrc::crc16Ccitt(check, 9) == 0x29B1);
+    CHECK(FrameCrc::crc32(check, 9) == 0xCBF43926UL);
+
+    for (size_t length = 0; length < 300; length++) {
+        const uint8_t *data = random.data() + length;
+        CHECK(FrameCrc::crc16Modbus(data, length) == bitwiseModbus(data, length));
+        CHECK(FrameCrc::crc16Ccitt(data, length) == bitwiseCcitt(data, length));
+        CHECK(FrameCrc::crc32(data, length) == bitwiseCrc32(data, length));
+
+        // chaining over two pieces gives the same result as one pass
+        size_t split = length / 3;
+        CHECK(FrameCrc::crc16Modbus(data + split, length - split, FrameCrc::crc16Modbus(data, split)) ==
+              bitwiseModbus(data, length));
+        CHECK(FrameCrc::crc16Ccitt(data + split, length - split, FrameCrc::crc16Ccitt(data, split)) ==
+              bitwiseCcitt(data, length));
+        CHECK(FrameCrc::crc32(data + split, length - split, FrameCrc::crc32(data, split)) ==
+              bitwiseCrc32(data, length));
+    }
+}
+
+static void checkCobs(std::vector<uint8_t> &random) {
+    // vectors from the original paper and the usual test set
+    const uint8_t zero[] = {0x00};
+    const uint8_t twoZeros[] = {0x00, 0x00};
+    const uint8_t mixed[] = {0x11, 0x22, 0x00, 0x33};
+    uint8_t out[600];
+
+    CHECK(FrameCobs::encode(zero, 1, out) == 2 && out[0] == 0x01 && out[1] == 0x01);
+    CHECK(FrameCobs::encode(twoZeros, 2, out) == 3 && out[0] == 0x01 && out[1] == 0x01 && out[2] == 0x01);
+    CHECK(FrameCobs::encode(mixed, 4, out) == 5 && out[0] == 0x03 && out[3] == 0x02 && out[4] == 0x33);
+
+    uint8_t run[255];
+    for (int i = 0; i < 255; i++) run[i] = i + 1;
+    CHECK(FrameCobs::encode(run, 254, out) == 255 && out[0] == 0xFF);
+    CHECK(FrameCobs::encode(run, 255, out) == 257 && out[0] == 0xFF && out[255] == 0x02 && out[256] == 0xFF);
+
+    const uint8_t badZero[] = {0x03, 0x11, 0x00};
+    const uint8_t badShort[] = {0x05, 0x11};
+    CHECK(FrameCobs::decode(badZero, 3, out) == -1);
+    CHECK(FrameCobs::decode(badShort, 2, out) == -1);
+
+    // random blocks with plenty of zeros and long runs, through both buffer layouts
+    for (size_t length = 0; length < 600; length += 7) {
+        std::vector<uint8_t> source(random.begin(), random.begin() + length + 1);
+        for (size_t i = 0; i < length; i++) if (i % 300 > 260) source[i] = 0;
+
+        uint8_t encoded[FRAME_COBS_MAX_ENCODED(600)];
+        size_t encodedLength = FrameCobs::encode(source.data(), length, encoded);
+        CHECK(encodedLength <= FRAME_COBS_MAX_ENCODED(length));
+        CHECK(memchr(encoded, 0, encodedLength) == NULL);
+
+        uint8_t inPlace[FRAME_COBS_MAX_ENCODED(600)];
+        memcpy(inPlace, source.data(), length);
+        CHECK(FrameCobs::encodeInPlace(inPlace, length) == encodedLength);
+        CHECK(memcmp(inPlace, encoded, encodedLength) == 0);
+
+        CHECK(FrameCobs::decode(inPlace, encodedLength, inPlace) == (int32_t) length);
+        CHECK(memcmp(inPlace, source.data(), length) == 0);
+    }
+}
+
+static void checkParser(std::vector<uint8_t> &random) {
+    uint8_t buffer[300];
+    FrameParser parser;
+
+    // escaped frames full of marker bytes, fed one byte at a time and in odd sized pieces
+    MemoryStream line;
+    std::vector<std::vector<uint8_t> > frames;
+    for (int i = 0; i < 50; i++) {
+        std::vector<uint8_t> frame(random.begin() + i * 7, random.begin() + i * 7 + 20 + i * 5);
+        for (size_t j = 0; j < frame.size(); j += 3) frame[j] = FRAME_STX + (j % 4);
+        frames.push_back(frame);
+        line.write((uint8_t) 0x55);
+        FrameEscape::write(&line, frame.data(), frame.size());
+    }
+
+    size_t found = 0;
+    parser.begin(buffer, sizeof(buffer));
+    for (size_t i = 0; i < line.data.size(); i++) {
+        if (parser.push(line.data[i]) == FRAME_READY) {
+            CHECK(found < frames.size() && parser.length() == frames[found].size() &&
+                  memcmp(parser.frame(), frames[found].data(), parser.length()) == 0);
+            found++;
+        }
+    }
+    CHECK(found == frames.size());
+
+    found = 0;
+    parser.begin(buffer, sizeof(buffer));
+    for (size_t offset = 0; offset < line.data.size();) {
+        size_t piece = 1 + offset % 37;
+        if (piece > line.data.size() - offset) piece = line.data.size() - offset;
+        FrameStatus status;
+        offset += parser.push(line.data.data() + offset, piece, status);
+        if (status == FRAME_READY) {
+            CHECK(found < frames.size() && parser.length() == frames[found].size() &&
+                  memcmp(parser.frame(), frames[found].data(), parser.length()) == 0);
+            found++;
+        }
+    }
+    CHECK(found == frames.size());
+
+    // a frame too large for the buffer is reported and the next one still comes through
+    uint8_t small[8];
+    FrameStatus status;
+    parser.begin(small, sizeof(small));
+    const uint8_t tooLong[] = {FRAME_STX, 1, 2, 3, 4, 5, 6, 7, 8, 9, FRAME_ETX, FRAME_STX, 1, 2, FRAME_ETX};
+    size_t used = parser.push(tooLong, sizeof(tooLong), status);
+    CHECK(status == FRAME_OVERFLOW);
+    used += parser.push(tooLong + used, sizeof(tooLong) - used, status);
+    CHECK(status == FRAME_READY && parser.length() == 2 && used == sizeof(tooLong));
+
+    // COBS frames, each closed by the delimiter
+    std::vector<uint8_t> cobsLine;
+    for (size_t i = 0; i < frames.size(); i++) {
+        uint8_t encoded[FRAME_COBS_MAX_ENCODED(300)];
+        size_t length = FrameCobs::encode(frames[i].data(), frames[i].size(), encoded);
+        cobsLine.insert(cobsLine.end(), encoded, encoded + length);
+        cobsLine.push_back(FRAME_COBS_DELIMITER);
+    }
+
+    found = 0;
+    parser.begin(buffer, sizeof(buffer), FRAME_MODE_COBS);
+    for (size_t i = 0; i < cobsLine.size(); i++) {
+        if (parser.push(cobsLine[i]) == FRAME_READY) {
+            CHECK(found < frames.size() && parser.length() == frames[found].size() &&
+                  memcmp(parser.frame(), frames[found].data(), parser.length()) == 0);
+            found++;
+        }
+    }
+    CHECK(found == frames.size());
+}
+
+int main() {
+    std::vector<uint8_t> random(BENCH_BLOCK * 2);
+    srand(1);
+    for (size_t i = 0; i < random.size(); i++) random[i] = rand() & 0xFF;
+
+    checkCrc(random);
+    checkCobs(random);
+    checkParser(random);
+
+#ifdef FRAME_CRC_SLICED
+    printf("sliced tables\n");
+#else
+    printf("single table\n");
+#endif
+
+    const uint8_t *block = random.data();
+    bench("crc16 modbus bitwise", BENCH_BYTES / 8, [&] { sink += bitwiseModbus(block, BENCH_BLOCK); });
+    bench("crc16 modbus FrameCrc", BENCH_BYTES, [&] { sink += FrameCrc::crc16Modbus(block, BENCH_BLOCK); });
+    bench("crc16 ccitt bitwise", BENCH_BYTES / 8, [&] { sink += bitwiseCcitt(block, BENCH_BLOCK); });
+    bench("crc16 ccitt FrameCrc", BENCH_BYTES, [&] { sink += FrameCrc::crc16Ccitt(block, BENCH_BLOCK); });
+    bench("crc32 bitwise", BENCH_BYTES / 8, [&] { sink += bitwiseCrc32(block, BENCH_BLOCK); });
+    bench("crc32 FrameCrc", BENCH_BYTES, [&] { sink += FrameCrc::crc32(block, BENCH_BLOCK); });
+
+    static uint8_t encoded[FRAME_ESCAPE_MAX_ENCODED(BENCH_BLOCK)];
+    static uint8_t decoded[BENCH_BLOCK];
+    size_t cobsLength = FrameCobs::encode(block, BENCH_BLOCK, encoded);
+    bench("cobs encode", BENCH_BYTES, [&] { sink += FrameCobs::encode(block, BENCH_BLOCK, encoded); });
+    bench("cobs decode", BENCH_BYTES, [&] { sink += FrameCobs::decode(encoded, cobsLength, decoded); });
+    bench("escape encode", BENCH_BYTES, [&] { sink += FrameEscape::encode(block, BENCH_BLOCK, encoded); });
+
+    FrameParser parser;
+    MemoryStream line;
+    FrameEscape::write(&line, block, BENCH_BLOCK);
+    parser.begin(decoded, sizeof(decoded));
+    bench("parser escaped, per byte", BENCH_BYTES / 4, [&] {
+        for (size_t i = 0; i < line.data.size(); i++) sink += parser.push(line.data[i]);
+    });
+    bench("parser escaped, block", BENCH_BYTES, [&] {
+        FrameStatus status;
+        sink += parser.push(line.data.data(), line.data.size(), status);
+    });
+
+    std::vector<uint8_t> cobsLine(encoded, encoded + FrameCobs::encode(block, BENCH_BLOCK, encoded));
+    cobsLine.push_back(FRAME_COBS_DELIMITER);
+    parser.begin(decoded, sizeof(decoded), FRAME_MODE_COBS);
+    bench("parser cobs, block", BENCH_BYTES / 4, [&] {
+        FrameStatus status;
+        sink += parser.push(cobsLine.data(), cobsLine.size(), status);
+    });
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,284 @@
+// Loopback test for modbusMaster on Linux. The master talks through one end of a pty pair, a thread
+// on the other end plays three RTU slaves (one of them never answers).
+//
+//   g++ -std=c++11 -O2 -pthread -I. -I../../../../../../../lib/modules/communication/wired/modbus
+//       ModbusMasterLoopback.cpp ../../../../../../../lib/modules/communication/wired/modbus/modbusMaster.cpp
+//       -o ModbusMasterLoopback
+//   ./ModbusMasterLoopback
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <atomic>
+#include <thread>
+
+#include "Arduino.h"
+#include "modbusMaster.h"
+
+#define BAUD 9600
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("FAILED line %d: %s\n", __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+class PtyStream : public Stream {
+public:
+    explicit PtyStream(int fd) : fd(fd) {}
+
+    int available() override {
+        int count = 0;
+        ioctl(fd, FIONREAD, &count);
+        return count;
+    }
+
+    int read() override {
+        uint8_t c;
+        return ::read(fd, &c, 1) == 1 ? c : -1;
+    }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        size_t written = 0;
+        while (written < size) {
+            ssize_t n = ::write(fd, buffer + written, size - written);
+            if (n <= 0) break;
+            written += n;
+        }
+        return written;
+    }
+
+private:
+    int fd;
+};
+
+struct SimulatedSlave {
+    byte id;
+    bool answers;
+    word holding[256];
+    word input[256];
+    byte coils[32];
+    unsigned long requests;
+};
+
+static SimulatedSlave slaves[3];
+static std::atomic<bool> stopSlaves(false);
+static std::atomic<unsigned long> minGapMicros(0xFFFFFFFFUL);
+
+static SimulatedSlave *findSlave(byte id) {
+    for (int i = 0; i < 3; i++) {
+        if (slaves[i].id == id) return &slaves[i];
+    }
+    return NULL;
+}
+
+static void reply(int fd, byte *frame, word len) {
+    word crc = modbusCrc(frame, len - 2);
+    frame[len - 2] = crc >> 8;
+    frame[len - 1] = crc & 0xFF;
+    ::write(fd, frame, len);
+}
+
+static void answer(int fd, const byte *query, word len) {
+    if (len != 8 || modbusCrc(query, 6) != (word) ((query[6] << 8) | query[7])) return;
+
+    SimulatedSlave *slave = findSlave(query[0]);
+    if (slave == NULL || !slave->answers) return;
+    slave->requests++;
+
+    byte function = query[1];
+    word field1 = (query[2] << 8) | query[3];
+    word field2 = (query[4] << 8) | query[5];
+    byte out[MODBUS_BUFFER_SIZE];
+    out[0] = query[0];
+    out[1] = function;
+
+    // a slave takes a moment to build its reply
+    usleep(500);
+
+    bool bits = function == READ_DO || function == READ_DI;
+    if (function >= READ_DO && function <= READ_AI) {
+        if ((long) field1 + field2 > 256) {
+            out[1] = function | 0x80;
+            out[2] = ILLEGAL_DATA_ADDRESS;
+            reply(fd, out, 5);
+            return;
+        }
+        out[2] = bits ? (field2 + 7) / 8 : field2 * 2;
+        memset(out + 3, 0, out[2]);
+        for (word i = 0; i < field2; i++) {
+            word address = field1 + i;
+            if (bits) {
+                if ((slave->coils[address >> 3] >> (address & 7)) & 1) out[3 + (i >> 3)] |= 1 << (i & 7);
+            } else {
+                word value = function == READ_AO ? slave->holding[address] : slave->input[address];
+                out[3 + i * 2] = value >> 8;
+                out[4 + i * 2] = value & 0xFF;
+            }
+        }
+        reply(fd, out, 5 + out[2]);
+        return;
+    }
+
+    if (function == WRITE_AO) slave->holding[field1 & 0xFF] = field2;
+    if (function == WRITE_DO) {
+        word address = field1 & 0xFF;
+        if (field2) slave->coils[address >> 3] |= 1 << (address & 7);
+        else slave->coils[address >> 3] &= ~(1 << (address & 7));
+    }
+    memcpy(out, query, 8);
+    reply(fd, out, 8);
+}
+
+static void slaveLoop(int fd, unsigned long frameSilence) {
+    byte frame[MODBUS_BUFFER_SIZE];
+    word len = 0;
+    unsigned long lastReply = 0;
+
+    while (!stopSlaves) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        // the end of a query is 3.5 characters of silence
+        int ready = poll(&pfd, 1, len > 0 ? (int) (frameSilence / 1000) + 1 : 20);
+
+        if (ready > 0) {
+            if (len == 0 && lastReply != 0) {
+                unsigned long gap = micros() - lastReply;
+                if (gap < minGapMicros) minGapMicros = gap;
+            }
+            ssize_t n = ::read(fd, frame + len, sizeof(frame) - len);
+            if (n > 0) len += n;
+            continue;
+        }
+
+        if (len > 0) {
+            answer(fd, frame, len);
+            lastReply = micros();
+            len = 0;
+        }
+    }
+}
+
+static void makeRaw(int fd) {
+    struct termios tio;
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+}
+
+int main() {
+    int masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (masterFd < 0 || grantpt(masterFd) != 0 || unlockpt(masterFd) != 0) {
+        perror("pty");
+        return 1;
+    }
+    int slaveFd = open(ptsname(masterFd), O_RDWR | O_NOCTTY);
+    if (slaveFd < 0) {
+        perror("pty slave");
+        return 1;
+    }
+    makeRaw(masterFd);
+    makeRaw(slaveFd);
+
+    // slave 1 is an energy meter, slave 2 a drive, slave 9 is configured but switched off
+    memset(slaves, 0, sizeof(slaves));
+    slaves[0].id = 1;
+    slaves[0].answers = true;
+    slaves[1].id = 2;
+    slaves[1].answers = true;
+    slaves[2].id = 9;
+    slaves[2].answers = false;
+    for (int i = 0; i < 256; i++) {
+        slaves[0].input[i] = 1000 + i;
+        slaves[1].holding[i] = 2000 + i;
+        slaves[1].coils[i / 8] = 0xA5;
+    }
+
+    PtyStream stream(masterFd);
+    modbusMaster master;
+    master.begin(&stream, BAUD);
+    master.setTimeout(50);
+
+    // one register per poll, the way the meter used to be read
+    int meter[10];
+    for (int i = 0; i < 10; i++) {
+        meter[i] = master.addPoll(1, READ_AI, i, 1, 100);
+    }
+    int drive = master.addPoll(2, READ_AO, 0, 4, 100);
+    int driveStatus = master.addPoll(2, READ_AO, 4, 2, 200);
+    int driveFault = master.addPoll(2, READ_AO, 100, 2, 500);
+    int driveCoils = master.addPoll(2, READ_DO, 0, 8, 100);
+    master.addPoll(2, READ_DO, 8, 8, 100);
+    int offline = master.addPoll(9, READ_AO, 0, 2, 100);
+
+    // meter 0-9, drive 0-5, drive 100-101, drive coils 0-15, offline 0-1
+    CHECK(master.getBlockCount() == 5);
+
+    unsigned long frameSilence = (11000000UL / BAUD) * 7 / 2;
+    std::thread bus(slaveLoop, slaveFd, frameSilence);
+
+    unsigned long start = millis();
+    bool written = false;
+    while (millis() - start < 2000) {
+        master.run();
+        if (!written && millis() - start > 500) {
+            written = master.writeRegister(2, 1, 1234);
+        }
+        usleep(50);
+    }
+    while (!master.isIdle()) {
+        master.run();
+        usleep(50);
+    }
+    stopSlaves = true;
+    bus.join();
+
+    for (int i = 0; i < 10; i++) {
+        CHECK(master.getRegister(meter[i], 0) == 1000 + i);
+        CHECK(master.isFresh(meter[i], 300));
+    }
+    word value = 0;
+    CHECK(master.getRegister(1, 7, value, READ_AI) && value == 1007);
+    CHECK(master.getRegister(drive, 0) == 2000);
+    CHECK(master.getRegister(drive, 1) == 1234);
+    CHECK(slaves[1].holding[1] == 1234);
+    CHECK(master.getRegister(driveStatus, 1) == 2005);
+    CHECK(master.getRegister(driveFault, 0) == 2100);
+    CHECK(master.getBit(driveCoils, 0) && !master.getBit(driveCoils, 1) && master.getBit(driveCoils, 2));
+    bool coil = false;
+    CHECK(master.getBit(2, 15, coil) && coil);
+    CHECK(!master.isFresh(offline, 10000));
+    CHECK(master.getAge(offline) == 0xFFFFFFFFUL);
+
+    modbusMaster::Stats stats;
+    master.getStats(stats);
+    unsigned long gap = minGapMicros;
+    printf("requests %lu, responses %lu, timeouts %lu, crc errors %lu, exceptions %lu\n",
+           stats.requests, stats.responses, stats.timeouts, stats.crcErrors, stats.exceptions);
+    printf("meter requests %lu for 10 registers polled every 100 ms over 2 s\n", slaves[0].requests);
+    printf("shortest gap between reply and next query %lu us, 3.5 characters is %lu us\n", gap, frameSilence);
+
+    CHECK(stats.crcErrors == 0);
+    CHECK(stats.exceptions == 0);
+    // the meter block goes out about every 100 ms instead of ten requests each time
+    CHECK(slaves[0].requests >= 15 && slaves[0].requests <= 25);
+    // the offline slave backs off instead of taking a 50 ms timeout every 100 ms
+    CHECK(stats.timeouts <= 10);
+    CHECK(gap >= frameSilence);
+
+    close(slaveFd);
+    close(masterFd);
+
+    printf(failures == 0 ? "all checks passed\n" : "%d checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#define ENABLE_MODULE_MODBUS
+#include "Kinematrix.h"
+
+// RS485 transceiver on Serial2, DE/RE tied together
+#define RS485_RX_PIN   16
+#define RS485_TX_PIN   17
+#define RS485_DE_PIN   4
+#define RS485_BAUD     9600
+
+#define PZEM_ID        1
+#define VFD_ID         2
+
+modbusMaster master;
+
+int pzemVoltage, pzemCurrent, pzemPower, pzemEnergy;
+int vfdStatus, vfdFrequency;
+
+void setup() {
+  Serial.begin(115200);
+  Serial2.begin(RS485_BAUD, SERIAL_8N1, RS485_RX_PIN, RS485_TX_PIN);
+
+  master.begin(&Serial2, RS485_BAUD, RS485_DE_PIN);
+  master.setTimeout(100);
+
+  // polls are declared per value, adjacent ones are read in a single request
+  pzemVoltage = master.addPoll(PZEM_ID, READ_AI, 0x0000, 1, 500);
+  pzemCurrent = master.addPoll(PZEM_ID, READ_AI, 0x0001, 2, 500);
+  pzemPower = master.addPoll(PZEM_ID, READ_AI, 0x0003, 2, 500);
+  pzemEnergy = master.addPoll(PZEM_ID, READ_AI, 0x0005, 2, 2000);
+
+  vfdStatus = master.addPoll(VFD_ID, READ_AO, 0x2100, 1, 100);
+  vfdFrequency = master.addPoll(VFD_ID, READ_AO, 0x2101, 2, 100);
+
+  Serial.print("Block reads on the bus: ");
+  Serial.println(master.getBlockCount());
+}
+
+void loop() {
+  master.run();
+
+  static unsigned long lastPrint = 0;
+  if (millis() - lastPrint >= 1000) {
+    lastPrint = millis();
+
+    if (master.isFresh(pzemVoltage, 1500)) {
+      float voltage = master.getRegister(pzemVoltage, 0) / 10.0;
+      uint32_t current = ((uint32_t) master.getRegister(pzemCurrent, 1) << 16) | master.getRegister(pzemCurrent, 0);
+      Serial.print("Voltage: ");
+      Serial.print(voltage);
+      Serial.print(" V, current: ");
+      Serial.print(current / 1000.0);
+      Serial.println(" A");
+    } else {
+      Serial.println("PZEM not answering");
+    }
+
+    if (master.isFresh(vfdStatus, 500)) {
+      Serial.print("VFD status: 0x");
+      Serial.print(master.getRegister(vfdStatus, 0), HEX);
+      Serial.print(", output: ");
+      Serial.print(master.getRegister(vfdFrequency, 0) / 100.0);
+      Serial.println(" Hz");
+    }
+
+    modbusMaster::Stats stats;
+    master.getStats(stats);
+    Serial.print("Requests: ");
+    Serial.print(stats.requests);
+    Serial.print(", timeouts: ");
+    Serial.println(stats.timeouts);
+  }
+
+  if (Serial.available()) {
+    // any key sets the drive to 25.00 Hz, the write goes out ahead of the next poll
+    while (Serial.available()) Serial.read();
+    master.writeRegister(VFD_ID, 0x2001, 2500);
+  }
+}
@@ -0,0 +1,15 @@
+#ifndef CLIENT_HOST_SHIM_H
+#define CLIENT_HOST_SHIM_H
+
+#include "Arduino.h"
+
+class Client : public Stream {
+public:
+    using Stream::read;
+    using Stream::write;
+    virtual int read(uint8_t *buffer, size_t size) = 0;
+    virtual uint8_t connected() = 0;
+    virtual void stop() = 0;
+};
+
+#endif
@@ -0,0 +1,367 @@
+// Loopback test for the Modbus TCP server and client on Linux. Both talk over local sockets, and an
+// RTU slave on a pty pair serves the same register bank, so a value written on one side is read
+// back on the other without any copy between the two.
+//
+//   M=../../../../../../../lib/modules/communication/wired/modbus
+//   g++ -std=c++11 -O2 -I. -I$M ModbusTcpLoopback.cpp $M/modbusPdu.cpp $M/modbusRegBank.cpp
+//       $M/modbusDevice.cpp $M/modbusSlave.cpp $M/modbusTcpServer.cpp $M/modbusTcpClient.cpp
+//       -o ModbusTcpLoopback
+//   ./ModbusTcpLoopback
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include "Arduino.h"
+#include "Client.h"
+#include "modbusDevice.h"
+#include "modbusSlave.h"
+#include "modbusTcpServer.h"
+#include "modbusTcpClient.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("FAILED line %d: %s\n", __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+class SocketClient : public Client {
+public:
+    SocketClient() : fd(-1) {}
+    explicit SocketClient(int fd) : fd(fd) {}
+
+    int available() override {
+        int count = 0;
+        if (fd < 0 || ioctl(fd, FIONREAD, &count) != 0) return 0;
+        return count;
+    }
+
+    int read() override {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+
+    int read(uint8_t *buffer, size_t size) override {
+        if (fd < 0) return -1;
+        ssize_t n = recv(fd, buffer, size, MSG_DONTWAIT);
+        return n > 0 ? (int) n : -1;
+    }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        if (fd < 0) return 0;
+        ssize_t n = send(fd, buffer, size, MSG_NOSIGNAL);
+        return n > 0 ? (size_t) n : 0;
+    }
+
+    uint8_t connected() override {
+        if (fd < 0) return 0;
+        uint8_t c;
+        ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        return n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+    }
+
+    void stop() override {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+
+    int fd;
+};
+
+class PtyStream : public SoftwareSerial {
+public:
+    explicit PtyStream(int fd) : fd(fd) {}
+
+    int available() override {
+        int count = 0;
+        ioctl(fd, FIONREAD, &count);
+        return count;
+    }
+
+    int read() override {
+        uint8_t c;
+        return ::read(fd, &c, 1) == 1 ? c : -1;
+    }
+
+    size_t write(uint8_t c) override {
+        return ::write(fd, &c, 1) == 1 ? 1 : 0;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        ssize_t n = ::write(fd, buffer, size);
+        return n > 0 ? (size_t) n : 0;
+    }
+
+private:
+    int fd;
+};
+
+static int connectTo(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (connect(fd, (struct sockaddr *) &address, sizeof(address)) != 0) {
+        perror("connect");
+        exit(1);
+    }
+    return fd;
+}
+
+static modbusDevice device;
+static modbusTcpServer server;
+static SocketClient accepted[MODBUS_TCP_MAX_CLIENTS];
+static int listenFd;
+
+static void pumpServer() {
+    int fd = accept(listenFd, NULL, NULL);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        for (int i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+            if (accepted[i].fd < 0) {
+                accepted[i].fd = fd;
+                server.attach(&accepted[i]);
+                break;
+            }
+        }
+    }
+    server.run();
+}
+
+static word putAdu(byte *out, word transaction, byte unit, const byte *pdu, word length) {
+    out[0] = transaction >> 8;
+    out[1] = transaction & 0xFF;
+    out[2] = 0;
+    out[3] = 0;
+    out[4] = (length + 1) >> 8;
+    out[5] = (length + 1) & 0xFF;
+    out[6] = unit;
+    memcpy(out + 7, pdu, length);
+    return 7 + length;
+}
+
+// reads whole ADUs from a raw socket while the server keeps running
+static word receiveAdus(int fd, byte *buffer, word expected) {
+    word length = 0;
+    word complete = 0;
+    unsigned long start = millis();
+    while (complete < expected && millis() - start < 1000) {
+        pumpServer();
+        ssize_t n = recv(fd, buffer + length, 1024 - length, MSG_DONTWAIT);
+        if (n > 0) length += n;
+
+        word offset = 0;
+        complete = 0;
+        while (offset + 7 <= length) {
+            word adu = 6 + ((buffer[offset + 4] << 8) | buffer[offset + 5]);
+            if (offset + adu > length) break;
+            offset += adu;
+            complete++;
+        }
+        usleep(100);
+    }
+    return length;
+}
+
+struct Reply {
+    word length;
+    byte pdu[MODBUS_PDU_SIZE];
+};
+
+static Reply replies[64];
+
+static void onReply(word transaction, const byte *pdu, word length) {
+    Reply &reply = replies[transaction % 64];
+    reply.length = length;
+    if (length) memcpy(reply.pdu, pdu, length);
+}
+
+static word replyRegister(word transaction, word index) {
+    const byte *pdu = replies[transaction % 64].pdu;
+    return (pdu[2 + index * 2] << 8) | pdu[3 + index * 2];
+}
+
+static word rtuQuery(int fd, modbusSlave &slave, const byte *pdu, word length, byte *reply) {
+    byte frame[MODBUS_BUFFER_SIZE];
+    frame[0] = 1;
+    memcpy(frame + 1, pdu, length);
+    word crc = modbusCrc(frame, length + 1);
+    frame[length + 1] = crc >> 8;
+    frame[length + 2] = crc & 0xFF;
+    ::write(fd, frame, length + 3);
+    usleep(2000);
+
+    slave.run();
+    usleep(2000);
+    ssize_t n = ::read(fd, reply, MODBUS_BUFFER_SIZE);
+    return n > 0 ? n : 0;
+}
+
+int main() {
+    signal(SIGPIPE, SIG_IGN);
+
+    device.setId(1);
+    device.addHoldingRegisters(0, 200);
+    device.addInputRegisters(0, 10);
+    device.addCoils(0, 32);
+    for (word i = 0; i < 200; i++) device.set(HOLDING_REGISTER_BASE + i, 100 + i);
+    for (word i = 0; i < 10; i++) device.set(INPUT_REGISTER_BASE + i, 500 + i);
+    server.begin(&device);
+
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    bind(listenFd, (struct sockaddr *) &address, sizeof(address));
+    listen(listenFd, 4);
+    fcntl(listenFd, F_SETFL, O_NONBLOCK);
+    socklen_t addressLength = sizeof(address);
+    getsockname(listenFd, (struct sockaddr *) &address, &addressLength);
+    int port = ntohs(address.sin_port);
+
+    // three requests in one segment, answered in order from one run()
+    int raw = connectTo(port);
+    byte out[1024];
+    byte in[1024];
+    word length = 0;
+    const byte readTen[] = {READ_AO, 0x00, 0x00, 0x00, 0x0A};
+    const byte writeOne[] = {WRITE_AO, 0x00, 0x05, 0x03, 0x09};
+    const byte readOne[] = {READ_AO, 0x00, 0x05, 0x00, 0x01};
+    length += putAdu(out + length, 0x1001, 1, readTen, sizeof(readTen));
+    length += putAdu(out + length, 0x1002, 1, writeOne, sizeof(writeOne));
+    length += putAdu(out + length, 0x1003, 1, readOne, sizeof(readOne));
+    send(raw, out, length, 0);
+
+    word received = receiveAdus(raw, in, 3);
+    CHECK(received == (7 + 22) + (7 + 5) + (7 + 4));
+    CHECK(in[0] == 0x10 && in[1] == 0x01 && in[7] == READ_AO && in[8] == 20);
+    CHECK(in[9] == 0 && in[10] == 100 && in[27] == 0 && in[28] == 109);
+    CHECK(in[29] == 0x10 && in[30] == 0x02 && in[36] == WRITE_AO);
+    CHECK(in[41] == 0x10 && in[42] == 0x03 && in[50] == 0x03 && in[51] == 0x09);
+    CHECK(device.get(HOLDING_REGISTER_BASE + 5) == 0x0309);
+
+    // exceptions: zero quantity, unknown function, a range running off the table, a foreign unit
+    const byte zero[] = {READ_AO, 0x00, 0x00, 0x00, 0x00};
+    const byte unknown[] = {0x2B, 0x0E, 0x01, 0x00, 0x00};
+    const byte offTable[] = {READ_AI, 0x27, 0x0E, 0x00, 0x02};
+    length = 0;
+    length += putAdu(out + length, 1, 1, zero, sizeof(zero));
+    length += putAdu(out + length, 2, 1, unknown, sizeof(unknown));
+    length += putAdu(out + length, 3, 1, offTable, sizeof(offTable));
+    length += putAdu(out + length, 4, 7, readOne, sizeof(readOne));
+    send(raw, out, length, 0);
+    received = receiveAdus(raw, in, 4);
+    CHECK(received == 4 * 9);
+    CHECK(in[7] == (READ_AO | 0x80) && in[8] == ILLEGAL_DATA_VALUE);
+    CHECK(in[16] == (0x2B | 0x80) && in[17] == ILLEGAL_FUNCTION);
+    CHECK(in[25] == (READ_AI | 0x80) && in[26] == ILLEGAL_DATA_ADDRESS);
+    CHECK(in[34] == (READ_AO | 0x80) && in[35] == GATEWAY_TARGET_FAILED);
+
+    // the pipelining client on a second connection, eight requests in flight at once
+    SocketClient clientSocket(connectTo(port));
+    modbusTcpClient client;
+    client.begin(&clientSocket, 1);
+    client.onResponse(onReply);
+
+    const word values[] = {0xAAAA, 0xBBBB, 0xCCCC, 0xDDDD};
+    int write = client.writeRegisters(50, 4, values);
+    int reads[7];
+    for (int i = 0; i < 6; i++) {
+        reads[i] = client.read(READ_AO, i * 20, 20);
+    }
+    reads[6] = client.read(READ_AI, 0, 10);
+    CHECK(client.getPending() == 8);
+    CHECK(client.read(READ_AO, 0, 1) == MODBUS_INVALID);
+
+    unsigned long start = millis();
+    while (client.getPending() > 0 && millis() - start < 1000) {
+        pumpServer();
+        client.run();
+        usleep(100);
+    }
+    CHECK(client.getPending() == 0);
+    CHECK(server.getConnectionCount() == 2);
+    CHECK(replies[write % 64].length == 5 && replies[write % 64].pdu[0] == WRITE_MULTIPLE_AO);
+    CHECK(replies[reads[0] % 64].length == 42 && replyRegister(reads[0], 0) == 100);
+    CHECK(replyRegister(reads[0], 5) == 0x0309);
+    CHECK(replyRegister(reads[2], 10) == 0xAAAA && replyRegister(reads[2], 13) == 0xDDDD);
+    CHECK(replyRegister(reads[5], 19) == 219);
+    CHECK(replyRegister(reads[6], 9) == 509);
+
+    // the RTU slave answers from the bank the TCP client just wrote
+    int ptyMaster = posix_openpt(O_RDWR | O_NOCTTY);
+    grantpt(ptyMaster);
+    unlockpt(ptyMaster);
+    int ptySlave = open(ptsname(ptyMaster), O_RDWR | O_NOCTTY);
+    struct termios tio;
+    tcgetattr(ptySlave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(ptySlave, TCSANOW, &tio);
+
+    PtyStream serial(ptySlave);
+    modbusSlave slave;
+    slave._device = &device;
+    slave.begin(&serial, 9600);
+
+    byte rtu[MODBUS_BUFFER_SIZE];
+    const byte readWritten[] = {READ_AO, 0x00, 0x32, 0x00, 0x04};
+    word rtuLength = rtuQuery(ptyMaster, slave, readWritten, sizeof(readWritten), rtu);
+    CHECK(rtuLength == 13 && rtu[0] == 1 && rtu[2] == 8);
+    CHECK(rtu[3] == 0xAA && rtu[9] == 0xDD && rtu[10] == 0xDD);
+    CHECK(rtuLength == 13 && modbusCrc(rtu, 11) == (word) ((rtu[11] << 8) | rtu[12]));
+
+    // and a multiple coil write over RTU shows up for TCP readers
+    const byte writeCoils[] = {WRITE_MULTIPLE_DO, 0x00, 0x03, 0x00, 0x0A, 0x02, 0xFF, 0x02};
+    rtuLength = rtuQuery(ptyMaster, slave, writeCoils, sizeof(writeCoils), rtu);
+    CHECK(rtuLength == 8 && rtu[1] == WRITE_MULTIPLE_DO && rtu[5] == 0x0A);
+
+    int coils = client.read(READ_DO, 0, 16);
+    start = millis();
+    while (client.getPending() > 0 && millis() - start < 1000) {
+        pumpServer();
+        client.run();
+        usleep(100);
+    }
+    CHECK(replies[coils % 64].length == 4 && replies[coils % 64].pdu[1] == 2);
+    CHECK(replies[coils % 64].pdu[2] == 0xF8 && replies[coils % 64].pdu[3] == 0x17);
+
+    // a peer that goes away frees its slot
+    close(raw);
+    start = millis();
+    while (server.getConnectionCount() > 1 && millis() - start < 1000) {
+        pumpServer();
+        usleep(100);
+    }
+    CHECK(server.getConnectionCount() == 1);
+
+    printf("requests served %lu\n", server.getRequestCount());
+    printf(failures == 0 ? "all checks passed\n" : "%d checks failed\n", failures);
+
+    clientSocket.stop();
+    close(ptySlave);
+    close(ptyMaster);
+    close(listenFd);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,11 @@
+#ifndef SOFTWARE_SERIAL_HOST_SHIM_H
+#define SOFTWARE_SERIAL_HOST_SHIM_H
+
+#include "Arduino.h"
+
+class SoftwareSerial : public Stream {
+public:
+    virtual void begin(long) {}
+};
+
+#endif
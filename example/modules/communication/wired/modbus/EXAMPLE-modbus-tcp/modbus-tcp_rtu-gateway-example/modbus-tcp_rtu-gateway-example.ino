@@ -0,0 +1,65 @@
+#define ENABLE_MODULE_MODBUS
+#include "Kinematrix.h"
+#include <WiFi.h>
+
+// One register map served on RS485 and on Wi-Fi at the same time
+#define RS485_RX_PIN   16
+#define RS485_TX_PIN   17
+#define RS485_BAUD     9600
+
+const char *ssid = "your-ssid";
+const char *password = "your-password";
+
+modbusDevice device;
+modbusSlave rtu;
+modbusTcpServer tcp;
+
+WiFiServer server(MODBUS_TCP_PORT);
+WiFiClient clients[MODBUS_TCP_MAX_CLIENTS];
+
+void setup() {
+  Serial.begin(115200);
+  Serial2.begin(RS485_BAUD, SERIAL_8N1, RS485_RX_PIN, RS485_TX_PIN);
+
+  device.setId(1);
+  device.addCoils(0, 16);
+  device.addInputRegisters(0, 8);
+  device.addHoldingRegisters(0, 32);
+
+  rtu._device = &device;
+  rtu.begin(&Serial2, RS485_BAUD);
+  tcp.begin(&device);
+
+  WiFi.begin(ssid, password);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(500);
+    Serial.print(".");
+  }
+  Serial.println();
+  Serial.print("Modbus TCP on ");
+  Serial.println(WiFi.localIP());
+  server.begin();
+}
+
+void loop() {
+  WiFiClient incoming = server.available();
+  if (incoming) {
+    for (int i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+      if (!clients[i].connected()) {
+        clients[i] = incoming;
+        tcp.attach(&clients[i]);
+        break;
+      }
+    }
+  }
+
+  // sensors write straight into the bank both front ends read from
+  device.set(INPUT_REGISTER_BASE + 0, analogRead(34));
+  device.set(INPUT_REGISTER_BASE + 1, millis() / 1000);
+
+  rtu.run();
+  tcp.run();
+
+  // a setpoint written from either side drives the output
+  digitalWrite(2, device.get(COIL_BASE + 0) ? HIGH : LOW);
+}
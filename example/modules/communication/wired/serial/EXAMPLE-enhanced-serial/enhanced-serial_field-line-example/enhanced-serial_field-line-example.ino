@@ -0,0 +1,38 @@
+#define ENABLE_MODULE_SERIAL_ENHANCED
+#include "Kinematrix.h"
+
+// 50 Hz field lines over Serial1 without String, nothing here touches the heap
+EnhancedSerial link;
+unsigned long lastSend = 0;
+
+void setup() {
+  Serial.begin(115200);
+  Serial1.begin(115200);
+  link.begin(&Serial1);
+}
+
+void loop() {
+  // split once when the line completes, every field is then read in place
+  if (link.pollLine()) {
+    float setpoint = link.getFieldFloat(0);
+    long mode = link.getFieldInt(1, -1);
+    if (link.fieldEquals(2, "RESET")) {
+      Serial.println("reset requested");
+    }
+    Serial.print(setpoint);
+    Serial.print(" ");
+    Serial.println(mode);
+  }
+
+  if (millis() - lastSend >= 20) {
+    lastSend = millis();
+
+    link.beginLine();
+    link.addField(millis());
+    for (uint8_t pin = A0; pin < A0 + 8; pin++) {
+      link.addField(analogRead(pin) * (5.0 / 1023.0), 3);
+    }
+    link.addField("OK");
+    link.sendLine();
+  }
+}
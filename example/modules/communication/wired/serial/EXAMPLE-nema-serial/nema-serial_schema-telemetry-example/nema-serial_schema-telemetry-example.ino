@@ -0,0 +1,57 @@
+#define ENABLE_MODULE_SERIAL_NEMA
+#include "Kinematrix.h"
+
+// 100 Hz telemetry between two boards on Serial2, fixed layout instead of JSON
+#define CMD_TELEMETRY  (CMD_CUSTOM_START + 0)
+
+// append new fields at the end, older receivers keep working and report them absent
+#define TELEMETRY_FIELDS(FIELD)   \
+  FIELD(uint32_t, uptime)         \
+  FIELD(int16_t, temperature)     \
+  FIELD(uint16_t, battery)        \
+  FIELD(float, heading)
+
+NEMA_SCHEMA(Telemetry, 0x01, 1, TELEMETRY_FIELDS)
+
+NemaSerial link;
+unsigned long lastSend = 0;
+
+void onPacket(uint8_t command, uint8_t *data, uint16_t length) {
+  if (command != CMD_TELEMETRY || NemaSchemaView::idOf(data, length) != Telemetry::ID) return;
+
+  // decoded straight from the receive buffer, nothing is copied
+  Telemetry::View msg(data, length);
+  Serial.print("uptime ");
+  Serial.print(msg.uptime());
+  Serial.print(" temp ");
+  Serial.print(msg.temperature() / 100.0);
+  if (msg.has_heading()) {
+    Serial.print(" heading ");
+    Serial.print(msg.heading());
+  }
+  Serial.println();
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial2.begin(921600);
+
+  link.begin(&Serial2);
+  link.setRequireAck(false);
+  link.setPacketHandler(onPacket);
+}
+
+void loop() {
+  link.processIncoming();
+
+  if (millis() - lastSend >= 10) {
+    lastSend = millis();
+
+    // encoded in place in the transmit buffer, unset fields go out as absent
+    link.beginMessage<Telemetry>()
+        .uptime(millis())
+        .temperature(analogRead(34) * 10)
+        .battery(analogRead(35));
+    link.endPacket(CMD_TELEMETRY);
+  }
+}
@@ -0,0 +1,80 @@
+#define ENABLE_MODULE_LORA_COM_V2
+#include "Kinematrix.h"
+
+// Pin definitions
+#define LORA_CS_PIN    10
+#define LORA_RESET_PIN 9
+#define LORA_IRQ_PIN   2
+
+// EU868 limits every node to 1% airtime, the queue waits for the band to reopen
+#define LORA_FREQUENCY 868E6
+
+// Node configuration - CHANGE THIS FOR EACH NODE
+#define NODE_ID 1
+#define MAX_TTL 3
+#define STATUS_INTERVAL 30000
+
+#define MSG_STATUS 0x08
+
+LoRaComV2 lora;
+unsigned long lastStatusTime = 0;
+uint32_t statusCount = 0;
+
+void sendStatus() {
+    // "STATUS;1;23.45;61.20;1024;" is 26 bytes as text, the same fields take 6 bytes here
+    LoRaPacketWriter packet = lora.beginPacket(LORA_BROADCAST_ID, MSG_STATUS);
+    packet.writeFixed(23.45, 100);     // temperature, 0.01 C
+    packet.writeFixed(61.2, 10);       // humidity, 0.1 %
+    packet.writeVarint(statusCount++);
+
+    if (!lora.queuePacket(packet, LORA_PRIORITY_NORMAL, MAX_TTL)) {
+        Serial.println("Queue full, status dropped");
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    if (!lora.init(LORA_CS_PIN, LORA_RESET_PIN, LORA_IRQ_PIN, LORA_FREQUENCY)) {
+        Serial.println("LoRa initialization failed!");
+        while (1);
+    }
+
+    lora.configure(9, 125E3, 14);
+    lora.enableMeshMode(NODE_ID);
+    lora.setRegion(REGION_EU868);
+
+    Serial.print("Status packet airtime: ");
+    Serial.print(lora.getAirtime(LORA_PACKET_HEADER_SIZE + 6));
+    Serial.println(" ms");
+}
+
+void loop() {
+    // duplicates are dropped and floods for other nodes are relayed from the queue by itself
+    LoRaPacket packet;
+    if (lora.receivePacket(&packet) && packet.msgType == MSG_STATUS) {
+        LoRaPacketReader reader(packet.payload, packet.payloadLen);
+        float temperature = reader.readFixed(100);
+        float humidity = reader.readFixed(10);
+        uint32_t count = reader.readVarint();
+
+        if (reader.ok()) {
+            Serial.print("Node ");
+            Serial.print(packet.sourceId);
+            Serial.print(" #");
+            Serial.print(count);
+            Serial.print(": ");
+            Serial.print(temperature);
+            Serial.print(" C, ");
+            Serial.print(humidity);
+            Serial.println(" %");
+        }
+    }
+
+    if (millis() - lastStatusTime > STATUS_INTERVAL) {
+        lastStatusTime = millis();
+        sendStatus();
+    }
+
+    lora.processQueue();
+}
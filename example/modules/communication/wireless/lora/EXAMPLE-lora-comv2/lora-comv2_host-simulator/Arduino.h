@@ -0,0 +1,105 @@
+// Just enough of the Arduino API to run LoRaComV2 on the simulated radio on Linux. The clock
+// functions are defined by lora-sim.cpp and run on the simulator's virtual clock.
+#ifndef ARDUINO_HOST_SHIM_H
+#define ARDUINO_HOST_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef uint16_t word;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+class String : public std::string {
+public:
+    String() {}
+    String(const char *text) : std::string(text) {}
+    String(const std::string &text) : std::string(text) {}
+    String(char c) : std::string(1, c) {}
+    String(int value) : std::string(std::to_string(value)) {}
+    String(unsigned int value) : std::string(std::to_string(value)) {}
+    String(long value) : std::string(std::to_string(value)) {}
+    String(unsigned long value) : std::string(std::to_string(value)) {}
+    String(double value, int decimals = 2) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.*f", decimals, value);
+        assign(text);
+    }
+
+    unsigned int length() const { return size(); }
+    char charAt(unsigned int index) const { return index < size() ? (*this)[index] : 0; }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < to && from < size() ? String(substr(from, to - from)) : String();
+    }
+    String substring(unsigned int from) const { return from < size() ? String(substr(from)) : String(); }
+    int indexOf(const char *text) const {
+        size_t at = find(text);
+        return at == npos ? -1 : (int) at;
+    }
+    int indexOf(char c) const {
+        size_t at = find(c);
+        return at == npos ? -1 : (int) at;
+    }
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return atof(c_str()); }
+    void trim() {
+        size_t first = find_first_not_of(" \t\r\n");
+        size_t last = find_last_not_of(" \t\r\n");
+        if (first == npos) clear();
+        else assign(substr(first, last - first + 1));
+    }
+};
+
+class Stream {
+public:
+    virtual ~Stream() {}
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        size_t written = 0;
+        while (size--) written += write(*buffer++);
+        return written;
+    }
+    virtual void flush() {}
+
+    size_t print(const String &text) { return write((const uint8_t *) text.data(), text.size()); }
+    size_t print(const char *text) { return write((const uint8_t *) text, strlen(text)); }
+    template<typename T>
+    size_t print(T value) { return print(String(value)); }
+    size_t println() { return print("\r\n"); }
+    template<typename T>
+    size_t println(T value) { return print(value) + println(); }
+
+    String readStringUntil(char terminator) {
+        String text;
+        while (available()) {
+            int c = read();
+            if (c < 0 || c == terminator) break;
+            text += (char) c;
+        }
+        return text;
+    }
+};
+
+class HostSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+};
+
+static HostSerial Serial;
+
+#endif
@@ -0,0 +1,380 @@
+// Runs LoRaComV2 unchanged on simulated radios (lora-sim.h) and reports delivered throughput,
+// latency percentiles and retransmissions for the three ways the class is used, each swept over
+// the setting it depends on:
+//
+//   half duplex  pairs on runHalfDuplexCycle(), switch interval
+//   star         sensors on sendDataWithAck() to one gateway, ACK timeout, 20 and 50 nodes
+//   mesh flood   receiveMessage()/relayMessage() and receivePacket()/processQueue(), TTL
+//
+//   g++ -std=c++11 -O2 -DKINEMATRIX_LORA_SIM -I. LoRaSimulator.cpp -o LoRaSimulator
+//   ./LoRaSimulator
+//
+// Runs are seeded, the same build prints the same table. The whole sweep takes a few minutes.
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "Arduino.h"
+#include "../../../../../../../lib/modules/communication/wireless/lora/lora-comv2.h"
+#include "../../../../../../../lib/modules/communication/wireless/lora/lora-comv2.cpp"
+#include "../../../../../../../lib/modules/communication/wireless/lora/lora-base.cpp"
+
+#define SEED 0x4C6F5261
+
+static LoRaSim &sim = LoRaSim::instance();
+
+static uint32_t rngState = SEED;
+
+static uint32_t randomBelow(uint32_t limit) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return limit ? rngState % limit : 0;
+}
+
+// application level bookkeeping: when a message was made and who got it first
+
+struct Traffic {
+    std::vector<uint64_t> createdUs;
+    std::set<uint64_t> seen;
+    std::vector<double> latencyMs;
+    uint32_t bytes;
+    uint32_t duplicates;
+};
+
+static Traffic traffic;
+
+static void resetTraffic() {
+    traffic.createdUs.clear();
+    traffic.seen.clear();
+    traffic.latencyMs.clear();
+    traffic.bytes = 0;
+    traffic.duplicates = 0;
+}
+
+static uint32_t newMessage() {
+    traffic.createdUs.push_back(sim.nowUs());
+    return traffic.createdUs.size();
+}
+
+static bool wasDelivered(uint32_t id, int receiver) {
+    return traffic.seen.count(((uint64_t) id << 8) | receiver) > 0;
+}
+
+static void delivered(uint32_t id, int receiver, size_t bytes) {
+    if (id == 0 || id > traffic.createdUs.size()) return;
+    if (!traffic.seen.insert(((uint64_t) id << 8) | receiver).second) {
+        traffic.duplicates++;
+        return;
+    }
+    traffic.latencyMs.push_back((sim.nowUs() - traffic.createdUs[id - 1]) / 1000.0);
+    traffic.bytes += bytes;
+}
+
+static double percentile(std::vector<double> &values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t) ceil(p / 100.0 * values.size());
+    return values[rank > 0 ? rank - 1 : 0];
+}
+
+static void printHeader(const char *title, const char *knob) {
+    printf("\n%s\n", title);
+    printf("%-10s %8s %9s %7s %9s %8s %8s %8s %7s %6s %6s %6s %6s\n",
+           knob, "sent", "delivered", "ratio", "goodput", "p50", "p90", "p99",
+           "radioTx", "retx", "coll", "lost", "off");
+    printf("%-10s %8s %9s %7s %9s %8s %8s %8s %7s %6s %6s %6s %6s\n",
+           "", "", "", "", "B/s", "ms", "ms", "ms", "", "", "", "", "");
+}
+
+// receivers is how many nodes should get each message, retx what the radios sent beyond one
+// transmission per message; extra is printed at the end of the line
+static void printRow(uint32_t knob, uint32_t receivers, uint32_t durationMs, uint32_t retx, const char *extra = "") {
+    LoRaSimStats total = sim.total();
+    uint32_t sent = traffic.createdUs.size();
+    uint32_t got = traffic.latencyMs.size();
+    uint32_t expected = sent * receivers;
+
+    printf("%-10u %8u %9u %6.1f%% %9.1f %8.0f %8.0f %8.0f %7u %6u %6u %6u %6u %s\n",
+           knob, sent, got, expected ? 100.0 * got / expected : 0.0,
+           traffic.bytes * 1000.0 / durationMs,
+           percentile(traffic.latencyMs, 50), percentile(traffic.latencyMs, 90),
+           percentile(traffic.latencyMs, 99),
+           total.txPackets, retx, total.collisions, total.weakSignal + total.randomLoss,
+           total.notListening, extra);
+}
+
+static void resetSim(float exponent, float fadingDb) {
+    sim.reset(SEED);
+    sim.setPathLoss(exponent, 40, fadingDb);
+    sim.setLossRate(0.01f);
+    sim.setLoopTime(2000);
+    rngState = SEED;
+    resetTraffic();
+}
+
+static void freeRadios(std::vector<LoRaComV2 *> &radios) {
+    for (size_t i = 0; i < radios.size(); i++) {
+        delete radios[i];
+    }
+    radios.clear();
+}
+
+// half duplex: pairs 800 m apart on their own channels, a new reading every 5 s per node, which
+// runHalfDuplexCycle() repeats at the start of every transmit window until it is replaced
+
+#define HD_PAIRS 10
+#define HD_READING_INTERVAL 5000
+#define HD_DURATION 600000UL
+
+static std::vector<LoRaComV2 *> radios;
+
+static void halfDuplexReceive(const String &data) {
+    delivered(data.toInt(), sim.currentNode(), data.length());
+}
+
+static void halfDuplexSent(const String &data) {
+    (void) data;
+}
+
+static void runHalfDuplex(uint32_t interval) {
+    resetSim(2.9f, 4);
+
+    std::vector<unsigned long> nextReading(HD_PAIRS * 2);
+    for (int i = 0; i < HD_PAIRS * 2; i++) {
+        radios.push_back(new LoRaComV2());
+        long frequency = 865100000L + (i / 2) * 200000L;
+        uint32_t bootDelay = randomBelow(interval * 2);
+
+        sim.addNode((i % 2) * 800.0f, (i / 2) * 5000.0f, [=, &nextReading]() {
+            delay(bootDelay);
+            radios[i]->init(frequency);
+            radios[i]->configure(7, 125E3, 14);
+            radios[i]->setMode(MODE_HALF_DUPLEX, interval);
+            nextReading[i] = millis();
+        }, [=, &nextReading]() {
+            if (millis() >= nextReading[i]) {
+                nextReading[i] += HD_READING_INTERVAL;
+                radios[i]->clearData();
+                radios[i]->addData(newMessage());
+                radios[i]->addData(23.5);
+                radios[i]->addData(61);
+            }
+            radios[i]->runHalfDuplexCycle(halfDuplexReceive, halfDuplexSent);
+        });
+    }
+
+    sim.run(HD_DURATION);
+    uint32_t sent = traffic.createdUs.size();
+    printRow(interval, 1, HD_DURATION, sim.total().txPackets - std::min(sim.total().txPackets, sent));
+    freeRadios(radios);
+}
+
+// star: sensors up to 1.5 km around a gateway send a reading every 60 s with sendDataWithAck(),
+// the gateway answers every packet with ACK;<id>. sendDataWithAck() takes any packet that
+// contains "ACK", an ACK meant for another sensor counts as a false ACK.
+
+#define STAR_PERIOD 60000UL
+#define STAR_DURATION 900000UL
+#define STAR_RETRIES 3
+
+static std::vector<uint32_t> ackedIds;
+
+static void gatewayReceive(const String &data) {
+    delivered(data.toInt(), 0, data.length());
+    radios[0]->clearData();
+    radios[0]->addData("ACK");
+    radios[0]->addData(data.toInt());
+    radios[0]->sendData();
+}
+
+static void runStar(int sensors, uint32_t ackTimeout) {
+    resetSim(2.9f, 4);
+    ackedIds.clear();
+
+    radios.push_back(new LoRaComV2());
+    sim.addNode(0, 0, []() {
+        radios[0]->init(868100000L);
+        radios[0]->configure(9, 125E3, 14);
+    }, []() {
+        radios[0]->receive(gatewayReceive);
+    });
+
+    std::vector<unsigned long> nextReading(sensors + 1);
+    for (int i = 1; i <= sensors; i++) {
+        radios.push_back(new LoRaComV2());
+        float distance = 200 + randomBelow(1300);
+        float angle = randomBelow(3600) * 6.2831853f / 3600;
+        nextReading[i] = randomBelow(STAR_PERIOD);
+
+        sim.addNode(distance * cosf(angle), distance * sinf(angle), [=]() {
+            radios[i]->init(868100000L);
+            radios[i]->configure(9, 125E3, 14);
+        }, [=, &nextReading]() {
+            if (millis() < nextReading[i]) return;
+            nextReading[i] += STAR_PERIOD;
+
+            uint32_t id = newMessage();
+            radios[i]->clearData();
+            radios[i]->addData(id);
+            radios[i]->addData(21.4);
+            radios[i]->addData(58.2);
+            if (radios[i]->sendDataWithAck(ackTimeout, STAR_RETRIES)) ackedIds.push_back(id);
+        });
+    }
+
+    sim.run(STAR_DURATION);
+
+    uint32_t sensorTx = 0;
+    for (int i = 1; i <= sensors; i++) {
+        sensorTx += sim.stats(i).txPackets;
+    }
+    uint32_t falseAcks = 0;
+    for (size_t i = 0; i < ackedIds.size(); i++) {
+        if (!wasDelivered(ackedIds[i], 0)) falseAcks++;
+    }
+    char extra[48];
+    snprintf(extra, sizeof(extra), "acked %u, false %u", (unsigned) ackedIds.size(), falseAcks);
+    printRow(ackTimeout, 1, STAR_DURATION, sensorTx - std::min(sensorTx, (uint32_t) traffic.createdUs.size()), extra);
+    freeRadios(radios);
+}
+
+// mesh flood: a grid 500 m apart where only direct neighbours hear each other reliably, the
+// middle node floods a broadcast every 10 s
+
+#define MESH_SPACING 500.0f
+#define MESH_FLOODS 30
+#define MESH_FLOOD_INTERVAL 10000UL
+
+enum MeshVariant {
+    MESH_TEXT,
+    MESH_TEXT_JITTER,
+    MESH_BINARY
+};
+
+// relays are held back up to this long in MESH_TEXT_JITTER, so neighbours stop transmitting at once
+#define MESH_RELAY_JITTER 300
+
+struct PendingRelay {
+    LoRaMessage msg;
+    bool waiting;
+    unsigned long at;
+};
+
+static void runMesh(int columns, int rows, MeshVariant variant, uint8_t ttl) {
+    resetSim(3.5f, 4);
+
+    int count = columns * rows;
+    int origin = (rows / 2) * columns + (columns - 1) / 2;
+    std::vector<PendingRelay> pending(count);
+    std::vector<unsigned long> nextFlood(count, 0);
+
+    for (int i = 0; i < count; i++) {
+        radios.push_back(new LoRaComV2());
+        pending[i].waiting = false;
+
+        sim.addNode((i % columns) * MESH_SPACING, (i / columns) * MESH_SPACING, [=, &nextFlood]() {
+            radios[i]->init(868100000L);
+            radios[i]->configure(7, 125E3, 14);
+            radios[i]->enableMeshMode(i + 1);
+            nextFlood[i] = 1000 + randomBelow(1000);
+        }, [=, &pending, &nextFlood]() {
+            LoRaComV2 &radio = *radios[i];
+
+            if (i == origin && millis() >= nextFlood[i] && traffic.createdUs.size() < MESH_FLOODS) {
+                nextFlood[i] += MESH_FLOOD_INTERVAL;
+                uint32_t id = newMessage();
+                if (variant == MESH_BINARY) {
+                    LoRaPacketWriter writer = radio.beginPacket(LORA_BROADCAST_ID, MSG_BROADCAST);
+                    writer.writeVarint(id).writeFixed(21.4f, 100).writeFixed(58.2f, 10);
+                    radio.queuePacket(writer, LORA_PRIORITY_NORMAL, ttl);
+                } else {
+                    char text[32];
+                    snprintf(text, sizeof(text), "%u;21.40;58.20;", id);
+                    radio.broadcastMessage(text, ttl);
+                }
+            }
+
+            if (variant == MESH_BINARY) {
+                LoRaPacket packet;
+                if (radio.receivePacket(&packet)) {
+                    LoRaPacketReader reader(packet.payload, packet.payloadLen);
+                    delivered(reader.readVarint(), i, packet.payloadLen);
+                }
+                radio.processQueue();
+                return;
+            }
+
+            LoRaMessage msg;
+            if (radio.receiveMessage(&msg)) {
+                delivered(atol(msg.payload), i, msg.payloadLen);
+                if (variant == MESH_TEXT) {
+                    radio.relayMessage(&msg);
+                } else {
+                    pending[i].msg = msg;
+                    pending[i].waiting = true;
+                    pending[i].at = millis() + randomBelow(MESH_RELAY_JITTER);
+                }
+            }
+            if (pending[i].waiting && millis() >= pending[i].at) {
+                pending[i].waiting = false;
+                radio.relayMessage(&pending[i].msg);
+            }
+        });
+    }
+
+    uint32_t duration = 2000 + MESH_FLOODS * MESH_FLOOD_INTERVAL;
+    sim.run(duration);
+
+    uint32_t floods = traffic.createdUs.size();
+    char extra[48];
+    snprintf(extra, sizeof(extra), "%.1f tx per flood", floods ? (double) sim.total().txPackets / floods : 0.0);
+    printRow(ttl, count - 1, duration, sim.total().txPackets - std::min(sim.total().txPackets, floods), extra);
+    freeRadios(radios);
+}
+
+int main() {
+    printf("LoRaComV2 on the simulated radio, 1 %% random loss, 4 dB fading, 6 dB capture\n");
+    printf("retx: radio transmissions beyond one per message (repeats, retries or relays)\n");
+    printf("coll / lost / off: packets a node missed to a collision, to range or the loss rate, or because\n");
+    printf("                   its radio was not listening; out of range nodes count every packet\n");
+
+    printHeader("half duplex, 10 pairs 800 m apart, SF7, reading every 5 s", "interval");
+    const uint32_t intervals[] = {100, 250, 500, 1000, 2000};
+    for (size_t i = 0; i < sizeof(intervals) / sizeof(intervals[0]); i++) {
+        runHalfDuplex(intervals[i]);
+    }
+
+    const int stars[] = {20, 50};
+    const uint32_t timeouts[] = {200, 500, 1000, 2000};
+    for (size_t s = 0; s < sizeof(stars) / sizeof(stars[0]); s++) {
+        char title[96];
+        snprintf(title, sizeof(title), "star, %d sensors within 1.5 km, SF9, reading every 60 s, %d tries",
+                 stars[s], STAR_RETRIES);
+        printHeader(title, "ackTimeout");
+        for (size_t i = 0; i < sizeof(timeouts) / sizeof(timeouts[0]); i++) {
+            runStar(stars[s], timeouts[i]);
+        }
+    }
+
+    const int grids[][2] = {{5, 4}, {10, 5}};
+    const char *variants[] = {"relayMessage() at once", "relayMessage() after 0-300 ms",
+                              "receivePacket()/processQueue()"};
+    const uint8_t ttls[] = {2, 4, 6, 8};
+    for (size_t g = 0; g < sizeof(grids) / sizeof(grids[0]); g++) {
+        for (int v = MESH_TEXT; v <= MESH_BINARY; v++) {
+            char title[96];
+            snprintf(title, sizeof(title), "mesh flood, %dx%d grid 500 m apart, SF7, %s",
+                     grids[g][0], grids[g][1], variants[v]);
+            printHeader(title, "ttl");
+            for (size_t i = 0; i < sizeof(ttls) / sizeof(ttls[0]); i++) {
+                runMesh(grids[g][0], grids[g][1], (MeshVariant) v, ttls[i]);
+            }
+        }
+    }
+
+    return 0;
+}
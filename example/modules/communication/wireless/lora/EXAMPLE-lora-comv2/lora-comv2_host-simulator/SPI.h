@@ -0,0 +1 @@
+// lora-comv2.h pulls in SPI.h, the simulated radio does not need it.
@@ -0,0 +1,113 @@
+#define ENABLE_MODULE_ESP_NOW_TRANSPORT
+#include "Kinematrix.h"
+
+// Flash the same sketch on the hub and on every sensor, only the MAC list has to match the boards.
+// The first address is the hub.
+#define SNAPSHOT_SAMPLES 1024
+#define SNAPSHOT_INTERVAL 2000
+#define STATUS_INTERVAL 200
+
+struct __attribute__((packed)) Status {
+    uint32_t uptime;
+    int16_t rssi;
+    uint8_t battery;
+};
+
+ESPNow espNow;
+ESPNowTransport transport;
+
+bool isHub = false;
+const uint8_t *hubMac = nullptr;
+
+// 1024 samples of 3 bytes, ~3 KB: 13 fragments instead of one frame that esp_now_send rejects
+uint8_t snapshot[SNAPSHOT_SAMPLES * 3];
+unsigned long lastSnapshot = 0;
+unsigned long lastStatus = 0;
+
+void printMac(const uint8_t *mac) {
+    Serial.print(espNow.macAddressToString((uint8_t *) mac));
+}
+
+void onMessage(const uint8_t *mac, const uint8_t *data, size_t len) {
+    printMac(mac);
+    if (len == sizeof(Status)) {
+        Status status;
+        memcpy(&status, data, sizeof(status));
+        Serial.print(" status, uptime ");
+        Serial.print(status.uptime);
+        Serial.print(" ms, battery ");
+        Serial.print(status.battery);
+        Serial.println(" %");
+    } else {
+        Serial.print(" snapshot, ");
+        Serial.print(len);
+        Serial.println(" bytes");
+    }
+}
+
+void printStats() {
+    for (uint8_t i = 0; i < transport.getPeerCount(); i++) {
+        const uint8_t *mac = transport.getPeerAddress(i);
+        const ESPNowPeerStats *stats = transport.getStats(mac);
+        printMac(mac);
+        Serial.print(" frames ");
+        Serial.print(stats->framesSent);
+        Serial.print(" sent / ");
+        Serial.print(stats->framesFailed);
+        Serial.print(" failed, messages ");
+        Serial.print(stats->messagesSent);
+        Serial.print(" sent (");
+        Serial.print(stats->messagesBatched);
+        Serial.print(" batched) / ");
+        Serial.print(stats->messagesReceived);
+        Serial.println(" received");
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    espNow.addMacAddress("24:6F:28:AA:00:01");
+    espNow.addMacAddress("24:6F:28:AA:00:02");
+    espNow.addMacAddress("24:6F:28:AA:00:03");
+
+    transport.setReceiveHandler(onMessage);
+    if (!transport.begin(espNow)) {
+        Serial.println("ESP-NOW initialization failed!");
+    }
+
+    isHub = espNow.getThisDeviceIndex() == 0;
+    hubMac = espNow.getMacAddress(0);
+
+    for (size_t i = 0; i < sizeof(snapshot); i++) {
+        snapshot[i] = i;
+    }
+}
+
+void loop() {
+    // sends at most one frame and waits for its send callback before the next one
+    transport.update();
+
+    if (isHub) {
+        static unsigned long lastStats = 0;
+        if (millis() - lastStats > 10000) {
+            lastStats = millis();
+            printStats();
+        }
+        return;
+    }
+
+    // small and frequent, several of them share one frame
+    if (millis() - lastStatus > STATUS_INTERVAL) {
+        lastStatus = millis();
+        Status status = {millis(), (int16_t) WiFi.RSSI(), 87};
+        transport.send(hubMac, (const uint8_t *) &status, sizeof(status));
+    }
+
+    if (millis() - lastSnapshot > SNAPSHOT_INTERVAL) {
+        lastSnapshot = millis();
+        if (!transport.send(hubMac, snapshot, sizeof(snapshot))) {
+            Serial.println("Previous snapshot still going out, skipped");
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#define ENABLE_MODULE_PCF8574_MODULE
+#define ENABLE_MODULE_DIGITAL_INPUT
+#define ENABLE_MODULE_PCF8574_PORT_CACHE
+#include "Kinematrix.h"
+
+// 4 LED boards at 0x20-0x23 and 4 button boards at 0x24-0x27, 5 LEDs and 5 buttons each. Every
+// button lights the LED with the same number. Through the cache one loop is 4 reads plus one write
+// per LED board that changed, instead of 20 reads and 20 writes.
+#define BOARDS 4
+#define PINS_PER_BOARD 5
+#define STATS_INTERVAL 5000
+
+PCF8574PortCache bus(&Wire);
+
+PCF8574Module leds[BOARDS] = {
+        PCF8574Module(0x20), PCF8574Module(0x21), PCF8574Module(0x22), PCF8574Module(0x23)
+};
+
+DigitalInI2C buttons[BOARDS * PINS_PER_BOARD] = {
+        DigitalInI2C(0), DigitalInI2C(1), DigitalInI2C(2), DigitalInI2C(3), DigitalInI2C(4),
+        DigitalInI2C(0), DigitalInI2C(1), DigitalInI2C(2), DigitalInI2C(3), DigitalInI2C(4),
+        DigitalInI2C(0), DigitalInI2C(1), DigitalInI2C(2), DigitalInI2C(3), DigitalInI2C(4),
+        DigitalInI2C(0), DigitalInI2C(1), DigitalInI2C(2), DigitalInI2C(3), DigitalInI2C(4)
+};
+
+unsigned long lastStats = 0;
+
+void setup() {
+    Serial.begin(115200);
+    Wire.begin();
+    Wire.setClock(100000);
+
+    for (int board = 0; board < BOARDS; board++) {
+        leds[board].attachCache(&bus);
+        for (int pin = 0; pin < PINS_PER_BOARD; pin++) {
+            leds[board].setupLED(pin, LOW);
+        }
+    }
+
+    for (int i = 0; i < BOARDS * PINS_PER_BOARD; i++) {
+        buttons[i].init(&bus, 0x24 + i / PINS_PER_BOARD);
+        buttons[i].setDebounceTime(20);
+    }
+
+    // all LEDs off and the button pins released in one pass
+    if (!bus.commit()) Serial.println("| an expander did not answer");
+}
+
+void loop() {
+    bus.update();
+
+    for (int i = 0; i < BOARDS * PINS_PER_BOARD; i++) {
+        buttons[i].update();
+        int board = i / PINS_PER_BOARD;
+        int pin = i % PINS_PER_BOARD;
+        leds[board].digitalWrite(pin, buttons[i].getState() == LOW ? HIGH : LOW);
+    }
+
+    if (millis() - lastStats >= STATS_INTERVAL) {
+        lastStats = millis();
+        const PCF8574BusStats &stats = bus.getStats();
+        Serial.print("| reads: ");
+        Serial.print(stats.reads);
+        Serial.print("| writes: ");
+        Serial.print(stats.writes);
+        Serial.print("| errors: ");
+        Serial.print(stats.errors);
+        Serial.print("| pin reads: ");
+        Serial.print(stats.pinReads);
+        Serial.print("| pin writes: ");
+        Serial.print(stats.pinWrites);
+        Serial.println();
+        bus.resetStats();
+    }
+}
@@ -0,0 +1,71 @@
+#include <Arduino.h>
+#define ENABLE_MODULE_SPSC_RING
+#define ENABLE_MODULE_WORKER_POOL
+#include "Kinematrix.h"
+
+#define BLOCK_SIZE 128
+#define BLOCK_COUNT 4
+
+struct SampleBlock {
+  float samples[BLOCK_SIZE];
+  float rms;
+};
+
+WorkerPool pool;
+SampleBlock blocks[BLOCK_COUNT];
+SpscRing<uint16_t, 256> adcRing;
+hw_timer_t *sampleTimer = NULL;
+
+void IRAM_ATTR onSampleTimer() {
+  // ISR -> task tanpa lock dan tanpa alokasi
+  adcRing.push(analogRead(34));
+}
+
+void computeRms(void *context) {
+  SampleBlock *block = (SampleBlock *) context;
+  float sum = 0;
+  for (int i = 0; i < BLOCK_SIZE; i++) {
+    sum += block->samples[i] * block->samples[i];
+  }
+  block->rms = sqrt(sum / BLOCK_SIZE);
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  // satu worker per core, job diambil dari deque masing-masing dan dicuri saat idle
+  pool.begin(2);
+
+  sampleTimer = timerBegin(0, 80, true);
+  timerAttachInterrupt(sampleTimer, &onSampleTimer, true);
+  timerAlarmWrite(sampleTimer, 1000, true);
+  timerAlarmEnable(sampleTimer);
+
+  Serial.println("WorkerPool Dual Core Example Started");
+}
+
+void loop() {
+  static int fill = 0;
+  static int current = 0;
+  uint16_t raw;
+
+  while (adcRing.pop(raw)) {
+    blocks[current].samples[fill++] = raw;
+    if (fill == BLOCK_SIZE) {
+      pool.submit(computeRms, &blocks[current]);
+      current = (current + 1) % BLOCK_COUNT;
+      fill = 0;
+
+      if (current == 0) {
+        pool.waitIdle(100);
+        for (int i = 0; i < BLOCK_COUNT; i++) {
+          Serial.print("RMS ");
+          Serial.print(i);
+          Serial.print(": ");
+          Serial.println(blocks[i].rms);
+        }
+      }
+    }
+  }
+  delay(1);
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+// Host benchmark for WorkerPool and SpscRing, workers run on pthreads instead of FreeRTOS tasks.
+//
+//   g++ -std=c++11 -O2 -pthread -I../../../../../lib/modules/task WorkerPoolBenchmark.cpp
+//       ../../../../../lib/modules/task/WorkerPool.cpp -o WorkerPoolBenchmark
+//   ./WorkerPoolBenchmark
+
+#include <stdio.h>
+#include <thread>
+#include <chrono>
+
+#include "SpscRing.h"
+#include "WorkerPool.h"
+
+struct FilterBlock {
+    float samples[256];
+    float output;
+};
+
+static void runFilterBlock(void *context) {
+    FilterBlock *block = (FilterBlock *) context;
+    float state = 0;
+    for (int pass = 0; pass < 64; pass++) {
+        for (int i = 0; i < 256; i++) {
+            state += 0.1f * (block->samples[i] - state);
+        }
+    }
+    block->output = state;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void benchmarkRing() {
+    static SpscRing<uint32_t, 1024> ring;
+    const uint32_t messages = 10000000;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::thread consumer([&]() {
+        uint32_t expected = 0;
+        uint32_t value;
+        while (expected < messages) {
+            if (!ring.pop(value)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (value != expected) {
+                printf("ring order broken at %u\n", expected);
+                return;
+            }
+            expected++;
+        }
+    });
+
+    for (uint32_t i = 0; i < messages;) {
+        if (ring.push(i)) {
+            i++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+
+    double ms = elapsedMs(start);
+    printf("SpscRing: %u messages in %.1f ms, %.1f M msg/s\n", messages, ms, messages / ms / 1000.0);
+}
+
+static void benchmarkPool(uint8_t workerCount) {
+    static WorkerPool pool;
+    static FilterBlock blocks[512];
+    const int rounds = 20;
+
+    for (int i = 0; i < 512; i++) {
+        for (int j = 0; j < 256; j++) {
+            blocks[i].samples[j] = (float) ((i * 31 + j * 7) % 100);
+        }
+    }
+
+    pool.begin(workerCount);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < 512; i++) {
+            while (!pool.submit(runFilterBlock, &blocks[i])) {
+                std::this_thread::yield();
+            }
+        }
+        pool.waitIdle(10000);
+    }
+    double ms = elapsedMs(start);
+
+    printf("WorkerPool x%u: %d blocks in %.1f ms", workerCount, rounds * 512, ms);
+    for (uint8_t i = 0; i < workerCount; i++) {
+        WorkerPool::Stats stats;
+        pool.getStats(i, stats);
+        printf("  [w%u run %u stolen %u sleeps %u]", i, stats.executed, stats.stolen, stats.sleeps);
+    }
+    printf("\n");
+    pool.end();
+}
+
+int main() {
+    benchmarkRing();
+
+    static FilterBlock block;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20 * 512; i++) {
+        runFilterBlock(&block);
+    }
+    printf("serial: %d blocks in %.1f ms\n", 20 * 512, elapsedMs(start));
+
+    benchmarkPool(1);
+    benchmarkPool(2);
+    benchmarkPool(4);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+// Just enough of the Arduino API to build TimerWheel and TimerManager on Linux. millis() is
+// defined by TimerWheelCheck.cpp and runs on the check's virtual clock.
+#ifndef ARDUINO_HOST_SHIM_H
+#define ARDUINO_HOST_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+unsigned long millis();
+
+class String : public std::string {
+public:
+    String() {}
+    String(const char *text) : std::string(text) {}
+};
+
+#endif
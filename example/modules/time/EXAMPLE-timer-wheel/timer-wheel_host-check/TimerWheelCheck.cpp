@@ -0,0 +1,231 @@
+// Drives TimerWheel and an attached TimerManager on a virtual clock through setClock() and checks
+//
+//   order        handles fire in deadline order, equal deadlines all in one tick
+//   cancel       a cancelled handle never fires, a rescheduled one only at its new deadline
+//   wrap         deadlines on both sides of the millis() rollover keep their order
+//   budget       a zero delay reschedule from its own callback fires once per tick
+//   timer        an attached TimerManager expires from tick() on a wheel clock that is not millis(),
+//                also across the rollover
+//
+//   g++ -std=c++11 -Wall -I. TimerWheelCheck.cpp -o TimerWheelCheck
+//   ./TimerWheelCheck
+//
+// Prints one line per check and exits with the number of failures.
+
+#include <stdio.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "../../../../../lib/modules/time/timer-wheel.h"
+#include "../../../../../lib/modules/time/timer-wheel.cpp"
+#include "../../../../../lib/modules/time/timer-manager.h"
+#include "../../../../../lib/modules/time/timer-manager.cpp"
+
+// the last millis() value before the rollover, whatever the width of unsigned long on this host
+static const unsigned long ROLLOVER = (unsigned long) -1;
+
+static unsigned long clockNow = 0;
+
+unsigned long millis() {
+    return clockNow;
+}
+
+static unsigned long virtualClock() {
+    return clockNow;
+}
+
+static std::vector<uint16_t> fired;
+static int failures = 0;
+
+static void record(void *owner, uint16_t tag) {
+    (void) owner;
+    fired.push_back(tag);
+}
+
+static void expect(bool condition, const char *what) {
+    if (!condition) {
+        printf("    failed: %s\n", what);
+        failures++;
+    }
+}
+
+static void report(const char *name, int failuresBefore) {
+    printf("%-8s %s\n", name, failures == failuresBefore ? "ok" : "FAILED");
+}
+
+static void checkOrder() {
+    int before = failures;
+    TimerWheel wheel;
+    wheel.setClock(virtualClock);
+    clockNow = 1000;
+    fired.clear();
+
+    // more handles than the initial capacity, so the table grows while entries are pending
+    const unsigned long delays[] = {50, 10, 30, 10, 70, 20, 60, 40, 90, 80, 30, 5};
+    const uint16_t count = sizeof(delays) / sizeof(delays[0]);
+    for (uint16_t i = 0; i < count; i++) {
+        wheel.scheduleIn(wheel.allocate(record, nullptr, i), delays[i]);
+    }
+    expect(wheel.getPendingCount() == count, "all handles pending");
+    expect(wheel.getNextDeadline() == 1005, "earliest deadline at the top");
+
+    clockNow = 1009;
+    expect(wheel.tick() == 1, "one handle due before 10 ms");
+    clockNow = 1010;
+    expect(wheel.tick() == 2, "equal deadlines fire in the same tick");
+
+    clockNow = 1100;
+    wheel.tick();
+    expect(fired.size() == count, "every handle fired once");
+    for (size_t i = 1; i < fired.size(); i++) {
+        expect(delays[fired[i - 1]] <= delays[fired[i]], "fired in deadline order");
+    }
+    expect(!wheel.hasPending(), "nothing left pending");
+    report("order", before);
+}
+
+static void checkCancel() {
+    int before = failures;
+    TimerWheel wheel;
+    wheel.setClock(virtualClock);
+    clockNow = 0;
+    fired.clear();
+
+    TimerHandle a = wheel.allocate(record, nullptr, 1);
+    TimerHandle b = wheel.allocate(record, nullptr, 2);
+    TimerHandle c = wheel.allocate(record, nullptr, 3);
+    wheel.scheduleIn(a, 10);
+    wheel.scheduleIn(b, 20);
+    wheel.scheduleIn(c, 30);
+
+    expect(wheel.cancel(b), "cancel of a pending handle");
+    expect(!wheel.cancel(b), "second cancel is a no-op");
+    expect(!wheel.isPending(b), "cancelled handle not pending");
+    wheel.scheduleIn(a, 40);
+    expect(wheel.getRemaining(a) == 40, "reschedule moves the deadline");
+
+    clockNow = 35;
+    wheel.tick();
+    expect(fired.size() == 1 && fired[0] == 3, "only the untouched handle fired by 35 ms");
+
+    wheel.release(a);
+    expect(!wheel.scheduleIn(a, 1), "a released handle cannot be scheduled");
+    clockNow = 100;
+    wheel.tick();
+    expect(fired.size() == 1, "released and cancelled handles never fire");
+    report("cancel", before);
+}
+
+static void checkWrap() {
+    int before = failures;
+    TimerWheel wheel;
+    wheel.setClock(virtualClock);
+    clockNow = ROLLOVER - 25;
+    fired.clear();
+
+    TimerHandle late = wheel.allocate(record, nullptr, 2);
+    TimerHandle early = wheel.allocate(record, nullptr, 1);
+    TimerHandle after = wheel.allocate(record, nullptr, 3);
+    wheel.scheduleIn(late, 40);   // past the rollover, deadline 14
+    wheel.scheduleIn(early, 10);  // before the rollover
+    wheel.scheduleIn(after, 100);
+    expect(wheel.getNextDeadline() == ROLLOVER - 15, "pre rollover deadline first");
+    expect(wheel.getRemaining(late) == 40, "remaining time spans the rollover");
+
+    clockNow = ROLLOVER;
+    expect(wheel.tick() == 1, "pre rollover deadline fires before the wrap");
+    clockNow = 13;
+    expect(wheel.tick() == 0, "post rollover deadline not due early");
+    clockNow = 14;
+    expect(wheel.tick() == 1, "post rollover deadline due after the wrap");
+    clockNow = 200;
+    wheel.tick();
+    expect(fired.size() == 3 && fired[0] == 1 && fired[1] == 2 && fired[2] == 3, "order kept across the wrap");
+    report("wrap", before);
+}
+
+static TimerWheel *selfWheel = nullptr;
+static TimerHandle selfHandle = TIMER_WHEEL_INVALID;
+static int selfCount = 0;
+
+static void rescheduleSelf(void *owner, uint16_t tag) {
+    (void) owner;
+    (void) tag;
+    selfCount++;
+    selfWheel->scheduleIn(selfHandle, 0);
+}
+
+static void checkBudget() {
+    int before = failures;
+    TimerWheel wheel;
+    wheel.setClock(virtualClock);
+    clockNow = 500;
+    selfWheel = &wheel;
+    selfHandle = wheel.allocate(rescheduleSelf, nullptr);
+    wheel.scheduleIn(selfHandle, 0);
+
+    wheel.tick();
+    expect(selfCount == 1, "zero delay reschedule waits for the next tick");
+    wheel.tick();
+    expect(selfCount == 2, "and fires on it");
+    wheel.release(selfHandle);
+    report("budget", before);
+}
+
+static int timerFired = 0;
+
+// a wheel on its own clock, the timer keeps measuring on millis()
+static unsigned long skewedClock() {
+    return clockNow + 5000;
+}
+
+static void onTimer(TimerManager *timer) {
+    (void) timer;
+    timerFired++;
+}
+
+static void checkTimer() {
+    int before = failures;
+    TimerWheel wheel;
+    wheel.setClock(skewedClock);
+    clockNow = ROLLOVER - 5099;
+
+    TimerManager timer(250, TIMER_INTERVAL);
+    timer.setCallback(onTimer);
+    timer.enableAutoExecuteCallback(true);
+    timer.start();
+    expect(timer.attach(&wheel), "attach to the wheel");
+    expect(wheel.getRemaining(0) == 250, "scheduled for the full duration");
+
+    clockNow += 100;
+    timer.pause();
+    expect(!wheel.hasPending(), "paused timer leaves the wheel");
+    clockNow += 1000;
+    timer.resume();
+    expect(wheel.getRemaining(0) == 150, "resumed with the time it had left");
+
+    clockNow += 149;
+    wheel.tick();
+    expect(timerFired == 0, "not expired a millisecond early");
+    clockNow += 1;
+    wheel.tick();
+    expect(timerFired == 1, "expired by tick() past the rollover");
+    expect(wheel.getRemaining(0) == 250, "interval timer scheduled again");
+
+    clockNow += 250;
+    wheel.tick();
+    expect(timerFired == 2, "second interval");
+    timer.detach();
+    expect(!wheel.hasPending(), "detach releases the handle");
+    report("timer", before);
+}
+
+int main() {
+    checkOrder();
+    checkCancel();
+    checkWrap();
+    checkBudget();
+    checkTimer();
+    printf("%s\n", failures == 0 ? "all checks passed" : "checks FAILED");
+    return failures;
+}
@@ -0,0 +1,58 @@
+#include <Arduino.h>
+#define ENABLE_MODULE_VARIABLE_WATCHER
+#include "Kinematrix.h"
+
+#define CHANNEL_COUNT 64
+
+VariableWatcher watcher(CHANNEL_COUNT + 2);
+
+float channels[CHANNEL_COUNT];
+int relayState = 0;
+String mode = "idle";
+
+void setup() {
+  Serial.begin(115200);
+
+  for (int i = 0; i < CHANNEL_COUNT; i++) {
+    // channel hanya dilaporkan jika bergeser lebih dari 0.5
+    watcher.watch(&channels[i], "ch" + String(i), 0.5);
+  }
+  watcher.watch(&relayState, "relay");
+  watcher.watch(&mode, "mode");
+
+  Serial.println("Delta Telemetry Example Started");
+}
+
+void loop() {
+  for (int i = 0; i < CHANNEL_COUNT; i++) {
+    channels[i] = analogRead(A0) / 10.0 + random(-3, 3) * 0.1;
+  }
+  relayState = digitalRead(2);
+  mode = relayState ? "active" : "idle";
+
+  // hanya entry yang berubah yang dikirim, biaya publish mengikuti jumlah perubahan
+  if (watcher.checkAll() > 0) {
+    Serial.print("{");
+    bool first = true;
+    for (int i = watcher.nextChanged(); i >= 0; i = watcher.nextChanged(i)) {
+      if (!first) Serial.print(",");
+      first = false;
+
+      Serial.print("\"");
+      Serial.print(watcher.getName(i));
+      Serial.print("\":");
+      if (watcher.getType(i) == WATCH_FLOAT) {
+        Serial.print(watcher.get<float>(i));
+      } else if (watcher.getType(i) == WATCH_STRING) {
+        Serial.print("\"");
+        Serial.print(watcher.get<String>(i));
+        Serial.print("\"");
+      } else {
+        Serial.print(watcher.get<int>(i));
+      }
+    }
+    Serial.println("}");
+  }
+
+  delay(200);
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "CeriaDevOP.h"
+
+CeriaSerial link;
+
+uint32_t lastSend = 0;
+uint32_t counter = 0;
+
+void onLinkReceive(const String &key, const String &value) {
+    Serial.println("RX " + key + " = " + value);
+}
+
+void onLinkDelivered(uint8_t sequence) {
+    Serial.println("ACK #" + String(sequence));
+}
+
+void onLinkFailed(uint8_t sequence) {
+    Serial.println("LOST #" + String(sequence));
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial2.begin(115200, SERIAL_8N1, 16, 17);
+    delay(2000);
+
+    Serial.println("=== CeriaSerial Reliable Example ===");
+
+    link.begin(Serial2, 115200, FRAME_128B);
+    link.setWindow(4);
+    link.setRetries(5);
+    link.onReceive(onLinkReceive);
+    link.onDelivered(onLinkDelivered);
+    link.onFailed(onLinkFailed);
+
+    // configuration has to arrive before streaming starts
+    link.send("mode", "stream", true);
+    if (link.waitForDelivery(1000)) {
+        Serial.println("Peer configured");
+    } else {
+        Serial.println("Peer did not confirm configuration");
+    }
+}
+
+void loop() {
+    link.tick();
+
+    if (millis() - lastSend >= 50) {
+        lastSend = millis();
+
+        // a burst of reliable frames, several in flight at once
+        if (link.send("count", counter, true)) {
+            counter++;
+        } else {
+            Serial.println("TX queue full, pending " + String(link.getPendingCount()));
+        }
+    }
+
+    static uint32_t lastReport = 0;
+    if (millis() - lastReport >= 5000) {
+        lastReport = millis();
+
+        uint32_t delivered, failed, retransmissions;
+        link.getReliableStats(delivered, failed, retransmissions);
+        Serial.println("Delivered: " + String(delivered) + " Failed: " + String(failed) +
+                       " Retransmissions: " + String(retransmissions));
+    }
+}
@@ -212,18 +212,7 @@ namespace CeriaDevOP {
     }
 
     uint16_t CeriaDisplayDWIN::calculateCRC16(uint8_t *data, uint8_t length) {
-        uint16_t crc = 0xFFFF;
-        for (uint8_t i = 0; i < length; i++) {
-            crc ^= data[i];
-            for (uint8_t j = 0; j < 8; j++) {
-                if (crc & 0x0001) {
-                    crc = (crc >> 1) ^ 0xA001;
-                } else {
-                    crc >>= 1;
-                }
-            }
-        }
-        return crc;
+        return FrameCrc::crc16Modbus(data, length);
     }
 
     bool CeriaDisplayDWIN::sendCommand(uint8_t cmd, uint16_t address, uint8_t *data, uint8_t dataLength) {
@@ -7,6 +7,7 @@
 
 #include "Arduino.h"
 #include "Stream.h"
+#include "../../../modules/communication/codec/frame-crc.h"
 
 #define DWIN_HEADER_H                    0x5A
 #define DWIN_HEADER_L                    0xA5
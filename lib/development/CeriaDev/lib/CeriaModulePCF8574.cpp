@@ -11,6 +11,7 @@ namespace CeriaDevOP {
         _encoderSetup = false;
         _encoderPinA = 0;
         _encoderPinB = 0;
+        _portCache = nullptr;
     }
 
     CeriaModulePCF8574::CeriaModulePCF8574(uint8_t address, uint8_t interruptPin, void (*interruptFunction)())
@@ -23,6 +24,7 @@ namespace CeriaDevOP {
         _encoderSetup = false;
         _encoderPinA = 0;
         _encoderPinB = 0;
+        _portCache = nullptr;
     }
 
 #if !defined(__AVR) && !defined(ARDUINO_ARCH_SAMD) && !defined(TEENSYDUINO)
@@ -36,6 +38,7 @@ namespace CeriaDevOP {
         _encoderSetup = false;
         _encoderPinA = 0;
         _encoderPinB = 0;
+        _portCache = nullptr;
     }
 
     CeriaModulePCF8574::CeriaModulePCF8574(uint8_t address, int sda, int scl, uint8_t interruptPin, void (*interruptFunction)())
@@ -48,6 +51,7 @@ namespace CeriaDevOP {
         _encoderSetup = false;
         _encoderPinA = 0;
         _encoderPinB = 0;
+        _portCache = nullptr;
     }
 
 #endif
@@ -63,6 +67,7 @@ namespace CeriaDevOP {
         _encoderSetup = false;
         _encoderPinA = 0;
         _encoderPinB = 0;
+        _portCache = nullptr;
     }
 
     CeriaModulePCF8574::CeriaModulePCF8574(TwoWire *pWire, uint8_t address, uint8_t interruptPin, void (*interruptFunction)())
@@ -75,6 +80,7 @@ namespace CeriaDevOP {
         _encoderSetup = false;
         _encoderPinA = 0;
         _encoderPinB = 0;
+        _portCache = nullptr;
     }
 
 #endif
@@ -91,6 +97,7 @@ namespace CeriaDevOP {
         _encoderSetup = false;
         _encoderPinA = 0;
         _encoderPinB = 0;
+        _portCache = nullptr;
     }
 
     CeriaModulePCF8574::CeriaModulePCF8574(TwoWire *pWire, uint8_t address, int sda, int scl, uint8_t interruptPin, void (*interruptFunction)())
@@ -103,6 +110,7 @@ namespace CeriaDevOP {
         _encoderSetup = false;
         _encoderPinA = 0;
         _encoderPinB = 0;
+        _portCache = nullptr;
     }
 
 #endif
@@ -142,18 +150,31 @@ namespace CeriaDevOP {
     }
 
     bool CeriaModulePCF8574::isConnected(uint32_t timeoutMs) {
-        return isLastTransmissionSuccess() && (millis() - _lastUpdateTime) < timeoutMs;
+        return isLinkOk() && (millis() - _lastUpdateTime) < timeoutMs;
     }
 
     void CeriaModulePCF8574::setPinMode(uint8_t pin, PCF8574PinMode mode, uint8_t output_start) {
+        if (_portCache != nullptr) {
+            if (mode == PCF8574_PIN_OUTPUT) {
+                _portCache->setOutput(_i2cAddress, pin, output_start);
+            } else {
+                _portCache->setInput(_i2cAddress, pin);
+            }
+            return;
+        }
         PCF8574::pinMode(pin, mode, output_start);
     }
 
     uint8_t CeriaModulePCF8574::readPin(uint8_t pin) {
+        if (_portCache != nullptr) return _portCache->read(_i2cAddress, pin);
         return PCF8574::digitalRead(pin);
     }
 
     bool CeriaModulePCF8574::writePin(uint8_t pin, uint8_t value) {
+        if (_portCache != nullptr) {
+            _portCache->write(_i2cAddress, pin, value);
+            return true;
+        }
         return PCF8574::digitalWrite(pin, value);
     }
 
@@ -213,6 +234,8 @@ namespace CeriaDevOP {
     }
 
     uint8_t CeriaModulePCF8574::readAllPins() {
+        if (_portCache != nullptr) return _portCache->readAll(_i2cAddress);
+
 #ifndef PCF8574_LOW_MEMORY
         PCF8574::DigitalInput inputs = PCF8574::digitalReadAll();
         return (inputs.p7 << 7) | (inputs.p6 << 6) | (inputs.p5 << 5) | (inputs.p4 << 4) |
@@ -223,6 +246,11 @@ namespace CeriaDevOP {
     }
 
     bool CeriaModulePCF8574::writeAllPins(uint8_t pinValues) {
+        if (_portCache != nullptr) {
+            _portCache->writeAll(_i2cAddress, pinValues);
+            return true;
+        }
+
 #ifndef PCF8574_LOW_MEMORY
         PCF8574::DigitalInput outputs;
         outputs.p0 = (pinValues & 0x01) ? HIGH : LOW;
@@ -248,7 +276,7 @@ namespace CeriaDevOP {
     }
 
     String CeriaModulePCF8574::getPinStatusString() {
-        if (!isLastTransmissionSuccess()) return "PCF8574 Error";
+        if (!isLinkOk()) return "PCF8574 Error";
 
         uint8_t pinStates = readAllPins();
         String result = "Pins: ";
@@ -260,7 +288,7 @@ namespace CeriaDevOP {
     }
 
     String CeriaModulePCF8574::getModuleStatusString() {
-        if (!isLastTransmissionSuccess()) return "PCF8574 Error";
+        if (!isLinkOk()) return "PCF8574 Error";
 
         String result = "PCF8574@0x" + String(_i2cAddress, HEX);
         result += ", Pins: 0x" + String(readAllPins(), HEX);
@@ -273,6 +301,9 @@ namespace CeriaDevOP {
         if (_encoderSetup) {
             result += ", ENC: P" + String(_encoderPinA) + "/P" + String(_encoderPinB);
         }
+        if (_portCache != nullptr) {
+            result += ", CACHE: ON";
+        }
         return result;
     }
 
@@ -281,6 +312,7 @@ namespace CeriaDevOP {
         uint8_t initialStates = readAllPins();
 
         while (millis() - startTime < timeoutMs) {
+            if (_portCache != nullptr) _portCache->update();
             update();
             if (hasNewData() && readAllPins() != initialStates) {
                 return true;
@@ -290,4 +322,18 @@ namespace CeriaDevOP {
         return false;
     }
 
+    void CeriaModulePCF8574::attachCache(PCF8574PortCache *portCache) {
+        _portCache = portCache;
+        if (_portCache != nullptr) _portCache->attach(_i2cAddress);
+    }
+
+    PCF8574PortCache *CeriaModulePCF8574::getCache() {
+        return _portCache;
+    }
+
+    bool CeriaModulePCF8574::isLinkOk() {
+        if (_portCache != nullptr) return _portCache->isOnline(_i2cAddress);
+        return isLastTransmissionSuccess();
+    }
+
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "Arduino.h"
 #include "PCF8574.h"
+#include "../../../modules/io/pcf8574-port-cache.h"
 
 namespace CeriaDevOP {
 
@@ -74,7 +75,13 @@ namespace CeriaDevOP {
 
         bool waitForChange(uint32_t timeoutMs = 5000);
 
+        // pin and port access goes through the bus cache, attach before setPinMode(); update() then
+        // checks the byte the cache read instead of the chip
+        void attachCache(PCF8574PortCache *portCache);
+        PCF8574PortCache *getCache();
+
     private:
+        PCF8574PortCache *_portCache;
         bool _hasNewData;
         uint32_t _lastUpdateTime;
         uint8_t _i2cAddress;
@@ -83,6 +90,8 @@ namespace CeriaDevOP {
         bool _encoderSetup;
         uint8_t _encoderPinA;
         uint8_t _encoderPinB;
+
+        bool isLinkOk();
     };
 
 }
@@ -6,10 +6,16 @@ namespace CeriaDevOP {
             : _serial(nullptr), _baudRate(115200), _frameSize(FRAME_AUTO), _duplexMode(FULL_DUPLEX),
               _sequenceNumber(0), _lastHeartbeat(0), _timeout(CERIA_SERIAL_DEFAULT_TIMEOUT),
               _retryCount(0), _maxRetries(3), _txBuffer(nullptr), _rxBuffer(nullptr),
-              _bufferSize(0), _rxIndex(0), _inFrame(false), _escaped(false),
+              _txStorage(nullptr), _bufferSize(0),
+              _txQueue(nullptr), _window(CERIA_SERIAL_DEFAULT_WINDOW), _nextSequence(0), _sendSequence(0),
+              _epoch(0), _retransmitTimeout(0), _autoRetransmitTimeout(true),
+              _txSynced(false), _syncAttempts(0), _syncSentAt(0),
+              _rxHighest(0), _rxEpoch(0), _rxWindow(0), _rxSynced(false),
+              _rxIndex(0),
               _lastActivity(0), _backoffTime(0), _channelBusy(false),
-              _onReceive(nullptr), _onError(nullptr),
-              _framesSent(0), _framesReceived(0), _crcErrors(0), _collisions(0) {
+              _onReceive(nullptr), _onError(nullptr), _onDelivered(nullptr), _onFailed(nullptr),
+              _framesSent(0), _framesReceived(0), _crcErrors(0), _collisions(0),
+              _delivered(0), _failed(0), _retransmissions(0) {
     }
 
     CeriaSerial::~CeriaSerial() {
@@ -28,10 +34,18 @@ namespace CeriaDevOP {
 
         _sequenceNumber = 0;
         _rxIndex = 0;
-        _inFrame = false;
-        _escaped = false;
+        _parser.begin(_rxBuffer, _bufferSize);
         _lastHeartbeat = millis();
 
+        // the epoch tells frames of this run from late ones of the last; it can repeat after a restart,
+        // so the SYNC, not the epoch, is what clears the peer's duplicate window
+        _epoch = static_cast<uint8_t>(micros() ^ random(256));
+        _nextSequence = 0;
+        _sendSequence = 0;
+        _rxSynced = false;
+        if (_autoRetransmitTimeout) setRetransmitTimeout(0);
+        sendSync();
+
         return true;
     }
 
@@ -45,6 +59,22 @@ namespace CeriaDevOP {
         _maxRetries = count;
     }
 
+    void CeriaSerial::setWindow(uint8_t frames) {
+        uint8_t limit = (CERIA_SERIAL_TX_QUEUE < CERIA_SERIAL_MAX_WINDOW) ? CERIA_SERIAL_TX_QUEUE : CERIA_SERIAL_MAX_WINDOW;
+        _window = (frames == 0) ? 1 : (frames > limit ? limit : frames);
+    }
+
+    void CeriaSerial::setRetransmitTimeout(uint32_t ms) {
+        _autoRetransmitTimeout = (ms == 0);
+        if (_autoRetransmitTimeout) {
+            // a worst case frame is fully escaped: twice the buffer at 10 bits per byte, out and back
+            uint32_t frameTime = (_baudRate > 0) ? (uint32_t) _bufferSize * 2 * 10 * 1000 / _baudRate : 0;
+            _retransmitTimeout = frameTime * 2 + 20;
+        } else {
+            _retransmitTimeout = ms;
+        }
+    }
+
     void CeriaSerial::onReceive(CeriaSerialReceiveCallback callback) {
         _onReceive = callback;
     }
@@ -53,6 +83,14 @@ namespace CeriaDevOP {
         _onError = callback;
     }
 
+    void CeriaSerial::onDelivered(CeriaSerialDeliveryCallback callback) {
+        _onDelivered = callback;
+    }
+
+    void CeriaSerial::onFailed(CeriaSerialDeliveryCallback callback) {
+        _onFailed = callback;
+    }
+
     bool CeriaSerial::sendTyped(const String &key, int value, bool reliable) {
         return sendInternal(key, String(value), CERIA_SERIAL_TYPE_INT, reliable);
     }
@@ -118,6 +156,8 @@ namespace CeriaDevOP {
         if (_duplexMode == HALF_DUPLEX) {
             _channelBusy = (now - _lastActivity) < 10;
         }
+
+        serviceQueue();
     }
 
     bool CeriaSerial::isConnected() {
@@ -129,7 +169,7 @@ namespace CeriaDevOP {
     }
 
     void CeriaSerial::ping() {
-        sendInternal("ping", String(millis()), CERIA_SERIAL_CMD_PING, false);
+        sendInternal("ping", String(millis()), CERIA_SERIAL_TYPE_INT, false, CERIA_SERIAL_CMD_PING);
     }
 
     void CeriaSerial::getStats(uint32_t &sent, uint32_t &received, uint32_t &errors) {
@@ -138,21 +178,67 @@ namespace CeriaDevOP {
         errors = _crcErrors + _collisions;
     }
 
+    void CeriaSerial::getReliableStats(uint32_t &delivered, uint32_t &failed, uint32_t &retransmissions) {
+        delivered = _delivered;
+        failed = _failed;
+        retransmissions = _retransmissions;
+    }
+
     void CeriaSerial::reset() {
         _framesSent = 0;
         _framesReceived = 0;
         _crcErrors = 0;
         _collisions = 0;
+        _delivered = 0;
+        _failed = 0;
+        _retransmissions = 0;
         _rxIndex = 0;
-        _inFrame = false;
-        _escaped = false;
+        _parser.reset();
         _sequenceNumber = 0;
+
+        // queued frames are dropped without callbacks; the new epoch keeps late ACKs of them from matching
+        if (_txQueue) {
+            for (uint8_t i = 0; i < CERIA_SERIAL_TX_QUEUE; i++) {
+                _txQueue[i].state = TX_SLOT_FREE;
+            }
+        }
+        _nextSequence = 0;
+        _sendSequence = 0;
+        _epoch++;
+        _rxSynced = false;
+        if (_serial) sendSync();
+    }
+
+    uint8_t CeriaSerial::getPendingCount() {
+        if (!_txQueue) return 0;
+
+        uint8_t pending = 0;
+        for (uint8_t i = 0; i < CERIA_SERIAL_TX_QUEUE; i++) {
+            if (_txQueue[i].state != TX_SLOT_FREE) pending++;
+        }
+        return pending;
+    }
+
+    uint8_t CeriaSerial::getLastSequence() {
+        return static_cast<uint8_t>(_nextSequence - 1);
     }
 
-    bool CeriaSerial::sendInternal(const String &key, const String &value, uint8_t dataType, bool reliable) {
+    bool CeriaSerial::waitForDelivery(uint32_t timeoutMs) {
+        uint32_t startTime = millis();
+        while (getPendingCount() > 0) {
+            if (millis() - startTime >= timeoutMs) return false;
+            tick();
+            yield();
+        }
+        return true;
+    }
+
+    bool CeriaSerial::sendInternal(const String &key, const String &value, uint8_t dataType, bool reliable,
+                                   uint8_t cmd) {
         if (!_serial) return false;
 
-        if (_duplexMode == HALF_DUPLEX) {
+        // reliable frames wait in the queue for a clear channel instead of failing here
+        if (_duplexMode == HALF_DUPLEX && !reliable) {
             if (!isChannelClear()) {
                 handleCollision();
                 return false;
@@ -162,42 +248,46 @@ namespace CeriaDevOP {
         String payload = key + ":" + value;
         uint16_t payloadLen = payload.length();
 
-        if (payloadLen + 6 > _bufferSize) {
+        if (payloadLen + (reliable ? 8 : 6) > _bufferSize) {
             triggerError(CERIA_SERIAL_ERR_FRAME_TOO_LARGE);
             return false;
         }
 
+        // the frame is built unescaped, the CRC covers these bytes and escaping happens on the way out
         uint16_t frameIndex = 0;
 
-        _txBuffer[frameIndex++] = CERIA_SERIAL_STX;
         _txBuffer[frameIndex++] = payloadLen & 0xFF;
 
-        uint8_t flags = (CERIA_SERIAL_CMD_DATA << 5) | (dataType << 2) | (_sequenceNumber & 0x03);
-        _txBuffer[frameIndex++] = flags;
+        if (reliable) {
+            _txBuffer[frameIndex++] = (CERIA_SERIAL_CMD_RELIABLE << 5) | (dataType << 2);
+            _txBuffer[frameIndex++] = _nextSequence;
+            _txBuffer[frameIndex++] = _epoch;
+        } else {
+            _txBuffer[frameIndex++] = (cmd << 5) | (dataType << 2) | (_sequenceNumber & 0x03);
+        }
 
         for (uint16_t i = 0; i < payloadLen; i++) {
-            uint8_t byte = payload[i];
-            if (byte == CERIA_SERIAL_STX || byte == CERIA_SERIAL_ETX || byte == CERIA_SERIAL_ESC) {
-                _txBuffer[frameIndex++] = CERIA_SERIAL_ESC;
-                _txBuffer[frameIndex++] = byte ^ CERIA_SERIAL_XOR;
-            } else {
-                _txBuffer[frameIndex++] = byte;
-            }
+            _txBuffer[frameIndex++] = payload[i];
         }
 
-        uint16_t crc = calculateCRC16(_txBuffer + 1, frameIndex - 1);
+        uint16_t crc = calculateCRC16(_txBuffer, frameIndex);
         _txBuffer[frameIndex++] = crc & 0xFF;
         _txBuffer[frameIndex++] = (crc >> 8) & 0xFF;
 
-        _txBuffer[frameIndex++] = CERIA_SERIAL_ETX;
-
-        bool success = sendFrame(_txBuffer, frameIndex, reliable);
-        if (success) {
-            _framesSent++;
-            _sequenceNumber = (_sequenceNumber + 1) & 0x03;
+        if (reliable) {
+            if (!enqueueReliable(_txBuffer, frameIndex)) {
+                triggerError(CERIA_SERIAL_ERR_BUFFER_FULL);
+                return false;
+            }
+            serviceQueue();
+            return true;
         }
 
-        return success;
+        writeFrame(_txBuffer, frameIndex);
+        _framesSent++;
+        _sequenceNumber = (_sequenceNumber + 1) & 0x03;
+
+        return true;
     }
 
     uint16_t CeriaSerial::getOptimalFrameSize() {
@@ -215,6 +305,22 @@ namespace CeriaDevOP {
 
         _bufferSize = static_cast<uint16_t>(_frameSize);
 
+        _txQueue = new TxSlot[CERIA_SERIAL_TX_QUEUE];
+        _txStorage = new uint8_t[CERIA_SERIAL_TX_QUEUE * _bufferSize];
+        if (!_txQueue || !_txStorage) {
+            freeBuffers();
+            return false;
+        }
+
+        for (uint8_t i = 0; i < CERIA_SERIAL_TX_QUEUE; i++) {
+            _txQueue[i].data = _txStorage + i * _bufferSize;
+            _txQueue[i].length = 0;
+            _txQueue[i].sequence = 0;
+            _txQueue[i].attempts = 0;
+            _txQueue[i].sentAt = 0;
+            _txQueue[i].state = TX_SLOT_FREE;
+        }
+
         if (_bufferSize <= 128) {
             static uint8_t staticTxBuffer[128];
             static uint8_t staticRxBuffer[128];
@@ -238,78 +344,221 @@ namespace CeriaDevOP {
             delete[] _txBuffer;
             delete[] _rxBuffer;
         }
+        delete[] _txQueue;
+        delete[] _txStorage;
         _txBuffer = nullptr;
         _rxBuffer = nullptr;
+        _txQueue = nullptr;
+        _txStorage = nullptr;
         _bufferSize = 0;
     }
 
     uint16_t CeriaSerial::calculateCRC16(const uint8_t *data, uint16_t length) {
-        uint16_t crc = 0xFFFF;
-
-        for (uint16_t i = 0; i < length; i++) {
-            crc ^= data[i];
-            for (uint8_t j = 0; j < 8; j++) {
-                if (crc & 0x0001) {
-                    crc = (crc >> 1) ^ 0xA001;
-                } else {
-                    crc >>= 1;
+        return FrameCrc::crc16Modbus(data, length);
+    }
+
+    void CeriaSerial::writeFrame(const uint8_t *frame, uint16_t length) {
+        // every byte after STX is escaped, length, flags and CRC included
+        FrameEscape::write(_serial, frame, length);
+    }
+
+    void CeriaSerial::sendControl(uint8_t cmd, uint8_t sequence, uint8_t epoch) {
+        uint8_t frame[6];
+        frame[0] = 0;
+        frame[1] = cmd << 5;
+        frame[2] = sequence;
+        frame[3] = epoch;
+
+        uint16_t crc = calculateCRC16(frame, 4);
+        frame[4] = crc & 0xFF;
+        frame[5] = (crc >> 8) & 0xFF;
+
+        writeFrame(frame, sizeof(frame));
+    }
+
+    void CeriaSerial::sendSync() {
+        _txSynced = false;
+        _syncAttempts = 1;
+        _syncSentAt = millis();
+        sendControl(CERIA_SERIAL_CMD_SYNC, 0, _epoch);
+    }
+
+    // true once the peer acknowledged the SYNC; until then it is repeated while reliable frames wait
+    bool CeriaSerial::serviceSync() {
+        if (_txSynced) return true;
+        if (_sendSequence == _nextSequence) return false;
+
+        if (_syncAttempts > 0) {
+            uint8_t shift = (_syncAttempts - 1 < 3) ? _syncAttempts - 1 : 3;
+            if (millis() - _syncSentAt < (_retransmitTimeout << shift)) return false;
+
+            if (_syncAttempts > _maxRetries) {
+                // no peer: the waiting frames fail like unacknowledged ones, the next send starts over
+                for (uint8_t i = 0; i < CERIA_SERIAL_TX_QUEUE; i++) {
+                    if (_txQueue[i].state == TX_SLOT_QUEUED) releaseSlot(_txQueue[i], false);
                 }
+                _sendSequence = _nextSequence;
+                _syncAttempts = 0;
+                return false;
             }
         }
 
-        return crc;
+        _syncAttempts++;
+        _syncSentAt = millis();
+        sendControl(CERIA_SERIAL_CMD_SYNC, 0, _epoch);
+        return false;
     }
 
-    bool CeriaSerial::sendFrame(const uint8_t *frame, uint16_t length, bool reliable) {
-        if (!_serial) return false;
+    bool CeriaSerial::enqueueReliable(const uint8_t *frame, uint16_t length) {
+        if (!_txQueue) return false;
 
-        uint8_t attempts = 0;
+        for (uint8_t i = 0; i < CERIA_SERIAL_TX_QUEUE; i++) {
+            TxSlot &slot = _txQueue[i];
+            if (slot.state != TX_SLOT_FREE) continue;
 
-        do {
-            _serial->write(frame, length);
-            _serial->flush();
+            memcpy(slot.data, frame, length);
+            slot.length = length;
+            slot.sequence = _nextSequence++;
+            slot.attempts = 0;
+            slot.state = TX_SLOT_QUEUED;
+            return true;
+        }
+        return false;
+    }
+
+    void CeriaSerial::transmitSlot(TxSlot &slot) {
+        writeFrame(slot.data, slot.length);
+
+        if (slot.attempts == 0) {
+            _framesSent++;
+        } else {
+            _retransmissions++;
+        }
+        if (slot.attempts < 255) slot.attempts++;
+        slot.sentAt = millis();
+        slot.state = TX_SLOT_IN_FLIGHT;
+    }
+
+    void CeriaSerial::releaseSlot(TxSlot &slot, bool delivered) {
+        uint8_t sequence = slot.sequence;
+        slot.state = TX_SLOT_FREE;
+
+        if (delivered) {
+            _delivered++;
+            if (_onDelivered) _onDelivered(sequence);
+        } else {
+            _failed++;
+            triggerError(CERIA_SERIAL_ERR_TIMEOUT);
+            if (_onFailed) _onFailed(sequence);
+        }
+    }
+
+    void CeriaSerial::serviceQueue() {
+        if (!_serial || !_txQueue) return;
+        if (_duplexMode == HALF_DUPLEX && !isChannelClear()) return;
+        if (!serviceSync()) return;
 
-            if (!reliable) {
-                return true;
+        uint32_t now = millis();
+        TxSlot *oldest = nullptr;
+
+        for (uint8_t i = 0; i < CERIA_SERIAL_TX_QUEUE; i++) {
+            TxSlot &slot = _txQueue[i];
+            if (slot.state != TX_SLOT_IN_FLIGHT) continue;
+
+            // each retransmission waits twice as long as the one before, up to 8 times the base
+            uint8_t shift = (slot.attempts - 1 < 3) ? slot.attempts - 1 : 3;
+            if (now - slot.sentAt >= (_retransmitTimeout << shift)) {
+                if (slot.attempts > _maxRetries) {
+                    releaseSlot(slot, false);
+                    continue;
+                }
+                transmitSlot(slot);
             }
 
-            uint32_t startTime = millis();
-            while (millis() - startTime < _timeout) {
-                tick();
+            if (!oldest || static_cast<uint8_t>(_sendSequence - slot.sequence) >
+                           static_cast<uint8_t>(_sendSequence - oldest->sequence)) {
+                oldest = &slot;
             }
+        }
 
-            attempts++;
-        } while (attempts < _maxRetries);
+        // new frames go out in sequence order while the window past the oldest unacknowledged one has room
+        while (_sendSequence != _nextSequence) {
+            if (oldest && static_cast<uint8_t>(_sendSequence - oldest->sequence) >= _window) break;
 
-        return attempts < _maxRetries;
+            TxSlot *next = nullptr;
+            for (uint8_t i = 0; i < CERIA_SERIAL_TX_QUEUE; i++) {
+                if (_txQueue[i].state == TX_SLOT_QUEUED && _txQueue[i].sequence == _sendSequence) {
+                    next = &_txQueue[i];
+                    break;
+                }
+            }
+            if (!next) break;
+
+            transmitSlot(*next);
+            _sendSequence++;
+            if (!oldest) oldest = next;
+        }
     }
 
-    void CeriaSerial::processIncomingByte(uint8_t byte) {
-        if (!_inFrame) {
-            if (byte == CERIA_SERIAL_STX) {
-                _inFrame = true;
-                _rxIndex = 0;
-                _escaped = false;
+    void CeriaSerial::handleAck(uint8_t sequence, uint8_t epoch, bool negative) {
+        if (!_txQueue || epoch != _epoch) return;
+
+        for (uint8_t i = 0; i < CERIA_SERIAL_TX_QUEUE; i++) {
+            TxSlot &slot = _txQueue[i];
+            if (slot.state != TX_SLOT_IN_FLIGHT || slot.sequence != sequence) continue;
+
+            if (negative) {
+                // the peer saw a later frame arrive first, resend on the next tick instead of waiting out the timer
+                slot.sentAt = millis() - (_retransmitTimeout << 3);
+            } else {
+                releaseSlot(slot, true);
             }
             return;
         }
+    }
 
-        if (_escaped) {
-            byte ^= CERIA_SERIAL_XOR;
-            _escaped = false;
-        } else if (byte == CERIA_SERIAL_ESC) {
-            _escaped = true;
-            return;
-        } else if (byte == CERIA_SERIAL_ETX) {
-            processCompleteFrame();
-            _inFrame = false;
-            return;
+    CeriaSerial::RxVerdict CeriaSerial::acceptSequence(uint8_t sequence, uint8_t epoch) {
+        // without a SYNC since our own start the sender is already mid stream, take it from here
+        if (!_rxSynced) {
+            _rxSynced = true;
+            _rxEpoch = epoch;
+            _rxHighest = sequence;
+            _rxWindow = 1;
+            return RX_NEW;
+        }
+        // a new epoch always starts with a SYNC, anything else is left over from before it
+        if (epoch != _rxEpoch) return RX_STALE;
+
+        // bit n of the window is set when sequence _rxHighest - n has been received
+        int8_t distance = static_cast<int8_t>(sequence - _rxHighest);
+        if (distance > 0) {
+            if (distance <= CERIA_SERIAL_MAX_WINDOW) {
+                for (uint8_t missing = _rxHighest + 1; missing != sequence; missing++) {
+                    sendControl(CERIA_SERIAL_CMD_NAK, missing, epoch);
+                }
+            }
+            _rxWindow = (distance < 32) ? (_rxWindow << distance) | 1 : 1;
+            _rxHighest = sequence;
+            return RX_NEW;
         }
 
-        if (_rxIndex < _bufferSize - 1) {
-            _rxBuffer[_rxIndex++] = byte;
-        } else {
-            _inFrame = false;
+        uint8_t age = static_cast<uint8_t>(-distance);
+        if (age >= 32) return RX_STALE;
+
+        uint32_t mask = static_cast<uint32_t>(1) << age;
+        if (_rxWindow & mask) return RX_DUPLICATE;
+
+        _rxWindow |= mask;
+        return RX_NEW;
+    }
+
+    void CeriaSerial::processIncomingByte(uint8_t byte) {
+        FrameStatus status = _parser.push(byte);
+
+        if (status == FRAME_READY) {
+            _rxIndex = _parser.length();
+            processCompleteFrame();
+        } else if (status == FRAME_OVERFLOW) {
             triggerError(CERIA_SERIAL_ERR_BUFFER_FULL);
         }
     }
@@ -322,7 +571,6 @@ namespace CeriaDevOP {
 
         uint8_t cmd = (flags >> 5) & 0x07;
         uint8_t dataType = (flags >> 2) & 0x07;
-        uint8_t seq = flags & 0x03;
 
         uint16_t receivedCRC = _rxBuffer[_rxIndex - 2] | (_rxBuffer[_rxIndex - 1] << 8);
         uint16_t calculatedCRC = calculateCRC16(_rxBuffer, _rxIndex - 2);
@@ -333,8 +581,43 @@ namespace CeriaDevOP {
             return;
         }
 
+        uint16_t payloadStart = 2;
+
+        if (cmd == CERIA_SERIAL_CMD_ACK || cmd == CERIA_SERIAL_CMD_NAK) {
+            if (_rxIndex >= 6) handleAck(_rxBuffer[2], _rxBuffer[3], cmd == CERIA_SERIAL_CMD_NAK);
+            return;
+        }
+
+        if (cmd == CERIA_SERIAL_CMD_SYNC) {
+            if (_rxIndex < 6) return;
+
+            // the peer (re)started, the next reliable frame is its sequence 0 whatever the epoch
+            _rxSynced = true;
+            _rxEpoch = _rxBuffer[3];
+            _rxHighest = 0xFF;
+            _rxWindow = 0;
+            sendControl(CERIA_SERIAL_CMD_SYNC_ACK, 0, _rxBuffer[3]);
+            return;
+        }
+
+        if (cmd == CERIA_SERIAL_CMD_SYNC_ACK) {
+            if (_rxIndex >= 6 && _rxBuffer[3] == _epoch) _txSynced = true;
+            return;
+        }
+
+        if (cmd == CERIA_SERIAL_CMD_RELIABLE) {
+            if (_rxIndex < 6) return;
+
+            RxVerdict verdict = acceptSequence(_rxBuffer[2], _rxBuffer[3]);
+            // a duplicate is acknowledged again, its first ACK may be the one that got lost; a stale
+            // frame is not, its ACK could match a different frame of the current epoch
+            if (verdict != RX_STALE) sendControl(CERIA_SERIAL_CMD_ACK, _rxBuffer[2], _rxBuffer[3]);
+            if (verdict != RX_NEW) return;
+            payloadStart = 4;
+        }
+
         String payload = "";
-        for (uint16_t i = 2; i < _rxIndex - 2; i++) {
+        for (uint16_t i = payloadStart; i < _rxIndex - 2; i++) {
             payload += (char) _rxBuffer[i];
         }
 
@@ -346,6 +629,7 @@ namespace CeriaDevOP {
 
         switch (cmd) {
             case CERIA_SERIAL_CMD_DATA:
+            case CERIA_SERIAL_CMD_RELIABLE:
                 if (_onReceive) {
                     _onReceive(key, value);
                 }
@@ -356,9 +640,6 @@ namespace CeriaDevOP {
                 sendInternal("pong", value, CERIA_SERIAL_TYPE_STRING, false);
                 break;
 
-            case CERIA_SERIAL_CMD_ACK:
-                break;
-
             default:
                 break;
         }
@@ -7,16 +7,21 @@
 
 #include "Arduino.h"
 #include "Stream.h"
+#include "../../../modules/communication/codec/frame-codec.h"
 
-#define CERIA_SERIAL_STX           0x7E
-#define CERIA_SERIAL_ETX           0x7F
-#define CERIA_SERIAL_ESC           0x7D
-#define CERIA_SERIAL_XOR           0x20
+#define CERIA_SERIAL_STX           FRAME_STX
+#define CERIA_SERIAL_ETX           FRAME_ETX
+#define CERIA_SERIAL_ESC           FRAME_ESC
+#define CERIA_SERIAL_XOR           FRAME_XOR
 
 #define CERIA_SERIAL_CMD_DATA            0x00
 #define CERIA_SERIAL_CMD_ACK             0x01
 #define CERIA_SERIAL_CMD_PING            0x02
 #define CERIA_SERIAL_CMD_HEARTBEAT       0x03
+#define CERIA_SERIAL_CMD_RELIABLE        0x04
+#define CERIA_SERIAL_CMD_NAK             0x05
+#define CERIA_SERIAL_CMD_SYNC            0x06
+#define CERIA_SERIAL_CMD_SYNC_ACK        0x07
 
 #define CERIA_SERIAL_TYPE_STRING         0x00
 #define CERIA_SERIAL_TYPE_INT            0x01
@@ -52,9 +57,33 @@ namespace CeriaDevOP {
 
     typedef void (*CeriaSerialReceiveCallback)(const String &key, const String &value);
     typedef void (*CeriaSerialErrorCallback)(CeriaSerialError error);
+    typedef void (*CeriaSerialDeliveryCallback)(uint8_t sequence);
 
     class CeriaSerial {
     private:
+        enum TxSlotState : uint8_t {
+            TX_SLOT_FREE = 0,
+            TX_SLOT_QUEUED,
+            TX_SLOT_IN_FLIGHT
+        };
+
+        enum RxVerdict : uint8_t {
+            RX_NEW = 0,
+            RX_DUPLICATE,
+            // from an older epoch or too far behind the window to tell, not acknowledged
+            RX_STALE
+        };
+
+        // a reliable frame waiting for its ACK, kept unescaped so a retransmission is a plain write
+        struct TxSlot {
+            uint8_t *data;
+            uint16_t length;
+            uint8_t sequence;
+            uint8_t attempts;
+            uint32_t sentAt;
+            TxSlotState state;
+        };
+
         Stream *_serial;
         uint32_t _baudRate;
         FrameSize _frameSize;
@@ -68,10 +97,27 @@ namespace CeriaDevOP {
 
         uint8_t *_txBuffer;
         uint8_t *_rxBuffer;
+        uint8_t *_txStorage;
         uint16_t _bufferSize;
+
+        TxSlot *_txQueue;
+        uint8_t _window;
+        uint8_t _nextSequence;
+        uint8_t _sendSequence;
+        uint8_t _epoch;
+        uint32_t _retransmitTimeout;
+        bool _autoRetransmitTimeout;
+        // reliable frames wait until the peer acknowledged a SYNC for the current epoch
+        bool _txSynced;
+        uint8_t _syncAttempts;
+        uint32_t _syncSentAt;
+
+        uint8_t _rxHighest;
+        uint8_t _rxEpoch;
+        uint32_t _rxWindow;
+        bool _rxSynced;
         uint16_t _rxIndex;
-        bool _inFrame;
-        bool _escaped;
+        FrameParser _parser;
 
         uint32_t _lastActivity;
         uint32_t _backoffTime;
@@ -79,18 +125,31 @@ namespace CeriaDevOP {
 
         CeriaSerialReceiveCallback _onReceive;
         CeriaSerialErrorCallback _onError;
+        CeriaSerialDeliveryCallback _onDelivered;
+        CeriaSerialDeliveryCallback _onFailed;
 
         uint32_t _framesSent;
         uint32_t _framesReceived;
         uint32_t _crcErrors;
         uint32_t _collisions;
+        uint32_t _delivered;
+        uint32_t _failed;
+        uint32_t _retransmissions;
 
         uint16_t getOptimalFrameSize();
         bool initializeBuffers();
         void freeBuffers();
         uint16_t calculateCRC16(const uint8_t *data, uint16_t length);
-        bool buildFrame(const String &key, const String &value, uint8_t cmd, uint8_t type);
-        bool sendFrame(const uint8_t *frame, uint16_t length, bool reliable = false);
+        void writeFrame(const uint8_t *frame, uint16_t length);
+        void sendControl(uint8_t cmd, uint8_t sequence, uint8_t epoch);
+        void sendSync();
+        bool serviceSync();
+        bool enqueueReliable(const uint8_t *frame, uint16_t length);
+        void transmitSlot(TxSlot &slot);
+        void serviceQueue();
+        void releaseSlot(TxSlot &slot, bool delivered);
+        void handleAck(uint8_t sequence, uint8_t epoch, bool negative);
+        RxVerdict acceptSequence(uint8_t sequence, uint8_t epoch);
         void processIncomingByte(uint8_t byte);
         void processCompleteFrame();
         bool isChannelClear();
@@ -104,9 +163,15 @@ namespace CeriaDevOP {
         bool begin(Stream &serial, uint32_t baud = 115200, FrameSize size = FRAME_AUTO);
         void setMode(DuplexMode mode);
         void setRetries(uint8_t count);
+        // reliable frames sent and not yet acknowledged, up to the TX queue size
+        void setWindow(uint8_t frames);
+        // first retransmission delay, later ones double; 0 derives it from baud rate and frame size
+        void setRetransmitTimeout(uint32_t ms);
 
         void onReceive(CeriaSerialReceiveCallback callback);
         void onError(CeriaSerialErrorCallback callback);
+        void onDelivered(CeriaSerialDeliveryCallback callback);
+        void onFailed(CeriaSerialDeliveryCallback callback);
 
         template<typename T>
         bool send(const String &key, T value, bool reliable = false) {
@@ -119,8 +184,14 @@ namespace CeriaDevOP {
         void ping();
 
         void getStats(uint32_t &sent, uint32_t &received, uint32_t &errors);
+        void getReliableStats(uint32_t &delivered, uint32_t &failed, uint32_t &retransmissions);
         void reset();
 
+        // reliable sends only queue the frame, tick() moves it; these report on the queue
+        uint8_t getPendingCount();
+        uint8_t getLastSequence();
+        bool waitForDelivery(uint32_t timeoutMs);
+
         bool sendTyped(const String &key, int value, bool reliable);
         bool sendTyped(const String &key, long value, bool reliable);
         bool sendTyped(const String &key, uint8_t value, bool reliable);
@@ -134,20 +205,30 @@ namespace CeriaDevOP {
         uint8_t detectStringType(String &str);
 
     private:
-        bool sendInternal(const String &key, const String &value, uint8_t dataType, bool reliable);
+        bool sendInternal(const String &key, const String &value, uint8_t dataType, bool reliable,
+                          uint8_t cmd = CERIA_SERIAL_CMD_DATA);
     };
 
 #if defined(ESP32)
 #define CERIA_SERIAL_DEFAULT_FRAME    FRAME_256B
 #define CERIA_SERIAL_DEFAULT_TIMEOUT  2000
+#define CERIA_SERIAL_TX_QUEUE         8
+#define CERIA_SERIAL_DEFAULT_WINDOW   4
 #elif defined(ESP8266)
 #define CERIA_SERIAL_DEFAULT_FRAME    FRAME_128B
 #define CERIA_SERIAL_DEFAULT_TIMEOUT  3000
+#define CERIA_SERIAL_TX_QUEUE         8
+#define CERIA_SERIAL_DEFAULT_WINDOW   4
 #else
 #define CERIA_SERIAL_DEFAULT_FRAME    FRAME_64B
 #define CERIA_SERIAL_DEFAULT_TIMEOUT  5000
+#define CERIA_SERIAL_TX_QUEUE         4
+#define CERIA_SERIAL_DEFAULT_WINDOW   2
 #endif
 
+// the receiver remembers this many sequence numbers for duplicate detection, so it caps the window
+#define CERIA_SERIAL_MAX_WINDOW       16
+
 }
 
 #endif
\ No newline at end of file
@@ -21,6 +21,9 @@
 
 // === MODULES ===
 
+// modules/communication/codec
+#define ENABLE_MODULE_FRAME_CODEC
+
 // modules/communication/wired/i2c
 #define ENABLE_MODULE_I2C_EXPANDER
 #define ENABLE_MODULE_I2C_SCANNER
@@ -47,6 +50,7 @@
 
 // modules/communication/wireless/now
 #define ENABLE_MODULE_ESP_NOW
+#define ENABLE_MODULE_ESP_NOW_TRANSPORT
 
 // modules/control
 #define ENABLE_MODULE_DECISION_TREE
@@ -78,6 +82,7 @@
 // modules/file
 #define ENABLE_MODULE_EEPROM_LIB
 #define ENABLE_MODULE_EEPROM_LIB_ESP8266
+#define ENABLE_MODULE_RECORD_STORE
 #define ENABLE_MODULE_SD_ARDUINO
 #define ENABLE_MODULE_SD_CARD_MODULE_ESP32
 
@@ -98,11 +103,13 @@
 #define ENABLE_MODULE_MOVING_AVERAGE_FILTER
 
 // modules/io
+#define ENABLE_MODULE_CONTINUOUS_ADC
 #define ENABLE_MODULE_DIGITAL_INPUT
 #define ENABLE_MODULE_DIGITAL_OUTPUT
 #define ENABLE_MODULE_PCF8574_INPUT_MODULE
 #define ENABLE_MODULE_PCF8574_MODULE
 #define ENABLE_MODULE_PCF8574_OUTPUT_MODULE
+#define ENABLE_MODULE_PCF8574_PORT_CACHE
 #define ENABLE_MODULE_ROTARY_ENCODER
 #define ENABLE_MODULE_SEVEN_SEGMENT
 #define ENABLE_MODULE_SEVEN_SEGMENT_74HC595
@@ -112,15 +119,20 @@
 // modules/task
 #define ENABLE_MODULE_FREE_RTOS_HANDLER
 #define ENABLE_MODULE_TASK_HANDLER
+#define ENABLE_MODULE_TASK_SCHEDULER
+#define ENABLE_MODULE_SPSC_RING
+#define ENABLE_MODULE_WORKER_POOL
 
 // modules/time
 #define ENABLE_MODULE_TIMER_DURATION
 #define ENABLE_MODULE_TIMER_MANAGER
 #define ENABLE_MODULE_TIMER_TASK
+#define ENABLE_MODULE_TIMER_WHEEL
 
 // modules/utils
 #define ENABLE_MODULE_EASY_LOGIC
 #define ENABLE_MODULE_LOGIC_CONDITION_MANAGER
+#define ENABLE_MODULE_RULE_VM
 #define ENABLE_MODULE_STATE_ACTION_MANAGER
 #define ENABLE_MODULE_VARIABLE_WATCHER
 
@@ -151,6 +163,7 @@
 // sensors/SensorModuleV1
 #define ENABLE_SENSOR_MODULE
 #define ENABLE_SENSOR_MODULE_UTILITY
+#define ENABLE_SENSOR_PULSE_CAPTURE
 
 // sensors/SensorModuleV1/calibration
 #define ENABLE_ANALOG_SENSOR_CALIBRATOR
@@ -215,7 +228,9 @@
 #define ENABLE_SENSOR_BME680_V2
 #define ENABLE_SENSOR_CUSTOM_TEMPLATE_V2
 #define ENABLE_SENSOR_DHT_V2
+#define ENABLE_SENSOR_DS18B20_V2
 #define ENABLE_SENSOR_GP2Y_DUST_V2
+#define ENABLE_SENSOR_HX711_V2
 #define ENABLE_SENSOR_INA219_V2
 #define ENABLE_SENSOR_MHRTC_V2
 #define ENABLE_SENSOR_MLX90614_V2
@@ -224,4 +239,5 @@
 #define ENABLE_SENSOR_RTC_DS1307_V2
 #define ENABLE_SENSOR_RTC_DS3231_V2
 #define ENABLE_SENSOR_RTC_PCF8523_V2
-#define ENABLE_SENSOR_RTC_PCF8563_V2
\ No newline at end of file
+#define ENABLE_SENSOR_RTC_PCF8563_V2
+#define ENABLE_SENSOR_SCD30_V2
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef KINEMATRIX_FRAME_COBS
+#define KINEMATRIX_FRAME_COBS
+
+#include "Arduino.h"
+
+// worst case overhead: one code byte per started run of 254 bytes
+#define FRAME_COBS_OVERHEAD(length)    (1 + (length) / 254)
+#define FRAME_COBS_MAX_ENCODED(length) ((length) + FRAME_COBS_OVERHEAD(length))
+#define FRAME_COBS_DELIMITER           0x00
+
+/*
+Consistent Overhead Byte Stuffing. The encoded block contains no 0x00, so a single 0x00 can end
+every frame and a receiver resynchronises on the next one after any error. The delimiter itself is
+not written by encode() and must not be passed to decode().
+*/
+class FrameCobs {
+public:
+    // dst may be the same buffer as src shifted forward by FRAME_COBS_OVERHEAD(length), or separate
+    static inline size_t encode(const uint8_t *src, size_t length, uint8_t *dst) {
+        uint8_t *start = dst;
+        uint8_t *code = dst++;
+        uint8_t run = 1;
+
+        while (length--) {
+            uint8_t value = *src++;
+            if (value != 0) {
+                *dst++ = value;
+                run++;
+            }
+            if (value == 0 || run == 0xFF) {
+                *code = run;
+                code = dst++;
+                run = 1;
+                // a full run at the very end needs no extra code byte
+                if (value != 0 && length == 0) {
+                    dst--;
+                    return dst - start;
+                }
+            }
+        }
+        *code = run;
+        return dst - start;
+    }
+
+    // buffer must have room for FRAME_COBS_MAX_ENCODED(length) bytes
+    static inline size_t encodeInPlace(uint8_t *buffer, size_t length) {
+        size_t overhead = FRAME_COBS_OVERHEAD(length);
+        memmove(buffer + overhead, buffer, length);
+        return encode(buffer + overhead, length, buffer);
+    }
+
+    // returns the decoded length, or -1 for a malformed block; dst may be the same buffer as src
+    static inline int32_t decode(const uint8_t *src, size_t length, uint8_t *dst) {
+        const uint8_t *end = src + length;
+        uint8_t *start = dst;
+
+        while (src < end) {
+            uint8_t run = *src++;
+            if (run == 0 || (size_t) (end - src) < (size_t) (run - 1)) return -1;
+
+            for (uint8_t i = 1; i < run; i++) {
+                uint8_t value = *src++;
+                if (value == 0) return -1;
+                *dst++ = value;
+            }
+            // a short run stands for a zero, unless the block ends there
+            if (run != 0xFF && src < end) *dst++ = 0;
+        }
+        return dst - start;
+    }
+};
+
+#endif
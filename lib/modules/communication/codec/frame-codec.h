@@ -0,0 +1,12 @@
+#ifndef KINEMATRIX_FRAME_CODEC
+#define KINEMATRIX_FRAME_CODEC
+
+#pragma message("[COMPILED]: frame-codec.h")
+
+// header only, every protocol that frames or checksums serial data includes what it needs from here
+#include "frame-crc.h"
+#include "frame-cobs.h"
+#include "frame-escape.h"
+#include "frame-parser.h"
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef KINEMATRIX_FRAME_ESCAPE
+#define KINEMATRIX_FRAME_ESCAPE
+
+#include "Arduino.h"
+
+#define FRAME_STX            0x7E
+#define FRAME_ETX            0x7F
+#define FRAME_ESC            0x7D
+#define FRAME_XOR            0x20
+
+#define FRAME_ESCAPE_MAX_ENCODED(length) ((length) * 2)
+
+/*
+STX/ETX framing with ESC stuffing as used by CeriaSerial and NemaSerial: every byte between the
+markers that equals STX, ETX or ESC goes out as ESC followed by the byte XOR 0x20.
+*/
+class FrameEscape {
+public:
+    static inline bool isSpecial(uint8_t value) {
+        return value == FRAME_STX || value == FRAME_ETX || value == FRAME_ESC;
+    }
+
+    // dst needs room for FRAME_ESCAPE_MAX_ENCODED(length) bytes, returns the bytes written
+    static inline size_t encode(const uint8_t *src, size_t length, uint8_t *dst) {
+        uint8_t *start = dst;
+        while (length--) {
+            uint8_t value = *src++;
+            if (isSpecial(value)) {
+                *dst++ = FRAME_ESC;
+                *dst++ = value ^ FRAME_XOR;
+            } else {
+                *dst++ = value;
+            }
+        }
+        return dst - start;
+    }
+
+    // stuffs one piece of a frame without markers; runs without special bytes go out straight from data
+    static inline size_t writeBody(Stream *out, const uint8_t *data, size_t length) {
+        size_t written = 0;
+        size_t runStart = 0;
+
+        for (size_t i = 0; i < length; i++) {
+            if (!isSpecial(data[i])) continue;
+
+            if (i > runStart) written += out->write(data + runStart, i - runStart);
+            uint8_t pair[2] = {FRAME_ESC, (uint8_t) (data[i] ^ FRAME_XOR)};
+            written += out->write(pair, 2);
+            runStart = i + 1;
+        }
+
+        if (length > runStart) written += out->write(data + runStart, length - runStart);
+        return written;
+    }
+
+    // writes STX, the stuffed frame and ETX
+    static inline size_t write(Stream *out, const uint8_t *frame, size_t length) {
+        size_t written = out->write((uint8_t) FRAME_STX);
+        written += writeBody(out, frame, length);
+        written += out->write((uint8_t) FRAME_ETX);
+        return written;
+    }
+};
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef KINEMATRIX_FRAME_PARSER
+#define KINEMATRIX_FRAME_PARSER
+
+#include "Arduino.h"
+#include "frame-escape.h"
+#include "frame-cobs.h"
+
+enum FrameMode : uint8_t {
+    FRAME_MODE_ESCAPED = 0,
+    FRAME_MODE_COBS
+};
+
+enum FrameStatus : uint8_t {
+    FRAME_PENDING = 0,
+    FRAME_READY,
+    FRAME_OVERFLOW,
+    FRAME_MALFORMED
+};
+
+/*
+Byte stream to frame reassembly over a caller owned buffer. In escaped mode the buffer receives the
+bytes between STX and ETX already unstuffed; in COBS mode everything up to the 0x00 delimiter is
+collected and decoded in place. A ready frame stays valid until the next push().
+*/
+class FrameParser {
+public:
+    FrameParser() : _buffer(nullptr), _capacity(0), _index(0), _length(0), _mode(FRAME_MODE_ESCAPED),
+                    _inFrame(false), _escaped(false) {
+    }
+
+    void begin(uint8_t *buffer, uint16_t capacity, FrameMode mode = FRAME_MODE_ESCAPED) {
+        _buffer = buffer;
+        _capacity = capacity;
+        _mode = mode;
+        reset();
+    }
+
+    // swaps in a larger buffer holding the same bytes, a frame in progress carries on
+    void setBuffer(uint8_t *buffer, uint16_t capacity) {
+        _buffer = buffer;
+        _capacity = capacity;
+        if (_index > _capacity) reset();
+    }
+
+    void reset() {
+        _index = 0;
+        _length = 0;
+        _inFrame = (_mode == FRAME_MODE_COBS);
+        _escaped = false;
+    }
+
+    FrameStatus push(uint8_t value) {
+        if (_mode == FRAME_MODE_COBS) return pushCobs(value);
+
+        if (value == FRAME_STX) {
+            // a marker inside a frame means its ETX was lost, start over
+            _inFrame = true;
+            _index = 0;
+            _escaped = false;
+            return FRAME_PENDING;
+        }
+        if (!_inFrame) return FRAME_PENDING;
+
+        if (value == FRAME_ETX) {
+            _inFrame = false;
+            _length = _index;
+            return _escaped ? FRAME_MALFORMED : FRAME_READY;
+        }
+        if (value == FRAME_ESC) {
+            _escaped = true;
+            return FRAME_PENDING;
+        }
+        if (_escaped) {
+            value ^= FRAME_XOR;
+            _escaped = false;
+        }
+        if (_index >= _capacity) {
+            _inFrame = false;
+            return FRAME_OVERFLOW;
+        }
+
+        _buffer[_index++] = value;
+        return FRAME_PENDING;
+    }
+
+    // consumes bytes up to and including the one that finishes a frame or fails, returns how many
+    size_t push(const uint8_t *data, size_t length, FrameStatus &status) {
+        status = FRAME_PENDING;
+        size_t used = 0;
+
+        if (_mode == FRAME_MODE_ESCAPED) {
+            while (used < length) {
+                // plain bytes inside a frame are copied without going through the state machine
+                if (_inFrame && !_escaped) {
+                    size_t room = _capacity - _index;
+                    size_t run = 0;
+                    while (run < room && used + run < length && !FrameEscape::isSpecial(data[used + run])) run++;
+                    memcpy(_buffer + _index, data + used, run);
+                    _index += run;
+                    used += run;
+                    if (used == length) break;
+                }
+
+                status = push(data[used++]);
+                if (status != FRAME_PENDING) break;
+            }
+            return used;
+        }
+
+        while (used < length) {
+            status = push(data[used++]);
+            if (status != FRAME_PENDING) break;
+        }
+        return used;
+    }
+
+    const uint8_t *frame() const {
+        return _buffer;
+    }
+
+    uint16_t length() const {
+        return _length;
+    }
+
+    uint16_t received() const {
+        return _index;
+    }
+
+    // bytes pushed now are stored, so a caller growing its buffer knows when to do it
+    bool inFrame() const {
+        return _inFrame;
+    }
+
+private:
+    FrameStatus pushCobs(uint8_t value) {
+        if (value != FRAME_COBS_DELIMITER) {
+            if (!_inFrame) return FRAME_PENDING;
+            if (_index >= _capacity) {
+                // skip the rest up to the next delimiter
+                _inFrame = false;
+                return FRAME_OVERFLOW;
+            }
+            _buffer[_index++] = value;
+            return FRAME_PENDING;
+        }
+
+        uint16_t encoded = _index;
+        bool wasInFrame = _inFrame;
+        _index = 0;
+        _inFrame = true;
+        if (!wasInFrame || encoded == 0) return FRAME_PENDING;
+
+        int32_t decoded = FrameCobs::decode(_buffer, encoded, _buffer);
+        if (decoded < 0) return FRAME_MALFORMED;
+        _length = decoded;
+        return FRAME_READY;
+    }
+
+    uint8_t *_buffer;
+    uint16_t _capacity;
+    uint16_t _index;
+    uint16_t _length;
+    FrameMode _mode;
+    bool _inFrame;
+    bool _escaped;
+};
+
+#endif
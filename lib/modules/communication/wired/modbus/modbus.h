@@ -20,6 +20,32 @@
 
 #define WRITE_DO	0x05
 #define WRITE_AO	0x06
+#define WRITE_MULTIPLE_DO	0x0F
+#define WRITE_MULTIPLE_AO	0x10
+
+// Modbus exception codes
+#define ILLEGAL_FUNCTION	0x01
+#define ILLEGAL_DATA_ADDRESS	0x02
+#define ILLEGAL_DATA_VALUE	0x03
+#define GATEWAY_TARGET_FAILED	0x0B
+
+// Largest RTU frame: address, PDU of up to 253 bytes, crc
+#define MODBUS_BUFFER_SIZE	256
+// Most registers / coils a single read may ask for
+#define MAX_READ_REGISTERS	125
+#define MAX_READ_BITS		2000
+// Most registers / coils a single write may carry
+#define MAX_WRITE_REGISTERS	123
+#define MAX_WRITE_BITS		1968
+// Largest PDU: function code and up to 252 data bytes
+#define MODBUS_PDU_SIZE		253
+
+// Modbus TCP: MBAP header of transaction, protocol, length and unit id
+#define MODBUS_TCP_PORT		502
+#define MBAP_HEADER_SIZE	7
+#define MODBUS_TCP_ADU_SIZE	(MBAP_HEADER_SIZE + MODBUS_PDU_SIZE)
+
+#define MODBUS_INVALID		-1
 
 #define RTU 		0x01
 #define ASCII		0x02
@@ -0,0 +1,13 @@
+#ifndef _MODBUSCRC
+#define _MODBUSCRC
+
+#include "Arduino.h"
+#include "../../codec/frame-crc.h"
+
+// CRC of the first len bytes, high byte is the one sent first
+static inline word modbusCrc(const byte *msg, word len) {
+    word crc = FrameCrc::crc16Modbus(msg, len);
+    return (crc << 8) | (crc >> 8);
+}
+
+#endif
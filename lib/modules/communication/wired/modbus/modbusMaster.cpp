@@ -0,0 +1,528 @@
+#include "modbusMaster.h"
+
+modbusMaster::modbusMaster(void) {
+    _serial = 0;
+    _txEnablePin = -1;
+    _frameSilence = 0;
+    _lastActivity = 0;
+    _sentAt = 0;
+    _timeout = MODBUS_RESPONSE_TIMEOUT;
+    _maxGap = 0;
+    _maxBlockSize = MAX_READ_REGISTERS;
+
+    _polls = 0;
+    _pollCount = 0;
+    _pollCapacity = 0;
+    _blocks = 0;
+    _blockCount = 0;
+    _compiled = true;
+
+    _writeHead = 0;
+    _writeCount = 0;
+
+    _state = MASTER_IDLE;
+    _pending = MODBUS_INVALID;
+    _pendingWrite = false;
+    _requestSlave = 0;
+    _requestFunction = 0;
+    _len = 0;
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+modbusMaster::~modbusMaster(void) {
+    this->freeBlocks();
+    free(_polls);
+}
+
+void modbusMaster::begin(Stream *serial, unsigned long baud, int txEnablePin) {
+    _serial = serial;
+    _txEnablePin = txEnablePin;
+
+    // 3.5 characters of 11 bits, fixed at 1750us above 19200 baud as the RTU spec asks
+    if (baud > 19200) _frameSilence = 1750;
+    else _frameSilence = (11000000UL / baud) * 7 / 2;
+
+    if (_txEnablePin >= 0) {
+        pinMode(_txEnablePin, OUTPUT);
+        digitalWrite(_txEnablePin, LOW);
+    }
+    _lastActivity = micros();
+}
+
+void modbusMaster::setTimeout(word timeoutMs) {
+    _timeout = timeoutMs;
+}
+
+void modbusMaster::setMaxGap(word registers) {
+    _maxGap = registers;
+    _compiled = false;
+}
+
+void modbusMaster::setMaxBlockSize(word registers) {
+    if (registers == 0) registers = 1;
+    if (registers > MAX_READ_REGISTERS) registers = MAX_READ_REGISTERS;
+    _maxBlockSize = registers;
+    _compiled = false;
+}
+
+bool modbusMaster::isBitFunction(byte function) {
+    return function == READ_DO || function == READ_DI;
+}
+
+word modbusMaster::blockLimit(byte function) {
+    return isBitFunction(function) ? MAX_READ_BITS : _maxBlockSize;
+}
+
+int modbusMaster::addPoll(byte slave, byte function, word address, word count, unsigned long intervalMs) {
+    if (slave == 0 || slave > 247) return MODBUS_INVALID;
+    if (function < READ_DO || function > READ_AI) return MODBUS_INVALID;
+    if (count == 0 || count > blockLimit(function)) return MODBUS_INVALID;
+    if ((long) address + count > 0x10000) return MODBUS_INVALID;
+
+    if (_pollCount == _pollCapacity) {
+        if (_pollCapacity == 255) return MODBUS_INVALID;
+
+        byte newCapacity = _pollCapacity == 0 ? 4 : (_pollCapacity > 127 ? 255 : _pollCapacity * 2);
+        modbusPoll *newPolls = (modbusPoll *) realloc(_polls, newCapacity * sizeof(modbusPoll));
+        if (newPolls == 0) return MODBUS_INVALID;
+
+        _polls = newPolls;
+        _pollCapacity = newCapacity;
+    }
+
+    modbusPoll *poll = &_polls[_pollCount];
+    poll->slave = slave;
+    poll->function = function;
+    poll->address = address;
+    poll->count = count;
+    poll->interval = intervalMs;
+    poll->block = 0;
+    poll->offset = 0;
+
+    // the block plan is rebuilt on the next idle run()
+    _compiled = false;
+    return _pollCount++;
+}
+
+void modbusMaster::clearPolls(void) {
+    _pollCount = 0;
+    _compiled = false;
+}
+
+void modbusMaster::freeBlocks(void) {
+    for (byte i = 0; i < _blockCount; i++) {
+        free(_blocks[i].regs);
+    }
+    free(_blocks);
+    _blocks = 0;
+    _blockCount = 0;
+}
+
+/*
+Merges the polls into block reads. Polls are ordered by slave, function and address, then each one
+joins the previous block when it starts at most _maxGap registers after its end and the block stays
+within the read limit of the function.
+*/
+void modbusMaster::compile(void) {
+    this->freeBlocks();
+    _compiled = true;
+    if (_pollCount == 0) return;
+
+    byte *order = (byte *) malloc(_pollCount);
+    _blocks = (modbusBlock *) calloc(_pollCount, sizeof(modbusBlock));
+    if (order == 0 || _blocks == 0) {
+        free(order);
+        free(_blocks);
+        _blocks = 0;
+        // tried again on the next run()
+        _compiled = false;
+        _stats.allocFailures++;
+        return;
+    }
+
+    for (byte i = 0; i < _pollCount; i++) {
+        byte j = i;
+        while (j > 0) {
+            const modbusPoll &a = _polls[order[j - 1]];
+            const modbusPoll &b = _polls[i];
+            if (a.slave < b.slave || (a.slave == b.slave && (a.function < b.function ||
+                                      (a.function == b.function && a.address <= b.address))))
+                break;
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    unsigned long now = millis();
+    modbusBlock *block = 0;
+    for (byte i = 0; i < _pollCount; i++) {
+        modbusPoll &poll = _polls[order[i]];
+        long pollEnd = (long) poll.address + poll.count;
+
+        if (block != 0 && block->slave == poll.slave && block->function == poll.function) {
+            long blockEnd = (long) block->address + block->count;
+            long mergedEnd = pollEnd > blockEnd ? pollEnd : blockEnd;
+
+            if (poll.address <= blockEnd + _maxGap && mergedEnd - block->address <= blockLimit(poll.function)) {
+                block->count = mergedEnd - block->address;
+                if (poll.interval < block->interval) block->interval = poll.interval;
+                poll.block = _blockCount - 1;
+                poll.offset = poll.address - block->address;
+                continue;
+            }
+        }
+
+        block = &_blocks[_blockCount];
+        block->slave = poll.slave;
+        block->function = poll.function;
+        block->address = poll.address;
+        block->count = poll.count;
+        block->interval = poll.interval;
+        block->nextDue = now;
+        poll.block = _blockCount;
+        poll.offset = 0;
+        _blockCount++;
+    }
+    free(order);
+
+    for (byte i = 0; i < _blockCount; i++) {
+        modbusBlock &current = _blocks[i];
+        if (isBitFunction(current.function)) current.bits = (byte *) calloc((current.count + 7) / 8, 1);
+        else current.regs = (word *) calloc(current.count, sizeof(word));
+        if (current.regs == 0) {
+            // a block without its image would be written by store(), drop the whole plan
+            this->freeBlocks();
+            _compiled = false;
+            _stats.allocFailures++;
+            return;
+        }
+    }
+}
+
+modbusMaster::modbusBlock *modbusMaster::findBlock(byte slave, byte function, word address) {
+    for (byte i = 0; i < _blockCount; i++) {
+        modbusBlock *block = &_blocks[i];
+        if (block->slave == slave && block->function == function &&
+            address >= block->address && (long) address < (long) block->address + block->count)
+            return (block);
+    }
+    return (0);
+}
+
+int modbusMaster::nextBlock(unsigned long now) {
+    int next = MODBUS_INVALID;
+    long mostLate = 0;
+
+    // the most overdue block goes first, so a fast poll cannot starve the others
+    for (byte i = 0; i < _blockCount; i++) {
+        long late = (long) (now - _blocks[i].nextDue);
+        if (late >= mostLate) {
+            if (next == MODBUS_INVALID || late > mostLate) {
+                next = i;
+                mostLate = late;
+            }
+        }
+    }
+    return next;
+}
+
+bool modbusMaster::writeRegister(byte slave, word address, word value) {
+    if (slave > 247 || _writeCount == QUEMAX) return (false);
+
+    modbusWrite &write = _writes[(_writeHead + _writeCount) % QUEMAX];
+    write.slave = slave;
+    write.function = WRITE_AO;
+    write.address = address;
+    write.value = value;
+    write.retries = 0;
+    _writeCount++;
+    return (true);
+}
+
+bool modbusMaster::writeCoil(byte slave, word address, bool value) {
+    if (slave > 247 || _writeCount == QUEMAX) return (false);
+
+    modbusWrite &write = _writes[(_writeHead + _writeCount) % QUEMAX];
+    write.slave = slave;
+    write.function = WRITE_DO;
+    write.address = address;
+    write.value = value ? 0xFF00 : 0x0000;
+    write.retries = 0;
+    _writeCount++;
+    return (true);
+}
+
+bool modbusMaster::getRegister(byte slave, word address, word &value, byte function) {
+    if (!_compiled) return (false);
+
+    modbusBlock *block = this->findBlock(slave, function, address);
+    if (block == 0 || !block->valid || isBitFunction(function)) return (false);
+
+    value = block->regs[address - block->address];
+    return (true);
+}
+
+bool modbusMaster::getBit(byte slave, word address, bool &value, byte function) {
+    if (!_compiled) return (false);
+
+    modbusBlock *block = this->findBlock(slave, function, address);
+    if (block == 0 || !block->valid || !isBitFunction(function)) return (false);
+
+    word index = address - block->address;
+    value = (block->bits[index >> 3] >> (index & 7)) & 1;
+    return (true);
+}
+
+word modbusMaster::getRegister(int poll, word index) {
+    if (!_compiled || poll < 0 || poll >= _pollCount || index >= _polls[poll].count) return (0);
+
+    modbusBlock &block = _blocks[_polls[poll].block];
+    if (isBitFunction(block.function)) return (0);
+    return (block.regs[_polls[poll].offset + index]);
+}
+
+bool modbusMaster::getBit(int poll, word index) {
+    if (!_compiled || poll < 0 || poll >= _pollCount || index >= _polls[poll].count) return (false);
+
+    modbusBlock &block = _blocks[_polls[poll].block];
+    if (!isBitFunction(block.function)) return (false);
+
+    index += _polls[poll].offset;
+    return (block.bits[index >> 3] >> (index & 7)) & 1;
+}
+
+bool modbusMaster::isFresh(int poll, unsigned long maxAgeMs) {
+    return this->getAge(poll) <= maxAgeMs;
+}
+
+unsigned long modbusMaster::getAge(int poll) {
+    if (!_compiled || poll < 0 || poll >= _pollCount) return (0xFFFFFFFFUL);
+
+    modbusBlock &block = _blocks[_polls[poll].block];
+    if (!block.valid) return (0xFFFFFFFFUL);
+    return (millis() - block.updated);
+}
+
+byte modbusMaster::getException(int poll) {
+    if (!_compiled || poll < 0 || poll >= _pollCount) return (0);
+    return (_blocks[_polls[poll].block].exception);
+}
+
+int modbusMaster::getBlockCount(void) {
+    if (!_compiled && _state == MASTER_IDLE) this->compile();
+    return (_blockCount);
+}
+
+void modbusMaster::getStats(Stats &stats) {
+    stats = _stats;
+}
+
+bool modbusMaster::isIdle(void) {
+    return _state == MASTER_IDLE && _writeCount == 0;
+}
+
+void modbusMaster::sendFrame(byte slave, byte function, word field1, word field2) {
+    _requestSlave = slave;
+    _requestFunction = function;
+
+    _frame[0] = slave;
+    _frame[1] = function;
+    _frame[2] = field1 >> 8;
+    _frame[3] = field1 & 0xFF;
+    _frame[4] = field2 >> 8;
+    _frame[5] = field2 & 0xFF;
+
+    word crc = modbusCrc(_frame, 6);
+    _frame[6] = crc >> 8;
+    _frame[7] = crc & 0xFF;
+
+    if (_txEnablePin >= 0) digitalWrite(_txEnablePin, HIGH);
+    _serial->write(_frame, 8);
+    // flush() returns once the last stop bit is out, the silence before the reply counts from here
+    _serial->flush();
+    if (_txEnablePin >= 0) digitalWrite(_txEnablePin, LOW);
+
+    _lastActivity = micros();
+    _sentAt = millis();
+    _len = 0;
+    _stats.requests++;
+}
+
+/*
+Length of the reply being received, 0 while the header is not in yet.
+*/
+word modbusMaster::expectedLength(void) {
+    if (_len < 3) return (0);
+    if (_frame[1] & 0x80) return (5);
+    if (_frame[1] == WRITE_DO || _frame[1] == WRITE_AO) return (8);
+    return (5 + _frame[2]);
+}
+
+void modbusMaster::receive(void) {
+    while (_serial->available()) {
+        int c = _serial->read();
+        if (c < 0) break;
+        if (_len < MODBUS_BUFFER_SIZE) _frame[_len++] = c;
+        _lastActivity = micros();
+    }
+
+    // a reply whose length is known ends with its last byte instead of after 3.5 silent characters
+    word expected = this->expectedLength();
+    if (expected > 0 && _len >= expected) {
+        this->complete(true);
+        return;
+    }
+
+    if (_len > 0) {
+        // a frame cut short by silence is a broken frame
+        if (micros() - _lastActivity >= _frameSilence) this->complete(true);
+        return;
+    }
+
+    if (millis() - _sentAt >= _timeout) this->complete(false);
+}
+
+void modbusMaster::store(modbusBlock *block) {
+    if (isBitFunction(block->function)) {
+        memcpy(block->bits, _frame + 3, (block->count + 7) / 8);
+        return;
+    }
+    for (word i = 0; i < block->count; i++) {
+        block->regs[i] = (_frame[3 + i * 2] << 8) | _frame[4 + i * 2];
+    }
+}
+
+void modbusMaster::backOff(byte slave, unsigned long now) {
+    // every block of a silent slave waits, doubling from the response timeout, so it cannot hold the bus
+    for (byte i = 0; i < _blockCount; i++) {
+        modbusBlock &block = _blocks[i];
+        if (block.slave != slave) continue;
+
+        if (block.failures < 8) block.failures++;
+        unsigned long delayMs = (unsigned long) _timeout << block.failures;
+        if (delayMs > MODBUS_MAX_BACKOFF) delayMs = MODBUS_MAX_BACKOFF;
+        if ((long) (now + delayMs - block.nextDue) > 0) block.nextDue = now + delayMs;
+    }
+}
+
+void modbusMaster::complete(bool received) {
+    unsigned long now = millis();
+    word expected = this->expectedLength();
+    bool valid = received && expected > 0 && _len == expected &&
+                 _frame[0] == _requestSlave && (_frame[1] & 0x7F) == _requestFunction &&
+                 modbusCrc(_frame, _len - 2) == (word) ((_frame[_len - 2] << 8) | _frame[_len - 1]);
+    byte exception = valid && (_frame[1] & 0x80) ? _frame[2] : 0;
+
+    // a read reply has to carry exactly the block that was asked for
+    if (valid && !exception && !_pendingWrite && _pending != MODBUS_INVALID) {
+        modbusBlock &block = _blocks[_pending];
+        word dataBytes = isBitFunction(block.function) ? (block.count + 7) / 8 : block.count * 2;
+        if (_frame[2] != dataBytes) valid = false;
+    }
+
+    if (!received) _stats.timeouts++;
+    else if (!valid) _stats.crcErrors++;
+    else if (exception) _stats.exceptions++;
+    else _stats.responses++;
+
+    _state = MASTER_IDLE;
+    _len = 0;
+
+    if (_pendingWrite) {
+        _pendingWrite = false;
+        modbusWrite &write = _writes[_writeHead];
+
+        // a lost write is sent again, an answered one leaves the queue either way
+        if (!valid && ++write.retries <= MODBUS_WRITE_RETRIES) return;
+        _writeHead = (_writeHead + 1) % QUEMAX;
+        _writeCount--;
+
+        if (valid && !exception) {
+            modbusBlock *block = this->findBlock(write.slave, write.function == WRITE_AO ? READ_AO : READ_DO,
+                                                 write.address);
+            if (block == 0) return;
+
+            word index = write.address - block->address;
+            if (write.function == WRITE_AO) block->regs[index] = write.value;
+            else if (write.value) block->bits[index >> 3] |= 1 << (index & 7);
+            else block->bits[index >> 3] &= ~(1 << (index & 7));
+        }
+        return;
+    }
+
+    if (_pending == MODBUS_INVALID) return;
+    modbusBlock *block = &_blocks[_pending];
+    _pending = MODBUS_INVALID;
+
+    if (!received) {
+        this->backOff(block->slave, now);
+        return;
+    }
+    if (!valid) return;
+
+    for (byte i = 0; i < _blockCount; i++) {
+        if (_blocks[i].slave == block->slave) _blocks[i].failures = 0;
+    }
+
+    block->exception = exception;
+    if (exception) return;
+
+    this->store(block);
+    block->valid = true;
+    block->updated = now;
+}
+
+void modbusMaster::run(void) {
+    if (_serial == 0) return;
+
+    if (_state == MASTER_WAITING) {
+        this->receive();
+        return;
+    }
+
+    // anything on the bus while no reply is expected is noise, it still restarts the silence
+    while (_serial->available()) {
+        _serial->read();
+        _lastActivity = micros();
+    }
+
+    if (_state == MASTER_TURNAROUND) {
+        if (millis() - _sentAt < MODBUS_TURNAROUND_DELAY) return;
+        _state = MASTER_IDLE;
+    }
+
+    if (!_compiled) this->compile();
+
+    // the next request goes out as soon as the bus has been quiet for 3.5 characters
+    if (micros() - _lastActivity < _frameSilence) return;
+
+    if (_writeCount > 0) {
+        modbusWrite &write = _writes[_writeHead];
+        this->sendFrame(write.slave, write.function, write.address, write.value);
+
+        if (write.slave == 0) {
+            // nobody answers a broadcast, give the slaves time to act on it
+            _writeHead = (_writeHead + 1) % QUEMAX;
+            _writeCount--;
+            _state = MASTER_TURNAROUND;
+            return;
+        }
+        _pendingWrite = true;
+        _state = MASTER_WAITING;
+        return;
+    }
+
+    unsigned long now = millis();
+    int next = this->nextBlock(now);
+    if (next == MODBUS_INVALID) return;
+
+    modbusBlock &block = _blocks[next];
+    // stays on the interval grid, a block that fell a whole interval behind resyncs instead of bursting
+    block.nextDue += block.interval;
+    if ((long) (now - block.nextDue) >= 0) block.nextDue = now + block.interval;
+
+    _pending = next;
+    this->sendFrame(block.slave, block.function, block.address, block.count);
+    _state = MASTER_WAITING;
+}
@@ -0,0 +1,159 @@
+#ifndef _MODBUSMASTER
+#define _MODBUSMASTER
+
+#include "Arduino.h"
+#include "modbus.h"
+#include "modbusCrc.h"
+
+// how long a slave gets to start answering
+#define MODBUS_RESPONSE_TIMEOUT    100
+// silence after a broadcast before the bus is used again
+#define MODBUS_TURNAROUND_DELAY    100
+// ceiling for the back-off of a slave that stopped answering
+#define MODBUS_MAX_BACKOFF         5000
+// times a write is sent again when no valid reply comes back
+#define MODBUS_WRITE_RETRIES       2
+
+/*
+Non-blocking RTU master. Register polls are compiled into block reads: polls of the same slave and
+function that touch or overlap are merged into one request of up to 125 registers or 2000 bits.
+Every block keeps a cached image of the remote registers with the time it was last refreshed, so
+readers take values from the cache and never wait on the bus. Writes are queued and sent ahead of
+the polls. Addresses are the ones on the wire, starting at 0.
+*/
+class modbusMaster {
+public:
+    struct Stats {
+        unsigned long requests;
+        unsigned long responses;
+        unsigned long timeouts;
+        unsigned long crcErrors;
+        unsigned long exceptions;
+        // block plans that could not be built for lack of memory, retried on the next run()
+        unsigned long allocFailures;
+    };
+
+    modbusMaster(void);
+    ~modbusMaster(void);
+
+    // the serial port is expected to be opened by the caller, baud only sets the frame timing
+    void begin(Stream *serial, unsigned long baud, int txEnablePin = -1);
+    void setTimeout(word timeoutMs);
+    // registers that may be read along to join two polls of the same slave, 0 merges only touching polls
+    void setMaxGap(word registers);
+    // some devices answer fewer than 125 registers per read
+    void setMaxBlockSize(word registers);
+
+    int addPoll(byte slave, byte function, word address, word count, unsigned long intervalMs);
+    void clearPolls(void);
+
+    bool writeRegister(byte slave, word address, word value);
+    bool writeCoil(byte slave, word address, bool value);
+
+    // cached values, false when the address is not polled or has never been read
+    bool getRegister(byte slave, word address, word &value, byte function = READ_AO);
+    bool getBit(byte slave, word address, bool &value, byte function = READ_DO);
+    word getRegister(int poll, word index);
+    bool getBit(int poll, word index);
+
+    bool isFresh(int poll, unsigned long maxAgeMs);
+    unsigned long getAge(int poll);
+    byte getException(int poll);
+    int getBlockCount(void);
+    void getStats(Stats &stats);
+
+    bool isIdle(void);
+    void run(void);
+
+private:
+    enum state {
+        MASTER_IDLE,
+        MASTER_WAITING,
+        MASTER_TURNAROUND
+    };
+
+    struct modbusPoll {
+        byte slave;
+        byte function;
+        word address;
+        word count;
+        unsigned long interval;
+        byte block;
+        word offset;
+    };
+
+    struct modbusBlock {
+        byte slave;
+        byte function;
+        word address;
+        word count;
+        unsigned long interval;
+        unsigned long nextDue;
+        unsigned long updated;
+        bool valid;
+        byte exception;
+        byte failures;
+        // registers as words, coils and discrete inputs packed LSB first as on the wire
+        union {
+            word *regs;
+            byte *bits;
+        };
+    };
+
+    struct modbusWrite {
+        byte slave;
+        byte function;
+        word address;
+        word value;
+        byte retries;
+    };
+
+    modbusMaster(const modbusMaster &);
+    modbusMaster &operator=(const modbusMaster &);
+
+    static bool isBitFunction(byte function);
+    word blockLimit(byte function);
+
+    void compile(void);
+    void freeBlocks(void);
+    modbusBlock *findBlock(byte slave, byte function, word address);
+    int nextBlock(unsigned long now);
+
+    void sendFrame(byte slave, byte function, word field1, word field2);
+    void receive(void);
+    word expectedLength(void);
+    void complete(bool received);
+    void store(modbusBlock *block);
+    void backOff(byte slave, unsigned long now);
+
+    Stream *_serial;
+    int _txEnablePin;
+    unsigned long _frameSilence;
+    unsigned long _lastActivity;
+    unsigned long _sentAt;
+    word _timeout;
+    word _maxGap;
+    word _maxBlockSize;
+
+    modbusPoll *_polls;
+    byte _pollCount;
+    byte _pollCapacity;
+    modbusBlock *_blocks;
+    byte _blockCount;
+    bool _compiled;
+
+    modbusWrite _writes[QUEMAX];
+    byte _writeHead;
+    byte _writeCount;
+
+    state _state;
+    int _pending;
+    bool _pendingWrite;
+    byte _requestSlave;
+    byte _requestFunction;
+    byte _frame[MODBUS_BUFFER_SIZE];
+    word _len;
+    Stats _stats;
+};
+
+#endif
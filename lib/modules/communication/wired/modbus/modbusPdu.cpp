@@ -0,0 +1,83 @@
+#include "modbusPdu.h"
+
+/*
+Checks that a range stays inside one table of the 5 digit numbering used by the register bank.
+*/
+bool modbusPdu::inRange(word base, word address, word quantity) {
+    long limit = base == HOLDING_REGISTER_BASE ? 0x10000L - base : 9999;
+    return (long) address + quantity <= limit;
+}
+
+word modbusPdu::exception(byte function, byte code, byte *reply) {
+    reply[0] = function | 0x80;
+    reply[1] = code;
+    return (2);
+}
+
+word modbusPdu::process(modbusRegBank *bank, const byte *request, word length, byte *reply) {
+    // function code, address word and quantity or value word
+    if (length < 5) return (0);
+
+    // every field is read before the reply overwrites a shared buffer
+    byte function = request[0];
+    word address = (request[1] << 8) | request[2];
+    word value = (request[3] << 8) | request[4];
+
+    switch (function) {
+        case READ_DO:
+        case READ_DI: {
+            word base = function == READ_DO ? COIL_BASE : DISCRETE_INPUT_BASE;
+            if (value == 0 || value > MAX_READ_BITS) return exception(function, ILLEGAL_DATA_VALUE, reply);
+            if (!inRange(base, address, value)) return exception(function, ILLEGAL_DATA_ADDRESS, reply);
+
+            reply[0] = function;
+            reply[1] = (value + 7) / 8;
+            bank->readBits(base + address, value, reply + 2);
+            return (2 + reply[1]);
+        }
+        case READ_AO:
+        case READ_AI: {
+            word base = function == READ_AO ? HOLDING_REGISTER_BASE : INPUT_REGISTER_BASE;
+            if (value == 0 || value > MAX_READ_REGISTERS) return exception(function, ILLEGAL_DATA_VALUE, reply);
+            if (!inRange(base, address, value)) return exception(function, ILLEGAL_DATA_ADDRESS, reply);
+
+            reply[0] = function;
+            reply[1] = value * 2;
+            bank->readRegisters(base + address, value, reply + 2);
+            return (2 + reply[1]);
+        }
+        case WRITE_DO:
+        case WRITE_AO: {
+            word base = function == WRITE_DO ? COIL_BASE : HOLDING_REGISTER_BASE;
+            if (!inRange(base, address, 1)) return exception(function, ILLEGAL_DATA_ADDRESS, reply);
+
+            // a coil is on for any non-zero value, 0xFF00 included
+            bank->set(base + address, value);
+
+            // the reply echoes the request
+            if (reply != request) memcpy(reply, request, 5);
+            return (5);
+        }
+        case WRITE_MULTIPLE_DO:
+        case WRITE_MULTIPLE_AO: {
+            bool bits = function == WRITE_MULTIPLE_DO;
+            word base = bits ? COIL_BASE : HOLDING_REGISTER_BASE;
+            word limit = bits ? MAX_WRITE_BITS : MAX_WRITE_REGISTERS;
+            word byteCount = length > 5 ? request[5] : 0;
+
+            if (value == 0 || value > limit || byteCount != (bits ? (value + 7) / 8 : value * 2) ||
+                length < 6 + byteCount)
+                return exception(function, ILLEGAL_DATA_VALUE, reply);
+            if (!inRange(base, address, value)) return exception(function, ILLEGAL_DATA_ADDRESS, reply);
+
+            if (bits) bank->writeBits(base + address, value, request + 6);
+            else bank->writeRegisters(base + address, value, request + 6);
+
+            // function, address and quantity, all still in place when the buffer is shared
+            if (reply != request) memcpy(reply, request, 5);
+            return (5);
+        }
+        default:
+            return exception(function, ILLEGAL_FUNCTION, reply);
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef _MODBUSPDU
+#define _MODBUSPDU
+
+#include "Arduino.h"
+#include "modbus.h"
+#include "modbusRegBank.h"
+
+/*
+Transport independent request handling. A PDU is the function code and its data, without the RTU
+address and crc or the TCP MBAP header, so the RTU slave and the TCP server answer from the same
+register bank through the same code. The reply may be built in the request buffer.
+*/
+class modbusPdu {
+public:
+    // returns the reply length, 0 when the request is too short to answer
+    static word process(modbusRegBank *bank, const byte *request, word length, byte *reply);
+    static word exception(byte function, byte code, byte *reply);
+
+private:
+    static bool inRange(word base, word address, word quantity);
+};
+
+#endif
@@ -1,112 +1,292 @@
 #include "modbusRegBank.h"
 
 modbusRegBank::modbusRegBank(void) {
-    _digRegs = 0;
-    _lastDigReg = 0;
-    _anaRegs = 0;
-    _lastAnaReg = 0;
+    _blocks = 0;
+    _blockCount = 0;
+    _blockCapacity = 0;
+    _lastBlock = 0;
 }
 
-void modbusRegBank::add(word addr) {
-    if (addr < 20000) {
-        modbusDigReg *temp;
+modbusRegBank::~modbusRegBank(void) {
+    for (byte i = 0; i < _blockCount; i++) {
+        free(_blocks[i].regs);
+    }
+    free(_blocks);
+}
 
-        temp = (modbusDigReg *) malloc(sizeof(modbusDigReg));
-        temp->address = addr;
-        temp->value = 0;
-        temp->next = 0;
+bool modbusRegBank::isDigital(word addr) {
+    return addr < 20000;
+}
 
-        if (_digRegs == 0) {
-            _digRegs = temp;
-            _lastDigReg = _digRegs;
-        } else {
-            _lastDigReg->next = temp; // Assign the last register's next pointer to temp;
-            _lastDigReg = temp; // then make temp the last register in the list.
+bool modbusRegBank::getBit(const byte *bits, word index) {
+    return (bits[index >> 3] >> (index & 7)) & 1;
+}
+
+void modbusRegBank::setBit(byte *bits, word index, bool value) {
+    if (value) bits[index >> 3] |= (1 << (index & 7));
+    else bits[index >> 3] &= ~(1 << (index & 7));
+}
+
+static size_t blockBytes(bool digital, word capacity) {
+    return digital ? (capacity + 7) / 8 : capacity * sizeof(word);
+}
+
+modbusRegBank::regBlock *modbusRegBank::findBlock(word addr) {
+    if (_blockCount == 0) return (0);
+
+    // consecutive accesses nearly always land in the same block
+    regBlock *block = &_blocks[_lastBlock];
+    if (addr >= block->start && (word) (addr - block->start) < block->count) return (block);
+
+    for (byte i = 0; i < _blockCount; i++) {
+        block = &_blocks[i];
+        if (addr >= block->start && (word) (addr - block->start) < block->count) {
+            _lastBlock = i;
+            return (block);
         }
-    } else {
-        modbusAnaReg *temp;
+    }
+    return (0);
+}
 
-        temp = (modbusAnaReg *) malloc(sizeof(modbusAnaReg));
-        temp->address = addr;
-        temp->value = 0;
-        temp->next = 0;
+modbusRegBank::regBlock *modbusRegBank::appendBlock(word start, word capacity) {
+    if (_blockCount == _blockCapacity) {
+        if (_blockCapacity == 255) return (0);
 
-        if (_anaRegs == 0) {
-            _anaRegs = temp;
-            _lastAnaReg = _anaRegs;
-        } else {
-            _lastAnaReg->next = temp;
-            _lastAnaReg = temp;
+        byte newCapacity = _blockCapacity == 0 ? 4 : (_blockCapacity > 127 ? 255 : _blockCapacity * 2);
+        regBlock *newBlocks = (regBlock *) realloc(_blocks, newCapacity * sizeof(regBlock));
+        if (newBlocks == 0) return (0);
+
+        _blocks = newBlocks;
+        _blockCapacity = newCapacity;
+    }
+
+    regBlock *block = &_blocks[_blockCount];
+    block->start = start;
+    block->count = 0;
+    block->capacity = capacity;
+    block->digital = isDigital(start);
+    block->regs = (word *) calloc(1, blockBytes(block->digital, capacity));
+    if (block->regs == 0) return (0);
+
+    _blockCount++;
+    return (block);
+}
+
+bool modbusRegBank::growBlock(regBlock *block, word capacity) {
+    if (capacity <= block->capacity) return (true);
+
+    size_t oldBytes = blockBytes(block->digital, block->capacity);
+    size_t newBytes = blockBytes(block->digital, capacity);
+    byte *storage = (byte *) realloc(block->bits, newBytes);
+    if (storage == 0) return (false);
+
+    memset(storage + oldBytes, 0, newBytes - oldBytes);
+    block->bits = storage;
+    block->capacity = capacity;
+    return (true);
+}
+
+void modbusRegBank::add(word addr) {
+    if (this->has(addr)) return;
+
+    // extend the block that ends right before this address, else start a new one
+    for (byte i = 0; i < _blockCount; i++) {
+        regBlock *block = &_blocks[i];
+        if (block->digital == isDigital(addr) && (long) block->start + block->count == addr) {
+            if (block->count == block->capacity) {
+                word capacity = block->capacity < 4 ? 8 : block->capacity * 2;
+                if (capacity < block->capacity) capacity = 0xFFFF;
+                if (!growBlock(block, capacity)) return;
+            }
+            block->count++;
+            return;
         }
     }
+
+    regBlock *block = appendBlock(addr, 8);
+    if (block) block->count = 1;
 }
 
-word modbusRegBank::get(word addr) {
-    if (addr < 20000) {
-        modbusDigReg *regPtr;
-        regPtr = (modbusDigReg *) this->search(addr);
-        if (regPtr) return (regPtr->value);
-        else return (0);
-    } else {
-        modbusAnaReg *regPtr;
-        regPtr = (modbusAnaReg *) this->search(addr);
-        if (regPtr) return (regPtr->value);
-        else return (0);
+bool modbusRegBank::addRange(word firstAddress, word count) {
+    if (count == 0) return (false);
+
+    long lastAddress = (long) firstAddress + count - 1;
+    if (lastAddress > 0xFFFF || isDigital(firstAddress) != isDigital(lastAddress)) return (false);
+
+    for (byte i = 0; i < _blockCount; i++) {
+        regBlock *block = &_blocks[i];
+        long blockEnd = (long) block->start + block->count - 1;
+
+        // overlapping an existing map, fall back to adding the missing addresses one by one
+        if (firstAddress <= blockEnd && lastAddress >= block->start) {
+            for (long addr = firstAddress; addr <= lastAddress; addr++) {
+                this->add((word) addr);
+            }
+            return (true);
+        }
+    }
+
+    for (byte i = 0; i < _blockCount; i++) {
+        regBlock *block = &_blocks[i];
+        if (block->digital == isDigital(firstAddress) && (long) block->start + block->count == firstAddress &&
+            (long) block->count + count <= 0xFFFF) {
+            if (!growBlock(block, block->count + count)) return (false);
+            block->count += count;
+            return (true);
+        }
     }
+
+    regBlock *block = appendBlock(firstAddress, count);
+    if (block == 0) return (false);
+    block->count = count;
+    return (true);
+}
+
+bool modbusRegBank::addCoils(word offset, word count) {
+    return this->addRange(COIL_BASE + offset, count);
+}
+
+bool modbusRegBank::addDiscreteInputs(word offset, word count) {
+    return this->addRange(DISCRETE_INPUT_BASE + offset, count);
+}
+
+bool modbusRegBank::addInputRegisters(word offset, word count) {
+    return this->addRange(INPUT_REGISTER_BASE + offset, count);
+}
+
+bool modbusRegBank::addHoldingRegisters(word offset, word count) {
+    return this->addRange(HOLDING_REGISTER_BASE + offset, count);
+}
+
+word modbusRegBank::get(word addr) {
+    regBlock *block = this->findBlock(addr);
+    if (block == 0) return (0);
+
+    word index = addr - block->start;
+    if (block->digital) return getBit(block->bits, index) ? 0xFF : 0x00;
+    return (block->regs[index]);
 }
 
 void modbusRegBank::set(word addr, word value) {
-    // for digital data
-    if (addr < 20000) {
-        modbusDigReg *regPtr;
-        // search for the register address
-        regPtr = (modbusDigReg *) this->search(addr);
-        // if a pointer was returned, the set the register value to true if value is non-zero
-        if (regPtr) {
-            if (value) regPtr->value = 0xFF;
-            else regPtr->value = 0x00;
+    regBlock *block = this->findBlock(addr);
+    if (block == 0) return;
+
+    word index = addr - block->start;
+    // digital registers only keep whether the value is non-zero
+    if (block->digital) setBit(block->bits, index, value != 0);
+    else block->regs[index] = value;
+}
+
+bool modbusRegBank::has(word addr) {
+    return this->findBlock(addr) != 0;
+}
+
+word *modbusRegBank::getRegisters(word address, word count) {
+    regBlock *block = this->findBlock(address);
+    if (block == 0 || block->digital) return (0);
+
+    word index = address - block->start;
+    if ((long) index + count > block->count) return (0);
+    return (block->regs + index);
+}
+
+void modbusRegBank::readRegisters(word address, word count, byte *out) {
+    while (count > 0) {
+        regBlock *block = this->findBlock(address);
+        if (block == 0 || block->digital) {
+            *out++ = 0;
+            *out++ = 0;
+            address++;
+            count--;
+            continue;
         }
-    } else {
-        modbusAnaReg *regPtr;
-        // search for the register address
-        regPtr = (modbusAnaReg *) this->search(addr);
-        // if found, then assign the register value to the new value.
-        if (regPtr) regPtr->value = value;
-    }
-}
-
-void *modbusRegBank::search(word addr) {
-    // if the requested address is 0-19999
-    // use a digital register pointer assigned to the first digital register,
-    // else use an analog register pointer assigned the first analog register
-
-    if (addr < 20000) {
-        modbusDigReg *regPtr = _digRegs;
-
-        // if there is no register configured, bail
-        if (regPtr == 0) return (0);
-
-        // scan through the linked list until the end of the list or the register is found.
-        // return the pointer.
-        do {
-            if (regPtr->address == addr) return (regPtr);
-            regPtr = regPtr->next;
-        } while (regPtr);
-    } else {
-        modbusAnaReg *regPtr = _anaRegs;
-
-        // if there is no register configured, bail
-        if (regPtr == 0) return (0);
-
-        // scan through the linked list until the end of the list or the register is found.
-        // return the pointer.
-        do {
-            if (regPtr->address == addr)
-                return (regPtr);
-            regPtr = regPtr->next;
-        } while (regPtr);
+
+        word index = address - block->start;
+        word run = block->count - index;
+        if (run > count) run = count;
+
+        const word *regs = block->regs + index;
+        for (word i = 0; i < run; i++) {
+            *out++ = regs[i] >> 8;
+            *out++ = regs[i] & 0xFF;
+        }
+        address += run;
+        count -= run;
+    }
+}
+
+void modbusRegBank::writeRegisters(word address, word count, const byte *in) {
+    while (count > 0) {
+        regBlock *block = this->findBlock(address);
+        if (block == 0 || block->digital) {
+            in += 2;
+            address++;
+            count--;
+            continue;
+        }
+
+        word index = address - block->start;
+        word run = block->count - index;
+        if (run > count) run = count;
+
+        word *regs = block->regs + index;
+        for (word i = 0; i < run; i++) {
+            regs[i] = (in[0] << 8) | in[1];
+            in += 2;
+        }
+        address += run;
+        count -= run;
+    }
+}
+
+void modbusRegBank::readBits(word address, word count, byte *out) {
+    memset(out, 0, (count + 7) / 8);
+
+    word bit = 0;
+    while (count > 0) {
+        regBlock *block = this->findBlock(address);
+        if (block == 0 || !block->digital) {
+            bit++;
+            address++;
+            count--;
+            continue;
+        }
+
+        word index = address - block->start;
+        word run = block->count - index;
+        if (run > count) run = count;
+
+        for (word i = 0; i < run; i++) {
+            if (getBit(block->bits, index + i)) setBit(out, bit, true);
+            bit++;
+        }
+        address += run;
+        count -= run;
+    }
+}
+
+void modbusRegBank::writeBits(word address, word count, const byte *in) {
+    word bit = 0;
+    while (count > 0) {
+        regBlock *block = this->findBlock(address);
+        if (block == 0 || !block->digital) {
+            bit++;
+            address++;
+            count--;
+            continue;
+        }
+
+        word index = address - block->start;
+        word run = block->count - index;
+        if (run > count) run = count;
+
+        for (word i = 0; i < run; i++) {
+            setBit(block->bits, index + i, getBit(in, bit));
+            bit++;
+        }
+        address += run;
+        count -= run;
     }
-    return (0);
 }
 
 void modbusRegBank::sendDataInt(int value, long address) {
@@ -4,24 +4,34 @@
 #include "Arduino.h"
 #include "modbus.h"
 
-struct modbusDigReg {
-    word address;
-    byte value;
-    modbusDigReg *next;
-};
-
-struct modbusAnaReg {
-    word address;
-    word value;
-    modbusAnaReg *next;
-};
+// first address of each table in the 5 digit numbering used by get() and set()
+#define COIL_BASE               1
+#define DISCRETE_INPUT_BASE     10001
+#define INPUT_REGISTER_BASE     30001
+#define HOLDING_REGISTER_BASE   40001
 
 class modbusRegBank {
 public:
     modbusRegBank(void);
+    ~modbusRegBank(void);
+
     void add(word);
+    bool addRange(word firstAddress, word count);
+    bool addCoils(word offset, word count);
+    bool addDiscreteInputs(word offset, word count);
+    bool addInputRegisters(word offset, word count);
+    bool addHoldingRegisters(word offset, word count);
+
     word get(word);
     void set(word, word);
+    bool has(word);
+
+    // range access for the slave, unmapped addresses read as 0 and ignore writes
+    void readRegisters(word address, word count, byte *out);
+    void writeRegisters(word address, word count, const byte *in);
+    void readBits(word address, word count, byte *out);
+    void writeBits(word address, word count, const byte *in);
+    word *getRegisters(word address, word count);
 
     void sendDataInt(int value, long address);
     void sendDataLong(long value, long address);
@@ -41,10 +51,34 @@ public:
     double mapDouble(double x, double in_min, double in_max, double out_min, double out_max);
 
 private:
-    void *search(word);
+    // registers live in contiguous blocks, coils and discrete inputs bit-packed, so an address
+    // resolves to a block and an index instead of a list walk
+    struct regBlock {
+        word start;
+        word count;
+        word capacity;
+        bool digital;
+        union {
+            byte *bits;
+            word *regs;
+        };
+    };
+
+    modbusRegBank(const modbusRegBank &);
+    modbusRegBank &operator=(const modbusRegBank &);
+
+    regBlock *findBlock(word addr);
+    regBlock *appendBlock(word start, word capacity);
+    bool growBlock(regBlock *block, word capacity);
+
+    static bool isDigital(word addr);
+    static bool getBit(const byte *bits, word index);
+    static void setBit(byte *bits, word index, bool value);
 
-    modbusDigReg *_digRegs, *_lastDigReg;
-    modbusAnaReg *_anaRegs, *_lastAnaReg;
+    regBlock *_blocks;
+    byte _blockCount;
+    byte _blockCapacity;
+    byte _lastBlock;
 };
 
 #endif
@@ -0,0 +1,155 @@
+#include "modbusTcpClient.h"
+
+modbusTcpClient::modbusTcpClient(void) {
+    _client = 0;
+    _unit = 0xFF;
+    _timeout = MODBUS_TCP_RESPONSE_TIMEOUT;
+    _nextTransaction = 1;
+    _handler = 0;
+    _pendingCount = 0;
+    _rxLen = 0;
+
+    for (byte i = 0; i < MODBUS_TCP_MAX_PENDING; i++) {
+        _pending[i].used = false;
+    }
+}
+
+void modbusTcpClient::begin(Client *client, byte unit) {
+    _client = client;
+    _unit = unit;
+    _rxLen = 0;
+    _pendingCount = 0;
+    for (byte i = 0; i < MODBUS_TCP_MAX_PENDING; i++) {
+        _pending[i].used = false;
+    }
+}
+
+void modbusTcpClient::setTimeout(word timeoutMs) {
+    _timeout = timeoutMs;
+}
+
+void modbusTcpClient::onResponse(modbusTcpHandler handler) {
+    _handler = handler;
+}
+
+byte modbusTcpClient::getPending(void) {
+    return (_pendingCount);
+}
+
+int modbusTcpClient::request(const byte *pdu, word length) {
+    if (_client == 0 || length == 0 || length > MODBUS_PDU_SIZE) return (MODBUS_INVALID);
+    if (_pendingCount == MODBUS_TCP_MAX_PENDING) return (MODBUS_INVALID);
+
+    byte slot = 0;
+    while (_pending[slot].used) slot++;
+
+    word transaction = _nextTransaction++;
+    _tx[0] = transaction >> 8;
+    _tx[1] = transaction & 0xFF;
+    _tx[2] = 0;
+    _tx[3] = 0;
+    _tx[4] = (length + 1) >> 8;
+    _tx[5] = (length + 1) & 0xFF;
+    _tx[6] = _unit;
+    memcpy(_tx + MBAP_HEADER_SIZE, pdu, length);
+
+    if (_client->write(_tx, MBAP_HEADER_SIZE + length) != (size_t) (MBAP_HEADER_SIZE + length))
+        return (MODBUS_INVALID);
+
+    _pending[slot].transaction = transaction;
+    _pending[slot].sentAt = millis();
+    _pending[slot].used = true;
+    _pendingCount++;
+    return (transaction);
+}
+
+int modbusTcpClient::fixedRequest(byte function, word field1, word field2) {
+    byte pdu[5];
+    pdu[0] = function;
+    pdu[1] = field1 >> 8;
+    pdu[2] = field1 & 0xFF;
+    pdu[3] = field2 >> 8;
+    pdu[4] = field2 & 0xFF;
+    return this->request(pdu, 5);
+}
+
+int modbusTcpClient::read(byte function, word address, word quantity) {
+    if (function < READ_DO || function > READ_AI) return (MODBUS_INVALID);
+    return this->fixedRequest(function, address, quantity);
+}
+
+int modbusTcpClient::writeRegister(word address, word value) {
+    return this->fixedRequest(WRITE_AO, address, value);
+}
+
+int modbusTcpClient::writeCoil(word address, bool value) {
+    return this->fixedRequest(WRITE_DO, address, value ? 0xFF00 : 0x0000);
+}
+
+int modbusTcpClient::writeRegisters(word address, word quantity, const word *values) {
+    if (quantity == 0 || quantity > MAX_WRITE_REGISTERS) return (MODBUS_INVALID);
+
+    byte pdu[MODBUS_PDU_SIZE];
+    pdu[0] = WRITE_MULTIPLE_AO;
+    pdu[1] = address >> 8;
+    pdu[2] = address & 0xFF;
+    pdu[3] = quantity >> 8;
+    pdu[4] = quantity & 0xFF;
+    pdu[5] = quantity * 2;
+    for (word i = 0; i < quantity; i++) {
+        pdu[6 + i * 2] = values[i] >> 8;
+        pdu[7 + i * 2] = values[i] & 0xFF;
+    }
+    return this->request(pdu, 6 + quantity * 2);
+}
+
+void modbusTcpClient::dispatch(word transaction, const byte *pdu, word length) {
+    for (byte i = 0; i < MODBUS_TCP_MAX_PENDING; i++) {
+        if (_pending[i].used && _pending[i].transaction == transaction) {
+            _pending[i].used = false;
+            _pendingCount--;
+            if (_handler) _handler(transaction, pdu, length);
+            return;
+        }
+    }
+    // a reply to a request that already timed out is dropped
+}
+
+void modbusTcpClient::run(void) {
+    if (_client == 0) return;
+
+    while (true) {
+        int available = _client->available();
+        if (available > 0 && _rxLen < MODBUS_TCP_ADU_SIZE) {
+            word room = MODBUS_TCP_ADU_SIZE - _rxLen;
+            int received = _client->read(_rx + _rxLen, available < room ? available : room);
+            if (received > 0) _rxLen += received;
+        }
+
+        if (_rxLen < MBAP_HEADER_SIZE) break;
+
+        word protocol = (_rx[2] << 8) | _rx[3];
+        word length = (_rx[4] << 8) | _rx[5];
+        if (protocol != 0 || length < 2 || length > MODBUS_PDU_SIZE + 1) {
+            // out of step with the server, whatever is buffered cannot be trusted
+            _rxLen = 0;
+            break;
+        }
+
+        word aduLength = 6 + length;
+        if (_rxLen < aduLength) break;
+
+        this->dispatch((_rx[0] << 8) | _rx[1], _rx + MBAP_HEADER_SIZE, length - 1);
+        _rxLen -= aduLength;
+        memmove(_rx, _rx + aduLength, _rxLen);
+    }
+
+    unsigned long now = millis();
+    for (byte i = 0; i < MODBUS_TCP_MAX_PENDING; i++) {
+        if (_pending[i].used && now - _pending[i].sentAt >= _timeout) {
+            _pending[i].used = false;
+            _pendingCount--;
+            if (_handler) _handler(_pending[i].transaction, 0, 0);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef _MODBUSTCPCLIENT
+#define _MODBUSTCPCLIENT
+
+#include "Arduino.h"
+#include "Client.h"
+#include "modbus.h"
+
+// requests that may be in flight on one connection
+#ifndef MODBUS_TCP_MAX_PENDING
+#define MODBUS_TCP_MAX_PENDING      8
+#endif
+#define MODBUS_TCP_RESPONSE_TIMEOUT 1000
+
+// pdu is the reply PDU, function code first; a timed out request is reported with length 0
+typedef void (*modbusTcpHandler)(word transaction, const byte *pdu, word length);
+
+/*
+Pipelining Modbus TCP client. Requests go out as soon as they are made, each with its own
+transaction id, and replies are matched back by that id whatever order they come in.
+*/
+class modbusTcpClient {
+public:
+    modbusTcpClient(void);
+    void begin(Client *client, byte unit = 0xFF);
+    void setTimeout(word timeoutMs);
+    void onResponse(modbusTcpHandler handler);
+
+    // all return the transaction id, or MODBUS_INVALID when the pipeline is full or the write failed
+    int request(const byte *pdu, word length);
+    int read(byte function, word address, word quantity);
+    int writeRegister(word address, word value);
+    int writeCoil(word address, bool value);
+    int writeRegisters(word address, word quantity, const word *values);
+
+    byte getPending(void);
+    void run(void);
+
+private:
+    struct pendingRequest {
+        word transaction;
+        unsigned long sentAt;
+        bool used;
+    };
+
+    int fixedRequest(byte function, word field1, word field2);
+    void dispatch(word transaction, const byte *pdu, word length);
+
+    Client *_client;
+    byte _unit;
+    word _timeout;
+    word _nextTransaction;
+    modbusTcpHandler _handler;
+
+    pendingRequest _pending[MODBUS_TCP_MAX_PENDING];
+    byte _pendingCount;
+
+    byte _rx[MODBUS_TCP_ADU_SIZE];
+    word _rxLen;
+    byte _tx[MODBUS_TCP_ADU_SIZE];
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "modbusTcpServer.h"
+
+modbusTcpServer::modbusTcpServer(void) {
+    _device = 0;
+    _idleTimeout = MODBUS_TCP_IDLE_TIMEOUT;
+    _requests = 0;
+
+    for (byte i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+        _connections[i].client = 0;
+        _connections[i].lastActivity = 0;
+        _connections[i].rxLen = 0;
+    }
+}
+
+void modbusTcpServer::begin(modbusDevice *device) {
+    _device = device;
+}
+
+void modbusTcpServer::setIdleTimeout(unsigned long timeoutMs) {
+    _idleTimeout = timeoutMs;
+}
+
+int modbusTcpServer::attach(Client *client) {
+    if (client == 0) return (MODBUS_INVALID);
+
+    int slot = MODBUS_INVALID;
+    for (byte i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+        // the same client object handed over again carries a new connection
+        if (_connections[i].client == client) {
+            slot = i;
+            break;
+        }
+        if (_connections[i].client == 0 && slot == MODBUS_INVALID) slot = i;
+    }
+
+    if (slot == MODBUS_INVALID) {
+        slot = 0;
+        for (byte i = 1; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+            if ((long) (_connections[i].lastActivity - _connections[slot].lastActivity) < 0) slot = i;
+        }
+        if (_connections[slot].client != client) this->close(_connections[slot]);
+    }
+
+    connection &conn = _connections[slot];
+    conn.client = client;
+    conn.lastActivity = millis();
+    conn.rxLen = 0;
+    return (slot);
+}
+
+byte modbusTcpServer::getConnectionCount(void) {
+    byte count = 0;
+    for (byte i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+        if (_connections[i].client) count++;
+    }
+    return (count);
+}
+
+unsigned long modbusTcpServer::getRequestCount(void) {
+    return (_requests);
+}
+
+void modbusTcpServer::close(connection &conn) {
+    if (conn.client) conn.client->stop();
+    conn.client = 0;
+    conn.rxLen = 0;
+}
+
+bool modbusTcpServer::acceptsUnit(byte unit) {
+    // a server without an ID answers every unit, otherwise its own, 0 and the 0xFF of plain TCP devices
+    byte id = _device->getId();
+    return (id == 0 || unit == id || unit == 0 || unit == 0xFF);
+}
+
+/*
+Answers every complete request in the receive buffer, up to MODBUS_TCP_MAX_PIPELINE. Returns true
+when at least one reply was sent.
+*/
+bool modbusTcpServer::serve(connection &conn) {
+    Client *client = conn.client;
+    word txLen = 0;
+    byte handled = 0;
+
+    while (handled < MODBUS_TCP_MAX_PIPELINE) {
+        int available = client->available();
+        if (available > 0 && conn.rxLen < MODBUS_TCP_ADU_SIZE) {
+            word room = MODBUS_TCP_ADU_SIZE - conn.rxLen;
+            int received = client->read(conn.rx + conn.rxLen, available < room ? available : room);
+            if (received > 0) {
+                conn.rxLen += received;
+                conn.lastActivity = millis();
+            }
+        }
+
+        if (conn.rxLen < MBAP_HEADER_SIZE) break;
+
+        word protocol = (conn.rx[2] << 8) | conn.rx[3];
+        word length = (conn.rx[4] << 8) | conn.rx[5];
+        // the stream cannot be resynchronised after a bad header, only the connection can be dropped
+        if (protocol != 0 || length < 2 || length > MODBUS_PDU_SIZE + 1) {
+            if (txLen) client->write(_tx, txLen);
+            this->close(conn);
+            return (txLen > 0);
+        }
+
+        word aduLength = 6 + length;
+        if (conn.rxLen < aduLength) break;
+
+        if (txLen + MODBUS_TCP_ADU_SIZE > (int) sizeof(_tx)) {
+            client->write(_tx, txLen);
+            txLen = 0;
+        }
+
+        byte *out = _tx + txLen;
+        byte unit = conn.rx[6];
+        word pduLength;
+        if (this->acceptsUnit(unit)) pduLength = modbusPdu::process(_device, conn.rx + 7, length - 1, out + 7);
+        else pduLength = modbusPdu::exception(conn.rx[7], GATEWAY_TARGET_FAILED, out + 7);
+
+        if (pduLength > 0) {
+            // transaction and protocol id are echoed, the length covers unit id and PDU
+            memcpy(out, conn.rx, 4);
+            out[4] = (pduLength + 1) >> 8;
+            out[5] = (pduLength + 1) & 0xFF;
+            out[6] = unit;
+            txLen += MBAP_HEADER_SIZE + pduLength;
+        }
+
+        conn.rxLen -= aduLength;
+        memmove(conn.rx, conn.rx + aduLength, conn.rxLen);
+        handled++;
+        _requests++;
+    }
+
+    if (txLen) client->write(_tx, txLen);
+    return (handled > 0);
+}
+
+void modbusTcpServer::run(void (*callback)()) {
+    if (_device == 0) return;
+
+    bool served = false;
+    for (byte i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+        connection &conn = _connections[i];
+        if (conn.client == 0) continue;
+
+        if (!conn.client->connected() && !conn.client->available()) {
+            this->close(conn);
+            continue;
+        }
+        if (this->serve(conn)) served = true;
+
+        if (conn.client && millis() - conn.lastActivity >= _idleTimeout) this->close(conn);
+    }
+
+    if (served && callback != nullptr) {
+        callback();
+    }
+}
\ No newline at end of file
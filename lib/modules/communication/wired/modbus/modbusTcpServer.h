@@ -0,0 +1,57 @@
+#ifndef _MODBUSTCPSERVER
+#define _MODBUSTCPSERVER
+
+#include "Arduino.h"
+#include "Client.h"
+#include "modbus.h"
+#include "modbusDevice.h"
+#include "modbusPdu.h"
+
+#ifndef MODBUS_TCP_MAX_CLIENTS
+#define MODBUS_TCP_MAX_CLIENTS      4
+#endif
+// a connection without requests for this long is closed
+#define MODBUS_TCP_IDLE_TIMEOUT     60000
+// requests answered per connection in one run(), one busy client cannot hold the loop
+#define MODBUS_TCP_MAX_PIPELINE     8
+
+/*
+Modbus TCP front end over the same register bank as modbusSlave. Connections are accepted by the
+sketch (WiFiServer, EthernetServer, ...) and handed over with attach(). Every run() answers all
+complete requests waiting on a connection, in order, and sends the replies in one write.
+*/
+class modbusTcpServer {
+public:
+    modbusTcpServer(void);
+    void begin(modbusDevice *device);
+    void setIdleTimeout(unsigned long timeoutMs);
+
+    // the client object has to stay alive while attached, a full table drops the longest idle one
+    int attach(Client *client);
+    byte getConnectionCount(void);
+    unsigned long getRequestCount(void);
+
+    void run(void (*callback)() = nullptr);
+
+    modbusDevice *_device;
+
+private:
+    struct connection {
+        Client *client;
+        unsigned long lastActivity;
+        word rxLen;
+        byte rx[MODBUS_TCP_ADU_SIZE];
+    };
+
+    bool serve(connection &conn);
+    void close(connection &conn);
+    bool acceptsUnit(byte unit);
+
+    connection _connections[MODBUS_TCP_MAX_CLIENTS];
+    // replies of one run() are collected here and written together
+    byte _tx[MODBUS_TCP_ADU_SIZE * 2];
+    unsigned long _idleTimeout;
+    unsigned long _requests;
+};
+
+#endif
@@ -54,7 +54,14 @@ EnhancedSerial::EnhancedSerial(size_t _bufferSize)
           buffer(nullptr),
           bufferSize(0),
           bufferHead(0),
-          bufferTail(0) {
+          bufferTail(0),
+          fieldSeparator(';'),
+          txLength(0),
+          txOverflow(false),
+          rxLength(0),
+          rxOverflow(false),
+          rxComplete(false),
+          rxFieldCount(0) {
     if (!initializeBuffer(_bufferSize)) {
         setError(Error::MEMORY_ERROR);
     }
@@ -359,11 +366,16 @@ String EnhancedSerial::cleanString(const String &input, bool allowNewlines, bool
 }
 
 float EnhancedSerial::getFloat(const String &data, uint8_t index, const char *separator) {
-    return parseStr(data, separator, index).toFloat();
+    // the number is read where it sits, no substring is made
+    Field field;
+    if (!findField(data.c_str(), data.length(), separator[0], index, &field)) return 0;
+    return toFloat(data.c_str() + field.offset, field.length);
 }
 
 int EnhancedSerial::getInt(const String &data, uint8_t index, const char *separator) {
-    return parseStr(data, separator, index).toInt();
+    Field field;
+    if (!findField(data.c_str(), data.length(), separator[0], index, &field)) return 0;
+    return toLong(data.c_str() + field.offset, field.length);
 }
 
 String EnhancedSerial::getString(const String &data, uint8_t index, const char *separator) {
@@ -384,6 +396,341 @@ String EnhancedSerial::parseStr(const String &data, const char *separator, int i
     return found > index ? data.substring(strIndex[0], strIndex[1]) : "";
 }
 
+void EnhancedSerial::setSeparator(char separator) {
+    fieldSeparator = separator;
+}
+
+char EnhancedSerial::getSeparator() const {
+    return fieldSeparator;
+}
+
+void EnhancedSerial::beginLine() {
+    txLength = 0;
+    txOverflow = false;
+    txLine[0] = '\0';
+}
+
+uint8_t EnhancedSerial::formatUnsigned(unsigned long value, char *out) {
+    char digits[10];
+    uint8_t count = 0;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+
+    for (uint8_t i = 0; i < count; i++) {
+        out[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+bool EnhancedSerial::appendField(const char *text, size_t length) {
+    // room for the separator and the terminator, a field is never written half
+    if (txLength + length + 2 > ENHANCED_SERIAL_LINE_SIZE) {
+        txOverflow = true;
+        setError(Error::BUFFER_OVERFLOW);
+        return false;
+    }
+
+    memcpy(txLine + txLength, text, length);
+    txLength += length;
+    txLine[txLength++] = fieldSeparator;
+    txLine[txLength] = '\0';
+    return true;
+}
+
+bool EnhancedSerial::appendNumber(unsigned long value, bool negative) {
+    char text[11];
+    uint8_t length = 0;
+    if (negative) text[length++] = '-';
+    length += formatUnsigned(value, text + length);
+    return appendField(text, length);
+}
+
+EnhancedSerial &EnhancedSerial::addField(long value) {
+    if (value < 0) {
+        appendNumber(0UL - (unsigned long) value, true);
+    } else {
+        appendNumber(value, false);
+    }
+    return *this;
+}
+
+EnhancedSerial &EnhancedSerial::addField(unsigned long value) {
+    appendNumber(value, false);
+    return *this;
+}
+
+EnhancedSerial &EnhancedSerial::addField(int value) {
+    return addField((long) value);
+}
+
+EnhancedSerial &EnhancedSerial::addField(unsigned int value) {
+    return addField((unsigned long) value);
+}
+
+EnhancedSerial &EnhancedSerial::addField(double value, uint8_t decimals) {
+    // same digits as Print::print(value, decimals), so the other side cannot tell the paths apart
+    if (isnan(value)) {
+        appendField("nan", 3);
+        return *this;
+    }
+    if (isinf(value)) {
+        appendField("inf", 3);
+        return *this;
+    }
+    if (value > 4294967040.0 || value < -4294967040.0) {
+        appendField("ovf", 3);
+        return *this;
+    }
+    if (decimals > 8) decimals = 8;
+
+    char text[21];
+    uint8_t length = 0;
+    if (value < 0.0) {
+        text[length++] = '-';
+        value = -value;
+    }
+
+    double rounding = 0.5;
+    for (uint8_t i = 0; i < decimals; i++) {
+        rounding /= 10.0;
+    }
+    value += rounding;
+
+    unsigned long whole = (unsigned long) value;
+    double remainder = value - (double) whole;
+    length += formatUnsigned(whole, text + length);
+
+    if (decimals > 0) {
+        text[length++] = '.';
+        while (decimals-- > 0) {
+            remainder *= 10.0;
+            uint8_t digit = (uint8_t) remainder;
+            text[length++] = '0' + digit;
+            remainder -= digit;
+        }
+    }
+
+    appendField(text, length);
+    return *this;
+}
+
+EnhancedSerial &EnhancedSerial::addField(const char *value) {
+    if (value != nullptr) appendField(value, strlen(value));
+    return *this;
+}
+
+bool EnhancedSerial::sendLine() {
+    if (!serialPtr || txOverflow) return false;
+    size_t written = serialPtr->write((const uint8_t *) txLine, txLength);
+    written += serialPtr->write((const uint8_t *) "\r\n", 2);
+    return written == (size_t) txLength + 2;
+}
+
+const char *EnhancedSerial::getLine() const {
+    return txLength > 0 ? txLine : "";
+}
+
+uint16_t EnhancedSerial::getLineLength() const {
+    return txLength;
+}
+
+bool EnhancedSerial::pollLine() {
+    if (!serialPtr) return false;
+
+    if (rxComplete) {
+        rxComplete = false;
+        rxLength = 0;
+        rxFieldCount = 0;
+    }
+
+    while (serialPtr->available()) {
+        int c = serialPtr->read();
+        if (c < 0) break;
+
+        if (c == '\n') {
+            if (rxOverflow) {
+                // the tail of a line that did not fit, nothing of it is handed out
+                rxOverflow = false;
+                rxLength = 0;
+                continue;
+            }
+            rxLine[rxLength] = '\0';
+            rxFieldCount = split(rxLine, rxLength, fieldSeparator, rxFields, ENHANCED_SERIAL_MAX_FIELDS);
+            rxComplete = true;
+            return true;
+        }
+
+        if (c == '\r') continue;
+        if (autoCleanEnabled && (c < 32 || c > 126)) continue;
+
+        if (rxLength + 1 >= ENHANCED_SERIAL_LINE_SIZE) {
+            if (!rxOverflow) setError(Error::BUFFER_OVERFLOW);
+            rxOverflow = true;
+            continue;
+        }
+        rxLine[rxLength++] = (char) c;
+    }
+
+    return false;
+}
+
+const char *EnhancedSerial::getReceivedLine() const {
+    return rxComplete ? rxLine : "";
+}
+
+uint8_t EnhancedSerial::getFieldCount() const {
+    return rxComplete ? rxFieldCount : 0;
+}
+
+const EnhancedSerial::Field *EnhancedSerial::fieldAt(uint8_t index) const {
+    if (!rxComplete || index >= rxFieldCount) return nullptr;
+    return &rxFields[index];
+}
+
+long EnhancedSerial::getFieldInt(uint8_t index, long fallback) const {
+    const Field *field = fieldAt(index);
+    if (field == nullptr) return fallback;
+    return toLong(rxLine + field->offset, field->length, fallback);
+}
+
+float EnhancedSerial::getFieldFloat(uint8_t index, float fallback) const {
+    const Field *field = fieldAt(index);
+    if (field == nullptr) return fallback;
+    return toFloat(rxLine + field->offset, field->length, fallback);
+}
+
+size_t EnhancedSerial::getFieldString(uint8_t index, char *out, size_t size) const {
+    if (out == nullptr || size == 0) return 0;
+
+    const Field *field = fieldAt(index);
+    size_t length = field == nullptr ? 0 : field->length;
+    if (length > size - 1) length = size - 1;
+    if (length > 0) memcpy(out, rxLine + field->offset, length);
+    out[length] = '\0';
+    return length;
+}
+
+bool EnhancedSerial::fieldEquals(uint8_t index, const char *text) const {
+    const Field *field = fieldAt(index);
+    if (field == nullptr || text == nullptr) return false;
+    return strlen(text) == field->length && memcmp(rxLine + field->offset, text, field->length) == 0;
+}
+
+uint8_t EnhancedSerial::split(const char *line, size_t length, char separator, Field *fields, uint8_t maxFields) {
+    if (line == nullptr || fields == nullptr) return 0;
+
+    uint8_t count = 0;
+    size_t start = 0;
+    for (size_t i = 0; i <= length && count < maxFields; i++) {
+        if (i < length && line[i] != separator) continue;
+        // a trailing separator does not open an empty last field
+        if (i == length && start == length) break;
+
+        fields[count].offset = start;
+        fields[count].length = i - start;
+        count++;
+        start = i + 1;
+    }
+    return count;
+}
+
+bool EnhancedSerial::findField(const char *line, size_t length, char separator, uint8_t index, Field *field) {
+    if (line == nullptr) return false;
+
+    uint8_t found = 0;
+    size_t start = 0;
+    for (size_t i = 0; i <= length; i++) {
+        if (i < length && line[i] != separator) continue;
+        if (i == length && start == length) break;
+
+        if (found == index) {
+            field->offset = start;
+            field->length = i - start;
+            return true;
+        }
+        found++;
+        start = i + 1;
+    }
+    return false;
+}
+
+long EnhancedSerial::toLong(const char *text, size_t length, long fallback) {
+    size_t i = 0;
+    while (i < length && text[i] == ' ') i++;
+
+    bool negative = false;
+    if (i < length && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        i++;
+    }
+
+    if (i == length || text[i] < '0' || text[i] > '9') return fallback;
+
+    unsigned long value = 0;
+    while (i < length && text[i] >= '0' && text[i] <= '9') {
+        value = value * 10 + (text[i] - '0');
+        i++;
+    }
+    return negative ? -(long) value : (long) value;
+}
+
+float EnhancedSerial::toFloat(const char *text, size_t length, float fallback) {
+    static const float powers[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+    size_t i = 0;
+    while (i < length && text[i] == ' ') i++;
+
+    bool negative = false;
+    if (i < length && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        i++;
+    }
+
+    // up to 9 significant digits go into an integer, the rest only move the exponent
+    uint32_t mantissa = 0;
+    int exponent = 0;
+    bool digits = false;
+    while (i < length && text[i] >= '0' && text[i] <= '9') {
+        if (mantissa < 100000000UL) {
+            mantissa = mantissa * 10 + (text[i] - '0');
+        } else {
+            exponent++;
+        }
+        digits = true;
+        i++;
+    }
+    if (i < length && text[i] == '.') {
+        i++;
+        while (i < length && text[i] >= '0' && text[i] <= '9') {
+            if (mantissa < 100000000UL) {
+                mantissa = mantissa * 10 + (text[i] - '0');
+                exponent--;
+            }
+            digits = true;
+            i++;
+        }
+    }
+    if (!digits) return fallback;
+
+    if (i + 1 < length && (text[i] == 'e' || text[i] == 'E')) {
+        exponent += (int) toLong(text + i + 1, length - i - 1, 0);
+    }
+
+    float value = (float) mantissa;
+    while (exponent > 10) {
+        value *= powers[10];
+        exponent -= 10;
+    }
+    while (exponent < -10) {
+        value /= powers[10];
+        exponent += 10;
+    }
+    value = exponent >= 0 ? value * powers[exponent] : value / powers[-exponent];
+    return negative ? -value : value;
+}
+
 bool EnhancedSerial::find(const char *target, size_t length) {
     if (!target) return false;
     if (length == 0) length = strlen(target);
@@ -8,6 +8,31 @@
 #include "Arduino.h"
 #include "Stream.h"
 
+// fixed line buffers of the allocation-free path (beginLine/addField/sendLine and pollLine/getField*),
+// every instance holds two lines plus 4 bytes per field whether the path is used or not
+#if defined(__AVR__) && defined(RAMEND) && RAMEND < 0x1000
+// 4 KB of SRAM or less: Uno, Nano, Pro Mini, Leonardo, Micro, ATtiny
+#define ENHANCED_SERIAL_DEFAULT_LINE_SIZE 64
+#define ENHANCED_SERIAL_DEFAULT_MAX_FIELDS 8
+#elif defined(__AVR__)
+// Mega, ATmega1284
+#define ENHANCED_SERIAL_DEFAULT_LINE_SIZE 128
+#define ENHANCED_SERIAL_DEFAULT_MAX_FIELDS 16
+#elif defined(ESP32)
+#define ENHANCED_SERIAL_DEFAULT_LINE_SIZE 512
+#define ENHANCED_SERIAL_DEFAULT_MAX_FIELDS 64
+#else
+#define ENHANCED_SERIAL_DEFAULT_LINE_SIZE 256
+#define ENHANCED_SERIAL_DEFAULT_MAX_FIELDS 32
+#endif
+
+#ifndef ENHANCED_SERIAL_LINE_SIZE
+#define ENHANCED_SERIAL_LINE_SIZE ENHANCED_SERIAL_DEFAULT_LINE_SIZE
+#endif
+#ifndef ENHANCED_SERIAL_MAX_FIELDS
+#define ENHANCED_SERIAL_MAX_FIELDS ENHANCED_SERIAL_DEFAULT_MAX_FIELDS
+#endif
+
 class EnhancedSerial : public Stream {
 public:
     enum class Error {
@@ -18,6 +43,12 @@ public:
         MEMORY_ERROR
     };
 
+    // one field of a line, as a position in the line rather than a copy
+    struct Field {
+        uint16_t offset;
+        uint16_t length;
+    };
+
 private:
     Stream *serialPtr;
     String dataSend;
@@ -42,6 +73,23 @@ private:
     bool initializeBuffer(size_t size);
     void freeBuffer();
 
+    char fieldSeparator;
+    char txLine[ENHANCED_SERIAL_LINE_SIZE];
+    uint16_t txLength;
+    bool txOverflow;
+    char rxLine[ENHANCED_SERIAL_LINE_SIZE];
+    uint16_t rxLength;
+    bool rxOverflow;
+    bool rxComplete;
+    Field rxFields[ENHANCED_SERIAL_MAX_FIELDS];
+    uint8_t rxFieldCount;
+
+    bool appendField(const char *text, size_t length);
+    bool appendNumber(unsigned long value, bool negative);
+    static uint8_t formatUnsigned(unsigned long value, char *out);
+    const Field *fieldAt(uint8_t index) const;
+    static bool findField(const char *line, size_t length, char separator, uint8_t index, Field *field);
+
 public:
     explicit EnhancedSerial(size_t bufferSize = 2);
     ~EnhancedSerial();
@@ -103,6 +151,35 @@ public:
 
     String parseStr(const String &data, const char *separator, int index);
 
+    // builds "a;b;c;" in a fixed buffer, a field that does not fit is dropped and sendLine() fails
+    void setSeparator(char separator);
+    char getSeparator() const;
+    void beginLine();
+    EnhancedSerial &addField(long value);
+    EnhancedSerial &addField(unsigned long value);
+    EnhancedSerial &addField(int value);
+    EnhancedSerial &addField(unsigned int value);
+    EnhancedSerial &addField(double value, uint8_t decimals = 2);
+    EnhancedSerial &addField(const char *value);
+    bool sendLine();
+    const char *getLine() const;
+    uint16_t getLineLength() const;
+
+    // collects whatever bytes are waiting, true once a full line is in and split into fields;
+    // the fields stay valid until the next pollLine()
+    bool pollLine();
+    const char *getReceivedLine() const;
+    uint8_t getFieldCount() const;
+    long getFieldInt(uint8_t index, long fallback = 0) const;
+    float getFieldFloat(uint8_t index, float fallback = 0) const;
+    size_t getFieldString(uint8_t index, char *out, size_t size) const;
+    bool fieldEquals(uint8_t index, const char *text) const;
+
+    // the same splitting and conversion for lines held elsewhere, e.g. a String's c_str()
+    static uint8_t split(const char *line, size_t length, char separator, Field *fields, uint8_t maxFields);
+    static long toLong(const char *text, size_t length, long fallback = 0);
+    static float toFloat(const char *text, size_t length, float fallback = 0);
+
     bool find(const char *target, size_t length = 0);
     bool waitForData(unsigned long timeout = 1000);
 
@@ -0,0 +1,161 @@
+#ifndef KINEMATRIX_NEMA_SCHEMA
+#define KINEMATRIX_NEMA_SCHEMA
+
+#include "Arduino.h"
+#include <stddef.h>
+#include <string.h>
+
+/*
+Fixed layout messages for NemaSerial. A message is described once as a field list and the macro
+generates a Writer that encodes straight into the transmit buffer and a View that decodes straight
+out of the receive buffer, without String, JsonDocument or per field type tags.
+
+    #define TELEMETRY_FIELDS(FIELD) \
+        FIELD(uint32_t, uptime)     \
+        FIELD(int16_t, temperature) \
+        FIELD(float, voltage)
+
+    NEMA_SCHEMA(Telemetry, 0x01, 1, TELEMETRY_FIELDS)
+
+Wire layout, little endian:
+
+    [schema id][version][field count][presence bits, 1 per field][fields in declared order]
+
+Fields are scalars. A schema evolves by appending fields, never by reordering or retyping them;
+the field count on the wire lets an older receiver skip fields it does not know and a newer one
+report fields the sender did not have as absent. The version byte is for changes that break that
+rule, the receiver decides what to do with it. A field that was never set is sent as absent.
+*/
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "nema schema fields are laid out little endian");
+#endif
+
+#define NEMA_SCHEMA_HEADER_SIZE     3
+
+class NemaSchemaView {
+public:
+    // schema id of a received payload, -1 when it is too short to carry a header
+    static int16_t idOf(const uint8_t *data, uint16_t length) {
+        if (data == NULL || length < NEMA_SCHEMA_HEADER_SIZE) return -1;
+        return data[0];
+    }
+
+    bool valid() const { return _fields != NULL; }
+    uint8_t version() const { return _version; }
+    uint8_t fieldCount() const { return _count; }
+
+protected:
+    NemaSchemaView(const uint8_t *data, uint16_t length, uint8_t id)
+            : _presence(NULL),
+              _fields(NULL),
+              _fieldsLength(0),
+              _version(0),
+              _count(0) {
+        if (data == NULL || length < NEMA_SCHEMA_HEADER_SIZE || data[0] != id) return;
+
+        // the presence block follows the sender's field count, not ours
+        uint8_t presenceSize = (data[2] + 7) / 8;
+        if (length < NEMA_SCHEMA_HEADER_SIZE + presenceSize) return;
+
+        _version = data[1];
+        _count = data[2];
+        _presence = data + NEMA_SCHEMA_HEADER_SIZE;
+        _fields = _presence + presenceSize;
+        _fieldsLength = length - NEMA_SCHEMA_HEADER_SIZE - presenceSize;
+    }
+
+    bool has(uint8_t index, uint16_t offset, uint8_t size) const {
+        if (_fields == NULL || index >= _count) return false;
+        if (!(_presence[index >> 3] & (1 << (index & 7)))) return false;
+        return offset + size <= _fieldsLength;
+    }
+
+    bool read(uint8_t index, uint16_t offset, void *value, uint8_t size) const {
+        if (!has(index, offset, size)) return false;
+        // fields are packed, copy out instead of dereferencing at an odd address
+        memcpy(value, _fields + offset, size);
+        return true;
+    }
+
+private:
+    const uint8_t *_presence;
+    const uint8_t *_fields;
+    uint16_t _fieldsLength;
+    uint8_t _version;
+    uint8_t _count;
+};
+
+class NemaSchemaWriter {
+public:
+    bool valid() const { return _buffer != NULL; }
+
+protected:
+    NemaSchemaWriter(uint8_t *buffer, uint8_t id, uint8_t version, uint8_t count, uint16_t size)
+            : _buffer(buffer),
+              _fields(NULL) {
+        if (_buffer == NULL) return;
+
+        uint8_t presenceSize = (count + 7) / 8;
+        _buffer[0] = id;
+        _buffer[1] = version;
+        _buffer[2] = count;
+        memset(_buffer + NEMA_SCHEMA_HEADER_SIZE, 0, presenceSize + size);
+        _fields = _buffer + NEMA_SCHEMA_HEADER_SIZE + presenceSize;
+    }
+
+    void set(uint8_t index, uint16_t offset, const void *value, uint8_t size) {
+        if (_buffer == NULL) return;
+        _buffer[NEMA_SCHEMA_HEADER_SIZE + (index >> 3)] |= 1 << (index & 7);
+        memcpy(_fields + offset, value, size);
+    }
+
+private:
+    uint8_t *_buffer;
+    uint8_t *_fields;
+};
+
+#define NEMA_SCHEMA_ENUM(type, name) FIELD_##name,
+#define NEMA_SCHEMA_MEMBER(type, name) type name;
+
+#define NEMA_SCHEMA_GETTER(type, name)                                                  \
+    bool has_##name() const {                                                           \
+        return has(FIELD_##name, offsetof(Fields, name), sizeof(type));                 \
+    }                                                                                   \
+    type name(type fallback = type()) const {                                           \
+        type value = fallback;                                                          \
+        read(FIELD_##name, offsetof(Fields, name), &value, sizeof(type));               \
+        return value;                                                                   \
+    }
+
+#define NEMA_SCHEMA_SETTER(type, name)                                                  \
+    Writer &name(type value) {                                                          \
+        set(FIELD_##name, offsetof(Fields, name), &value, sizeof(type));                \
+        return *this;                                                                   \
+    }
+
+// field names must not clash with valid(), version() or fieldCount()
+#define NEMA_SCHEMA(Name, schemaId, schemaVersion, FIELDS)                              \
+    struct Name {                                                                       \
+        enum { ID = schemaId, VERSION = schemaVersion };                                \
+        enum Field { FIELDS(NEMA_SCHEMA_ENUM) FIELD_COUNT };                            \
+        struct __attribute__((packed)) Fields { FIELDS(NEMA_SCHEMA_MEMBER) };           \
+        enum {                                                                          \
+            HEADER_SIZE = NEMA_SCHEMA_HEADER_SIZE + (FIELD_COUNT + 7) / 8,              \
+            SIZE = HEADER_SIZE + sizeof(Fields)                                         \
+        };                                                                              \
+        class View : public NemaSchemaView {                                            \
+        public:                                                                         \
+            View(const uint8_t *data, uint16_t length)                                  \
+                    : NemaSchemaView(data, length, ID) {}                               \
+            FIELDS(NEMA_SCHEMA_GETTER)                                                  \
+        };                                                                              \
+        class Writer : public NemaSchemaWriter {                                        \
+        public:                                                                         \
+            explicit Writer(uint8_t *buffer)                                            \
+                    : NemaSchemaWriter(buffer, ID, VERSION, FIELD_COUNT, sizeof(Fields)) {} \
+            FIELDS(NEMA_SCHEMA_SETTER)                                                  \
+        };                                                                              \
+    };
+
+#endif
@@ -5,13 +5,10 @@ NemaSerial::NemaSerial() :
         _sequenceNumber(0),
         _receiveBuffer(NULL),
         _receiveBufferSize(0),
-        _receiveBufferIndex(0),
         _transmitBuffer(NULL),
         _transmitBufferSize(0),
         _transmitBufferIndex(0),
         _transmitBufferCapacity(0),
-        _escape(false),
-        _inPacket(false),
         _timeout(1000),
         _maxRetries(3),
         _requireAck(true),
@@ -55,7 +52,7 @@ bool NemaSerial::begin(Stream *serialPort, uint16_t receiveBufferSize) {
     }
 
     _receiveBufferSize = receiveBufferSize;
-    resetReceiveBuffer();
+    _parser.begin(_receiveBuffer, _receiveBufferSize);
     return true;
 }
 
@@ -94,9 +91,8 @@ bool NemaSerial::resizeReceiveBuffer(uint16_t newSize) {
     _receiveBuffer = newBuffer;
     _receiveBufferSize = newSize;
 
-    if (_receiveBufferIndex >= _receiveBufferSize) {
-        resetReceiveBuffer();
-    }
+    // a packet in progress carries on in the moved buffer unless it no longer fits
+    _parser.setBuffer(_receiveBuffer, _receiveBufferSize);
 
     return true;
 }
@@ -148,27 +144,11 @@ uint16_t NemaSerial::getTransmitBufferSize() const {
 }
 
 uint16_t NemaSerial::calculateCRC(uint8_t *buffer, uint16_t length) {
-    uint16_t crc = 0xFFFF;
-
-    for (uint16_t i = 0; i < length; i++) {
-        crc ^= buffer[i] << 8;
-
-        for (uint8_t j = 0; j < 8; j++) {
-            if (crc & 0x8000) {
-                crc = (crc << 1) ^ 0x1021;
-            } else {
-                crc = crc << 1;
-            }
-        }
-    }
-
-    return crc;
+    return FrameCrc::crc16Ccitt(buffer, length);
 }
 
 void NemaSerial::resetReceiveBuffer() {
-    _receiveBufferIndex = 0;
-    _escape = false;
-    _inPacket = false;
+    _parser.reset();
 }
 
 void NemaSerial::debugPrint(uint8_t level, const char *message) {
@@ -196,93 +176,65 @@ bool NemaSerial::processIncomingByte(uint8_t inByte) {
         return false;
     }
 
-    if (inByte == PKT_START_MARKER && !_inPacket) {
-        resetReceiveBuffer();
-        _inPacket = true;
-        _receiveBuffer[_receiveBufferIndex++] = inByte;
-        return false;
-    }
-
-    if (!_inPacket) {
-        return false;
-    }
-
-    if (inByte == PKT_ESCAPE_CHAR && !_escape) {
-        _escape = true;
-        return false;
-    }
-
-    if (_escape) {
-        inByte ^= PKT_XOR_CHAR;
-        _escape = false;
-    }
-
-    if (inByte == PKT_END_MARKER && !_escape) {
-        if (_receiveBufferIndex >= _receiveBufferSize) {
-            if (!resizeReceiveBuffer(_receiveBufferIndex + 1)) {
-                resetReceiveBuffer();
-                return false;
-            }
-        }
-
-        _receiveBuffer[_receiveBufferIndex++] = inByte;
-
-        if (_receiveBufferIndex < 6) {
-            debugPrint(DEBUG_ERRORS, "Packet too short");
-            _lastError = ERR_LENGTH;
+    // the buffer grows before a byte would not fit, so a long packet is never cut short
+    if (_parser.inFrame() && _parser.received() >= _receiveBufferSize) {
+        uint16_t newSize = _receiveBufferSize + DEFAULT_CHUNK_SIZE;
+        if (!resizeReceiveBuffer(newSize)) {
+            debugPrint(DEBUG_ERRORS, "Buffer overflow - resize failed");
+            _lastError = ERR_BUFFER_OVERFLOW;
             _packetErrors++;
             if (_errorHandlerCallback) {
-                _errorHandlerCallback(ERR_LENGTH);
+                _errorHandlerCallback(ERR_BUFFER_OVERFLOW);
             }
+            resetReceiveBuffer();
             return false;
         }
+    }
 
-        uint8_t dataLength = _receiveBuffer[2];
+    if (_parser.push(inByte) != FRAME_READY) {
+        return false;
+    }
 
-        if (_receiveBufferIndex != dataLength + PKT_HEADER_SIZE + 3) {
-            debugPrint(DEBUG_ERRORS, "Length mismatch");
-            _lastError = ERR_LENGTH;
-            _packetErrors++;
-            if (_errorHandlerCallback) {
-                _errorHandlerCallback(ERR_LENGTH);
-            }
-            return false;
+    // the parser leaves command, length, data and CRC, markers and escapes removed
+    uint16_t packetLength = _parser.length();
+
+    if (packetLength < 4) {
+        debugPrint(DEBUG_ERRORS, "Packet too short");
+        _lastError = ERR_LENGTH;
+        _packetErrors++;
+        if (_errorHandlerCallback) {
+            _errorHandlerCallback(ERR_LENGTH);
         }
+        return false;
+    }
 
-        uint16_t calculatedCRC = calculateCRC(_receiveBuffer + 1, dataLength + PKT_HEADER_SIZE - 1);
-        uint16_t receivedCRC = (_receiveBuffer[_receiveBufferIndex - 3] << 8) | _receiveBuffer[_receiveBufferIndex - 2];
+    uint8_t dataLength = _receiveBuffer[1];
 
-        if (calculatedCRC != receivedCRC) {
-            debugPrint(DEBUG_ERRORS, "CRC error");
-            _lastError = ERR_CRC;
-            _packetErrors++;
-            if (_errorHandlerCallback) {
-                _errorHandlerCallback(ERR_CRC);
-            }
-            return false;
+    if (packetLength != dataLength + PKT_HEADER_SIZE + 1) {
+        debugPrint(DEBUG_ERRORS, "Length mismatch");
+        _lastError = ERR_LENGTH;
+        _packetErrors++;
+        if (_errorHandlerCallback) {
+            _errorHandlerCallback(ERR_LENGTH);
         }
-
-        _packetsReceived++;
-        _inPacket = false;
-        return true;
+        return false;
     }
 
-    if (_receiveBufferIndex >= _receiveBufferSize) {
-        uint16_t newSize = _receiveBufferSize + DEFAULT_CHUNK_SIZE;
-        if (!resizeReceiveBuffer(newSize)) {
-            debugPrint(DEBUG_ERRORS, "Buffer overflow - resize failed");
-            _lastError = ERR_BUFFER_OVERFLOW;
-            _packetErrors++;
-            if (_errorHandlerCallback) {
-                _errorHandlerCallback(ERR_BUFFER_OVERFLOW);
-            }
-            resetReceiveBuffer();
-            return false;
+    uint16_t calculatedCRC = calculateCRC(_receiveBuffer, dataLength + PKT_HEADER_SIZE - 1);
+    uint16_t receivedCRC = (_receiveBuffer[packetLength - 2] << 8) | _receiveBuffer[packetLength - 1];
+
+    if (calculatedCRC != receivedCRC) {
+        debugPrint(DEBUG_ERRORS, "CRC error");
+        _lastError = ERR_CRC;
+        _packetErrors++;
+        if (_errorHandlerCallback) {
+            _errorHandlerCallback(ERR_CRC);
         }
+        return false;
     }
 
-    _receiveBuffer[_receiveBufferIndex++] = inByte;
-    return false;
+    _packetsReceived++;
+    return true;
 }
 
 bool NemaSerial::addToTransmitBuffer(uint8_t *data, uint16_t length) {
@@ -409,53 +361,24 @@ const char *NemaSerial::getErrorString(uint8_t errorCode) const {
 bool NemaSerial::sendPacket(uint8_t command, uint8_t *data, uint16_t length) {
     if (!_serial) return false;
 
-    uint16_t packetSize = 1 + 1 + 1 + length + 2 + 1;
-    uint8_t *packet = (uint8_t *) malloc(packetSize);
-
-    if (packet == NULL) {
-        _lastError = ERR_MEMORY;
-        if (_errorHandlerCallback) {
-            _errorHandlerCallback(ERR_MEMORY);
-        }
-        return false;
-    }
-
-    uint16_t packetIndex = 0;
-
-    packet[packetIndex++] = PKT_START_MARKER;
-    packet[packetIndex++] = command;
-    packet[packetIndex++] = length;
-
-    for (uint16_t i = 0; i < length; i++) {
-        packet[packetIndex++] = data[i];
-    }
-
-    uint16_t crc = calculateCRC(packet + 1, packetIndex - 1);
-    packet[packetIndex++] = (crc >> 8) & 0xFF;
-    packet[packetIndex++] = crc & 0xFF;
-
-    packet[packetIndex++] = PKT_END_MARKER;
+    // header, data and CRC are stuffed straight onto the stream, no packet copy is assembled
+    uint8_t header[PKT_HEADER_SIZE - 1] = {command, (uint8_t) length};
+    uint16_t crc = FrameCrc::crc16Ccitt(header, sizeof(header));
+    crc = FrameCrc::crc16Ccitt(data, length, crc);
+    uint8_t trailer[2] = {(uint8_t) ((crc >> 8) & 0xFF), (uint8_t) (crc & 0xFF)};
 
     if (_debugLevel >= DEBUG_INFO) {
         debugPrint(DEBUG_INFO, "Sending packet:");
-        debugPrintHex(DEBUG_INFO, packet, packetIndex);
+        debugPrintHex(DEBUG_INFO, header, sizeof(header));
+        debugPrintHex(DEBUG_INFO, data, length);
+        debugPrintHex(DEBUG_INFO, trailer, sizeof(trailer));
     }
 
     _serial->write(PKT_START_MARKER);
-
-    for (uint16_t i = 1; i < packetIndex - 1; i++) {
-        uint8_t b = packet[i];
-
-        if (b == PKT_START_MARKER || b == PKT_END_MARKER || b == PKT_ESCAPE_CHAR) {
-            _serial->write(PKT_ESCAPE_CHAR);
-            _serial->write(b ^ PKT_XOR_CHAR);
-        } else {
-            _serial->write(b);
-        }
-    }
-
+    FrameEscape::writeBody(_serial, header, sizeof(header));
+    FrameEscape::writeBody(_serial, data, length);
+    FrameEscape::writeBody(_serial, trailer, sizeof(trailer));
     _serial->write(PKT_END_MARKER);
-    free(packet);
 
     _packetsSent++;
     _sequenceNumber = (_sequenceNumber + 1) & 0xFF;
@@ -524,9 +447,9 @@ bool NemaSerial::receivePacket(uint8_t *command, uint8_t *data, uint16_t *length
             }
 
             if (processIncomingByte(inByte)) {
-                *command = _receiveBuffer[1];
+                *command = _receiveBuffer[0];
 
-                uint8_t dataLength = _receiveBuffer[2];
+                uint8_t dataLength = _receiveBuffer[1];
 
                 if (*length < dataLength) {
                     *length = dataLength;
@@ -540,11 +463,11 @@ bool NemaSerial::receivePacket(uint8_t *command, uint8_t *data, uint16_t *length
                 *length = dataLength;
 
                 if (dataLength > 0 && data != NULL) {
-                    memcpy(data, _receiveBuffer + 3, dataLength);
+                    memcpy(data, _receiveBuffer + 2, dataLength);
                 }
 
                 if (_requireAck) {
-                    sendAck(_receiveBuffer[3]);
+                    sendAck(_receiveBuffer[2]);
                 }
 
                 if (*command == CMD_JSON_DATA && _jsonHandlerCallback) {
@@ -586,37 +509,25 @@ void NemaSerial::processIncoming() {
         }
 
         if (processIncomingByte(inByte)) {
-            uint8_t command = _receiveBuffer[1];
-            uint8_t dataLength = _receiveBuffer[2];
-
-            uint8_t *tempData = (uint8_t *) malloc(dataLength);
-
-            if (tempData == NULL) {
-                _lastError = ERR_MEMORY;
-                if (_errorHandlerCallback) {
-                    _errorHandlerCallback(ERR_MEMORY);
-                }
-                continue;
-            }
-
-            memcpy(tempData, _receiveBuffer + 3, dataLength);
+            uint8_t command = _receiveBuffer[0];
+            uint8_t dataLength = _receiveBuffer[1];
+            // handed out in place, nothing is read into the buffer until the handlers return
+            uint8_t *data = _receiveBuffer + 2;
 
             if (_requireAck) {
-                sendAck(_receiveBuffer[3]);
+                sendAck(_receiveBuffer[2]);
             }
 
             if (command == CMD_JSON_DATA && _jsonHandlerCallback) {
                 JsonDocument doc;
-                if (parseJson(tempData, dataLength, doc)) {
+                if (parseJson(data, dataLength, doc)) {
                     _jsonHandlerCallback(doc);
                 }
             }
 
             if (_packetHandlerCallback) {
-                _packetHandlerCallback(command, tempData, dataLength);
+                _packetHandlerCallback(command, data, dataLength);
             }
-
-            free(tempData);
         }
     }
 }
@@ -667,12 +578,7 @@ bool NemaSerial::writeRegister(uint16_t reg, uint8_t value) {
 }
 
 NemaSerial &NemaSerial::beginPacket() {
-    if (_transmitBuffer != NULL) {
-        free(_transmitBuffer);
-        _transmitBuffer = NULL;
-        _transmitBufferCapacity = 0;
-    }
-
+    // the buffer is kept between packets, a steady message rate does not touch the heap
     _transmitBufferSize = 0;
     _transmitBufferIndex = 0;
 
@@ -831,13 +737,7 @@ bool NemaSerial::endPacket(uint8_t command) {
     }
 
     bool result = sendPacket(command, _transmitBuffer, _transmitBufferSize);
-
-    if (_transmitBuffer != NULL) {
-        free(_transmitBuffer);
-        _transmitBuffer = NULL;
-        _transmitBufferCapacity = 0;
-        _transmitBufferSize = 0;
-    }
+    _transmitBufferSize = 0;
 
     return result;
 }
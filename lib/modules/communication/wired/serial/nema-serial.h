@@ -3,11 +3,13 @@
 
 #include "Arduino.h"
 #include "ArduinoJson.h"
+#include "../../codec/frame-codec.h"
+#include "nema-schema.h"
 
-#define PKT_START_MARKER      0x7E
-#define PKT_END_MARKER        0x7F
-#define PKT_ESCAPE_CHAR       0x7D
-#define PKT_XOR_CHAR          0x20
+#define PKT_START_MARKER      FRAME_STX
+#define PKT_END_MARKER        FRAME_ETX
+#define PKT_ESCAPE_CHAR       FRAME_ESC
+#define PKT_XOR_CHAR          FRAME_XOR
 
 #define CMD_ACK               0x06
 #define CMD_NAK               0x15
@@ -63,6 +65,7 @@
 #define DEBUG_INFO            2
 #define DEBUG_VERBOSE         3
 
+// data points into the receive buffer, it is valid until the handler returns or waits for an ACK
 typedef void (*PacketHandlerFunction)(uint8_t command, uint8_t *data, uint16_t length);
 typedef void (*ErrorHandlerFunction)(uint8_t errorCode);
 typedef void (*JsonHandlerFunction)(JsonDocument &jsonDoc);
@@ -74,16 +77,13 @@ private:
 
     uint8_t *_receiveBuffer;
     uint16_t _receiveBufferSize;
-    uint16_t _receiveBufferIndex;
+    FrameParser _parser;
 
     uint8_t *_transmitBuffer;
     uint16_t _transmitBufferSize;
     uint16_t _transmitBufferIndex;
     uint16_t _transmitBufferCapacity;
 
-    bool _escape;
-    bool _inPacket;
-
     unsigned long _timeout;
     uint8_t _maxRetries;
     bool _requireAck;
@@ -168,6 +168,18 @@ public:
     NemaSerial &writeBool(bool value);
     bool endPacket(uint8_t command);
 
+    // fixed layout message from nema-schema.h, encoded in place and sent with endPacket()
+    template<typename T>
+    typename T::Writer beginMessage() {
+        static_assert(T::SIZE <= 0xFF, "schema does not fit in one packet");
+        beginPacket();
+        if (!resizeTransmitBuffer(T::SIZE)) {
+            return typename T::Writer(NULL);
+        }
+        _transmitBufferSize = T::SIZE;
+        return typename T::Writer(_transmitBuffer);
+    }
+
     bool sendJson(JsonDocument &doc, uint8_t command = CMD_JSON_DATA);
     bool parseJson(uint8_t *data, uint16_t length, JsonDocument &doc);
 
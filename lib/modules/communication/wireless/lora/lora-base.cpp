@@ -3,6 +3,10 @@
 
 #include "lora-base.h"
 
+#ifdef KINEMATRIX_LORA_SIM
+#include "lora-sim.cpp"
+#else
+
 // registers
 #define REG_FIFO                 0x00
 #define REG_OP_MODE              0x01
@@ -798,3 +802,5 @@ ISR_PREFIX void LoRaClass::onDio0Rise()
 }
 
 LoRaClass LoRa;
+
+#endif // KINEMATRIX_LORA_SIM
@@ -4,6 +4,11 @@
 #ifndef LORA_BASE_H // changed
 #define LORA_BASE_H // changed
 
+#ifdef KINEMATRIX_LORA_SIM
+// host builds: the same LoRaClass on top of the simulated radios of lora-sim
+#include "lora-sim.h"
+#else
+
 #include <Arduino.h>
 #include <SPI.h>
 
@@ -133,4 +138,6 @@ private:
 
 extern LoRaClass LoRa;
 
+#endif // KINEMATRIX_LORA_SIM
+
 #endif
@@ -19,8 +19,15 @@ LoRaComV2::LoRaComV2() {
 
     txBufferLen = 0;
     rxBufferLen = 0;
+    rxOversize = 0;
 
     knownNodeCount = 0;
+
+    txQueueCount = 0;
+    codingRate = 5;
+    for (uint8_t i = 0; i < LORA_TX_QUEUE_SIZE; i++) {
+        txQueue[i].used = false;
+    }
 }
 
 LoRaComV2::~LoRaComV2() {
@@ -148,6 +155,13 @@ void LoRaComV2::setPreambleLength(uint16_t length) {
     LoRa.setPreambleLength(length);
 }
 
+void LoRaComV2::setCodingRate(uint8_t denominator) {
+    if (!isLoRaReady) return;
+
+    codingRate = denominator;
+    LoRa.setCodingRate4(denominator);
+}
+
 void LoRaComV2::enableCRC() {
     if (!isLoRaReady) return;
     LoRa.enableCrc();
@@ -207,8 +221,7 @@ bool LoRaComV2::sendData() {
 
     LoRa.beginPacket();
     LoRa.print(dataSend);
-    int result = LoRa.endPacket();
-    lastActivity = millis();
+    int result = finishPacket(dataSend.length());
 
     return result == 1;
 }
@@ -222,8 +235,7 @@ bool LoRaComV2::sendDataCb(void (*onSend)(const String &)) {
 
     LoRa.beginPacket();
     LoRa.print(dataSend);
-    int result = LoRa.endPacket();
-    lastActivity = millis();
+    int result = finishPacket(dataSend.length());
 
     if (onSend != nullptr) {
         onSend(dataSend);
@@ -241,8 +253,7 @@ bool LoRaComV2::sendDataWithAck(unsigned long timeout, int maxRetries) {
     while (retries < maxRetries && !ackReceived) {
         LoRa.beginPacket();
         LoRa.print(dataSend);
-        LoRa.endPacket();
-        lastActivity = millis();
+        finishPacket(dataSend.length());
 
         unsigned long startTime = millis();
         while (millis() - startTime < timeout && !ackReceived) {
@@ -280,8 +291,7 @@ String LoRaComV2::sendDataAndWaitResponse(unsigned long timeout, int maxRetries)
     while (retries < maxRetries && !responseReceived) {
         LoRa.beginPacket();
         LoRa.print(dataSend);
-        LoRa.endPacket();
-        lastActivity = millis();
+        finishPacket(dataSend.length());
 
         if (operationMode == MODE_HALF_DUPLEX) {
             switchToReceive();
@@ -321,8 +331,7 @@ void LoRaComV2::sendDataAsync(uint32_t interval) {
         sendTime = millis();
         LoRa.beginPacket();
         LoRa.print(dataSend);
-        LoRa.endPacket();
-        lastActivity = millis();
+        finishPacket(dataSend.length());
     }
 }
 
@@ -337,8 +346,7 @@ void LoRaComV2::sendDataAsyncCb(uint32_t interval, void (*onSend)(const String &
         sendTime = millis();
         LoRa.beginPacket();
         LoRa.print(dataSend);
-        LoRa.endPacket();
-        lastActivity = millis();
+        finishPacket(dataSend.length());
 
         if (onSend != nullptr) {
             onSend(dataSend);
@@ -357,8 +365,7 @@ void LoRaComV2::sendBytes(const uint8_t *buffer, size_t size) {
     for (size_t i = 0; i < size; i++) {
         LoRa.write(buffer[i]);
     }
-    LoRa.endPacket();
-    lastActivity = millis();
+    finishPacket(size);
 }
 
 void LoRaComV2::sendByte(uint8_t byte) {
@@ -370,8 +377,7 @@ void LoRaComV2::sendByte(uint8_t byte) {
 
     LoRa.beginPacket();
     LoRa.write(byte);
-    LoRa.endPacket();
-    lastActivity = millis();
+    finishPacket(1);
 }
 
 bool LoRaComV2::sendMessage(LoRaMessage *msg) {
@@ -406,14 +412,20 @@ bool LoRaComV2::sendMessage(LoRaMessage *msg) {
         LoRa.write(msg->payload[i]);
     }
 
-    int result = LoRa.endPacket();
-    lastActivity = millis();
+    int result = finishPacket(10 + msg->payloadLen);
     lastMsgId = msg->msgId;
 
+    // our own flood must not be relayed back to us
+    dedupCache.check(msg->sourceId, msg->msgId, millis());
+
     return result == 1;
 }
 
 bool LoRaComV2::sendMessageToNode(uint16_t nodeId, const char *data, uint8_t msgType) {
+    return sendTextMessage(nodeId, data, msgType, 1);
+}
+
+bool LoRaComV2::sendTextMessage(uint16_t nodeId, const char *data, uint8_t msgType, uint8_t ttl) {
     if (!isLoRaReady || data == nullptr) return false;
 
     LoRaMessage msg;
@@ -421,7 +433,7 @@ bool LoRaComV2::sendMessageToNode(uint16_t nodeId, const char *data, uint8_t msg
     msg.sourceId = config.nodeId;
     msg.destId = nodeId;
     msg.msgId = generateMessageId();
-    msg.ttl = 1;
+    msg.ttl = ttl;
 
     size_t dataLen = strlen(data);
     if (dataLen > sizeof(msg.payload) - 1) {
@@ -437,7 +449,7 @@ bool LoRaComV2::sendMessageToNode(uint16_t nodeId, const char *data, uint8_t msg
 bool LoRaComV2::broadcastMessage(const char *data, uint8_t ttl) {
     if (!isLoRaReady || data == nullptr) return false;
 
-    return sendMessageToNode(0xFFFF, data, MSG_BROADCAST);
+    return sendTextMessage(LORA_BROADCAST_ID, data, MSG_BROADCAST, ttl);
 }
 
 bool LoRaComV2::relayMessage(LoRaMessage *msg) {
@@ -522,6 +534,12 @@ bool LoRaComV2::receiveMessage(LoRaMessage *msg) {
     }
 
     msg->msgType = LoRa.read();
+    if (msg->msgType & LORA_PACKET_MARKER) {
+        // a binary packet, see receivePacket()
+        while (LoRa.available()) LoRa.read();
+        return false;
+    }
+
     msg->sourceId = (LoRa.read() << 8) | LoRa.read();
     msg->destId = (LoRa.read() << 8) | LoRa.read();
     msg->msgId = (LoRa.read() << 8) | LoRa.read();
@@ -539,6 +557,10 @@ bool LoRaComV2::receiveMessage(LoRaMessage *msg) {
 
     lastActivity = millis();
 
+    if (operationMode == MODE_MESH && dedupCache.check(msg->sourceId, msg->msgId, millis())) {
+        return false;
+    }
+
     refreshNodeList(msg->sourceId);
 
     return true;
@@ -547,6 +569,199 @@ bool LoRaComV2::receiveMessage(LoRaMessage *msg) {
 void LoRaComV2::onReceiveCallback(void (*callback)(LoRaMessage *)) {
 }
 
+LoRaPacketWriter LoRaComV2::beginPacket(uint16_t destId, uint8_t msgType) {
+    txBuffer[0] = LORA_PACKET_MARKER | (msgType & 0x0F);
+    txBuffer[1] = config.nodeId >> 8;
+    txBuffer[2] = config.nodeId & 0xFF;
+    txBuffer[3] = destId >> 8;
+    txBuffer[4] = destId & 0xFF;
+    txBufferLen = LORA_PACKET_HEADER_SIZE;
+
+    return LoRaPacketWriter(txBuffer + LORA_PACKET_HEADER_SIZE, sizeof(txBuffer) - LORA_PACKET_HEADER_SIZE);
+}
+
+bool LoRaComV2::queuePacket(const LoRaPacketWriter &writer, uint8_t priority, uint8_t ttl) {
+    if (!writer.ok() || txBufferLen != LORA_PACKET_HEADER_SIZE) return false;
+
+    uint16_t msgId = generateMessageId();
+    txBuffer[5] = msgId >> 8;
+    txBuffer[6] = msgId & 0xFF;
+    txBuffer[7] = ttl;
+
+    if (!enqueue(txBuffer, LORA_PACKET_HEADER_SIZE + writer.size(), priority)) return false;
+
+    txBufferLen = 0;
+    dedupCache.check(config.nodeId, msgId, millis());
+    return true;
+}
+
+bool LoRaComV2::enqueue(const uint8_t *data, uint8_t length, uint8_t priority) {
+    int8_t slot = -1;
+    for (uint8_t i = 0; i < LORA_TX_QUEUE_SIZE; i++) {
+        if (!txQueue[i].used) {
+            slot = i;
+            break;
+        }
+    }
+
+    if (slot < 0) {
+        // full: the newest of the least important packets makes room, if it is below this one
+        for (uint8_t i = 0; i < LORA_TX_QUEUE_SIZE; i++) {
+            if (txQueue[i].priority >= priority) continue;
+            if (slot < 0 || txQueue[i].priority < txQueue[slot].priority ||
+                (txQueue[i].priority == txQueue[slot].priority &&
+                 (int32_t) (txQueue[i].queuedAt - txQueue[slot].queuedAt) > 0)) {
+                slot = i;
+            }
+        }
+        if (slot < 0) return false;
+        txQueueCount--;
+    }
+
+    TxSlot &entry = txQueue[slot];
+    memcpy(entry.data, data, length);
+    entry.length = length;
+    entry.priority = priority;
+    entry.queuedAt = millis();
+    entry.used = true;
+    txQueueCount++;
+    return true;
+}
+
+bool LoRaComV2::processQueue() {
+    if (!isLoRaReady || txQueueCount == 0) return false;
+
+    if (operationMode == MODE_HALF_DUPLEX && !inTransmitState) {
+        return false;
+    }
+
+    // highest priority first, oldest first within a priority
+    int8_t next = -1;
+    for (uint8_t i = 0; i < LORA_TX_QUEUE_SIZE; i++) {
+        if (!txQueue[i].used) continue;
+        if (next < 0 || txQueue[i].priority > txQueue[next].priority ||
+            (txQueue[i].priority == txQueue[next].priority &&
+             (int32_t) (txQueue[i].queuedAt - txQueue[next].queuedAt) < 0)) {
+            next = i;
+        }
+    }
+
+    TxSlot &entry = txQueue[next];
+    uint32_t airtime = getAirtime(entry.length);
+    if (!dutyCycle.fitsDwell(airtime)) {
+        // never allowed on air at this SF/BW, waiting would block the queue for good
+        entry.used = false;
+        txQueueCount--;
+        return false;
+    }
+    if (dutyCycle.waitTime(millis()) > 0) return false;
+
+    LoRa.beginPacket();
+    LoRa.write(entry.data, entry.length);
+    int result = finishPacket(entry.length);
+
+    entry.used = false;
+    txQueueCount--;
+    return result == 1;
+}
+
+bool LoRaComV2::receivePacket(LoRaPacket *packet) {
+    if (!isLoRaReady || packet == nullptr) return false;
+
+    if (operationMode == MODE_HALF_DUPLEX && inTransmitState) {
+        return false;
+    }
+
+    int packetSize = LoRa.parsePacket();
+    if (packetSize <= 0) return false;
+
+    rxBufferLen = 0;
+    while (LoRa.available()) {
+        uint8_t b = LoRa.read();
+        if (rxBufferLen < sizeof(rxBuffer)) rxBuffer[rxBufferLen++] = b;
+    }
+    lastActivity = millis();
+
+    if (rxBufferLen < LORA_PACKET_HEADER_SIZE || !(rxBuffer[0] & LORA_PACKET_MARKER)) {
+        return false;
+    }
+    if (packetSize > (int) sizeof(rxBuffer)) {
+        // from a node built with a larger LORA_PACKET_MAX_SIZE, a cut packet would be misread
+        rxOversize++;
+        return false;
+    }
+
+    packet->msgType = rxBuffer[0] & 0x0F;
+    packet->sourceId = (rxBuffer[1] << 8) | rxBuffer[2];
+    packet->destId = (rxBuffer[3] << 8) | rxBuffer[4];
+    packet->msgId = (rxBuffer[5] << 8) | rxBuffer[6];
+    packet->ttl = rxBuffer[7];
+    packet->payload = rxBuffer + LORA_PACKET_HEADER_SIZE;
+    packet->payloadLen = rxBufferLen - LORA_PACKET_HEADER_SIZE;
+
+    if (packet->sourceId == config.nodeId) return false;
+
+    if (operationMode != MODE_MESH) {
+        refreshNodeList(packet->sourceId);
+        return true;
+    }
+
+    if (dedupCache.check(packet->sourceId, packet->msgId, millis())) {
+        return false;
+    }
+    refreshNodeList(packet->sourceId);
+
+    if (packet->destId != config.nodeId && packet->ttl > 1) {
+        rxBuffer[7] = packet->ttl - 1;
+        enqueue(rxBuffer, rxBufferLen, LORA_PRIORITY_RELAY);
+    }
+
+    return packet->destId == config.nodeId || packet->destId == LORA_BROADCAST_ID;
+}
+
+uint32_t LoRaComV2::getOversizeCount() {
+    return rxOversize;
+}
+
+uint8_t LoRaComV2::getQueueCount() {
+    return txQueueCount;
+}
+
+void LoRaComV2::clearQueue() {
+    for (uint8_t i = 0; i < LORA_TX_QUEUE_SIZE; i++) {
+        txQueue[i].used = false;
+    }
+    txQueueCount = 0;
+}
+
+void LoRaComV2::setRegion(LoRaRegion region) {
+    dutyCycle.setRegion(region);
+}
+
+void LoRaComV2::setDutyCycle(uint16_t permille, uint32_t maxDwellMs) {
+    dutyCycle.setLimit(permille, maxDwellMs);
+}
+
+uint32_t LoRaComV2::getAirtime(uint8_t length) {
+    return LoRaAirtime::timeOnAirMs(length, config.spreadFactor, config.bandwidth, codingRate, config.preambleLen);
+}
+
+uint32_t LoRaComV2::getTxWaitTime() {
+    return dutyCycle.waitTime(millis());
+}
+
+uint32_t LoRaComV2::getAirtimeTotal() {
+    return dutyCycle.getAirtimeTotal();
+}
+
+int LoRaComV2::finishPacket(size_t length) {
+    uint32_t startedAt = millis();
+    int result = LoRa.endPacket();
+    dutyCycle.onTransmit(getAirtime(length > 0xFF ? 0xFF : length), startedAt);
+    lastActivity = millis();
+    return result;
+}
+
 void LoRaComV2::runHalfDuplexCycle(void (*onReceive)(const String &), void (*onSend)(const String &)) {
     if (!isLoRaReady || operationMode != MODE_HALF_DUPLEX) return;
 
@@ -592,7 +807,7 @@ void LoRaComV2::enableMeshMode(uint16_t nodeId) {
 bool LoRaComV2::sendToMesh(uint16_t destNodeId, const char *data, uint8_t ttl) {
     if (!isLoRaReady || operationMode != MODE_MESH) return false;
 
-    return sendMessageToNode(destNodeId, data, MSG_DATA);
+    return sendTextMessage(destNodeId, data, MSG_DATA, ttl);
 }
 
 void LoRaComV2::discoverNodes(uint8_t ttl) {
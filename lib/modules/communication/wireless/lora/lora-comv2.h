@@ -6,12 +6,26 @@
 #include "Arduino.h"
 #include "SPI.h"
 #include "lora-base.h"
+#include "lora-packet.h"
 
 #pragma message("[COMPILED]: lora-comv2.h")
 
 #define NONE ""
 #define SEPARATOR ";"
 
+#define LORA_BROADCAST_ID 0xFFFF
+
+// binary packets start with this bit set, which neither text nor LoRaMessage packets do
+#define LORA_PACKET_MARKER 0x80
+#define LORA_PACKET_HEADER_SIZE 8
+
+#ifndef LORA_TX_QUEUE_SIZE
+#define LORA_TX_QUEUE_SIZE LORA_DEFAULT_TX_QUEUE_SIZE
+#endif
+#ifndef LORA_MESSAGE_PAYLOAD_SIZE
+#define LORA_MESSAGE_PAYLOAD_SIZE 240
+#endif
+
 enum LoRaMode {
     MODE_NORMAL,
     MODE_HALF_DUPLEX,
@@ -27,6 +41,13 @@ enum MessageType {
     MSG_PONG
 };
 
+enum LoRaPriority {
+    LORA_PRIORITY_LOW,
+    LORA_PRIORITY_NORMAL,
+    LORA_PRIORITY_RELAY,
+    LORA_PRIORITY_HIGH
+};
+
 typedef struct {
     uint8_t msgType;
     uint16_t sourceId;
@@ -34,9 +55,20 @@ typedef struct {
     uint16_t msgId;
     uint8_t ttl;
     uint16_t payloadLen;
-    char payload[240];
+    char payload[LORA_MESSAGE_PAYLOAD_SIZE];
 } LoRaMessage;
 
+// a received binary packet, payload points into the receiver and is valid until the next receive
+typedef struct {
+    uint8_t msgType;
+    uint16_t sourceId;
+    uint16_t destId;
+    uint16_t msgId;
+    uint8_t ttl;
+    const uint8_t *payload;
+    uint8_t payloadLen;
+} LoRaPacket;
+
 typedef struct {
     uint8_t cs;
     uint8_t rst;
@@ -73,10 +105,25 @@ private:
     uint16_t knownNodes[32];
     uint8_t knownNodeCount;
 
-    uint8_t txBuffer[256];
-    uint8_t rxBuffer[256];
+    uint8_t txBuffer[LORA_PACKET_MAX_SIZE];
+    uint8_t rxBuffer[LORA_PACKET_MAX_SIZE];
     uint16_t txBufferLen;
     uint16_t rxBufferLen;
+    uint32_t rxOversize;
+
+    struct TxSlot {
+        bool used;
+        uint8_t priority;
+        uint8_t length;
+        uint32_t queuedAt;
+        uint8_t data[LORA_PACKET_MAX_SIZE];
+    };
+
+    TxSlot txQueue[LORA_TX_QUEUE_SIZE];
+    uint8_t txQueueCount;
+    uint8_t codingRate;
+    LoRaDutyCycle dutyCycle;
+    LoRaDedupCache dedupCache;
 
     String parseStr(String data, char separator[], int index);
     void switchToReceive();
@@ -86,6 +133,9 @@ private:
     bool isNodeKnown(uint16_t nodeId);
     uint16_t generateMessageId();
     bool validatePacket(const uint8_t *buffer, size_t size);
+    bool sendTextMessage(uint16_t nodeId, const char *data, uint8_t msgType, uint8_t ttl);
+    int finishPacket(size_t length);
+    bool enqueue(const uint8_t *data, uint8_t length, uint8_t priority);
 
 public:
     LoRaComV2();
@@ -101,6 +151,7 @@ public:
     void setNodeId(uint16_t id);
     void configure(uint8_t spreadingFactor, long bandwidth, uint8_t txPower, uint8_t syncWord = 0x12);
     void setPreambleLength(uint16_t length);
+    void setCodingRate(uint8_t denominator);
     void enableCRC();
     void disableCRC();
 
@@ -142,6 +193,24 @@ public:
     bool receiveMessage(LoRaMessage *msg);
     void onReceiveCallback(void (*callback)(LoRaMessage *));
 
+    // binary packets: 8 byte header and varint/fixed point fields instead of ASCII, sent from a
+    // prioritised queue by processQueue() as the duty cycle allows
+    LoRaPacketWriter beginPacket(uint16_t destId = LORA_BROADCAST_ID, uint8_t msgType = MSG_DATA);
+    bool queuePacket(const LoRaPacketWriter &writer, uint8_t priority = LORA_PRIORITY_NORMAL, uint8_t ttl = 1);
+    bool processQueue();
+    bool receivePacket(LoRaPacket *packet);
+    // binary packets longer than LORA_PACKET_MAX_SIZE that receivePacket() dropped
+    uint32_t getOversizeCount();
+    uint8_t getQueueCount();
+    void clearQueue();
+
+    // every transmission is charged, only the queue waits for the band to reopen
+    void setRegion(LoRaRegion region);
+    void setDutyCycle(uint16_t permille, uint32_t maxDwellMs = 0);
+    uint32_t getAirtime(uint8_t length);
+    uint32_t getTxWaitTime();
+    uint32_t getAirtimeTotal();
+
     void runHalfDuplexCycle(void (*onReceive)(const String &) = nullptr, void (*onSend)(const String &) = nullptr);
     bool isInTransmitState();
     void setTxRxInterval(uint32_t interval);
@@ -0,0 +1,370 @@
+#pragma once
+
+#ifndef LORA_PACKET_H
+#define LORA_PACKET_H
+
+#include "Arduino.h"
+
+/*
+Building blocks of the LoRaComV2 binary packet layer. They only touch memory and millis values
+passed in, so they also run off target:
+
+- LoRaPacketWriter / LoRaPacketReader: varint, zigzag, delta and fixed point fields
+- LoRaAirtime: time on air for SF/BW/CR, Semtech AN1200.13
+- LoRaDutyCycle: per transmission off time and dwell limit of a regional plan
+- LoRaDedupCache: recently seen (source, message id) pairs for mesh floods
+
+LORA_PACKET_MAX_SIZE bounds a binary packet, header included: 64 bytes on AVR, 255 elsewhere. A
+writer stops at it and LoRaComV2::receivePacket() rejects and counts longer binary packets, so
+mixed networks with AVR nodes keep their binary packets at 64 bytes or raise the limit. The text
+paths (receive(), receiveMessage()) read the radio directly and are not bounded by it.
+*/
+
+#if defined(ARDUINO_ARCH_AVR)
+#define LORA_DEFAULT_PACKET_SIZE    64
+#define LORA_DEFAULT_TX_QUEUE_SIZE  4
+#define LORA_DEFAULT_DEDUP_SIZE     8
+#else
+#define LORA_DEFAULT_PACKET_SIZE    255
+#define LORA_DEFAULT_TX_QUEUE_SIZE  8
+#define LORA_DEFAULT_DEDUP_SIZE     32
+#endif
+
+#ifndef LORA_PACKET_MAX_SIZE
+#define LORA_PACKET_MAX_SIZE LORA_DEFAULT_PACKET_SIZE
+#endif
+#ifndef LORA_DEDUP_SIZE
+#define LORA_DEDUP_SIZE LORA_DEFAULT_DEDUP_SIZE
+#endif
+// a flood is over long before this, an id seen again later is a new message
+#ifndef LORA_DEDUP_LIFETIME
+#define LORA_DEDUP_LIFETIME 60000UL
+#endif
+
+class LoRaPacketWriter {
+public:
+    LoRaPacketWriter(uint8_t *buffer = nullptr, uint8_t bufferSize = 0)
+            : data(buffer),
+              capacity(bufferSize),
+              length(0),
+              overflow(false) {
+    }
+
+    // 7 bits per byte, small values take one byte
+    LoRaPacketWriter &writeVarint(uint32_t value) {
+        while (value >= 0x80) {
+            put((uint8_t) (value | 0x80));
+            value >>= 7;
+        }
+        put((uint8_t) value);
+        return *this;
+    }
+
+    // zigzag first, so small negative numbers stay short too
+    LoRaPacketWriter &writeSigned(int32_t value) {
+        return writeVarint(((uint32_t) value << 1) ^ (uint32_t) (value >> 31));
+    }
+
+    // difference to the previous value of the same series, which is updated; the reader has to
+    // see every packet of the series, so across packets start each one from a known base
+    LoRaPacketWriter &writeDelta(int32_t value, int32_t &previous) {
+        writeSigned((int32_t) ((uint32_t) value - (uint32_t) previous));
+        previous = value;
+        return *this;
+    }
+
+    // value * scale rounded, e.g. scale 100 sends 23.45 C as 2345 in two bytes instead of four
+    LoRaPacketWriter &writeFixed(float value, float scale) {
+        float scaled = value * scale;
+        return writeSigned((int32_t) (scaled < 0 ? scaled - 0.5f : scaled + 0.5f));
+    }
+
+    LoRaPacketWriter &writeByte(uint8_t value) {
+        put(value);
+        return *this;
+    }
+
+    LoRaPacketWriter &writeFloat(float value) {
+        return writeBytes((const uint8_t *) &value, sizeof(value));
+    }
+
+    LoRaPacketWriter &writeBytes(const uint8_t *bytes, uint8_t count) {
+        if (length + count > capacity) {
+            overflow = true;
+            return *this;
+        }
+        memcpy(data + length, bytes, count);
+        length += count;
+        return *this;
+    }
+
+    LoRaPacketWriter &writeString(const char *text) {
+        uint8_t count = text == nullptr ? 0 : strnlen(text, 0xFF);
+        writeVarint(count);
+        return writeBytes((const uint8_t *) text, count);
+    }
+
+    uint8_t size() const { return length; }
+    bool ok() const { return data != nullptr && !overflow; }
+
+private:
+    void put(uint8_t value) {
+        if (length >= capacity) {
+            overflow = true;
+            return;
+        }
+        data[length++] = value;
+    }
+
+    uint8_t *data;
+    uint8_t capacity;
+    uint8_t length;
+    bool overflow;
+};
+
+class LoRaPacketReader {
+public:
+    LoRaPacketReader(const uint8_t *buffer = nullptr, uint8_t bufferLength = 0)
+            : data(buffer),
+              length(bufferLength),
+              position(0),
+              truncated(false) {
+    }
+
+    uint32_t readVarint() {
+        uint32_t value = 0;
+        for (uint8_t shift = 0; shift < 35; shift += 7) {
+            if (position >= length) {
+                truncated = true;
+                return 0;
+            }
+            uint8_t b = data[position++];
+            value |= (uint32_t) (b & 0x7F) << shift;
+            if (!(b & 0x80)) return value;
+        }
+        truncated = true;
+        return 0;
+    }
+
+    int32_t readSigned() {
+        uint32_t value = readVarint();
+        return (int32_t) ((value >> 1) ^ (0 - (value & 1)));
+    }
+
+    int32_t readDelta(int32_t &previous) {
+        previous = (int32_t) ((uint32_t) previous + (uint32_t) readSigned());
+        return previous;
+    }
+
+    float readFixed(float scale) {
+        return readSigned() / scale;
+    }
+
+    uint8_t readByte() {
+        if (position >= length) {
+            truncated = true;
+            return 0;
+        }
+        return data[position++];
+    }
+
+    float readFloat() {
+        float value = 0;
+        readBytes((uint8_t *) &value, sizeof(value));
+        return value;
+    }
+
+    bool readBytes(uint8_t *bytes, uint8_t count) {
+        if (position + count > length) {
+            truncated = true;
+            position = length;
+            return false;
+        }
+        memcpy(bytes, data + position, count);
+        position += count;
+        return true;
+    }
+
+    // copies at most size - 1 characters and terminates, the rest of the field is skipped
+    uint8_t readString(char *text, uint8_t size) {
+        uint32_t count = readVarint();
+        if (truncated || position + count > length) {
+            truncated = true;
+            if (text != nullptr && size > 0) text[0] = '\0';
+            return 0;
+        }
+        uint8_t copied = 0;
+        if (text != nullptr && size > 0) {
+            copied = count < (uint32_t) (size - 1) ? count : size - 1;
+            memcpy(text, data + position, copied);
+            text[copied] = '\0';
+        }
+        position += count;
+        return copied;
+    }
+
+    uint8_t remaining() const { return length - position; }
+    bool ok() const { return !truncated; }
+
+private:
+    const uint8_t *data;
+    uint8_t length;
+    uint8_t position;
+    bool truncated;
+};
+
+class LoRaAirtime {
+public:
+    // codingRate is the denominator of 4/5..4/8, explicit header, low data rate optimisation
+    // switched on above 16 ms per symbol as the radio does
+    static uint32_t timeOnAirUs(uint8_t payloadLen, uint8_t spreadFactor, long bandwidth,
+                                uint8_t codingRate = 5, uint16_t preambleLen = 8, bool crc = true) {
+        if (spreadFactor < 6 || spreadFactor > 12 || bandwidth <= 0) return 0;
+        if (codingRate < 5 || codingRate > 8) codingRate = 5;
+
+        uint32_t symbolUs = (1000000UL << spreadFactor) / (uint32_t) bandwidth;
+        bool lowDataRate = symbolUs > 16000;
+
+        int32_t numerator = 8 * (int32_t) payloadLen - 4 * spreadFactor + 28 + (crc ? 16 : 0);
+        int32_t denominator = 4 * (spreadFactor - (lowDataRate ? 2 : 0));
+        int32_t blocks = numerator > 0 ? (numerator + denominator - 1) / denominator : 0;
+        uint32_t payloadSymbols = 8 + blocks * codingRate;
+
+        // preamble is n + 4.25 symbols, counted in quarter symbols to stay in integers
+        uint32_t quarterSymbols = (preambleLen + payloadSymbols) * 4 + 17;
+        return quarterSymbols * (symbolUs / 4) + quarterSymbols * (symbolUs % 4) / 4;
+    }
+
+    static uint32_t timeOnAirMs(uint8_t payloadLen, uint8_t spreadFactor, long bandwidth,
+                                uint8_t codingRate = 5, uint16_t preambleLen = 8, bool crc = true) {
+        return (timeOnAirUs(payloadLen, spreadFactor, bandwidth, codingRate, preambleLen, crc) + 999) / 1000;
+    }
+};
+
+enum LoRaRegion {
+    REGION_NONE,
+    REGION_EU868,
+    REGION_US915,
+    REGION_AS923,
+    REGION_IN865
+};
+
+/*
+After a transmission of T ms the band stays closed for T / duty - T ms, the per transmission rule
+of the ETSI style plans. The dwell limit rejects any single packet that is on air for too long.
+*/
+class LoRaDutyCycle {
+public:
+    LoRaDutyCycle()
+            : dutyPermille(1000),
+              maxDwellMs(0),
+              blockedUntil(0),
+              blocked(false),
+              airtimeTotal(0) {
+    }
+
+    void setRegion(LoRaRegion region) {
+        switch (region) {
+            case REGION_EU868:
+                setLimit(10, 0);
+                break;
+            case REGION_US915:
+                setLimit(1000, 400);
+                break;
+            case REGION_AS923:
+                setLimit(10, 400);
+                break;
+            default:
+                setLimit(1000, 0);
+                break;
+        }
+    }
+
+    // 10 permille is 1 %, 1000 is no limit; dwell 0 is no limit
+    void setLimit(uint16_t permille, uint32_t dwellMs) {
+        dutyPermille = permille == 0 || permille > 1000 ? 1000 : permille;
+        maxDwellMs = dwellMs;
+        if (dutyPermille >= 1000) blocked = false;
+    }
+
+    bool fitsDwell(uint32_t airtimeMs) const {
+        return maxDwellMs == 0 || airtimeMs <= maxDwellMs;
+    }
+
+    uint32_t waitTime(uint32_t now) const {
+        if (!blocked) return 0;
+        int32_t left = (int32_t) (blockedUntil - now);
+        return left > 0 ? (uint32_t) left : 0;
+    }
+
+    bool canTransmit(uint32_t airtimeMs, uint32_t now) const {
+        return fitsDwell(airtimeMs) && waitTime(now) == 0;
+    }
+
+    void onTransmit(uint32_t airtimeMs, uint32_t startedAt) {
+        airtimeTotal += airtimeMs;
+        if (dutyPermille >= 1000) {
+            blocked = false;
+            return;
+        }
+        blockedUntil = startedAt + airtimeMs * 1000UL / dutyPermille;
+        blocked = true;
+    }
+
+    uint32_t getAirtimeTotal() const { return airtimeTotal; }
+
+private:
+    uint16_t dutyPermille;
+    uint32_t maxDwellMs;
+    uint32_t blockedUntil;
+    bool blocked;
+    uint32_t airtimeTotal;
+};
+
+class LoRaDedupCache {
+public:
+    LoRaDedupCache() : next(0) {
+        clear();
+    }
+
+    void clear() {
+        for (uint8_t i = 0; i < LORA_DEDUP_SIZE; i++) {
+            entries[i].used = false;
+        }
+        next = 0;
+    }
+
+    bool contains(uint16_t sourceId, uint16_t msgId, uint32_t now) const {
+        for (uint8_t i = 0; i < LORA_DEDUP_SIZE; i++) {
+            const Entry &e = entries[i];
+            if (e.used && e.sourceId == sourceId && e.msgId == msgId && now - e.seenAt < LORA_DEDUP_LIFETIME) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // true when the pair was already there, otherwise it is remembered over the oldest entry
+    bool check(uint16_t sourceId, uint16_t msgId, uint32_t now) {
+        if (contains(sourceId, msgId, now)) return true;
+        entries[next].sourceId = sourceId;
+        entries[next].msgId = msgId;
+        entries[next].seenAt = now;
+        entries[next].used = true;
+        next = (next + 1) % LORA_DEDUP_SIZE;
+        return false;
+    }
+
+private:
+    struct Entry {
+        uint16_t sourceId;
+        uint16_t msgId;
+        uint32_t seenAt;
+        bool used;
+    };
+
+    Entry entries[LORA_DEDUP_SIZE];
+    uint8_t next;
+};
+
+#endif // LORA_PACKET_H
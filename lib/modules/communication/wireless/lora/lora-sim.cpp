@@ -0,0 +1,607 @@
+#include "lora-sim.h"
+
+#include <math.h>
+
+LoRaClass LoRa;
+
+// virtual clock for everything built against the simulator
+
+unsigned long micros() {
+    return (unsigned long) LoRaSim::instance().nowUs();
+}
+
+unsigned long millis() {
+    LoRaSim::instance().touchClock();
+    return (unsigned long) (LoRaSim::instance().nowUs() / 1000);
+}
+
+void delay(unsigned long ms) {
+    LoRaSim::instance().sleepFor((uint64_t) ms * 1000);
+}
+
+void yield() {
+    LoRaSim::instance().sleepFor(0);
+}
+
+// a node that reads the clock this often without giving up the CPU is spinning on it
+#define LORA_SIM_SPIN_LIMIT 100000
+// LoRa SNR needed to demodulate, SF6..SF12
+static const float loraSimSnrLimit[] = {-5.0f, -7.5f, -10.0f, -12.5f, -15.0f, -17.5f, -20.0f};
+#define LORA_SIM_NOISE_FIGURE 6.0f
+
+LoRaSim &LoRaSim::instance() {
+    static LoRaSim sim;
+    return sim;
+}
+
+LoRaSim::LoRaSim()
+        : _nowUs(0),
+          _current(-1),
+          _seed(1),
+          _exponent(2.7f),
+          _referenceLoss(40.0f),
+          _fading(0.0f),
+          _lossRate(0.0f),
+          _capture(6.0f),
+          _loopUs(1000) {
+    _detached.mode = RADIO_SLEEP;
+    _detached.continuous = false;
+    _detached.fifoFull = false;
+    _detached.rxIndex = 0;
+    _detached.onReceive = nullptr;
+    _detached.onTxDone = nullptr;
+    _detached.txDonePending = false;
+}
+
+void LoRaSim::reset(uint32_t seed) {
+    for (size_t i = 0; i < _nodes.size(); i++) {
+        delete _nodes[i];
+    }
+    _nodes.clear();
+    _air.clear();
+    _nowUs = 0;
+    _current = -1;
+    _seed = seed ? seed : 1;
+}
+
+int LoRaSim::addNode(float x, float y, std::function<void()> setup, std::function<void()> loop) {
+    Node *n = new Node();
+    n->x = x;
+    n->y = y;
+    n->setup = setup;
+    n->loop = loop;
+    n->started = false;
+    n->wakeUs = _nowUs;
+    n->clockReads = 0;
+
+    n->mode = RADIO_SLEEP;
+    n->continuous = false;
+    n->listenSince = 0;
+    n->frequency = 915000000;
+    n->spreadFactor = 7;
+    n->bandwidth = 125000;
+    n->codingRate = 5;
+    n->preambleLen = 8;
+    n->syncWord = 0x12;
+    n->txPower = 17;
+    n->crc = false;
+    n->fifoFull = false;
+    n->fifoRssi = 0;
+    n->fifoSnr = 0;
+    n->fifoNotified = true;
+    n->rxIndex = 0;
+    n->lastRssi = 0;
+    n->lastSnr = 0;
+    n->onReceive = nullptr;
+    n->onTxDone = nullptr;
+    n->txDonePending = false;
+    memset(&n->stats, 0, sizeof(n->stats));
+
+    _nodes.push_back(n);
+    return _nodes.size() - 1;
+}
+
+void LoRaSim::setPathLoss(float exponent, float referenceLossDb, float fadingDb) {
+    _exponent = exponent;
+    _referenceLoss = referenceLossDb;
+    _fading = fadingDb;
+}
+
+void LoRaSim::setLossRate(float probability) {
+    _lossRate = probability;
+}
+
+void LoRaSim::setCaptureThreshold(float db) {
+    _capture = db;
+}
+
+void LoRaSim::setLoopTime(uint32_t us) {
+    _loopUs = us > 0 ? us : 1;
+}
+
+LoRaSimStats LoRaSim::total() const {
+    LoRaSimStats sum;
+    memset(&sum, 0, sizeof(sum));
+    for (size_t i = 0; i < _nodes.size(); i++) {
+        const LoRaSimStats &s = _nodes[i]->stats;
+        sum.txPackets += s.txPackets;
+        sum.txBytes += s.txBytes;
+        sum.airtimeUs += s.airtimeUs;
+        sum.rxPackets += s.rxPackets;
+        sum.collisions += s.collisions;
+        sum.weakSignal += s.weakSignal;
+        sum.randomLoss += s.randomLoss;
+        sum.notListening += s.notListening;
+        sum.overwritten += s.overwritten;
+    }
+    return sum;
+}
+
+void LoRaSim::entry(int index) {
+    LoRaSim &sim = instance();
+    Node &n = *sim._nodes[index];
+    n.setup();
+    for (;;) {
+        n.loop();
+        sim.sleepFor(sim._loopUs);
+    }
+}
+
+int LoRaSim::earliestNode() const {
+    int next = -1;
+    for (size_t i = 0; i < _nodes.size(); i++) {
+        if (next < 0 || _nodes[i]->wakeUs < _nodes[next]->wakeUs) next = i;
+    }
+    return next;
+}
+
+void LoRaSim::run(uint32_t durationMs) {
+    uint64_t endUs = _nowUs + (uint64_t) durationMs * 1000;
+
+    for (;;) {
+        int next = earliestNode();
+        if (next < 0 || _nodes[next]->wakeUs > endUs) {
+            resolve(endUs);
+            _nowUs = endUs;
+            return;
+        }
+        resume(next);
+    }
+}
+
+// nothing of run() stays live across the switch, the node's stack does the rest
+void LoRaSim::resume(int index) {
+    Node &n = *_nodes[index];
+    resolve(n.wakeUs);
+    if (n.wakeUs > _nowUs) _nowUs = n.wakeUs;
+
+    if (!n.started) {
+        n.started = true;
+        n.stack.resize(LORA_SIM_STACK_SIZE);
+        getcontext(&n.context);
+        n.context.uc_stack.ss_sp = n.stack.data();
+        n.context.uc_stack.ss_size = n.stack.size();
+        n.context.uc_link = &_scheduler;
+        makecontext(&n.context, (void (*)()) entry, 1, index);
+    }
+
+    _current = index;
+    n.clockReads = 0;
+    swapcontext(&_scheduler, &n.context);
+    _current = -1;
+}
+
+void LoRaSim::sleepFor(uint64_t us) {
+    if (_current < 0) return;
+
+    Node &n = node();
+    n.wakeUs = _nowUs + (us > 0 ? us : _loopUs);
+    swapcontext(&n.context, &_scheduler);
+
+    // back on this node, run what the DIO0 interrupt would have run meanwhile
+    if (n.txDonePending) {
+        n.txDonePending = false;
+        if (n.onTxDone) n.onTxDone();
+    }
+    if (n.fifoFull && !n.fifoNotified) {
+        n.fifoNotified = true;
+        if (n.onReceive) n.onReceive(n.fifo.size());
+    }
+}
+
+void LoRaSim::touchClock() {
+    if (_current < 0) return;
+    if (++node().clockReads > LORA_SIM_SPIN_LIMIT) sleepFor(_loopUs);
+}
+
+void LoRaSim::setMode(Node &n, RadioMode mode) {
+    if (mode == RADIO_RECEIVE && n.mode != RADIO_RECEIVE) n.listenSince = _nowUs;
+    n.mode = mode;
+}
+
+void LoRaSim::resolve(uint64_t untilUs) {
+    for (;;) {
+        Transmission *first = nullptr;
+        for (size_t i = 0; i < _air.size(); i++) {
+            if (!_air[i].resolved && _air[i].endUs <= untilUs && (first == nullptr || _air[i].endUs < first->endUs)) {
+                first = &_air[i];
+            }
+        }
+        if (first == nullptr) break;
+
+        if (first->endUs > _nowUs) _nowUs = first->endUs;
+        deliver(*first);
+        first->resolved = true;
+
+        Node &sender = *_nodes[first->sender];
+        setMode(sender, RADIO_STANDBY);
+        sender.txDonePending = true;
+    }
+
+    // a finished packet is kept while it can still collide with one that is on air
+    uint64_t oldestOpen = UINT64_MAX;
+    for (size_t i = 0; i < _air.size(); i++) {
+        if (!_air[i].resolved && _air[i].startUs < oldestOpen) oldestOpen = _air[i].startUs;
+    }
+    for (size_t i = 0; i < _air.size();) {
+        if (_air[i].resolved && _air[i].endUs <= oldestOpen && _air[i].endUs <= _nowUs) {
+            _air.erase(_air.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void LoRaSim::deliver(Transmission &tx) {
+    float noise = -174.0f + 10.0f * log10f((float) tx.bandwidth) + LORA_SIM_NOISE_FIGURE;
+    float snrLimit = loraSimSnrLimit[tx.spreadFactor - 6];
+
+    for (size_t j = 0; j < _nodes.size(); j++) {
+        if (j == tx.sender) continue;
+        Node &n = *_nodes[j];
+
+        // another channel or network, the radio does not even see it
+        if (n.frequency != tx.frequency || n.spreadFactor != tx.spreadFactor ||
+            n.bandwidth != tx.bandwidth || n.syncWord != tx.syncWord) {
+            continue;
+        }
+
+        float power = tx.power[j];
+        if (power - noise < snrLimit) {
+            n.stats.weakSignal++;
+            continue;
+        }
+        if (n.mode != RADIO_RECEIVE || n.listenSince > tx.startUs) {
+            n.stats.notListening++;
+            continue;
+        }
+
+        bool collided = false;
+        for (size_t k = 0; k < _air.size() && !collided; k++) {
+            const Transmission &other = _air[k];
+            if (&other == &tx || other.startUs >= tx.endUs || other.endUs <= tx.startUs) continue;
+            if (other.frequency != tx.frequency || other.spreadFactor != tx.spreadFactor) continue;
+            if (other.sender == j) continue;
+            collided = power - other.power[j] < _capture;
+        }
+        if (collided) {
+            n.stats.collisions++;
+            continue;
+        }
+
+        if (_lossRate > 0 && (nextRandom() % 1000000) < (uint32_t) (_lossRate * 1000000)) {
+            n.stats.randomLoss++;
+            continue;
+        }
+
+        if (n.fifoFull) n.stats.overwritten++;
+        n.fifo = tx.data;
+        n.fifoFull = true;
+        n.fifoNotified = false;
+        n.fifoRssi = (int) lroundf(power);
+        n.fifoSnr = power - noise;
+        n.stats.rxPackets++;
+
+        // single receive ends with the packet, continuous keeps listening
+        if (!n.continuous) setMode(n, RADIO_STANDBY);
+    }
+}
+
+float LoRaSim::receivedPower(const Node &from, const Node &to) {
+    float dx = from.x - to.x;
+    float dy = from.y - to.y;
+    float distance = sqrtf(dx * dx + dy * dy);
+    if (distance < 1.0f) distance = 1.0f;
+
+    float loss = _referenceLoss + 10.0f * _exponent * log10f(distance);
+    return from.txPower - loss + (_fading > 0 ? _fading * gaussian() : 0.0f);
+}
+
+uint32_t LoRaSim::nextRandom() {
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 17;
+    _seed ^= _seed << 5;
+    return _seed;
+}
+
+float LoRaSim::gaussian() {
+    float u1 = (nextRandom() + 1.0f) / 4294967297.0f;
+    float u2 = (nextRandom() + 1.0f) / 4294967297.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+// LoRaClass, every call goes to the radio of the node that is running
+
+#define LORA_SIM_NODE LoRaSim::instance().node()
+
+LoRaClass::LoRaClass() {
+}
+
+int LoRaClass::begin(long frequency) {
+    LoRaSim &sim = LoRaSim::instance();
+    if (sim._current < 0) return 0;
+
+    LoRaSim::Node &n = sim.node();
+    n.frequency = frequency;
+    n.txPower = 17;
+    sim.setMode(n, LoRaSim::RADIO_STANDBY);
+    return 1;
+}
+
+void LoRaClass::end() {
+    sleep();
+}
+
+int LoRaClass::beginPacket(int implicitHeader) {
+    (void) implicitHeader;
+    LoRaSim &sim = LoRaSim::instance();
+    LoRaSim::Node &n = sim.node();
+    if (n.mode == LoRaSim::RADIO_TRANSMIT) return 0;
+
+    sim.setMode(n, LoRaSim::RADIO_STANDBY);
+    n.txFifo.clear();
+    return 1;
+}
+
+int LoRaClass::endPacket(bool async) {
+    LoRaSim &sim = LoRaSim::instance();
+    LoRaSim::Node &n = sim.node();
+
+    uint32_t airtime = LoRaAirtime::timeOnAirUs(n.txFifo.size(), n.spreadFactor, n.bandwidth,
+                                                n.codingRate, n.preambleLen, n.crc);
+
+    LoRaSim::Transmission tx;
+    tx.sender = sim._current;
+    tx.startUs = sim._nowUs;
+    tx.endUs = sim._nowUs + airtime;
+    tx.frequency = n.frequency;
+    tx.spreadFactor = n.spreadFactor;
+    tx.bandwidth = n.bandwidth;
+    tx.syncWord = n.syncWord;
+    tx.data = n.txFifo;
+    tx.resolved = false;
+    tx.power.resize(sim._nodes.size());
+    for (size_t j = 0; j < sim._nodes.size(); j++) {
+        tx.power[j] = j == tx.sender ? 0.0f : sim.receivedPower(n, *sim._nodes[j]);
+    }
+    sim._air.push_back(tx);
+
+    sim.setMode(n, LoRaSim::RADIO_TRANSMIT);
+    n.stats.txPackets++;
+    n.stats.txBytes += n.txFifo.size();
+    n.stats.airtimeUs += airtime;
+
+    if (!async) {
+        // the driver polls TX_DONE, the node is stuck for the whole airtime
+        sim.sleepFor(airtime);
+        while (n.mode == LoRaSim::RADIO_TRANSMIT) sim.sleepFor(1);
+    }
+    return 1;
+}
+
+int LoRaClass::parsePacket(int size) {
+    (void) size;
+    LoRaSim &sim = LoRaSim::instance();
+    LoRaSim::Node &n = sim.node();
+
+    if (n.fifoFull) {
+        n.rx = n.fifo;
+        n.rxIndex = 0;
+        n.fifoFull = false;
+        n.fifoNotified = true;
+        n.lastRssi = n.fifoRssi;
+        n.lastSnr = n.fifoSnr;
+        if (!n.continuous) sim.setMode(n, LoRaSim::RADIO_STANDBY);
+        return n.rx.size();
+    }
+
+    if (n.mode != LoRaSim::RADIO_RECEIVE || n.continuous) {
+        n.continuous = false;
+        sim.setMode(n, LoRaSim::RADIO_RECEIVE);
+    }
+    return 0;
+}
+
+int LoRaClass::packetRssi() {
+    return LORA_SIM_NODE.lastRssi;
+}
+
+float LoRaClass::packetSnr() {
+    return LORA_SIM_NODE.lastSnr;
+}
+
+long LoRaClass::packetFrequencyError() {
+    return 0;
+}
+
+int LoRaClass::getSpreadingFactor() {
+    return LORA_SIM_NODE.spreadFactor;
+}
+
+long LoRaClass::getSignalBandwidth() {
+    return LORA_SIM_NODE.bandwidth;
+}
+
+int LoRaClass::rssi() {
+    LoRaSim &sim = LoRaSim::instance();
+    LoRaSim::Node &n = sim.node();
+
+    float strongest = -174.0f + 10.0f * log10f((float) n.bandwidth) + LORA_SIM_NOISE_FIGURE;
+    for (size_t i = 0; i < sim._air.size(); i++) {
+        const LoRaSim::Transmission &tx = sim._air[i];
+        if (tx.startUs <= sim._nowUs && tx.endUs > sim._nowUs && tx.sender != sim._current &&
+            tx.frequency == n.frequency && tx.power[sim._current] > strongest) {
+            strongest = tx.power[sim._current];
+        }
+    }
+    return (int) lroundf(strongest);
+}
+
+size_t LoRaClass::write(uint8_t byte) {
+    return write(&byte, 1);
+}
+
+size_t LoRaClass::write(const uint8_t *buffer, size_t size) {
+    LoRaSim::Node &n = LORA_SIM_NODE;
+    if (n.txFifo.size() + size > LORA_SIM_FIFO_SIZE) size = LORA_SIM_FIFO_SIZE - n.txFifo.size();
+    n.txFifo.insert(n.txFifo.end(), buffer, buffer + size);
+    return size;
+}
+
+int LoRaClass::available() {
+    LoRaSim::Node &n = LORA_SIM_NODE;
+    return n.rx.size() - n.rxIndex;
+}
+
+int LoRaClass::read() {
+    LoRaSim::Node &n = LORA_SIM_NODE;
+    if (n.rxIndex >= n.rx.size()) return -1;
+    return n.rx[n.rxIndex++];
+}
+
+int LoRaClass::peek() {
+    LoRaSim::Node &n = LORA_SIM_NODE;
+    if (n.rxIndex >= n.rx.size()) return -1;
+    return n.rx[n.rxIndex];
+}
+
+void LoRaClass::flush() {
+}
+
+void LoRaClass::onReceive(void (*callback)(int)) {
+    LORA_SIM_NODE.onReceive = callback;
+}
+
+void LoRaClass::onCadDone(void (*callback)(bool)) {
+    (void) callback;
+}
+
+void LoRaClass::onTxDone(void (*callback)()) {
+    LORA_SIM_NODE.onTxDone = callback;
+}
+
+void LoRaClass::receive(int size) {
+    (void) size;
+    LoRaSim &sim = LoRaSim::instance();
+    LoRaSim::Node &n = sim.node();
+    n.continuous = true;
+    sim.setMode(n, LoRaSim::RADIO_RECEIVE);
+}
+
+void LoRaClass::channelActivityDetection(void) {
+}
+
+void LoRaClass::idle() {
+    LoRaSim &sim = LoRaSim::instance();
+    LoRaSim::Node &n = sim.node();
+    if (n.mode == LoRaSim::RADIO_TRANSMIT) return;
+    n.continuous = false;
+    sim.setMode(n, LoRaSim::RADIO_STANDBY);
+}
+
+void LoRaClass::sleep() {
+    LoRaSim &sim = LoRaSim::instance();
+    LoRaSim::Node &n = sim.node();
+    if (n.mode == LoRaSim::RADIO_TRANSMIT) return;
+    n.continuous = false;
+    sim.setMode(n, LoRaSim::RADIO_SLEEP);
+}
+
+void LoRaClass::setTxPower(int level, int outputPin) {
+    (void) outputPin;
+    LORA_SIM_NODE.txPower = level;
+}
+
+void LoRaClass::setFrequency(long frequency) {
+    LORA_SIM_NODE.frequency = frequency;
+}
+
+void LoRaClass::setSpreadingFactor(int sf) {
+    if (sf < 6) sf = 6;
+    if (sf > 12) sf = 12;
+    LORA_SIM_NODE.spreadFactor = sf;
+}
+
+void LoRaClass::setSignalBandwidth(long sbw) {
+    LORA_SIM_NODE.bandwidth = sbw;
+}
+
+void LoRaClass::setCodingRate4(int denominator) {
+    if (denominator < 5) denominator = 5;
+    if (denominator > 8) denominator = 8;
+    LORA_SIM_NODE.codingRate = denominator;
+}
+
+void LoRaClass::setPreambleLength(long length) {
+    LORA_SIM_NODE.preambleLen = length;
+}
+
+void LoRaClass::setSyncWord(int sw) {
+    LORA_SIM_NODE.syncWord = sw;
+}
+
+void LoRaClass::enableCrc() {
+    LORA_SIM_NODE.crc = true;
+}
+
+void LoRaClass::disableCrc() {
+    LORA_SIM_NODE.crc = false;
+}
+
+void LoRaClass::enableInvertIQ() {
+}
+
+void LoRaClass::disableInvertIQ() {
+}
+
+void LoRaClass::enableLowDataRateOptimize() {
+}
+
+void LoRaClass::disableLowDataRateOptimize() {
+}
+
+void LoRaClass::setOCP(uint8_t mA) {
+    (void) mA;
+}
+
+void LoRaClass::setGain(uint8_t gain) {
+    (void) gain;
+}
+
+byte LoRaClass::random() {
+    return LoRaSim::instance().nextRandom() & 0xFF;
+}
+
+void LoRaClass::setPins(int ss, int reset, int dio0) {
+    (void) ss;
+    (void) reset;
+    (void) dio0;
+}
+
+void LoRaClass::setSPIFrequency(uint32_t frequency) {
+    (void) frequency;
+}
+
+void LoRaClass::dumpRegisters(Stream &out) {
+    (void) out;
+}
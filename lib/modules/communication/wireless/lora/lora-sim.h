@@ -0,0 +1,244 @@
+#ifndef LORA_SIM_H
+#define LORA_SIM_H
+
+/*
+Host-only stand-in for lora-base, selected with -DKINEMATRIX_LORA_SIM. LoRaClass keeps the public
+interface of the SX127x driver, but the radio behind it is one of N nodes in a simulated medium
+that runs on a virtual clock:
+
+- every node runs its own setup()/loop() as a coroutine, millis(), delay() and yield() read and
+  advance the virtual clock, so blocking calls like sendDataWithAck() work unchanged
+- airtime follows SF/BW/CR/preamble, a node cannot hear while it transmits
+- RSSI comes from log-distance path loss plus gaussian fading, packets below the sensitivity of
+  their SF/BW are not heard
+- overlapping packets on the same frequency and SF collide unless one is stronger by the capture
+  threshold, a random loss rate can be added on top
+- like the SX127x, parsePacket() listens for one packet and then stops until it is read;
+  receive() keeps listening and a newer packet replaces one that was not read yet
+
+The global LoRa object always talks to the radio of the node that is running.
+*/
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <ucontext.h>
+#include <vector>
+#include <functional>
+
+#include "lora-packet.h"
+
+#define PA_OUTPUT_RFO_PIN          0
+#define PA_OUTPUT_PA_BOOST_PIN     1
+
+#define LORA_DEFAULT_SS_PIN        10
+#define LORA_DEFAULT_RESET_PIN     9
+#define LORA_DEFAULT_DIO0_PIN      2
+
+#define LORA_SIM_FIFO_SIZE         255
+#define LORA_SIM_STACK_SIZE        (256 * 1024)
+
+class LoRaClass : public Stream {
+public:
+    LoRaClass();
+
+    int begin(long frequency);
+    void end();
+
+    int beginPacket(int implicitHeader = false);
+    int endPacket(bool async = false);
+
+    int parsePacket(int size = 0);
+    int packetRssi();
+    float packetSnr();
+    long packetFrequencyError();
+
+    int getSpreadingFactor();
+    long getSignalBandwidth();
+
+    int rssi();
+
+    virtual size_t write(uint8_t byte);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    virtual int available();
+    virtual int read();
+    virtual int peek();
+    virtual void flush();
+
+    void onReceive(void (*callback)(int));
+    void onCadDone(void (*callback)(bool));
+    void onTxDone(void (*callback)());
+
+    void receive(int size = 0);
+    void channelActivityDetection(void);
+
+    void idle();
+    void sleep();
+
+    void setTxPower(int level, int outputPin = PA_OUTPUT_PA_BOOST_PIN);
+    void setFrequency(long frequency);
+    void setSpreadingFactor(int sf);
+    void setSignalBandwidth(long sbw);
+    void setCodingRate4(int denominator);
+    void setPreambleLength(long length);
+    void setSyncWord(int sw);
+    void enableCrc();
+    void disableCrc();
+    void enableInvertIQ();
+    void disableInvertIQ();
+    void enableLowDataRateOptimize();
+    void disableLowDataRateOptimize();
+
+    void setOCP(uint8_t mA);
+    void setGain(uint8_t gain);
+
+    void crc() { enableCrc(); }
+    void noCrc() { disableCrc(); }
+
+    byte random();
+
+    void setPins(int ss = LORA_DEFAULT_SS_PIN, int reset = LORA_DEFAULT_RESET_PIN, int dio0 = LORA_DEFAULT_DIO0_PIN);
+    void setSPIFrequency(uint32_t frequency);
+
+    void dumpRegisters(Stream &out);
+};
+
+extern LoRaClass LoRa;
+
+// reception counters are per receiving node, a packet out of range of a node counts as weakSignal there
+struct LoRaSimStats {
+    uint32_t txPackets;
+    uint32_t txBytes;
+    uint64_t airtimeUs;
+    uint32_t rxPackets;
+    uint32_t collisions;
+    uint32_t weakSignal;
+    uint32_t randomLoss;
+    // transmitting, idle or started listening after the preamble
+    uint32_t notListening;
+    uint32_t overwritten;
+};
+
+class LoRaSim {
+public:
+    static LoRaSim &instance();
+
+    // clears all nodes and the clock, the same seed replays the same run
+    void reset(uint32_t seed = 1);
+
+    // node ids are 0, 1, 2... in the order they are added; positions in metres
+    int addNode(float x, float y, std::function<void()> setup, std::function<void()> loop);
+
+    // received power = txPower - (referenceLoss + 10 * exponent * log10(d / 1 m)) + N(0, fading)
+    void setPathLoss(float exponent, float referenceLossDb = 40, float fadingDb = 0);
+    void setLossRate(float probability);
+    void setCaptureThreshold(float db);
+    // virtual time a pass through loop() or a yield() takes
+    void setLoopTime(uint32_t us);
+
+    void run(uint32_t durationMs);
+
+    uint64_t nowUs() const { return _nowUs; }
+    int currentNode() const { return _current; }
+    uint8_t nodeCount() const { return _nodes.size(); }
+    const LoRaSimStats &stats(uint8_t node) const { return _nodes[node]->stats; }
+    LoRaSimStats total() const;
+
+    // called through millis(), delay() and yield() of the node that is running
+    void sleepFor(uint64_t us);
+    void touchClock();
+
+private:
+    friend class LoRaClass;
+
+    enum RadioMode {
+        RADIO_SLEEP,
+        RADIO_STANDBY,
+        RADIO_RECEIVE,
+        RADIO_TRANSMIT
+    };
+
+    struct Transmission {
+        uint8_t sender;
+        uint64_t startUs;
+        uint64_t endUs;
+        long frequency;
+        uint8_t spreadFactor;
+        long bandwidth;
+        uint8_t syncWord;
+        std::vector<uint8_t> data;
+        // power as heard by every node, fixed when the packet starts
+        std::vector<float> power;
+        bool resolved;
+    };
+
+    struct Node {
+        float x;
+        float y;
+        std::function<void()> setup;
+        std::function<void()> loop;
+        bool started;
+        ucontext_t context;
+        std::vector<uint8_t> stack;
+        uint64_t wakeUs;
+        uint32_t clockReads;
+
+        RadioMode mode;
+        bool continuous;
+        uint64_t listenSince;
+        long frequency;
+        uint8_t spreadFactor;
+        long bandwidth;
+        uint8_t codingRate;
+        uint16_t preambleLen;
+        uint8_t syncWord;
+        int8_t txPower;
+        bool crc;
+
+        std::vector<uint8_t> txFifo;
+        bool fifoFull;
+        bool fifoNotified;
+        std::vector<uint8_t> fifo;
+        int fifoRssi;
+        float fifoSnr;
+        std::vector<uint8_t> rx;
+        size_t rxIndex;
+        int lastRssi;
+        float lastSnr;
+        void (*onReceive)(int);
+        void (*onTxDone)();
+        bool txDonePending;
+
+        LoRaSimStats stats;
+    };
+
+    LoRaSim();
+    // outside of a node, e.g. a LoRaComV2 destructor, calls land on a radio nobody hears
+    Node &node() { return _current >= 0 ? *_nodes[_current] : _detached; }
+    static void entry(int index);
+    int earliestNode() const;
+    void resume(int index);
+    void setMode(Node &n, RadioMode mode);
+    void resolve(uint64_t untilUs);
+    void deliver(Transmission &tx);
+    float receivedPower(const Node &from, const Node &to);
+    float gaussian();
+    uint32_t nextRandom();
+
+    // by pointer, a running ucontext must not move
+    std::vector<Node *> _nodes;
+    Node _detached;
+    std::vector<Transmission> _air;
+    ucontext_t _scheduler;
+    uint64_t _nowUs;
+    int _current;
+    uint32_t _seed;
+    float _exponent;
+    float _referenceLoss;
+    float _fading;
+    float _lossRate;
+    float _capture;
+    uint32_t _loopUs;
+};
+
+#endif
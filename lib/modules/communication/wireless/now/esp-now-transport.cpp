@@ -0,0 +1,530 @@
+#include "esp-now-transport.h"
+
+#if defined(ESP32) || defined(ESP8266)
+
+ESPNowTransport *ESPNowTransport::instance = nullptr;
+
+ESPNowTransport::ESPNowTransport() {
+    now = nullptr;
+    handler = nullptr;
+
+    memset(peers, 0, sizeof(peers));
+    peerCount = 0;
+    nextPeer = 0;
+    nextMsgId = 0;
+    batchDelay = 5;
+    sendTimeout = 100;
+
+    txFrameLen = 0;
+    txMessages = 0;
+    txPeer = -1;
+    txAttempts = 0;
+    txAt = 0;
+    txState = TX_IDLE;
+    txIssued = 0;
+    txReported = 0;
+
+    rxHead = 0;
+    rxTail = 0;
+    rxOverflows = 0;
+    pumping = false;
+}
+
+ESPNowTransport::~ESPNowTransport() {
+    for (uint8_t i = 0; i < peerCount; i++) {
+        releaseOutgoing(peers[i]);
+        releaseIncoming(peers[i]);
+    }
+    if (instance == this) instance = nullptr;
+}
+
+bool ESPNowTransport::begin(ESPNow &espNow) {
+    now = &espNow;
+    instance = this;
+
+    bool isInit = espNow.begin(onSent, onReceived);
+
+    uint8_t thisMac[6];
+    WiFi.macAddress(thisMac);
+    for (int i = 0; i < espNow.getMacCount(); i++) {
+        const uint8_t *mac = espNow.getMacAddress(i);
+        if (memcmp(mac, thisMac, 6) != 0) insertPeer(mac);
+    }
+    nextMsgId = (uint16_t) micros();
+
+    return isInit;
+}
+
+bool ESPNowTransport::addPeer(const uint8_t *mac, uint8_t channel) {
+    if (mac == nullptr) return false;
+    if (findPeer(mac) >= 0) return true;
+    if (peerCount >= ESPNOW_TRANSPORT_MAX_PEERS) return false;
+
+    if (!esp_now_is_peer_exist(mac)) {
+        esp_now_peer_info_t peerInfo = {};
+        memcpy(peerInfo.peer_addr, mac, 6);
+        peerInfo.channel = channel;
+        peerInfo.encrypt = false;
+        if (esp_now_add_peer(&peerInfo) != ESP_OK) return false;
+    }
+
+    return insertPeer(mac) >= 0;
+}
+
+void ESPNowTransport::setReceiveHandler(ESPNowMessageHandler callback) {
+    handler = callback;
+}
+
+void ESPNowTransport::setBatchDelay(uint32_t ms) {
+    batchDelay = ms;
+}
+
+void ESPNowTransport::setSendTimeout(uint32_t ms) {
+    sendTimeout = ms;
+}
+
+bool ESPNowTransport::send(const uint8_t *mac, const uint8_t *data, size_t len) {
+    if (now == nullptr || mac == nullptr || data == nullptr || len == 0 || len > ESPNOW_MAX_MESSAGE_SIZE) {
+        return false;
+    }
+
+    int8_t index = findPeer(mac);
+    if (index < 0) return false;
+
+    Peer &peer = peers[index];
+    bool large = len > ESPNOW_BATCH_RECORD_MAX;
+
+    if (!hasRoom(peer, large, len)) {
+        // a batch that cannot take this message goes out now instead of after the delay
+        if (!large && peer.batchLen > 0) peer.batchSealed = true;
+
+        uint32_t startTime = millis();
+        while (!hasRoom(peer, large, len)) {
+            if (millis() - startTime >= sendTimeout) return false;
+            update();
+            yield();
+        }
+    }
+
+    return large ? queueLarge(peer, data, len) : queueSmall(peer, data, len);
+}
+
+bool ESPNowTransport::broadcast(const uint8_t *data, size_t len) {
+    bool success = true;
+    for (uint8_t i = 0; i < peerCount; i++) {
+        if (!send(peers[i].mac, data, len)) success = false;
+    }
+    return success;
+}
+
+bool ESPNowTransport::flush(uint32_t timeoutMs) {
+    for (uint8_t i = 0; i < peerCount; i++) {
+        if (peers[i].batchLen > 0) peers[i].batchSealed = true;
+    }
+
+    uint32_t startTime = millis();
+    while (!isIdle()) {
+        if (millis() - startTime >= timeoutMs) return false;
+        update();
+        yield();
+    }
+    return true;
+}
+
+bool ESPNowTransport::isIdle() {
+    if (txState != TX_IDLE) return false;
+    for (uint8_t i = 0; i < peerCount; i++) {
+        if (peers[i].batchLen > 0 || peers[i].outData != nullptr) return false;
+    }
+    return true;
+}
+
+void ESPNowTransport::update() {
+    if (now == nullptr) return;
+
+    if (!pumping) {
+        pumping = true;
+        pumpReceived();
+        expireIncoming();
+        pumping = false;
+    }
+
+    if (txState != TX_IDLE) finishSend();
+    if (txState == TX_IDLE) startNextFrame();
+}
+
+uint8_t ESPNowTransport::getPeerCount() {
+    return peerCount;
+}
+
+const uint8_t *ESPNowTransport::getPeerAddress(uint8_t index) {
+    return index < peerCount ? peers[index].mac : nullptr;
+}
+
+const ESPNowPeerStats *ESPNowTransport::getStats(const uint8_t *mac) {
+    int8_t index = findPeer(mac);
+    return index >= 0 ? &peers[index].stats : nullptr;
+}
+
+uint32_t ESPNowTransport::getRxOverflows() {
+    return rxOverflows;
+}
+
+void ESPNowTransport::resetStats() {
+    for (uint8_t i = 0; i < peerCount; i++) {
+        memset(&peers[i].stats, 0, sizeof(peers[i].stats));
+    }
+    rxOverflows = 0;
+}
+
+int8_t ESPNowTransport::findPeer(const uint8_t *mac) {
+    if (mac == nullptr) return -1;
+    for (uint8_t i = 0; i < peerCount; i++) {
+        if (memcmp(peers[i].mac, mac, 6) == 0) return i;
+    }
+    return -1;
+}
+
+int8_t ESPNowTransport::insertPeer(const uint8_t *mac) {
+    if (mac == nullptr || peerCount >= ESPNOW_TRANSPORT_MAX_PEERS) return -1;
+
+    int8_t index = findPeer(mac);
+    if (index >= 0) return index;
+
+    Peer &peer = peers[peerCount];
+    memset(&peer, 0, sizeof(peer));
+    memcpy(peer.mac, mac, 6);
+    // a restarted sender must not repeat the sequence the receiver saw last
+    peer.txSequence = (uint8_t) (micros() + peerCount);
+    return peerCount++;
+}
+
+bool ESPNowTransport::hasRoom(Peer &peer, bool large, size_t len) {
+    if (large) return peer.outData == nullptr;
+
+    // messages after a large one must not overtake it in the batch that goes before it
+    if (peer.outData != nullptr && peer.batchFirst) return false;
+    return peer.batchLen == 0 || peer.batchLen + 1 + len <= ESPNOW_FRAME_SIZE;
+}
+
+bool ESPNowTransport::queueSmall(Peer &peer, const uint8_t *data, size_t len) {
+    if (peer.batchLen == 0) {
+        peer.batch[0] = ESPNOW_FRAME_BATCH;
+        peer.batch[1] = 0;
+        peer.batchLen = ESPNOW_BATCH_HEADER_SIZE;
+        peer.batchCount = 0;
+        peer.batchSince = millis();
+        peer.batchFirst = false;
+        peer.batchSealed = false;
+    }
+
+    peer.batch[peer.batchLen++] = len;
+    memcpy(peer.batch + peer.batchLen, data, len);
+    peer.batchLen += len;
+    peer.batchCount++;
+
+    // not even a one byte message fits any more
+    if (peer.batchLen + 2 > ESPNOW_FRAME_SIZE) peer.batchSealed = true;
+    return true;
+}
+
+bool ESPNowTransport::queueLarge(Peer &peer, const uint8_t *data, size_t len) {
+    uint8_t *copy = (uint8_t *) malloc(len);
+    if (copy == nullptr) return false;
+    memcpy(copy, data, len);
+
+    peer.outData = copy;
+    peer.outLen = len;
+    peer.outMsgId = nextMsgId++;
+    peer.outCount = (len + ESPNOW_FRAGMENT_PAYLOAD - 1) / ESPNOW_FRAGMENT_PAYLOAD;
+    peer.outNext = 0;
+
+    if (peer.batchLen > 0) {
+        peer.batchFirst = true;
+        peer.batchSealed = true;
+    }
+    return true;
+}
+
+void ESPNowTransport::resetBatch(Peer &peer) {
+    peer.batchLen = 0;
+    peer.batchCount = 0;
+    peer.batchFirst = false;
+    peer.batchSealed = false;
+}
+
+void ESPNowTransport::releaseOutgoing(Peer &peer) {
+    free(peer.outData);
+    peer.outData = nullptr;
+    peer.outLen = 0;
+    peer.outCount = 0;
+    peer.outNext = 0;
+}
+
+void ESPNowTransport::releaseIncoming(Peer &peer) {
+    free(peer.inData);
+    peer.inData = nullptr;
+    peer.inActive = false;
+}
+
+void ESPNowTransport::pumpReceived() {
+    while (rxTail != rxHead) {
+        RxFrame &frame = rxQueue[rxTail];
+        int8_t index = findPeer(frame.mac);
+        if (index >= 0) handleFrame(peers[index], frame.data, frame.len);
+        rxTail = (rxTail + 1) % ESPNOW_RX_QUEUE_SIZE;
+    }
+}
+
+void ESPNowTransport::expireIncoming() {
+    for (uint8_t i = 0; i < peerCount; i++) {
+        Peer &peer = peers[i];
+        if (peer.inActive && millis() - peer.inLastAt > ESPNOW_REASSEMBLY_TIMEOUT) {
+            peer.stats.reassemblyDropped++;
+            releaseIncoming(peer);
+        }
+    }
+}
+
+void ESPNowTransport::handleFrame(Peer &peer, const uint8_t *frame, uint8_t len) {
+    if (len == 0) return;
+
+    switch (frame[0]) {
+        case ESPNOW_FRAME_BATCH:
+            handleBatch(peer, frame, len);
+            break;
+        case ESPNOW_FRAME_FRAGMENT:
+            handleFragment(peer, frame, len);
+            break;
+        default:
+            break;
+    }
+}
+
+void ESPNowTransport::handleBatch(Peer &peer, const uint8_t *frame, uint8_t len) {
+    if (len < ESPNOW_BATCH_HEADER_SIZE) return;
+
+    // the sender did not see our ACK and sent the same frame again
+    if (peer.hasRxSequence && frame[1] == peer.rxSequence) {
+        peer.stats.duplicatesDropped++;
+        return;
+    }
+    peer.rxSequence = frame[1];
+    peer.hasRxSequence = true;
+
+    uint8_t position = ESPNOW_BATCH_HEADER_SIZE;
+    while (position < len) {
+        uint8_t recordLen = frame[position++];
+        if (recordLen == 0 || position + recordLen > len) break;
+
+        peer.stats.messagesReceived++;
+        peer.stats.bytesReceived += recordLen;
+        if (handler != nullptr) handler(peer.mac, frame + position, recordLen);
+        position += recordLen;
+    }
+}
+
+void ESPNowTransport::handleFragment(Peer &peer, const uint8_t *frame, uint8_t len) {
+    if (len <= ESPNOW_FRAGMENT_HEADER_SIZE) return;
+
+    uint16_t msgId = frame[1] | (frame[2] << 8);
+    uint8_t index = frame[3];
+    uint8_t count = frame[4];
+    uint8_t dataLen = len - ESPNOW_FRAGMENT_HEADER_SIZE;
+
+    // every fragment but the last is full, that is how offsets are known without a length field
+    if (count == 0 || index >= count || (index < count - 1 && dataLen != ESPNOW_FRAGMENT_PAYLOAD)) return;
+
+    if (peer.hasCompleted && msgId == peer.lastCompletedId) {
+        peer.stats.duplicatesDropped++;
+        return;
+    }
+
+    if (peer.inActive && (msgId != peer.inMsgId || count != peer.inCount)) {
+        // the sender gave up on the previous message
+        peer.stats.reassemblyDropped++;
+        releaseIncoming(peer);
+    }
+
+    uint32_t offset = (uint32_t) index * ESPNOW_FRAGMENT_PAYLOAD;
+    if (offset + dataLen > ESPNOW_MAX_MESSAGE_SIZE) {
+        peer.stats.reassemblyDropped++;
+        releaseIncoming(peer);
+        return;
+    }
+
+    if (!peer.inActive) {
+        uint32_t capacity = (uint32_t) count * ESPNOW_FRAGMENT_PAYLOAD;
+        if (capacity > ESPNOW_MAX_MESSAGE_SIZE) capacity = ESPNOW_MAX_MESSAGE_SIZE;
+        peer.inData = (uint8_t *) malloc(capacity);
+        if (peer.inData == nullptr) {
+            peer.stats.reassemblyDropped++;
+            return;
+        }
+        peer.inActive = true;
+        peer.inMsgId = msgId;
+        peer.inCount = count;
+        peer.inReceived = 0;
+        peer.inLen = 0;
+        memset(peer.inBits, 0, sizeof(peer.inBits));
+    }
+
+    uint8_t mask = 1 << (index & 7);
+    if (peer.inBits[index >> 3] & mask) {
+        peer.stats.duplicatesDropped++;
+        return;
+    }
+    peer.inBits[index >> 3] |= mask;
+    peer.inReceived++;
+    peer.inLastAt = millis();
+
+    memcpy(peer.inData + offset, frame + ESPNOW_FRAGMENT_HEADER_SIZE, dataLen);
+    if (index == count - 1) peer.inLen = offset + dataLen;
+
+    if (peer.inReceived == count) {
+        peer.lastCompletedId = msgId;
+        peer.hasCompleted = true;
+        peer.stats.messagesReceived++;
+        peer.stats.bytesReceived += peer.inLen;
+        if (handler != nullptr) handler(peer.mac, peer.inData, peer.inLen);
+        releaseIncoming(peer);
+    }
+}
+
+void ESPNowTransport::finishSend() {
+    uint8_t state = txState;
+    if (state == TX_WAITING) {
+        if (millis() - txAt < ESPNOW_SEND_TIMEOUT) return;
+        state = TX_FAILED;
+    }
+
+    Peer &peer = peers[txPeer];
+    bool isBatch = txFrame[0] == ESPNOW_FRAME_BATCH;
+
+    if (state == TX_DONE) {
+        peer.stats.framesSent++;
+        peer.stats.bytesSent += txFrameLen;
+        if (isBatch) {
+            peer.stats.messagesSent += txMessages;
+            if (txMessages > 1) peer.stats.messagesBatched += txMessages;
+        } else if (++peer.outNext >= peer.outCount) {
+            peer.stats.messagesSent++;
+            releaseOutgoing(peer);
+        }
+        txState = TX_IDLE;
+        txPeer = -1;
+        return;
+    }
+
+    peer.stats.framesFailed++;
+    if (++txAttempts <= ESPNOW_SEND_RETRIES) {
+        transmit();
+        return;
+    }
+
+    // the peer is gone or out of range, the rest of a fragmented message would be useless
+    if (isBatch) {
+        peer.stats.messagesFailed += txMessages;
+    } else {
+        peer.stats.messagesFailed++;
+        releaseOutgoing(peer);
+    }
+    txState = TX_IDLE;
+    txPeer = -1;
+}
+
+void ESPNowTransport::startNextFrame() {
+    for (uint8_t i = 0; i < peerCount; i++) {
+        uint8_t index = (nextPeer + i) % peerCount;
+        if (buildFrame(peers[index])) {
+            // one frame per peer and turn, a large message does not hold up the others
+            nextPeer = (index + 1) % peerCount;
+            txPeer = index;
+            txAttempts = 0;
+            transmit();
+            return;
+        }
+    }
+}
+
+bool ESPNowTransport::buildFrame(Peer &peer) {
+    bool batchDue = peer.batchLen > 0 &&
+                    (peer.batchFirst ||
+                     (peer.outData == nullptr && (peer.batchSealed || millis() - peer.batchSince >= batchDelay)));
+
+    if (batchDue) {
+        memcpy(txFrame, peer.batch, peer.batchLen);
+        txFrame[1] = peer.txSequence++;
+        txFrameLen = peer.batchLen;
+        txMessages = peer.batchCount;
+        resetBatch(peer);
+        return true;
+    }
+
+    if (peer.outData != nullptr) {
+        uint32_t offset = (uint32_t) peer.outNext * ESPNOW_FRAGMENT_PAYLOAD;
+        uint16_t chunk = peer.outLen - offset;
+        if (chunk > ESPNOW_FRAGMENT_PAYLOAD) chunk = ESPNOW_FRAGMENT_PAYLOAD;
+
+        txFrame[0] = ESPNOW_FRAME_FRAGMENT;
+        txFrame[1] = peer.outMsgId & 0xFF;
+        txFrame[2] = peer.outMsgId >> 8;
+        txFrame[3] = peer.outNext;
+        txFrame[4] = peer.outCount;
+        memcpy(txFrame + ESPNOW_FRAGMENT_HEADER_SIZE, peer.outData + offset, chunk);
+        txFrameLen = ESPNOW_FRAGMENT_HEADER_SIZE + chunk;
+        txMessages = 0;
+        return true;
+    }
+
+    return false;
+}
+
+void ESPNowTransport::transmit() {
+    // waiting before the call, the send callback may come before sendData() returns
+    txState = TX_WAITING;
+    txAt = millis();
+    txIssued++;
+    if (now->sendData(peers[txPeer].mac, txFrame, txFrameLen) != ESP_OK) {
+        // no report will come for it
+        txIssued--;
+        txState = TX_FAILED;
+    }
+}
+
+void ESPNowTransport::onSent(const uint8_t *mac_addr, esp_now_send_status_t status) {
+    ESPNowTransport *transport = instance;
+    if (transport == nullptr) return;
+    // a late report for an attempt that timed out must not be credited to the one in flight
+    if (++transport->txReported != transport->txIssued) return;
+    if (transport->txState != TX_WAITING) return;
+    if (mac_addr != nullptr && transport->txPeer >= 0 &&
+        memcmp(mac_addr, transport->peers[transport->txPeer].mac, 6) != 0) {
+        return;
+    }
+
+    transport->txState = status == ESP_NOW_SEND_SUCCESS ? TX_DONE : TX_FAILED;
+}
+
+void ESPNowTransport::onReceived(const uint8_t *mac, const uint8_t *incomingData, int len) {
+    ESPNowTransport *transport = instance;
+    if (transport == nullptr || mac == nullptr || incomingData == nullptr || len <= 0 || len > ESPNOW_FRAME_SIZE) {
+        return;
+    }
+
+    // one slot stays empty to tell a full queue from an empty one
+    uint8_t head = transport->rxHead;
+    uint8_t next = (head + 1) % ESPNOW_RX_QUEUE_SIZE;
+    if (next == transport->rxTail) {
+        transport->rxOverflows++;
+        return;
+    }
+
+    RxFrame &frame = transport->rxQueue[head];
+    memcpy(frame.mac, mac, 6);
+    frame.len = len;
+    memcpy(frame.data, incomingData, len);
+    transport->rxHead = next;
+}
+
+#endif
@@ -0,0 +1,223 @@
+#pragma once
+
+#ifndef ESP_NOW_TRANSPORT_H
+#define ESP_NOW_TRANSPORT_H
+
+#if defined(ESP32) || defined(ESP8266)
+
+#include "Arduino.h"
+#include "esp-now.h"
+
+/*
+Message transport over ESPNow for peers that push more than one frame at a time.
+
+- one frame in flight: the next frame only goes out after the send callback reported the last
+  one, a failed frame is sent again up to ESPNOW_SEND_RETRIES times, so a burst never overflows
+  the driver queue
+- messages up to ESPNOW_BATCH_RECORD_MAX bytes to the same peer share a frame, held back for at
+  most the batch delay
+- larger messages, up to ESPNOW_MAX_MESSAGE_SIZE, go out as numbered fragments and are put back
+  together on the other side
+- per peer counters, peers are kept as 6 byte addresses
+
+Both sides must use the transport, frames start with a kind byte plain ESPNow data does not use.
+Messages to one peer arrive in the order they were sent, a message is delivered whole or not at
+all. The callbacks only queue, everything else happens in update().
+*/
+
+#define ESPNOW_FRAME_SIZE             250
+#define ESPNOW_FRAME_BATCH            0xB1
+#define ESPNOW_FRAME_FRAGMENT         0xF1
+// [kind][sequence] then [length][bytes] per message
+#define ESPNOW_BATCH_HEADER_SIZE      2
+// [kind][message id, 2 bytes][index][count] then bytes
+#define ESPNOW_FRAGMENT_HEADER_SIZE   5
+#define ESPNOW_BATCH_RECORD_MAX       (ESPNOW_FRAME_SIZE - ESPNOW_BATCH_HEADER_SIZE - 1)
+#define ESPNOW_FRAGMENT_PAYLOAD       (ESPNOW_FRAME_SIZE - ESPNOW_FRAGMENT_HEADER_SIZE)
+
+#if defined(ESP8266)
+#define ESPNOW_DEFAULT_MAX_MESSAGE    4096
+#define ESPNOW_DEFAULT_RX_QUEUE       4
+#else
+#define ESPNOW_DEFAULT_MAX_MESSAGE    8192
+#define ESPNOW_DEFAULT_RX_QUEUE       8
+#endif
+
+#ifndef ESPNOW_MAX_MESSAGE_SIZE
+#define ESPNOW_MAX_MESSAGE_SIZE ESPNOW_DEFAULT_MAX_MESSAGE
+#endif
+#ifndef ESPNOW_RX_QUEUE_SIZE
+#define ESPNOW_RX_QUEUE_SIZE ESPNOW_DEFAULT_RX_QUEUE
+#endif
+#ifndef ESPNOW_TRANSPORT_MAX_PEERS
+#define ESPNOW_TRANSPORT_MAX_PEERS 10
+#endif
+#ifndef ESPNOW_SEND_RETRIES
+#define ESPNOW_SEND_RETRIES 3
+#endif
+// the send callback normally comes within a few ms, a frame without one counts as failed
+#ifndef ESPNOW_SEND_TIMEOUT
+#define ESPNOW_SEND_TIMEOUT 50
+#endif
+#ifndef ESPNOW_REASSEMBLY_TIMEOUT
+#define ESPNOW_REASSEMBLY_TIMEOUT 500
+#endif
+
+#if ESPNOW_MAX_MESSAGE_SIZE > 255 * ESPNOW_FRAGMENT_PAYLOAD
+#error "ESPNOW_MAX_MESSAGE_SIZE needs more than 255 fragments"
+#endif
+
+// data is only valid until the handler returns
+typedef void (*ESPNowMessageHandler)(const uint8_t *mac, const uint8_t *data, size_t len);
+
+typedef struct {
+    uint32_t framesSent;
+    uint32_t framesFailed;
+    uint32_t messagesSent;
+    uint32_t messagesFailed;
+    uint32_t messagesBatched;
+    uint32_t bytesSent;
+    uint32_t messagesReceived;
+    uint32_t bytesReceived;
+    uint32_t duplicatesDropped;
+    uint32_t reassemblyDropped;
+} ESPNowPeerStats;
+
+class ESPNowTransport {
+private:
+    enum TxState {
+        TX_IDLE,
+        TX_WAITING,
+        TX_DONE,
+        TX_FAILED
+    };
+
+    struct Peer {
+        uint8_t mac[6];
+
+        uint8_t batch[ESPNOW_FRAME_SIZE];
+        uint8_t batchLen;
+        uint8_t batchCount;
+        uint32_t batchSince;
+        // the batch was started before the large message that is going out, it goes first
+        bool batchFirst;
+        // full or flushed, sent without waiting for the batch delay
+        bool batchSealed;
+        uint8_t txSequence;
+
+        uint8_t *outData;
+        uint16_t outLen;
+        uint16_t outMsgId;
+        uint8_t outCount;
+        uint8_t outNext;
+
+        uint8_t *inData;
+        uint16_t inMsgId;
+        uint16_t inLen;
+        uint8_t inCount;
+        uint8_t inReceived;
+        uint8_t inBits[32];
+        uint32_t inLastAt;
+        bool inActive;
+        uint16_t lastCompletedId;
+        bool hasCompleted;
+        uint8_t rxSequence;
+        bool hasRxSequence;
+
+        ESPNowPeerStats stats;
+    };
+
+    struct RxFrame {
+        uint8_t mac[6];
+        uint8_t len;
+        uint8_t data[ESPNOW_FRAME_SIZE];
+    };
+
+    static ESPNowTransport *instance;
+
+    ESPNow *now;
+    ESPNowMessageHandler handler;
+
+    Peer peers[ESPNOW_TRANSPORT_MAX_PEERS];
+    uint8_t peerCount;
+    uint8_t nextPeer;
+    uint16_t nextMsgId;
+    uint32_t batchDelay;
+    uint32_t sendTimeout;
+
+    uint8_t txFrame[ESPNOW_FRAME_SIZE];
+    uint8_t txFrameLen;
+    // messages in the batch frame on air, the batch itself is already free for new ones
+    uint8_t txMessages;
+    int8_t txPeer;
+    uint8_t txAttempts;
+    uint32_t txAt;
+    volatile uint8_t txState;
+    // one send report comes per accepted sendData(), in order. A report while fewer were counted
+    // than sent belongs to an attempt that already timed out and must not settle the current one
+    volatile uint8_t txIssued;
+    volatile uint8_t txReported;
+
+    RxFrame rxQueue[ESPNOW_RX_QUEUE_SIZE];
+    volatile uint8_t rxHead;
+    volatile uint8_t rxTail;
+    volatile uint32_t rxOverflows;
+    // a handler that calls send() runs update() again, which must not hand out the same frame twice
+    bool pumping;
+
+    int8_t findPeer(const uint8_t *mac);
+    int8_t insertPeer(const uint8_t *mac);
+    bool queueSmall(Peer &peer, const uint8_t *data, size_t len);
+    bool queueLarge(Peer &peer, const uint8_t *data, size_t len);
+    bool hasRoom(Peer &peer, bool large, size_t len);
+    void resetBatch(Peer &peer);
+    void releaseOutgoing(Peer &peer);
+    void releaseIncoming(Peer &peer);
+
+    void pumpReceived();
+    void expireIncoming();
+    void handleFrame(Peer &peer, const uint8_t *frame, uint8_t len);
+    void handleBatch(Peer &peer, const uint8_t *frame, uint8_t len);
+    void handleFragment(Peer &peer, const uint8_t *frame, uint8_t len);
+    void finishSend();
+    void startNextFrame();
+    bool buildFrame(Peer &peer);
+    void transmit();
+
+public:
+    ESPNowTransport();
+    ~ESPNowTransport();
+
+    // registers the transport callbacks through ESPNow::begin() and takes over its peer list
+    bool begin(ESPNow &espNow);
+    // a peer ESPNow does not know, added to the driver as well; channel 0 is the current one
+    bool addPeer(const uint8_t *mac, uint8_t channel = 0);
+    void setReceiveHandler(ESPNowMessageHandler callback);
+    // how long a small message may wait for others to share its frame, 0 sends at the next update()
+    void setBatchDelay(uint32_t ms);
+    // how long send() keeps calling update() for room in the peer's queue, 0 never waits
+    void setSendTimeout(uint32_t ms);
+
+    // false when the peer is unknown, the message is too large or there was no room in time
+    bool send(const uint8_t *mac, const uint8_t *data, size_t len);
+    // every peer except this device, true when all of them took it
+    bool broadcast(const uint8_t *data, size_t len);
+    // sends everything queued, including batches that are not due yet
+    bool flush(uint32_t timeoutMs = 1000);
+    bool isIdle();
+
+    // call from loop(): hands received messages to the handler and sends the next frame
+    void update();
+
+    uint8_t getPeerCount();
+    const uint8_t *getPeerAddress(uint8_t index);
+    const ESPNowPeerStats *getStats(const uint8_t *mac);
+    uint32_t getRxOverflows();
+    void resetStats();
+
+    static void onSent(const uint8_t *mac_addr, esp_now_send_status_t status);
+    static void onReceived(const uint8_t *mac, const uint8_t *incomingData, int len);
+};
+
+#endif
+#endif
@@ -70,8 +70,10 @@ int ESPNow::getThisDeviceIndex() {
 }
 
 int ESPNow::getThisDeviceIndexByMacAddress() {
+    uint8_t thisMac[6];
+    WiFi.macAddress(thisMac);
     for (int i = 0; i < macAddressLen; i++) {
-        if (macAddressToString(macAddressList[i]) == WiFi.macAddress()) {
+        if (isThisDevice(thisMac, macAddressList[i])) {
             return i;
         }
     }
@@ -79,28 +81,49 @@ int ESPNow::getThisDeviceIndexByMacAddress() {
 }
 
 void ESPNow::addMacAddress(String macStr, int master) {
+    uint8_t mac[6];
+    if (!macStringToUint8(macStr.c_str(), mac)) {
+        Serial.print("Invalid MAC address: ");
+        Serial.println(macStr);
+        return;
+    }
+    addMacAddress(mac, master);
+}
+
+void ESPNow::addMacAddress(const uint8_t *mac, int master) {
+    if (mac == nullptr) return;
     uint8_t *newMac = (uint8_t *) malloc(6 * sizeof(uint8_t));
     if (newMac == nullptr) {
         Serial.println("Memory Allocation Failed !");
         return;
     }
-    macStringToUint8(macStr.c_str(), newMac);
+    memcpy(newMac, mac, 6);
     if (macAddressLen >= MAX_MAC_COUNT) {
         Serial.println("Maximum MAC addresses reached!");
         free(newMac);
         return;
     }
-    macAddressList = (uint8_t **) realloc(macAddressList, (macAddressLen + 1) * sizeof(uint8_t *));
-    if (macAddressList == nullptr) {
+    uint8_t **grown = (uint8_t **) realloc(macAddressList, (macAddressLen + 1) * sizeof(uint8_t *));
+    if (grown == nullptr) {
         free(newMac);
         Serial.println("Memory Reallocation Failed !");
         return;
     }
+    macAddressList = grown;
     macAddressList[macAddressLen] = newMac;
     if (master != -1) setThisDeviceIndex(macAddressLen);
     macAddressLen++;
 }
 
+int ESPNow::getMacCount() {
+    return macAddressLen;
+}
+
+const uint8_t *ESPNow::getMacAddress(int index) {
+    if (index < 0 || index >= macAddressLen) return nullptr;
+    return macAddressList[index];
+}
+
 void ESPNow::debugMacAddressList() {
     Serial.println("Debugging MAC Address List:");
     for (int i = 0; i < macAddressLen; i++) {
@@ -132,13 +155,21 @@ String ESPNow::macAddressToString(uint8_t *macArray) {
     return String(macStr);
 }
 
-void ESPNow::macStringToUint8(const char *macStr, uint8_t *macArray) {
-    char *token = strtok((char *) macStr, ":");
-    int index = 0;
-    while (token != NULL) {
-        macArray[index++] = strtol(token, NULL, 16);
-        token = strtok(NULL, ":");
+bool ESPNow::macStringToUint8(const char *macStr, uint8_t *macArray) {
+    // parsed in place, the string is not modified and a malformed one never writes past 6 bytes
+    const char *cursor = macStr;
+    for (int index = 0; index < 6; index++) {
+        char *end;
+        long value = strtol(cursor, &end, 16);
+        if (end == cursor || value < 0 || value > 0xFF) return false;
+        macArray[index] = value;
+        if (index < 5) {
+            if (*end != ':' && *end != '-') return false;
+            end++;
+        }
+        cursor = end;
     }
+    return true;
 }
 
 void ESPNow::getData(void *__restrict destination, const void *__restrict message, size_t len) {
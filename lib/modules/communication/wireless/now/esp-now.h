@@ -29,12 +29,15 @@ public:
     int getThisDeviceIndex();
     int getThisDeviceIndexByMacAddress();
     void addMacAddress(String macStr, int master = -1);
+    void addMacAddress(const uint8_t *mac, int master = -1);
+    int getMacCount();
+    const uint8_t *getMacAddress(int index);
     void debugMacAddressList();
 
     esp_err_t sendData(const uint8_t *peer_addr, const uint8_t *data, size_t len);
     bool broadcastData(const uint8_t *data, size_t len, void (*err_callback)() = nullptr);
     String macAddressToString(uint8_t *macArray);
-    void macStringToUint8(const char *macStr, uint8_t *macArray);
+    bool macStringToUint8(const char *macStr, uint8_t *macArray);
 
     void getData(void *__restrict, const void *__restrict, size_t);
 
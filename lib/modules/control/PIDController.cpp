@@ -67,6 +67,7 @@ PIDController::PIDController(float p, float i, float d, float timeStep, float mi
     foundResponseTime = false;
 
     eepromAddress = 0;
+    recordStore = nullptr;
 }
 
 PIDController::~PIDController() {
@@ -689,7 +690,17 @@ void PIDController::setEEPROMAddress(int address) {
     eepromAddress = address;
 }
 
+void PIDController::setRecordStore(RecordStore *store) {
+    recordStore = store;
+}
+
 bool PIDController::saveParametersToEEPROM() const {
+    if (recordStore) {
+        // keyed by the eeprom address, unchanged parameters cost no write
+        float parameters[9] = {kp, ki, kd, outputMin, outputMax, integralMax, deadband, ultimateGain, ultimatePeriod};
+        return recordStore->put(eepromAddress, parameters);
+    }
+
     int addr = eepromAddress;
 
 #if IS_ESP
@@ -729,6 +740,23 @@ bool PIDController::saveParametersToEEPROM() const {
 }
 
 bool PIDController::loadParametersFromEEPROM() {
+    if (recordStore) {
+        float parameters[9];
+        if (!recordStore->get(eepromAddress, parameters)) {
+            return false;
+        }
+        kp = parameters[0];
+        ki = parameters[1];
+        kd = parameters[2];
+        outputMin = parameters[3];
+        outputMax = parameters[4];
+        integralMax = parameters[5];
+        deadband = parameters[6];
+        ultimateGain = parameters[7];
+        ultimatePeriod = parameters[8];
+        return true;
+    }
+
     int addr = eepromAddress;
 
 #if IS_ESP
@@ -2,6 +2,7 @@
 #define PID_CONTROLLER_H
 
 #include <Arduino.h>
+#include "../file/RecordStore.h"
 
 // Platform detection
 #if defined(ESP32) || defined(ESP8266)
@@ -84,6 +85,7 @@ private:
     // EEPROM settings
     int eepromAddress;
     const int eepromSize = 32;  // Bytes needed for parameters
+    RecordStore *recordStore;
 
     void updatePerformanceMetrics();
     void calculateZieglerNicholsParameters(char tuningType);
@@ -146,6 +148,7 @@ public:
 
     // EEPROM operations
     void setEEPROMAddress(int address);
+    void setRecordStore(RecordStore *store);
     bool saveParametersToEEPROM() const;
     bool loadParametersFromEEPROM();
 };
@@ -0,0 +1,330 @@
+#include "RecordStore.h"
+
+RecordStore::RecordStore()
+        : baseAddress(0),
+          bankSize(0),
+          activeBank(0),
+          sequence(0),
+          writeOffset(RECORD_STORE_BANK_HEADER_SIZE),
+          mounted(false),
+          compactions(0),
+          indexCount(0) {
+}
+
+bool RecordStore::begin(uint16_t _baseAddress, uint16_t size) {
+    baseAddress = _baseAddress;
+    bankSize = size / 2;
+    mounted = false;
+    if (bankSize < RECORD_STORE_BANK_HEADER_SIZE + RECORD_STORE_RECORD_HEADER_SIZE + 1) {
+        return false;
+    }
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+    if (!EEPROM.begin(_baseAddress + size)) {
+        return false;
+    }
+#endif
+
+    uint16_t sequence0 = 0;
+    uint16_t sequence1 = 0;
+    bool valid0 = readBankHeader(0, sequence0);
+    bool valid1 = readBankHeader(1, sequence1);
+
+    if (!valid0 && !valid1) {
+        format();
+        return mounted;
+    }
+
+    if (valid0 && valid1) {
+        activeBank = (int16_t) (sequence1 - sequence0) > 0 ? 1 : 0;
+    } else {
+        activeBank = valid1 ? 1 : 0;
+    }
+    sequence = activeBank ? sequence1 : sequence0;
+    mounted = true;
+    scan();
+    return true;
+}
+
+void RecordStore::format() {
+    // move past any generation still on the medium so its records can never validate again
+    uint16_t sequence0 = 0;
+    uint16_t sequence1 = 0;
+    uint16_t next = 1;
+    if (readBankHeader(0, sequence0)) next = sequence0 + 1;
+    if (readBankHeader(1, sequence1) && (int16_t) (sequence1 + 1 - next) > 0) next = sequence1 + 1;
+
+    for (uint8_t i = 0; i < RECORD_STORE_BANK_HEADER_SIZE; i++) {
+        writeByte(bankAddress(1) + i, 0xFF);
+    }
+    writeBankHeader(0, next);
+    commit();
+
+    activeBank = 0;
+    sequence = next;
+    mounted = true;
+    scan();
+}
+
+bool RecordStore::isMounted() const {
+    return mounted;
+}
+
+bool RecordStore::write(uint16_t key, const void *data, uint8_t length) {
+    if (!mounted || (length > 0 && data == nullptr)) return false;
+
+    const auto *bytes = (const uint8_t *) data;
+    int8_t position = findIndex(key);
+    if (position >= 0 && index[position].length == length && payloadEquals(index[position].offset, bytes, length)) {
+        return true;
+    }
+    if (position < 0 && length == 0) return true;
+    if (position < 0 && indexCount >= RECORD_STORE_MAX_KEYS) return false;
+
+    uint16_t needed = RECORD_STORE_RECORD_HEADER_SIZE + length;
+    if (writeOffset + needed > bankSize) {
+        return compactWith(key, bytes, length, true);
+    }
+
+    uint16_t offset = writeOffset;
+    writeOffset = appendRecord(activeBank, offset, sequence, key, bytes, length);
+    commit();
+    return updateIndex(key, offset, length);
+}
+
+uint8_t RecordStore::read(uint16_t key, void *data, uint8_t maxLength) const {
+    int8_t position = findIndex(key);
+    if (position < 0) return 0;
+
+    auto *bytes = (uint8_t *) data;
+    uint16_t address = bankAddress(activeBank) + index[position].offset + RECORD_STORE_RECORD_HEADER_SIZE;
+    uint8_t length = index[position].length;
+    for (uint8_t i = 0; i < length && i < maxLength; i++) {
+        bytes[i] = EEPROM.read(address + i);
+    }
+    return length;
+}
+
+bool RecordStore::contains(uint16_t key) const {
+    return findIndex(key) >= 0;
+}
+
+uint8_t RecordStore::getLength(uint16_t key) const {
+    int8_t position = findIndex(key);
+    return position < 0 ? 0 : index[position].length;
+}
+
+bool RecordStore::remove(uint16_t key) {
+    return write(key, nullptr, 0);
+}
+
+bool RecordStore::compact() {
+    if (!mounted) return false;
+    return compactWith(0, nullptr, 0, false);
+}
+
+uint16_t RecordStore::getFreeSpace() const {
+    return mounted ? bankSize - writeOffset : 0;
+}
+
+uint16_t RecordStore::getSequence() const {
+    return sequence;
+}
+
+uint8_t RecordStore::getRecordCount() const {
+    return indexCount;
+}
+
+uint32_t RecordStore::getCompactionCount() const {
+    return compactions;
+}
+
+uint16_t RecordStore::bankAddress(uint8_t bank) const {
+    return baseAddress + bank * bankSize;
+}
+
+bool RecordStore::readBankHeader(uint8_t bank, uint16_t &bankSequence) const {
+    uint8_t header[RECORD_STORE_BANK_HEADER_SIZE];
+    uint16_t address = bankAddress(bank);
+    for (uint8_t i = 0; i < RECORD_STORE_BANK_HEADER_SIZE; i++) {
+        header[i] = EEPROM.read(address + i);
+    }
+    uint16_t magic = header[0] | (header[1] << 8);
+    uint16_t crc = header[4] | (header[5] << 8);
+    if (magic != RECORD_STORE_MAGIC || crc != crc16(header, 4)) return false;
+    bankSequence = header[2] | (header[3] << 8);
+    return true;
+}
+
+void RecordStore::writeBankHeader(uint8_t bank, uint16_t bankSequence) {
+    uint8_t header[RECORD_STORE_BANK_HEADER_SIZE];
+    header[0] = RECORD_STORE_MAGIC & 0xFF;
+    header[1] = RECORD_STORE_MAGIC >> 8;
+    header[2] = bankSequence & 0xFF;
+    header[3] = bankSequence >> 8;
+    uint16_t crc = crc16(header, 4);
+    header[4] = crc & 0xFF;
+    header[5] = crc >> 8;
+
+    uint16_t address = bankAddress(bank);
+    for (uint8_t i = 0; i < RECORD_STORE_BANK_HEADER_SIZE; i++) {
+        writeByte(address + i, header[i]);
+    }
+}
+
+void RecordStore::scan() {
+    indexCount = 0;
+    uint16_t address = bankAddress(activeBank);
+    uint16_t offset = RECORD_STORE_BANK_HEADER_SIZE;
+
+    while (offset + RECORD_STORE_RECORD_HEADER_SIZE <= bankSize) {
+        uint8_t header[RECORD_STORE_RECORD_HEADER_SIZE];
+        for (uint8_t i = 0; i < RECORD_STORE_RECORD_HEADER_SIZE; i++) {
+            header[i] = EEPROM.read(address + offset + i);
+        }
+        uint8_t length = header[2];
+        if (header[3] != (uint8_t) sequence) break;
+        if (offset + RECORD_STORE_RECORD_HEADER_SIZE + length > bankSize) break;
+
+        uint16_t crc = crc16(header, 4, 0xFFFF ^ sequence);
+        for (uint8_t i = 0; i < length; i++) {
+            uint8_t value = EEPROM.read(address + offset + RECORD_STORE_RECORD_HEADER_SIZE + i);
+            crc = crc16(&value, 1, crc);
+        }
+        if (crc != (uint16_t) (header[4] | (header[5] << 8))) break;
+
+        updateIndex(header[0] | (header[1] << 8), offset, length);
+        offset += RECORD_STORE_RECORD_HEADER_SIZE + length;
+    }
+    writeOffset = offset;
+}
+
+int8_t RecordStore::findIndex(uint16_t key) const {
+    for (uint8_t i = 0; i < indexCount; i++) {
+        if (index[i].key == key) return i;
+    }
+    return -1;
+}
+
+bool RecordStore::updateIndex(uint16_t key, uint16_t offset, uint8_t length) {
+    int8_t position = findIndex(key);
+    if (length == 0) {
+        if (position >= 0) index[position] = index[--indexCount];
+        return true;
+    }
+    if (position < 0) {
+        if (indexCount >= RECORD_STORE_MAX_KEYS) return false;
+        position = indexCount++;
+    }
+    index[position].key = key;
+    index[position].offset = offset;
+    index[position].length = length;
+    return true;
+}
+
+bool RecordStore::payloadEquals(uint16_t offset, const uint8_t *data, uint8_t length) const {
+    uint16_t address = bankAddress(activeBank) + offset + RECORD_STORE_RECORD_HEADER_SIZE;
+    for (uint8_t i = 0; i < length; i++) {
+        if (EEPROM.read(address + i) != data[i]) return false;
+    }
+    return true;
+}
+
+uint16_t RecordStore::appendRecord(uint8_t bank, uint16_t offset, uint16_t bankSequence, uint16_t key,
+                                   const uint8_t *data, uint8_t length) {
+    uint8_t header[RECORD_STORE_RECORD_HEADER_SIZE];
+    uint16_t crc = fillRecordHeader(header, bankSequence, key, length);
+    crc = crc16(data, length, crc);
+
+    // payload first, header last: a torn write fails the crc and ends the log there
+    uint16_t address = bankAddress(bank) + offset;
+    for (uint8_t i = 0; i < length; i++) {
+        writeByte(address + RECORD_STORE_RECORD_HEADER_SIZE + i, data[i]);
+    }
+    writeRecordHeader(address, header, crc);
+    return offset + RECORD_STORE_RECORD_HEADER_SIZE + length;
+}
+
+uint16_t RecordStore::copyRecord(uint8_t bank, uint16_t offset, uint16_t bankSequence, const RecordIndex &record) {
+    uint8_t header[RECORD_STORE_RECORD_HEADER_SIZE];
+    uint16_t crc = fillRecordHeader(header, bankSequence, record.key, record.length);
+
+    uint16_t source = bankAddress(activeBank) + record.offset + RECORD_STORE_RECORD_HEADER_SIZE;
+    uint16_t address = bankAddress(bank) + offset;
+    for (uint8_t i = 0; i < record.length; i++) {
+        uint8_t value = EEPROM.read(source + i);
+        crc = crc16(&value, 1, crc);
+        writeByte(address + RECORD_STORE_RECORD_HEADER_SIZE + i, value);
+    }
+    writeRecordHeader(address, header, crc);
+    return offset + RECORD_STORE_RECORD_HEADER_SIZE + record.length;
+}
+
+uint16_t RecordStore::fillRecordHeader(uint8_t *header, uint16_t bankSequence, uint16_t key, uint8_t length) {
+    header[0] = key & 0xFF;
+    header[1] = key >> 8;
+    header[2] = length;
+    header[3] = (uint8_t) bankSequence;
+    return crc16(header, 4, 0xFFFF ^ bankSequence);
+}
+
+void RecordStore::writeRecordHeader(uint16_t address, uint8_t *header, uint16_t crc) {
+    header[4] = crc & 0xFF;
+    header[5] = crc >> 8;
+    for (uint8_t i = 0; i < RECORD_STORE_RECORD_HEADER_SIZE; i++) {
+        writeByte(address + i, header[i]);
+    }
+}
+
+bool RecordStore::compactWith(uint16_t key, const uint8_t *data, uint8_t length, bool hasRecord) {
+    uint16_t needed = RECORD_STORE_BANK_HEADER_SIZE;
+    for (uint8_t i = 0; i < indexCount; i++) {
+        if (hasRecord && index[i].key == key) continue;
+        needed += RECORD_STORE_RECORD_HEADER_SIZE + index[i].length;
+    }
+    if (hasRecord && length > 0) needed += RECORD_STORE_RECORD_HEADER_SIZE + length;
+    if (needed > bankSize) return false;
+
+    uint8_t target = activeBank ^ 1;
+    uint16_t nextSequence = sequence + 1;
+    uint16_t offset = RECORD_STORE_BANK_HEADER_SIZE;
+    for (uint8_t i = 0; i < indexCount; i++) {
+        if (hasRecord && index[i].key == key) continue;
+        offset = copyRecord(target, offset, nextSequence, index[i]);
+    }
+    if (hasRecord && length > 0) {
+        appendRecord(target, offset, nextSequence, key, data, length);
+    }
+
+    // the bank only becomes live once its header lands
+    writeBankHeader(target, nextSequence);
+    commit();
+
+    activeBank = target;
+    sequence = nextSequence;
+    compactions++;
+    scan();
+    return true;
+}
+
+void RecordStore::writeByte(uint16_t address, uint8_t value) {
+    if (EEPROM.read(address) != value) {
+        EEPROM.write(address, value);
+    }
+}
+
+void RecordStore::commit() {
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+    EEPROM.commit();
+#endif
+}
+
+uint16_t RecordStore::crc16(const uint8_t *data, uint16_t length, uint16_t crc) {
+    for (uint16_t i = 0; i < length; i++) {
+        crc ^= (uint16_t) data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#ifndef RECORD_STORE_H
+#define RECORD_STORE_H
+
+#pragma message("[COMPILED]: RecordStore.h")
+
+#include "Arduino.h"
+#include "EEPROM.h"
+
+#ifndef RECORD_STORE_MAX_KEYS
+#if defined(__AVR__)
+#define RECORD_STORE_MAX_KEYS 16
+#else
+#define RECORD_STORE_MAX_KEYS 32
+#endif
+#endif
+
+#define RECORD_STORE_MAGIC 0x4B52
+#define RECORD_STORE_BANK_HEADER_SIZE 6
+#define RECORD_STORE_RECORD_HEADER_SIZE 6
+#define RECORD_STORE_MAX_PAYLOAD 255
+
+// two-bank append log, newest valid record per key wins, bank header written last on compaction
+class RecordStore {
+private:
+    struct RecordIndex {
+        uint16_t key;
+        uint16_t offset;
+        uint8_t length;
+    };
+
+    uint16_t baseAddress;
+    uint16_t bankSize;
+    uint8_t activeBank;
+    uint16_t sequence;
+    uint16_t writeOffset;
+    bool mounted;
+    uint32_t compactions;
+
+    RecordIndex index[RECORD_STORE_MAX_KEYS];
+    uint8_t indexCount;
+
+    uint16_t bankAddress(uint8_t bank) const;
+    bool readBankHeader(uint8_t bank, uint16_t &bankSequence) const;
+    void writeBankHeader(uint8_t bank, uint16_t bankSequence);
+    void scan();
+    int8_t findIndex(uint16_t key) const;
+    bool updateIndex(uint16_t key, uint16_t offset, uint8_t length);
+    bool payloadEquals(uint16_t offset, const uint8_t *data, uint8_t length) const;
+    uint16_t appendRecord(uint8_t bank, uint16_t offset, uint16_t bankSequence, uint16_t key,
+                          const uint8_t *data, uint8_t length);
+    uint16_t copyRecord(uint8_t bank, uint16_t offset, uint16_t bankSequence, const RecordIndex &record);
+    bool compactWith(uint16_t key, const uint8_t *data, uint8_t length, bool hasRecord);
+
+    static uint16_t fillRecordHeader(uint8_t *header, uint16_t bankSequence, uint16_t key, uint8_t length);
+    static void writeRecordHeader(uint16_t address, uint8_t *header, uint16_t crc);
+    static void writeByte(uint16_t address, uint8_t value);
+    static void commit();
+
+public:
+    RecordStore();
+
+    bool begin(uint16_t _baseAddress, uint16_t size);
+    void format();
+    bool isMounted() const;
+
+    bool write(uint16_t key, const void *data, uint8_t length);
+    uint8_t read(uint16_t key, void *data, uint8_t maxLength) const;
+    bool contains(uint16_t key) const;
+    uint8_t getLength(uint16_t key) const;
+    bool remove(uint16_t key);
+    bool compact();
+
+    template<typename T>
+    bool put(uint16_t key, const T &value) {
+        return write(key, &value, sizeof(T));
+    }
+
+    template<typename T>
+    bool get(uint16_t key, T &value) const {
+        return read(key, &value, sizeof(T)) == sizeof(T);
+    }
+
+    uint16_t getFreeSpace() const;
+    uint16_t getSequence() const;
+    uint8_t getRecordCount() const;
+    uint32_t getCompactionCount() const;
+
+    static uint16_t crc16(const uint8_t *data, uint16_t length, uint16_t crc = 0xFFFF);
+};
+
+#endif  // RECORD_STORE_H
\ No newline at end of file
@@ -0,0 +1,363 @@
+/*
+ *  continuous-adc.cpp
+ *
+ *  continuous adc module c
+ *  Created on: 2026. 10. 18
+ */
+
+#include "continuous-adc.h"
+
+#ifdef CONTINUOUS_ADC_USE_ISR
+// the buffers are filled from the interrupt, readers take them with interrupts off
+#define CONTINUOUS_ADC_LOCK() uint8_t adcSreg = SREG; cli()
+#define CONTINUOUS_ADC_UNLOCK() SREG = adcSreg
+
+ContinuousADC *ContinuousADC::active = nullptr;
+
+ISR(ADC_vect) {
+    ContinuousADC::onConversion();
+}
+#else
+#define CONTINUOUS_ADC_LOCK()
+#define CONTINUOUS_ADC_UNLOCK()
+#endif
+
+ContinuousADC::ContinuousADC()
+        : channelCount(0),
+          sampleRateHz(20000),
+          running(false),
+          dirty(false),
+          dma(false) {
+#if defined(__AVR__)
+    reference = DEFAULT;
+    nextChannel = 0;
+#endif
+#ifdef CONTINUOUS_ADC_USE_ISR
+    isrChannel = 0;
+#endif
+}
+
+ContinuousADC::~ContinuousADC() {
+    end();
+}
+
+ContinuousADC &ContinuousADC::instance() {
+    static ContinuousADC adc;
+    return adc;
+}
+
+int8_t ContinuousADC::addChannel(uint8_t pin, uint32_t intervalUs) {
+    int8_t index = findChannel(pin);
+    if (index != CONTINUOUS_ADC_NO_CHANNEL) {
+        if (intervalUs < channels[index].intervalUs) channels[index].intervalUs = intervalUs;
+        return index;
+    }
+    if (channelCount >= CONTINUOUS_ADC_MAX_CHANNELS) return CONTINUOUS_ADC_NO_CHANNEL;
+
+    ContinuousADCChannel &channel = channels[channelCount];
+    channel.pin = pin;
+    channel.intervalUs = intervalUs;
+    channel.lastSampleUs = 0;
+    channel.sampleCount = 0;
+    channel.head = 0;
+    channel.count = 0;
+    pinMode(pin, INPUT);
+    dirty = true;
+    return channelCount++;
+}
+
+int8_t ContinuousADC::findChannel(uint8_t pin) const {
+    for (uint8_t i = 0; i < channelCount; i++) {
+        if (channels[i].pin == pin) return i;
+    }
+    return CONTINUOUS_ADC_NO_CHANNEL;
+}
+
+void ContinuousADC::setInterval(int8_t index, uint32_t intervalUs) {
+    if (index < 0 || index >= channelCount) return;
+    channels[index].intervalUs = intervalUs;
+}
+
+void ContinuousADC::setSampleRate(uint32_t hz) {
+    sampleRateHz = hz;
+    dirty = true;
+}
+
+#if defined(__AVR__)
+void ContinuousADC::setReference(uint8_t mode) {
+    reference = mode;
+}
+#endif
+
+bool ContinuousADC::begin() {
+    if (running && !dirty) return true;
+    if (running) end();
+    if (channelCount == 0) return false;
+#ifdef CONTINUOUS_ADC_USE_DMA
+    dma = beginDMA();
+#endif
+#ifdef CONTINUOUS_ADC_USE_ISR
+    if (!startBackground()) return false;
+#endif
+    running = true;
+    dirty = false;
+    return true;
+}
+
+void ContinuousADC::end() {
+    if (!running) return;
+#ifdef CONTINUOUS_ADC_USE_DMA
+    if (dma) {
+        analogContinuousStop();
+        analogContinuousDeinit();
+    }
+#endif
+#ifdef CONTINUOUS_ADC_USE_ISR
+    stopBackground();
+#endif
+    dma = false;
+    running = false;
+}
+
+void ContinuousADC::update() {
+    if (!running || dirty) {
+        if (!begin()) return;
+    }
+#ifdef CONTINUOUS_ADC_USE_DMA
+    if (dma) {
+        drainDMA();
+        return;
+    }
+#endif
+#ifndef CONTINUOUS_ADC_USE_ISR
+    pollChannels();
+#endif
+}
+
+void ContinuousADC::pushSample(ContinuousADCChannel &channel, uint16_t value, uint32_t now) {
+    channel.samples[channel.head] = value;
+    channel.head = (channel.head + 1) % CONTINUOUS_ADC_BUFFER_SIZE;
+    if (channel.count < CONTINUOUS_ADC_BUFFER_SIZE) channel.count++;
+    channel.sampleCount++;
+    channel.lastSampleUs = now;
+}
+
+#ifdef CONTINUOUS_ADC_USE_DMA
+bool ContinuousADC::beginDMA() {
+    uint8_t pins[CONTINUOUS_ADC_MAX_CHANNELS];
+    for (uint8_t i = 0; i < channelCount; i++) pins[i] = channels[i].pin;
+    if (!analogContinuous(pins, channelCount, 4, sampleRateHz, nullptr)) return false;
+    if (!analogContinuousStart()) {
+        analogContinuousDeinit();
+        return false;
+    }
+    return true;
+}
+
+void ContinuousADC::drainDMA() {
+    adc_continuous_data_t *result = nullptr;
+    if (!analogContinuousRead(&result, 0) || result == nullptr) return;
+    uint32_t now = micros();
+    for (uint8_t i = 0; i < channelCount; i++) {
+        ContinuousADCChannel &channel = channels[i];
+        if (channel.count > 0 && now - channel.lastSampleUs < channel.intervalUs) continue;
+        pushSample(channel, (uint16_t) result[i].avg_read_raw, now);
+    }
+}
+#endif
+
+#if defined(__AVR__)
+void ContinuousADC::selectChannel(uint8_t index) {
+    uint8_t pin = channels[index].pin;
+    if (pin >= A0) pin -= A0;
+#if defined(analogPinToChannel)
+    pin = analogPinToChannel(pin);
+#endif
+#if defined(ADCSRB) && defined(MUX5)
+    ADCSRB = (ADCSRB & ~(1 << MUX5)) | (((pin >> 3) & 0x01) << MUX5);
+#endif
+    ADMUX = (reference << 6) | (pin & 0x07);
+}
+
+uint16_t ContinuousADC::convert(uint8_t index) {
+    selectChannel(index);
+    ADCSRA |= (1 << ADSC);
+    while (bit_is_set(ADCSRA, ADSC));
+    uint8_t low = ADCL;
+    uint8_t high = ADCH;
+    return (high << 8) | low;
+}
+#endif
+
+#ifdef CONTINUOUS_ADC_USE_ISR
+bool ContinuousADC::startBackground() {
+    if (active != nullptr && active != this) return false;
+    // an analogRead() may still be converting, its flag must not reach the interrupt
+    while (bit_is_set(ADCSRA, ADSC));
+    active = this;
+    isrChannel = 0;
+    selectChannel(0);
+    ADCSRA |= (1 << ADIF) | (1 << ADIE);
+    ADCSRA |= (1 << ADSC);
+    return true;
+}
+
+void ContinuousADC::stopBackground() {
+    if (active != this) return;
+    ADCSRA &= ~(1 << ADIE);
+    while (bit_is_set(ADCSRA, ADSC));
+    active = nullptr;
+}
+
+void ContinuousADC::handleConversion() {
+    uint8_t low = ADCL;
+    uint8_t high = ADCH;
+    uint32_t now = micros();
+    ContinuousADCChannel &channel = channels[isrChannel];
+    if (channel.count == 0 || now - channel.lastSampleUs >= channel.intervalUs) {
+        pushSample(channel, (high << 8) | low, now);
+    }
+    // the next channel starts right away, a channel that is not due just skips its result
+    isrChannel = (isrChannel + 1) % channelCount;
+    selectChannel(isrChannel);
+    ADCSRA |= (1 << ADSC);
+}
+
+void ContinuousADC::onConversion() {
+    if (active != nullptr) active->handleConversion();
+}
+#endif
+
+void ContinuousADC::pollChannels() {
+    uint32_t now = micros();
+#if defined(__AVR__)
+    // one due channel per call keeps update() to a single ~110 us conversion
+    for (uint8_t n = 0; n < channelCount; n++) {
+        uint8_t index = (nextChannel + n) % channelCount;
+        ContinuousADCChannel &channel = channels[index];
+        if (channel.count > 0 && now - channel.lastSampleUs < channel.intervalUs) continue;
+        pushSample(channel, convert(index), now);
+        nextChannel = (index + 1) % channelCount;
+        return;
+    }
+#else
+    for (uint8_t i = 0; i < channelCount; i++) {
+        ContinuousADCChannel &channel = channels[i];
+        if (channel.count > 0 && now - channel.lastSampleUs < channel.intervalUs) continue;
+        pushSample(channel, analogRead(channel.pin), now);
+    }
+#endif
+}
+
+uint8_t ContinuousADC::available(int8_t index) const {
+    if (index < 0 || index >= channelCount) return 0;
+    return channels[index].count;
+}
+
+uint32_t ContinuousADC::getSampleCount(int8_t index) const {
+    if (index < 0 || index >= channelCount) return 0;
+    CONTINUOUS_ADC_LOCK();
+    uint32_t count = channels[index].sampleCount;
+    CONTINUOUS_ADC_UNLOCK();
+    return count;
+}
+
+uint16_t ContinuousADC::getLatest(int8_t index) const {
+    if (index < 0 || index >= channelCount || channels[index].count == 0) return 0;
+    const ContinuousADCChannel &channel = channels[index];
+    CONTINUOUS_ADC_LOCK();
+    uint16_t value = channel.samples[(channel.head + CONTINUOUS_ADC_BUFFER_SIZE - 1) % CONTINUOUS_ADC_BUFFER_SIZE];
+    CONTINUOUS_ADC_UNLOCK();
+    return value;
+}
+
+float ContinuousADC::getAverage(int8_t index, uint8_t samples) const {
+    if (index < 0 || index >= channelCount || channels[index].count == 0) return 0.0f;
+    const ContinuousADCChannel &channel = channels[index];
+    CONTINUOUS_ADC_LOCK();
+    if (samples == 0 || samples > channel.count) samples = channel.count;
+    uint32_t sum = 0;
+    uint8_t position = channel.head;
+    for (uint8_t i = 0; i < samples; i++) {
+        position = (position + CONTINUOUS_ADC_BUFFER_SIZE - 1) % CONTINUOUS_ADC_BUFFER_SIZE;
+        sum += channel.samples[position];
+    }
+    CONTINUOUS_ADC_UNLOCK();
+    return (float) sum / samples;
+}
+
+float ContinuousADC::getTrimmedAverage(int8_t index, uint8_t samples) const {
+    if (index < 0 || index >= channelCount || channels[index].count == 0) return 0.0f;
+    const ContinuousADCChannel &channel = channels[index];
+    uint16_t recent[CONTINUOUS_ADC_BUFFER_SIZE];
+    CONTINUOUS_ADC_LOCK();
+    if (samples == 0 || samples > channel.count) samples = channel.count;
+    uint8_t position = channel.head;
+    for (uint8_t i = 0; i < samples; i++) {
+        position = (position + CONTINUOUS_ADC_BUFFER_SIZE - 1) % CONTINUOUS_ADC_BUFFER_SIZE;
+        recent[i] = channel.samples[position];
+    }
+    CONTINUOUS_ADC_UNLOCK();
+
+    uint16_t sorted[CONTINUOUS_ADC_BUFFER_SIZE];
+    for (uint8_t i = 0; i < samples; i++) {
+        uint16_t value = recent[i];
+        int8_t j = i - 1;
+        while (j >= 0 && sorted[j] > value) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = value;
+    }
+
+    uint8_t start = samples / 4;
+    uint8_t end = samples - start;
+    uint32_t sum = 0;
+    for (uint8_t i = start; i < end; i++) sum += sorted[i];
+    return (float) sum / (end - start);
+}
+
+uint8_t ContinuousADC::read(int8_t index, uint16_t *output, uint8_t maxSamples, uint8_t decimation) const {
+    if (index < 0 || index >= channelCount || output == nullptr) return 0;
+    if (decimation == 0) decimation = 1;
+    const ContinuousADCChannel &channel = channels[index];
+    CONTINUOUS_ADC_LOCK();
+    uint8_t oldest = (channel.head + CONTINUOUS_ADC_BUFFER_SIZE - channel.count) % CONTINUOUS_ADC_BUFFER_SIZE;
+    uint8_t written = 0;
+    for (uint8_t i = 0; i + decimation <= channel.count && written < maxSamples; i += decimation) {
+        uint32_t sum = 0;
+        for (uint8_t k = 0; k < decimation; k++) {
+            sum += channel.samples[(oldest + i + k) % CONTINUOUS_ADC_BUFFER_SIZE];
+        }
+        output[written++] = sum / decimation;
+    }
+    CONTINUOUS_ADC_UNLOCK();
+    return written;
+}
+
+bool ContinuousADC::isRunning() const {
+    return running;
+}
+
+bool ContinuousADC::isContinuous() const {
+    return dma;
+}
+
+uint8_t ContinuousADC::getChannelCount() const {
+    return channelCount;
+}
+
+float ContinuousADC::readAverage(int8_t index, uint8_t pin, uint8_t samples) {
+    if (index == CONTINUOUS_ADC_NO_CHANNEL) return analogRead(pin);
+    ContinuousADC &adc = instance();
+    adc.update();
+#ifdef CONTINUOUS_ADC_USE_ISR
+    // the interrupt owns the ADC, wait for its first pass over the channels instead of converting here
+    uint32_t start = micros();
+    while (adc.available(index) == 0 && micros() - start < 2000UL);
+    if (adc.available(index) == 0) return 0.0f;
+#else
+    if (adc.available(index) == 0) return analogRead(pin);
+#endif
+    return adc.getAverage(index, samples);
+}
\ No newline at end of file
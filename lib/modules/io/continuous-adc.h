@@ -0,0 +1,133 @@
+/*
+ *  continuous-adc.h
+ *
+ *  continuous adc module header
+ *  Created on: 2026. 10. 18
+ */
+
+#pragma once
+
+#ifndef KADITA_CONTINUOUS_ADC_H
+#define KADITA_CONTINUOUS_ADC_H
+
+#include "Arduino.h"
+
+#pragma message("[COMPILED]: continuous-adc.h")
+
+#if defined(ESP32) && defined(ESP_ARDUINO_VERSION_MAJOR) && !defined(CONTINUOUS_ADC_DISABLE_DMA)
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+#define CONTINUOUS_ADC_USE_DMA
+#endif
+#endif
+
+/*
+Without DMA the channels are sampled from update(). On AVR, CONTINUOUS_ADC_AVR_BACKGROUND moves
+the sampling into the ADC interrupt: conversions run back to back over all channels and fill the
+buffers without update(). The interrupt then owns the ADC, every analog input of the sketch has to
+be a channel, a plain analogRead() would take a conversion away from it.
+*/
+#if defined(__AVR__) && defined(CONTINUOUS_ADC_AVR_BACKGROUND)
+#define CONTINUOUS_ADC_USE_ISR
+#endif
+
+#ifndef CONTINUOUS_ADC_MAX_CHANNELS
+#if defined(__AVR__)
+#define CONTINUOUS_ADC_MAX_CHANNELS 4
+#else
+#define CONTINUOUS_ADC_MAX_CHANNELS 8
+#endif
+#endif
+
+#ifndef CONTINUOUS_ADC_BUFFER_SIZE
+#if defined(__AVR__)
+#define CONTINUOUS_ADC_BUFFER_SIZE 16
+#else
+#define CONTINUOUS_ADC_BUFFER_SIZE 32
+#endif
+#endif
+
+#define CONTINUOUS_ADC_NO_CHANNEL (-1)
+
+struct ContinuousADCChannel {
+    uint8_t pin;
+    uint32_t intervalUs;
+    uint32_t lastSampleUs;
+    uint32_t sampleCount;
+    uint16_t samples[CONTINUOUS_ADC_BUFFER_SIZE];
+    uint8_t head;
+    uint8_t count;
+};
+
+class ContinuousADC {
+private:
+    ContinuousADCChannel channels[CONTINUOUS_ADC_MAX_CHANNELS];
+    uint8_t channelCount;
+    uint32_t sampleRateHz;
+    bool running;
+    bool dirty;
+    bool dma;
+
+#if defined(__AVR__)
+    uint8_t reference;
+    uint8_t nextChannel;
+
+    void selectChannel(uint8_t index);
+    // runs one conversion to the end, analogRead() elsewhere always finds the ADC idle
+    uint16_t convert(uint8_t index);
+#endif
+
+#ifdef CONTINUOUS_ADC_USE_ISR
+    static ContinuousADC *active;
+    volatile uint8_t isrChannel;
+
+    bool startBackground();
+    void stopBackground();
+    void handleConversion();
+#endif
+
+#ifdef CONTINUOUS_ADC_USE_DMA
+    bool beginDMA();
+    void drainDMA();
+#endif
+
+    void pushSample(ContinuousADCChannel &channel, uint16_t value, uint32_t now);
+    void pollChannels();
+
+public:
+    ContinuousADC();
+    ~ContinuousADC();
+
+    static ContinuousADC &instance();
+
+    int8_t addChannel(uint8_t pin, uint32_t intervalUs = 1000);
+    int8_t findChannel(uint8_t pin) const;
+    void setInterval(int8_t index, uint32_t intervalUs);
+    void setSampleRate(uint32_t hz);
+#if defined(__AVR__)
+    void setReference(uint8_t mode);
+#endif
+
+    bool begin();
+    void end();
+    void update();
+
+    uint8_t available(int8_t index) const;
+    uint32_t getSampleCount(int8_t index) const;
+    uint16_t getLatest(int8_t index) const;
+    float getAverage(int8_t index, uint8_t samples = 0) const;
+    float getTrimmedAverage(int8_t index, uint8_t samples = 0) const;
+    uint8_t read(int8_t index, uint16_t *output, uint8_t maxSamples, uint8_t decimation = 1) const;
+
+    bool isRunning() const;
+    bool isContinuous() const;
+    uint8_t getChannelCount() const;
+
+    static float readAverage(int8_t index, uint8_t pin, uint8_t samples = 0);
+
+#ifdef CONTINUOUS_ADC_USE_ISR
+    // called from the ADC interrupt
+    static void onConversion();
+#endif
+};
+
+#endif  // KADITA_CONTINUOUS_ADC_H
\ No newline at end of file
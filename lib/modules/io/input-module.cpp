@@ -247,22 +247,33 @@ DigitalInBase *DigitalInBase::stop() {
 ////////////////////////////////////////////////////////////////////////
 
 DigitalInI2C::DigitalInI2C(int pin)
-        : DigitalInBase(pin) {
+        : DigitalInBase(pin), pcf8574(nullptr), cache(nullptr), address(0) {
 
 }
 
 DigitalInI2C::DigitalInI2C(int pin, int mode)
-        : DigitalInBase(pin, mode) {
+        : DigitalInBase(pin, mode), pcf8574(nullptr), cache(nullptr), address(0) {
 
 }
 
 void DigitalInI2C::init(PCF8574 *_pcf8574) {
     pcf8574 = _pcf8574;
+    cache = nullptr;
+    previousSteadyState = getStateRaw();
+    lastSteadyState = previousSteadyState;
+    lastFlickerableState = previousSteadyState;
+}
+
+void DigitalInI2C::init(PCF8574PortCache *_cache, uint8_t _address) {
+    cache = _cache;
+    address = _address;
+    cache->setInput(address, btnPin);
     previousSteadyState = getStateRaw();
     lastSteadyState = previousSteadyState;
     lastFlickerableState = previousSteadyState;
 }
 
 int DigitalInI2C::getStateRaw() const {
+    if (cache != nullptr) return cache->read(address, btnPin);
     return pcf8574->digitalRead(btnPin);
 }
\ No newline at end of file
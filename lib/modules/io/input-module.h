@@ -10,6 +10,7 @@
 
 #include "Arduino.h"
 #include "PCF8574.h"
+#include "pcf8574-port-cache.h"
 
 #pragma message("[COMPILED]: input-module.h")
 
@@ -88,10 +89,14 @@ public:
 class DigitalInI2C : public DigitalInBase {
 private:
     PCF8574 *pcf8574;
+    PCF8574PortCache *cache;
+    uint8_t address;
 public:
     explicit DigitalInI2C(int pin);
     DigitalInI2C(int pin, int mode);
     void init(PCF8574 *_pcf8574);
+    // reads the pin from the port byte the cache fetched, update the cache first on every loop
+    void init(PCF8574PortCache *_cache, uint8_t _address);
     int getStateRaw() const override;
 };
 
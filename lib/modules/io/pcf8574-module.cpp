@@ -3,12 +3,16 @@
 PCF8574Module::PCF8574Module(uint8_t address) : pcf(address) {
     useInterrupt = false;
     ledStatus = 0;
+    cache = nullptr;
+    this->address = address;
 }
 
 PCF8574Module::PCF8574Module(uint8_t address, uint8_t interruptPin, void (*interruptFunction)())
         : pcf(address, interruptPin, interruptFunction) {
     useInterrupt = true;
     ledStatus = 0;
+    cache = nullptr;
+    this->address = address;
 }
 
 PCF8574Module::PCF8574Module(uint8_t address, int sda, int scl)
@@ -20,6 +24,8 @@ PCF8574Module::PCF8574Module(uint8_t address, int sda, int scl)
 {
     useInterrupt = false;
     ledStatus = 0;
+    cache = nullptr;
+    this->address = address;
 }
 
 PCF8574Module::PCF8574Module(uint8_t address, int sda, int scl, uint8_t interruptPin, void (*interruptFunction)())
@@ -31,6 +37,8 @@ PCF8574Module::PCF8574Module(uint8_t address, int sda, int scl, uint8_t interrup
 {
     useInterrupt = true;
     ledStatus = 0;
+    cache = nullptr;
+    this->address = address;
 }
 
 #if defined(ESP32) || defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_RENESAS)
@@ -39,12 +47,16 @@ PCF8574Module::PCF8574Module(TwoWire *wire, uint8_t address)
         : pcf(wire, address) {
     useInterrupt = false;
     ledStatus = 0;
+    cache = nullptr;
+    this->address = address;
 }
 
 PCF8574Module::PCF8574Module(TwoWire *wire, uint8_t address, uint8_t interruptPin, void (*interruptFunction)())
         : pcf(wire, address, interruptPin, interruptFunction) {
     useInterrupt = true;
     ledStatus = 0;
+    cache = nullptr;
+    this->address = address;
 }
 
 #endif
@@ -55,12 +67,16 @@ PCF8574Module::PCF8574Module(TwoWire *wire, uint8_t address, int sda, int scl)
         : pcf(wire, address, sda, scl) {
     useInterrupt = false;
     ledStatus = 0;
+    cache = nullptr;
+    this->address = address;
 }
 
 PCF8574Module::PCF8574Module(TwoWire *wire, uint8_t address, int sda, int scl, uint8_t interruptPin, void (*interruptFunction)())
         : pcf(wire, address, sda, scl, interruptPin, interruptFunction) {
     useInterrupt = true;
     ledStatus = 0;
+    cache = nullptr;
+    this->address = address;
 }
 
 #endif
@@ -69,7 +85,21 @@ bool PCF8574Module::begin() {
     return pcf.begin();
 }
 
+void PCF8574Module::attachCache(PCF8574PortCache *portCache) {
+    cache = portCache;
+    if (cache != nullptr) cache->attach(address);
+}
+
 void PCF8574Module::setupPin(uint8_t pin, uint8_t mode, uint8_t initialState) {
+    if (cache != nullptr) {
+        if (mode == PCF_OUTPUT) {
+            setupLED(pin, initialState);
+        } else {
+            cache->setInput(address, pin);
+        }
+        return;
+    }
+
     switch (mode) {
         case PCF_INPUT:
             pcf.pinMode(pin, INPUT);
@@ -89,6 +119,7 @@ void PCF8574Module::setupPin(uint8_t pin, uint8_t mode, uint8_t initialState) {
 }
 
 uint8_t PCF8574Module::digitalRead(uint8_t pin) {
+    if (cache != nullptr) return cache->read(address, pin);
     return pcf.digitalRead(pin);
 }
 
@@ -98,10 +129,16 @@ bool PCF8574Module::digitalWrite(uint8_t pin, uint8_t value) {
     } else {
         ledStatus &= ~(1 << pin);
     }
+    if (cache != nullptr) {
+        cache->write(address, pin, value);
+        return true;
+    }
     return pcf.digitalWrite(pin, value);
 }
 
 byte PCF8574Module::digitalReadAll() {
+    if (cache != nullptr) return cache->readAll(address);
+
 #ifdef PCF8574_LOW_MEMORY
     return pcf.digitalReadAll();
 #else
@@ -121,6 +158,10 @@ byte PCF8574Module::digitalReadAll() {
 
 bool PCF8574Module::digitalWriteAll(byte values) {
     ledStatus = values;
+    if (cache != nullptr) {
+        cache->writeAll(address, values);
+        return true;
+    }
 
 #ifdef PCF8574_LOW_MEMORY
     return pcf.digitalWriteAll(values);
@@ -139,15 +180,23 @@ bool PCF8574Module::digitalWriteAll(byte values) {
 }
 
 void PCF8574Module::setupButton(uint8_t pin) {
+    if (cache != nullptr) {
+        cache->setInput(address, pin);
+        return;
+    }
     pcf.pinMode(pin, INPUT_PULLUP);
 }
 
 bool PCF8574Module::readButton(uint8_t pin) {
-    return pcf.digitalRead(pin) == LOW;
+    return digitalRead(pin) == LOW;
 }
 
 void PCF8574Module::setupLED(uint8_t pin, uint8_t initialState) {
-    pcf.pinMode(pin, OUTPUT, initialState);
+    if (cache != nullptr) {
+        cache->setOutput(address, pin, initialState);
+    } else {
+        pcf.pinMode(pin, OUTPUT, initialState);
+    }
     if (initialState == HIGH) {
         ledStatus |= (1 << pin);
     } else {
@@ -156,13 +205,11 @@ void PCF8574Module::setupLED(uint8_t pin, uint8_t initialState) {
 }
 
 bool PCF8574Module::turnOnLED(uint8_t pin) {
-    ledStatus |= (1 << pin);
-    return pcf.digitalWrite(pin, HIGH);
+    return digitalWrite(pin, HIGH);
 }
 
 bool PCF8574Module::turnOffLED(uint8_t pin) {
-    ledStatus &= ~(1 << pin);
-    return pcf.digitalWrite(pin, LOW);
+    return digitalWrite(pin, LOW);
 }
 
 bool PCF8574Module::toggleLED(uint8_t pin) {
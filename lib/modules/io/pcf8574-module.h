@@ -3,6 +3,7 @@
 
 #include "Arduino.h"
 #include "PCF8574.h"
+#include "pcf8574-port-cache.h"
 
 #define PCF_INPUT 0
 #define PCF_INPUT_PULLUP 1
@@ -49,10 +50,17 @@ public:
     void setupEncoder(uint8_t pinA, uint8_t pinB);
     bool readEncoder(uint8_t pinA, uint8_t pinB, volatile long *encoderValue, bool reverseRotation = false);
 
+    // pins and LEDs go through the bus cache from here on, attach before setting them up;
+    // the encoder keeps reading the chip directly
+    void attachCache(PCF8574PortCache *portCache);
+
     PCF8574 *getPCF() { return &pcf; }
+    PCF8574PortCache *getCache() { return cache; }
 
 private:
     PCF8574 pcf;
+    PCF8574PortCache *cache;
+    uint8_t address;
     bool useInterrupt;
     byte ledStatus;
 };
@@ -0,0 +1,237 @@
+#ifndef KINEMATRIX_PCF8574_PORT_CACHE_H
+#define KINEMATRIX_PCF8574_PORT_CACHE_H
+
+#include "Arduino.h"
+#include "Wire.h"
+
+/*
+Port cache for PCF8574 expanders sharing one I2C bus, one cache per bus.
+
+- update() reads each expander that has inputs once, every pin read in between comes from that byte
+- pin writes only change a shadow byte, update() or commit() sends each changed port in one transfer
+  and a port that ends up where it was is not sent at all
+- the same address attached twice is the same port, so several modules on one expander share its
+  transfers
+
+The PCF8574 has no direction register, an input is a pin driven HIGH. The cache keeps input bits
+HIGH in every byte it writes, a port is only read when something asked for its inputs. Header only,
+the modules that can run through the cache include it themselves.
+*/
+
+#ifndef PCF8574_PORT_CACHE_MAX_PORTS
+#define PCF8574_PORT_CACHE_MAX_PORTS 8
+#endif
+
+typedef struct {
+    uint32_t reads;      // read transfers on the bus
+    uint32_t writes;     // write transfers on the bus
+    uint32_t errors;     // transfers the expander did not acknowledge
+    uint32_t pinReads;   // pin and port reads answered from the cache
+    uint32_t pinWrites;  // pin and port writes staged in a shadow byte
+} PCF8574BusStats;
+
+class PCF8574PortCache {
+private:
+    struct Port {
+        uint8_t address;
+        uint8_t inputMask;
+        uint8_t input;
+        uint8_t shadow;
+        uint8_t written;
+        bool hasWritten;
+        bool polled;
+        bool online;
+    };
+
+    TwoWire *wire;
+    Port ports[PCF8574_PORT_CACHE_MAX_PORTS];
+    uint8_t portCount;
+    uint32_t pollInterval;
+    uint32_t lastPoll;
+    volatile bool readRequested;
+    PCF8574BusStats stats;
+
+    Port *find(uint8_t address) {
+        for (uint8_t i = 0; i < portCount; i++) {
+            if (ports[i].address == address) return &ports[i];
+        }
+        return nullptr;
+    }
+
+    Port *portFor(uint8_t address) {
+        int8_t index = attach(address);
+        return index < 0 ? nullptr : &ports[index];
+    }
+
+    bool isDirty(const Port &port) const {
+        return !port.hasWritten || (uint8_t) (port.shadow | port.inputMask) != port.written;
+    }
+
+    bool readPort(Port &port) {
+        stats.reads++;
+        if (wire->requestFrom(port.address, (uint8_t) 1) != 1) {
+            stats.errors++;
+            port.online = false;
+            return false;
+        }
+        port.input = wire->read();
+        port.online = true;
+        return true;
+    }
+
+    bool writePort(Port &port) {
+        uint8_t value = port.shadow | port.inputMask;
+        stats.writes++;
+        wire->beginTransmission(port.address);
+        wire->write(value);
+        if (wire->endTransmission() != 0) {
+            // stays dirty, the next flush tries again
+            stats.errors++;
+            port.online = false;
+            return false;
+        }
+        port.written = value;
+        port.hasWritten = true;
+        port.online = true;
+        return true;
+    }
+
+public:
+    explicit PCF8574PortCache(TwoWire *_wire = &Wire)
+            : wire(_wire), portCount(0), pollInterval(0), lastPoll(0), readRequested(false) {
+        resetStats();
+    }
+
+    // the port index for the address, -1 when the table is full
+    int8_t attach(uint8_t address) {
+        for (uint8_t i = 0; i < portCount; i++) {
+            if (ports[i].address == address) return i;
+        }
+        if (portCount >= PCF8574_PORT_CACHE_MAX_PORTS) return -1;
+        Port &port = ports[portCount];
+        port.address = address;
+        port.inputMask = 0;
+        port.input = 0xFF;
+        // power on state of the chip, every pin HIGH
+        port.shadow = 0xFF;
+        port.written = 0xFF;
+        port.hasWritten = false;
+        port.polled = false;
+        port.online = false;
+        return portCount++;
+    }
+
+    void setInput(uint8_t address, uint8_t pin) {
+        Port *port = portFor(address);
+        if (port == nullptr || pin > 7) return;
+        port->inputMask |= (1 << pin);
+        port->polled = true;
+    }
+
+    void setOutput(uint8_t address, uint8_t pin, uint8_t initialState = LOW) {
+        Port *port = portFor(address);
+        if (port == nullptr || pin > 7) return;
+        port->inputMask &= ~(1 << pin);
+        if (initialState == HIGH) port->shadow |= (1 << pin);
+        else port->shadow &= ~(1 << pin);
+        // the first flush always goes out, the chip may not be in its power on state
+        port->hasWritten = false;
+    }
+
+    // the pin as of the last read of its port, HIGH before the first one
+    uint8_t read(uint8_t address, uint8_t pin) {
+        return (readAll(address) >> pin) & 0x01 ? HIGH : LOW;
+    }
+
+    // a port nobody read before is polled from the next update() on
+    uint8_t readAll(uint8_t address) {
+        Port *port = portFor(address);
+        if (port == nullptr) return 0xFF;
+        stats.pinReads++;
+        if (!port->polled) {
+            port->polled = true;
+            readPort(*port);
+        }
+        return port->input;
+    }
+
+    void write(uint8_t address, uint8_t pin, uint8_t value) {
+        Port *port = portFor(address);
+        if (port == nullptr || pin > 7) return;
+        stats.pinWrites++;
+        if (value == HIGH) port->shadow |= (1 << pin);
+        else port->shadow &= ~(1 << pin);
+    }
+
+    void writeAll(uint8_t address, uint8_t values) {
+        Port *port = portFor(address);
+        if (port == nullptr) return;
+        stats.pinWrites++;
+        port->shadow = values;
+    }
+
+    // what the outputs will be after the next flush
+    uint8_t getOutput(uint8_t address) {
+        Port *port = find(address);
+        return port == nullptr ? 0xFF : port->shadow;
+    }
+
+    bool isOnline(uint8_t address) {
+        Port *port = find(address);
+        return port != nullptr && port->online;
+    }
+
+    // 0 reads the inputs on every update()
+    void setPollInterval(uint32_t ms) {
+        pollInterval = ms;
+    }
+
+    // safe from an ISR, e.g. on the INT line of the expanders: the next update() reads the inputs
+    // even when the poll interval has not passed yet
+    void requestRead() {
+        readRequested = true;
+    }
+
+    // call once per loop() before the inputs are updated
+    void update() {
+        uint32_t now = millis();
+        if (pollInterval == 0 || readRequested || now - lastPoll >= pollInterval) {
+            readRequested = false;
+            lastPoll = now;
+            refresh();
+        }
+        commit();
+    }
+
+    // reads every polled port now, false when one of them did not answer
+    bool refresh() {
+        bool success = true;
+        for (uint8_t i = 0; i < portCount; i++) {
+            if (ports[i].polled && !readPort(ports[i])) success = false;
+        }
+        return success;
+    }
+
+    // sends every changed shadow byte now, false when one of them did not go out
+    bool commit() {
+        bool success = true;
+        for (uint8_t i = 0; i < portCount; i++) {
+            if (isDirty(ports[i]) && !writePort(ports[i])) success = false;
+        }
+        return success;
+    }
+
+    uint8_t getPortCount() const {
+        return portCount;
+    }
+
+    const PCF8574BusStats &getStats() const {
+        return stats;
+    }
+
+    void resetStats() {
+        memset(&stats, 0, sizeof(stats));
+    }
+};
+
+#endif
@@ -68,6 +68,63 @@ public:
         TaskHandle_t getHandle();
     };
 
+    // task whose control block and stack live inside the object, nothing is taken from the heap
+    template<uint32_t StackSize>
+    class StaticTask {
+    private:
+        StaticTask_t control;
+        StackType_t stack[StackSize];
+        TaskHandle_t handle;
+
+    public:
+        StaticTask() : handle(NULL) {}
+
+        ~StaticTask() {
+            remove();
+        }
+
+        bool create(void (*taskFunction)(void *), const char *taskName, void *parameter,
+                    UBaseType_t priority, BaseType_t core = -1) {
+            if (handle != NULL) return false;
+
+            if (core >= 0) {
+                handle = xTaskCreateStaticPinnedToCore(taskFunction, taskName, StackSize, parameter,
+                                                       priority, stack, &control, core);
+            } else {
+                handle = xTaskCreateStatic(taskFunction, taskName, StackSize, parameter,
+                                           priority, stack, &control);
+            }
+            return handle != NULL;
+        }
+
+        void suspend() {
+            if (handle != NULL) vTaskSuspend(handle);
+        }
+
+        void resume() {
+            if (handle != NULL) vTaskResume(handle);
+        }
+
+        void remove() {
+            if (handle != NULL) {
+                vTaskDelete(handle);
+                handle = NULL;
+            }
+        }
+
+        bool isRunning() {
+            return handle != NULL && eTaskGetState(handle) != eSuspended;
+        }
+
+        uint32_t getStackHighWaterMark() {
+            return handle != NULL ? uxTaskGetStackHighWaterMark(handle) : 0;
+        }
+
+        TaskHandle_t getHandle() {
+            return handle;
+        }
+    };
+
     class Mutex {
     private:
         SemaphoreHandle_t handle;
@@ -107,7 +164,7 @@ public:
 
     template<typename T>
     class Queue {
-    private:
+    protected:
         QueueHandle_t handle;
 
     public:
@@ -178,6 +235,21 @@ public:
         }
     };
 
+    // Queue<T> over storage owned by the object, create() needs no heap
+    template<typename T, UBaseType_t Length>
+    class StaticQueue : public Queue<T> {
+    private:
+        StaticQueue_t control;
+        uint8_t storage[Length * sizeof(T)];
+
+    public:
+        bool create() {
+            if (this->handle != NULL) return false;
+            this->handle = xQueueCreateStatic(Length, sizeof(T), storage, &control);
+            return this->handle != NULL;
+        }
+    };
+
     class Timer {
     private:
         TimerHandle_t handle;
@@ -0,0 +1,94 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#if !defined(__AVR__)
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+#include <atomic>
+
+#if defined(ESP32)
+#define SPSC_RING_ALIGN 4
+#else
+#define SPSC_RING_ALIGN 64
+#endif
+
+// lock-free single producer / single consumer ring, safe between an ISR and a task or between the two cores.
+// One side may only push, the other may only pop; indices run free and are masked, so Capacity is a power of two.
+template<typename T, uint16_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    bool push(const T &item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= Capacity) return false;
+
+        items[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+
+        item = items[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // zero-copy producer side: fill the returned slot in place, then commit()
+    T *reserve() {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= Capacity) return NULL;
+        return &items[t & (Capacity - 1)];
+    }
+
+    void commit() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // zero-copy consumer side: read the returned slot in place, then release()
+    T *front() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return NULL;
+        return &items[h & (Capacity - 1)];
+    }
+
+    void release() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    uint16_t size() const {
+        return (uint16_t) (tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+    }
+
+    bool isEmpty() const {
+        return size() == 0;
+    }
+
+    bool isFull() const {
+        return size() >= Capacity;
+    }
+
+    uint16_t capacity() const {
+        return Capacity;
+    }
+
+private:
+    T items[Capacity];
+    alignas(SPSC_RING_ALIGN) std::atomic<uint32_t> head;
+    alignas(SPSC_RING_ALIGN) std::atomic<uint32_t> tail;
+};
+
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,398 @@
+#include "TaskScheduler.h"
+
+TaskScheduler::TaskScheduler(uint8_t initialCapacity)
+        : tasks(NULL), order(NULL), capacity(0), taskCount(0), loopBudget(0), loopStart(0),
+          loopMaxMicros(0), taskStart(0), currentTask(TASK_SCHEDULER_INVALID), running(false),
+          pendingChanges(false), overrunHandler(NULL) {
+    if (initialCapacity > 0) {
+        grow(initialCapacity);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    free(tasks);
+    free(order);
+}
+
+bool TaskScheduler::grow(uint8_t newCapacity) {
+    if (newCapacity <= capacity) return false;
+
+    Task *newTasks = (Task *) realloc(tasks, newCapacity * sizeof(Task));
+    if (newTasks == NULL) return false;
+    tasks = newTasks;
+
+    uint8_t *newOrder = (uint8_t *) realloc(order, newCapacity);
+    if (newOrder == NULL) return false;
+    order = newOrder;
+
+    memset(tasks + capacity, 0, (newCapacity - capacity) * sizeof(Task));
+    capacity = newCapacity;
+    return true;
+}
+
+int TaskScheduler::allocateTask() {
+    for (uint8_t i = 0; i < capacity; i++) {
+        if (!tasks[i].used) return i;
+    }
+
+    uint8_t oldCapacity = capacity;
+    uint16_t newCapacity = capacity == 0 ? 4 : capacity * 2;
+    if (newCapacity > 255) newCapacity = 255;
+    if (!grow(newCapacity)) return TASK_SCHEDULER_INVALID;
+    return oldCapacity;
+}
+
+bool TaskScheduler::isValid(int taskId) const {
+    return taskId >= 0 && taskId < capacity && tasks[taskId].used && !tasks[taskId].removed;
+}
+
+void TaskScheduler::insertOrdered(uint8_t slot) {
+    // after every task of the same or higher priority, so equal priorities keep registration order
+    uint8_t position = taskCount;
+    while (position > 0 && tasks[order[position - 1]].priority < tasks[slot].priority) {
+        order[position] = order[position - 1];
+        position--;
+    }
+    order[position] = slot;
+    taskCount++;
+}
+
+void TaskScheduler::removeOrdered(uint8_t slot) {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        if (order[i] == slot) {
+            memmove(order + i, order + i + 1, taskCount - i - 1);
+            taskCount--;
+            return;
+        }
+    }
+}
+
+void TaskScheduler::clearStats(Task &task) {
+    task.runCount = 0;
+    task.totalMicros = 0;
+    task.sampleCount = 0;
+    task.maxMicros = 0;
+    task.lastMicros = 0;
+    task.overrunCount = 0;
+    task.deferredCount = 0;
+    task.maxLateness = 0;
+}
+
+int TaskScheduler::addTask(const char *name, void (*callback)(), unsigned long periodMs,
+                           uint8_t priority, uint32_t budgetMicros) {
+    if (callback == NULL) return TASK_SCHEDULER_INVALID;
+
+    int slot = addTask(name, (void (*)(void *)) NULL, NULL, periodMs, priority, budgetMicros);
+    if (slot != TASK_SCHEDULER_INVALID) {
+        tasks[slot].callback = callback;
+        tasks[slot].hasContext = false;
+    }
+    return slot;
+}
+
+int TaskScheduler::addTask(const char *name, void (*callback)(void *), void *context, unsigned long periodMs,
+                           uint8_t priority, uint32_t budgetMicros) {
+    int slot = allocateTask();
+    if (slot == TASK_SCHEDULER_INVALID) return TASK_SCHEDULER_INVALID;
+
+    Task &task = tasks[slot];
+    memset(&task, 0, sizeof(Task));
+    task.name = name != NULL ? name : "";
+    task.paramCallback = callback;
+    task.context = context;
+    task.period = periodMs;
+    task.nextRun = millis() + periodMs;
+    task.budget = budgetMicros;
+    task.priority = priority;
+    task.used = true;
+    task.enabled = true;
+    task.hasContext = true;
+
+    if (running) {
+        // joins the order once the current pass is over
+        task.queued = true;
+        pendingChanges = true;
+    } else {
+        insertOrdered(slot);
+    }
+    return slot;
+}
+
+bool TaskScheduler::removeTask(int taskId) {
+    if (!isValid(taskId)) return false;
+
+    Task &task = tasks[taskId];
+    task.enabled = false;
+    if (running) {
+        // the order array is being walked, the slot is released after the pass
+        task.removed = true;
+        pendingChanges = true;
+        return true;
+    }
+
+    if (!task.queued) {
+        removeOrdered(taskId);
+    }
+    task.used = false;
+    return true;
+}
+
+bool TaskScheduler::enable(int taskId) {
+    if (!isValid(taskId)) return false;
+
+    Task &task = tasks[taskId];
+    if (!task.enabled) {
+        task.enabled = true;
+        task.nextRun = millis() + task.period;
+    }
+    return true;
+}
+
+bool TaskScheduler::disable(int taskId) {
+    if (!isValid(taskId)) return false;
+    tasks[taskId].enabled = false;
+    return true;
+}
+
+bool TaskScheduler::isEnabled(int taskId) const {
+    return isValid(taskId) && tasks[taskId].enabled;
+}
+
+bool TaskScheduler::trigger(int taskId) {
+    if (!isValid(taskId)) return false;
+    tasks[taskId].triggered = true;
+    return true;
+}
+
+bool TaskScheduler::setPeriod(int taskId, unsigned long periodMs) {
+    if (!isValid(taskId)) return false;
+
+    Task &task = tasks[taskId];
+    task.nextRun = task.nextRun - task.period + periodMs;
+    task.period = periodMs;
+    return true;
+}
+
+bool TaskScheduler::setPriority(int taskId, uint8_t priority) {
+    if (!isValid(taskId)) return false;
+
+    Task &task = tasks[taskId];
+    if (task.priority == priority) return true;
+
+    task.priority = priority;
+    if (running) {
+        // moving it now would shift the order array under run(), it is moved after the pass
+        task.queued = true;
+        pendingChanges = true;
+    } else {
+        removeOrdered(taskId);
+        insertOrdered(taskId);
+    }
+    return true;
+}
+
+bool TaskScheduler::setBudget(int taskId, uint32_t budgetMicros) {
+    if (!isValid(taskId)) return false;
+    tasks[taskId].budget = budgetMicros;
+    return true;
+}
+
+void TaskScheduler::setLoopBudget(uint32_t budgetMicros) {
+    loopBudget = budgetMicros;
+}
+
+void TaskScheduler::setOverrunHandler(OverrunHandler handler) {
+    overrunHandler = handler;
+}
+
+void TaskScheduler::execute(uint8_t slot, unsigned long now) {
+    Task &task = tasks[slot];
+
+    if ((long) (now - task.nextRun) >= 0) {
+        unsigned long lateness = now - task.nextRun;
+        if (lateness > task.maxLateness) task.maxLateness = lateness;
+
+        // stays on the period grid, a task that fell a whole period behind resyncs instead of bursting
+        task.nextRun += task.period;
+        if ((long) (now - task.nextRun) >= 0) {
+            task.nextRun = now + task.period;
+        }
+    }
+    task.triggered = false;
+
+    currentTask = slot;
+    taskStart = micros();
+    if (task.hasContext) {
+        task.paramCallback(task.context);
+    } else {
+        task.callback();
+    }
+    uint32_t elapsed = micros() - taskStart;
+    currentTask = TASK_SCHEDULER_INVALID;
+
+    // looked up again, the callback may have added tasks and moved the table
+    Task &done = tasks[slot];
+    done.runCount++;
+    done.lastMicros = elapsed;
+    if (elapsed > done.maxMicros) done.maxMicros = elapsed;
+    if (done.totalMicros + elapsed < done.totalMicros) {
+        done.totalMicros /= 2;
+        done.sampleCount /= 2;
+    }
+    done.totalMicros += elapsed;
+    done.sampleCount++;
+
+    if (done.budget > 0 && elapsed > done.budget) {
+        done.overrunCount++;
+        if (overrunHandler != NULL) {
+            overrunHandler(slot, elapsed);
+        }
+    }
+}
+
+uint8_t TaskScheduler::run() {
+    unsigned long now = millis();
+    uint8_t executed = 0;
+
+    running = true;
+    loopStart = micros();
+
+    for (uint8_t i = 0; i < taskCount; i++) {
+        uint8_t slot = order[i];
+        Task &task = tasks[slot];
+        if (!task.enabled) continue;
+        if (!task.triggered && (long) (now - task.nextRun) < 0) continue;
+
+        // the loop budget only stops lower priority work, the first due task always runs
+        if (loopBudget > 0 && executed > 0 && (uint32_t) (micros() - loopStart) >= loopBudget) {
+            task.deferredCount++;
+            continue;
+        }
+
+        execute(slot, now);
+        executed++;
+    }
+
+    uint32_t loopElapsed = micros() - loopStart;
+    if (executed > 0 && loopElapsed > loopMaxMicros) {
+        loopMaxMicros = loopElapsed;
+    }
+    running = false;
+
+    if (pendingChanges) {
+        pendingChanges = false;
+        for (uint8_t slot = 0; slot < capacity; slot++) {
+            Task &task = tasks[slot];
+            if (!task.used) continue;
+
+            // a queued task is either new or changed priority, removeOrdered() skips slots not in the order
+            if (task.removed) {
+                removeOrdered(slot);
+                task.used = false;
+                task.removed = false;
+                task.queued = false;
+            } else if (task.queued) {
+                task.queued = false;
+                removeOrdered(slot);
+                insertOrdered(slot);
+            }
+        }
+    }
+    return executed;
+}
+
+int TaskScheduler::getCurrentTask() const {
+    return currentTask;
+}
+
+uint32_t TaskScheduler::getRemainingBudget() const {
+    uint32_t remaining = 0xFFFFFFFFUL;
+    uint32_t current = micros();
+
+    if (currentTask != TASK_SCHEDULER_INVALID && tasks[currentTask].budget > 0) {
+        uint32_t used = current - taskStart;
+        remaining = used < tasks[currentTask].budget ? tasks[currentTask].budget - used : 0;
+    }
+    if (running && loopBudget > 0) {
+        uint32_t used = current - loopStart;
+        uint32_t loopRemaining = used < loopBudget ? loopBudget - used : 0;
+        if (loopRemaining < remaining) remaining = loopRemaining;
+    }
+    return remaining;
+}
+
+bool TaskScheduler::shouldYield() const {
+    return getRemainingBudget() == 0;
+}
+
+unsigned long TaskScheduler::getTimeUntilNext() const {
+    unsigned long now = millis();
+    unsigned long soonest = (unsigned long) -1;
+
+    for (uint8_t i = 0; i < taskCount; i++) {
+        const Task &task = tasks[order[i]];
+        if (!task.enabled) continue;
+        if (task.triggered || (long) (now - task.nextRun) >= 0) return 0;
+
+        unsigned long wait = task.nextRun - now;
+        if (wait < soonest) soonest = wait;
+    }
+    return soonest;
+}
+
+int TaskScheduler::getTaskCount() const {
+    return taskCount;
+}
+
+const char *TaskScheduler::getName(int taskId) const {
+    return isValid(taskId) ? tasks[taskId].name : "";
+}
+
+bool TaskScheduler::getStats(int taskId, Stats &stats) const {
+    if (!isValid(taskId)) return false;
+
+    const Task &task = tasks[taskId];
+    stats.runCount = task.runCount;
+    stats.averageMicros = task.sampleCount > 0 ? task.totalMicros / task.sampleCount : 0;
+    stats.maxMicros = task.maxMicros;
+    stats.lastMicros = task.lastMicros;
+    stats.overrunCount = task.overrunCount;
+    stats.deferredCount = task.deferredCount;
+    stats.maxLateness = task.maxLateness;
+    return true;
+}
+
+uint32_t TaskScheduler::getLoopMaxMicros() const {
+    return loopMaxMicros;
+}
+
+void TaskScheduler::resetStats() {
+    for (uint8_t slot = 0; slot < capacity; slot++) {
+        clearStats(tasks[slot]);
+    }
+    loopMaxMicros = 0;
+}
+
+void TaskScheduler::printStats(Stream &out) const {
+    out.println(F("task              runs     avg(us)  max(us)  overrun  deferred  late(ms)"));
+
+    for (uint8_t i = 0; i < taskCount; i++) {
+        int slot = order[i];
+        Stats stats;
+        if (!getStats(slot, stats)) continue;
+
+        char line[96];
+        snprintf(line, sizeof(line), "%-16.16s  %-7lu  %-7lu  %-7lu  %-7lu  %-8lu  %lu",
+                 tasks[slot].name,
+                 (unsigned long) stats.runCount,
+                 (unsigned long) stats.averageMicros,
+                 (unsigned long) stats.maxMicros,
+                 (unsigned long) stats.overrunCount,
+                 (unsigned long) stats.deferredCount,
+                 (unsigned long) stats.maxLateness);
+        out.println(line);
+    }
+
+    out.print(F("loop max(us): "));
+    out.println(loopMaxMicros);
+}
\ No newline at end of file
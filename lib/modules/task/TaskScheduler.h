@@ -0,0 +1,120 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+
+#define TASK_SCHEDULER_INVALID -1
+
+#define TASK_PRIORITY_LOW 0
+#define TASK_PRIORITY_NORMAL 1
+#define TASK_PRIORITY_HIGH 2
+#define TASK_PRIORITY_CRITICAL 3
+
+// cooperative loop() scheduler: due tasks run highest priority first, each run is timed with micros()
+class TaskScheduler {
+public:
+    struct Stats {
+        uint32_t runCount;
+        uint32_t averageMicros;
+        uint32_t maxMicros;
+        uint32_t lastMicros;
+        uint32_t overrunCount;
+        uint32_t deferredCount;
+        uint32_t maxLateness;
+    };
+
+    typedef void (*OverrunHandler)(int taskId, uint32_t elapsedMicros);
+
+    explicit TaskScheduler(uint8_t initialCapacity = 4);
+    ~TaskScheduler();
+
+    int addTask(const char *name, void (*callback)(), unsigned long periodMs,
+                uint8_t priority = TASK_PRIORITY_NORMAL, uint32_t budgetMicros = 0);
+    int addTask(const char *name, void (*callback)(void *), void *context, unsigned long periodMs,
+                uint8_t priority = TASK_PRIORITY_NORMAL, uint32_t budgetMicros = 0);
+    bool removeTask(int taskId);
+
+    bool enable(int taskId);
+    bool disable(int taskId);
+    bool isEnabled(int taskId) const;
+    bool trigger(int taskId);
+
+    bool setPeriod(int taskId, unsigned long periodMs);
+    bool setPriority(int taskId, uint8_t priority);
+    bool setBudget(int taskId, uint32_t budgetMicros);
+
+    void setLoopBudget(uint32_t budgetMicros);
+    void setOverrunHandler(OverrunHandler handler);
+
+    uint8_t run();
+
+    int getCurrentTask() const;
+    uint32_t getRemainingBudget() const;
+    bool shouldYield() const;
+
+    unsigned long getTimeUntilNext() const;
+    int getTaskCount() const;
+    const char *getName(int taskId) const;
+
+    bool getStats(int taskId, Stats &stats) const;
+    uint32_t getLoopMaxMicros() const;
+    void resetStats();
+    void printStats(Stream &out = Serial) const;
+
+private:
+    struct Task {
+        const char *name;
+        union {
+            void (*callback)();
+            void (*paramCallback)(void *);
+        };
+        void *context;
+        unsigned long period;
+        unsigned long nextRun;
+        uint32_t budget;
+
+        uint32_t runCount;
+        uint32_t totalMicros;
+        uint32_t sampleCount;
+        uint32_t maxMicros;
+        uint32_t lastMicros;
+        uint32_t overrunCount;
+        uint32_t deferredCount;
+        uint32_t maxLateness;
+
+        uint8_t priority;
+        uint8_t used : 1;
+        uint8_t enabled : 1;
+        uint8_t hasContext : 1;
+        uint8_t triggered : 1;
+        uint8_t queued : 1;
+        uint8_t removed : 1;
+    };
+
+    TaskScheduler(const TaskScheduler &);
+    TaskScheduler &operator=(const TaskScheduler &);
+
+    bool grow(uint8_t newCapacity);
+    int allocateTask();
+    bool isValid(int taskId) const;
+    void insertOrdered(uint8_t slot);
+    void removeOrdered(uint8_t slot);
+    void clearStats(Task &task);
+    void execute(uint8_t slot, unsigned long now);
+
+    Task *tasks;
+    uint8_t *order;
+    uint8_t capacity;
+    uint8_t taskCount;
+
+    uint32_t loopBudget;
+    uint32_t loopStart;
+    uint32_t loopMaxMicros;
+    uint32_t taskStart;
+    int currentTask;
+    bool running;
+    bool pendingChanges;
+    OverrunHandler overrunHandler;
+};
+
+#endif
\ No newline at end of file
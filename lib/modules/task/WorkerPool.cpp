@@ -0,0 +1,326 @@
+#include "WorkerPool.h"
+
+#if defined(ESP32) || !defined(ARDUINO)
+
+#if !defined(ESP32)
+#include <sched.h>
+#include <time.h>
+#endif
+
+void WorkerPool::Lock::lock() {
+#if defined(ESP32)
+    portENTER_CRITICAL(&mux);
+#else
+    while (flag.test_and_set(std::memory_order_acquire)) {
+    }
+#endif
+}
+
+void WorkerPool::Lock::unlock() {
+#if defined(ESP32)
+    portEXIT_CRITICAL(&mux);
+#else
+    flag.clear(std::memory_order_release);
+#endif
+}
+
+WorkerPool::WorkerPool() : workerCount(0), pending(0), alive(0), running(false), nextWorker(0) {
+    for (uint8_t i = 0; i < WORKER_POOL_MAX_WORKERS; i++) {
+        Worker &worker = workers[i];
+        worker.pool = this;
+        worker.index = i;
+        worker.head = 0;
+        worker.count = 0;
+        worker.sleeping = false;
+        worker.executed = 0;
+        worker.stolen = 0;
+        worker.sleeps = 0;
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    end();
+}
+
+bool WorkerPool::begin(uint8_t count, uint8_t priority) {
+    if (running || count == 0) return false;
+    if (count > WORKER_POOL_MAX_WORKERS) count = WORKER_POOL_MAX_WORKERS;
+
+    workerCount = count;
+    pending = 0;
+    running = true;
+
+    // every deque is reset before the first worker starts, running workers scan all of them
+    for (uint8_t i = 0; i < workerCount; i++) {
+        Worker &worker = workers[i];
+        worker.head = 0;
+        worker.count = 0;
+        worker.sleeping = false;
+        worker.executed = 0;
+        worker.stolen = 0;
+        worker.sleeps = 0;
+#if !defined(ESP32)
+        worker.signals = 0;
+#endif
+    }
+
+    for (uint8_t i = 0; i < workerCount; i++) {
+        Worker &worker = workers[i];
+#if defined(ESP32)
+        static const char *names[] = {"worker0", "worker1"};
+        // one worker per core, single core chips (S2, C3, C6) leave the placement to the scheduler
+        BaseType_t core = portNUM_PROCESSORS > 1 ? (BaseType_t) (i % portNUM_PROCESSORS) : -1;
+        if (!worker.task.create(workerLoop, names[i % 2], &worker, priority, core)) {
+            workerCount = i;
+            end();
+            return false;
+        }
+#else
+        (void) priority;
+        pthread_mutex_init(&worker.mutex, NULL);
+        pthread_cond_init(&worker.wakeup, NULL);
+        if (pthread_create(&worker.thread, NULL, threadEntry, &worker) != 0) {
+            pthread_cond_destroy(&worker.wakeup);
+            pthread_mutex_destroy(&worker.mutex);
+            workerCount = i;
+            end();
+            return false;
+        }
+#endif
+        alive++;
+    }
+    return true;
+}
+
+void WorkerPool::end() {
+    // also reached when begin() could not start the first worker, the pool must not stay running
+    running = false;
+    if (workerCount == 0) {
+        pending = 0;
+        return;
+    }
+
+    for (uint8_t i = 0; i < workerCount; i++) {
+        wake(workers[i]);
+    }
+
+#if defined(ESP32)
+    // workers park after leaving their loop and are deleted here, their stacks live in this object
+    while (alive > 0) {
+        pause();
+    }
+    for (uint8_t i = 0; i < workerCount; i++) {
+        workers[i].task.remove();
+    }
+#else
+    for (uint8_t i = 0; i < workerCount; i++) {
+        pthread_join(workers[i].thread, NULL);
+        pthread_cond_destroy(&workers[i].wakeup);
+        pthread_mutex_destroy(&workers[i].mutex);
+    }
+    alive = 0;
+#endif
+
+    workerCount = 0;
+    pending = 0;
+}
+
+bool WorkerPool::pushJob(Worker &worker, const WorkerJob &job) {
+    worker.lock.lock();
+    bool pushed = worker.count < WORKER_POOL_DEQUE_SIZE;
+    if (pushed) {
+        worker.jobs[(worker.head + worker.count) % WORKER_POOL_DEQUE_SIZE] = job;
+        worker.count++;
+    }
+    worker.lock.unlock();
+    return pushed;
+}
+
+bool WorkerPool::popJob(Worker &worker, WorkerJob &job, bool stealing) {
+    worker.lock.lock();
+    bool popped = worker.count > 0 && (!stealing || worker.jobs[worker.head].stealable);
+    if (popped) {
+        job = worker.jobs[worker.head];
+        worker.head = (worker.head + 1) % WORKER_POOL_DEQUE_SIZE;
+        worker.count--;
+    }
+    worker.lock.unlock();
+    return popped;
+}
+
+bool WorkerPool::findJob(Worker &self, WorkerJob &job) {
+    if (popJob(self, job, false)) return true;
+
+    for (uint8_t i = 1; i < workerCount; i++) {
+        Worker &victim = workers[(self.index + i) % workerCount];
+        if (popJob(victim, job, true)) {
+            self.stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkerPool::hasWork(uint8_t index) {
+    for (uint8_t i = 0; i < workerCount; i++) {
+        Worker &worker = workers[i];
+        worker.lock.lock();
+        bool available = worker.count > 0 && (i == index || worker.jobs[worker.head].stealable);
+        worker.lock.unlock();
+        if (available) return true;
+    }
+    return false;
+}
+
+void WorkerPool::workerLoop(void *parameter) {
+    Worker &self = *(Worker *) parameter;
+    WorkerPool &pool = *self.pool;
+    WorkerJob job;
+
+    while (pool.running) {
+        if (pool.findJob(self, job)) {
+            job.function(job.context);
+            self.executed.fetch_add(1, std::memory_order_relaxed);
+            pool.pending--;
+            continue;
+        }
+        pool.sleep(self);
+    }
+
+    pool.alive--;
+#if defined(ESP32)
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+#endif
+}
+
+#if !defined(ESP32)
+void *WorkerPool::threadEntry(void *parameter) {
+    workerLoop(parameter);
+    return NULL;
+}
+#endif
+
+void WorkerPool::sleep(Worker &worker) {
+    // flag first, then look again: a submit racing with this either sees the flag or its job is found here
+    worker.sleeping = true;
+    if (!running || hasWork(worker.index)) {
+        worker.sleeping = false;
+        return;
+    }
+    worker.sleeps.fetch_add(1, std::memory_order_relaxed);
+
+#if defined(ESP32)
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#else
+    pthread_mutex_lock(&worker.mutex);
+    while (worker.signals == 0) {
+        pthread_cond_wait(&worker.wakeup, &worker.mutex);
+    }
+    worker.signals = 0;
+    pthread_mutex_unlock(&worker.mutex);
+#endif
+    worker.sleeping = false;
+}
+
+void WorkerPool::wake(Worker &worker) {
+#if defined(ESP32)
+    TaskHandle_t handle = worker.task.getHandle();
+    if (handle != NULL) {
+        xTaskNotifyGive(handle);
+    }
+#else
+    pthread_mutex_lock(&worker.mutex);
+    worker.signals++;
+    pthread_cond_signal(&worker.wakeup);
+    pthread_mutex_unlock(&worker.mutex);
+#endif
+}
+
+bool WorkerPool::submit(void (*function)(void *), void *context, int worker) {
+    if (!running || function == NULL) return false;
+
+    WorkerJob job;
+    job.function = function;
+    job.context = context;
+    job.stealable = worker < 0;
+
+    uint8_t target = worker >= 0 ? worker % workerCount : nextWorker.fetch_add(1) % workerCount;
+
+    pending++;
+    bool pushed = pushJob(workers[target], job);
+    for (uint8_t i = 1; !pushed && job.stealable && i < workerCount; i++) {
+        target = (target + 1) % workerCount;
+        pushed = pushJob(workers[target], job);
+    }
+    if (!pushed) {
+        pending--;
+        return false;
+    }
+
+    if (workers[target].sleeping) {
+        wake(workers[target]);
+    }
+    // one idle worker is enough to pick up stealable work queued behind a busy one
+    if (job.stealable) {
+        for (uint8_t i = 1; i < workerCount; i++) {
+            Worker &idle = workers[(target + i) % workerCount];
+            if (idle.sleeping) {
+                wake(idle);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+bool WorkerPool::waitIdle(uint32_t timeoutMs) {
+    uint32_t start = now();
+    while (pending > 0) {
+        if (now() - start >= timeoutMs) return false;
+        pause();
+    }
+    return true;
+}
+
+uint32_t WorkerPool::getPending() const {
+    return pending;
+}
+
+uint8_t WorkerPool::getWorkerCount() const {
+    return workerCount;
+}
+
+bool WorkerPool::getStats(uint8_t worker, Stats &stats) const {
+    if (worker >= workerCount) return false;
+
+    stats.executed = workers[worker].executed.load(std::memory_order_relaxed);
+    stats.stolen = workers[worker].stolen.load(std::memory_order_relaxed);
+    stats.sleeps = workers[worker].sleeps.load(std::memory_order_relaxed);
+    return true;
+}
+
+bool WorkerPool::isRunning() const {
+    return running;
+}
+
+uint32_t WorkerPool::now() {
+#if defined(ESP32)
+    return millis();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) (ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL);
+#endif
+}
+
+void WorkerPool::pause() {
+#if defined(ESP32)
+    vTaskDelay(1);
+#else
+    sched_yield();
+#endif
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,130 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#if defined(ESP32) || !defined(ARDUINO)
+
+#include <atomic>
+
+#if defined(ESP32)
+#include <Arduino.h>
+#include "FreeRTOSHandler.h"
+#else
+// host port for benchmarking, workers are pthreads
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#endif
+
+#if defined(ESP32)
+#define WORKER_POOL_MAX_WORKERS 2
+#else
+#define WORKER_POOL_MAX_WORKERS 8
+#endif
+
+#ifndef WORKER_POOL_DEQUE_SIZE
+#define WORKER_POOL_DEQUE_SIZE 32
+#endif
+
+#ifndef WORKER_POOL_STACK_SIZE
+#define WORKER_POOL_STACK_SIZE 4096
+#endif
+
+struct WorkerJob {
+    void (*function)(void *);
+    void *context;
+    bool stealable;
+};
+
+// fixed set of workers, on ESP32 pinned alternately to core 0 and 1. Each worker owns a bounded deque;
+// an idle worker takes stealable jobs from the others before going to sleep. No heap after begin().
+class WorkerPool {
+public:
+    struct Stats {
+        uint32_t executed;
+        uint32_t stolen;
+        uint32_t sleeps;
+    };
+
+    WorkerPool();
+    ~WorkerPool();
+
+    bool begin(uint8_t workerCount = WORKER_POOL_MAX_WORKERS, uint8_t priority = 1);
+    void end();
+
+    // worker < 0 spreads jobs round-robin and lets idle workers steal them,
+    // a fixed worker keeps its jobs in submission order and never has them stolen
+    bool submit(void (*function)(void *), void *context, int worker = -1);
+    bool waitIdle(uint32_t timeoutMs);
+
+    uint32_t getPending() const;
+    uint8_t getWorkerCount() const;
+    bool getStats(uint8_t worker, Stats &stats) const;
+    bool isRunning() const;
+
+private:
+    class Lock {
+    public:
+        void lock();
+        void unlock();
+
+    private:
+#if defined(ESP32)
+        portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+#else
+        std::atomic_flag flag = ATOMIC_FLAG_INIT;
+#endif
+    };
+
+    struct Worker {
+        WorkerPool *pool;
+        uint8_t index;
+
+        WorkerJob jobs[WORKER_POOL_DEQUE_SIZE];
+        uint16_t head;
+        uint16_t count;
+        Lock lock;
+
+        std::atomic<bool> sleeping;
+        std::atomic<uint32_t> executed;
+        std::atomic<uint32_t> stolen;
+        std::atomic<uint32_t> sleeps;
+
+#if defined(ESP32)
+        FreeRTOSHandler::StaticTask<WORKER_POOL_STACK_SIZE> task;
+#else
+        pthread_t thread;
+        pthread_mutex_t mutex;
+        pthread_cond_t wakeup;
+        uint32_t signals;
+#endif
+    };
+
+    WorkerPool(const WorkerPool &);
+    WorkerPool &operator=(const WorkerPool &);
+
+    static void workerLoop(void *parameter);
+#if !defined(ESP32)
+    static void *threadEntry(void *parameter);
+#endif
+
+    bool pushJob(Worker &worker, const WorkerJob &job);
+    bool popJob(Worker &worker, WorkerJob &job, bool stealing);
+    bool findJob(Worker &self, WorkerJob &job);
+    bool hasWork(uint8_t index);
+    void wake(Worker &worker);
+    void sleep(Worker &worker);
+
+    static uint32_t now();
+    static void pause();
+
+    Worker workers[WORKER_POOL_MAX_WORKERS];
+    uint8_t workerCount;
+    std::atomic<uint32_t> pending;
+    std::atomic<uint8_t> alive;
+    std::atomic<bool> running;
+    std::atomic<uint32_t> nextWorker;
+};
+
+#endif
+
+#endif
\ No newline at end of file
@@ -8,6 +8,8 @@ TimerManager::TimerManager() {
     _timerType = TIMER_ONESHOT;
     memset(&_flags, 0, sizeof(_flags));
     _callback = nullptr;
+    _wheel = nullptr;
+    _wheelHandle = TIMER_WHEEL_INVALID;
 }
 
 TimerManager::TimerManager(unsigned long interval, TimerType type) {
@@ -18,6 +20,58 @@ TimerManager::TimerManager(unsigned long interval, TimerType type) {
     _timerType = type;
     memset(&_flags, 0, sizeof(_flags));
     _callback = nullptr;
+    _wheel = nullptr;
+    _wheelHandle = TIMER_WHEEL_INVALID;
+}
+
+TimerManager::~TimerManager() {
+    detach();
+}
+
+bool TimerManager::attach(TimerWheel *wheel) {
+    detach();
+    if (wheel == nullptr) return false;
+
+    _wheelHandle = wheel->allocate(onWheelExpiry, this);
+    if (_wheelHandle == TIMER_WHEEL_INVALID) return false;
+
+    _wheel = wheel;
+    syncWheel();
+    return true;
+}
+
+void TimerManager::detach() {
+    if (_wheel != nullptr) {
+        _wheel->release(_wheelHandle);
+    }
+    _wheel = nullptr;
+    _wheelHandle = TIMER_WHEEL_INVALID;
+}
+
+bool TimerManager::isAttached() const {
+    return _wheel != nullptr;
+}
+
+void TimerManager::syncWheel() {
+    if (_wheel == nullptr) return;
+
+    if (_flags._isRunning && !_flags._isPaused) {
+        _wheel->scheduleIn(_wheelHandle, getRemainingMillis());
+    } else {
+        _wheel->cancel(_wheelHandle);
+    }
+}
+
+void TimerManager::onWheelExpiry(void *owner, uint16_t tag) {
+    (void) tag;
+    TimerManager *timer = static_cast<TimerManager *>(owner);
+    if (!timer->_flags._isRunning || timer->_flags._isPaused) return;
+
+    if (!timer->isExpired()) {
+        timer->syncWheel();
+    } else if (timer->_flags._autoCallback && timer->_callback != nullptr) {
+        timer->handleExpiry();
+    }
 }
 
 void TimerManager::start() {
@@ -26,17 +80,20 @@ void TimerManager::start() {
     _flags._isRunning = 1;
     _flags._isPaused = 0;
     _flags._hasExpired = 0;
+    syncWheel();
 }
 
 void TimerManager::stop() {
     _flags._isRunning = 0;
     _flags._isPaused = 0;
+    syncWheel();
 }
 
 void TimerManager::pause() {
     if (_flags._isRunning && !_flags._isPaused) {
         _pausedTime = millis();
         _flags._isPaused = 1;
+        syncWheel();
     }
 }
 
@@ -45,6 +102,7 @@ void TimerManager::resume() {
         unsigned long pauseDuration = millis() - _pausedTime;
         _startTime += pauseDuration;
         _flags._isPaused = 0;
+        syncWheel();
     }
 }
 
@@ -56,6 +114,7 @@ void TimerManager::reset() {
     if (_flags._isPaused) {
         _pausedTime = _startTime;
     }
+    syncWheel();
 }
 
 void TimerManager::restart() {
@@ -86,6 +145,7 @@ bool TimerManager::isPaused() const {
 
 void TimerManager::setDuration(unsigned long milliseconds) {
     _duration = milliseconds;
+    syncWheel();
 }
 
 void TimerManager::setDurationSeconds(unsigned long seconds) {
@@ -281,6 +341,8 @@ void TimerManager::executeCallback() {
 }
 
 void TimerManager::update() {
+    if (_wheel != nullptr) return;
+
     if (_flags._isRunning && !_flags._isPaused && _flags._autoCallback && _callback != nullptr) {
         if (isExpired()) {
             handleExpiry();
@@ -297,6 +359,7 @@ void TimerManager::handleExpiry() {
         reset();
     } else {
         _flags._isRunning = 0;
+        syncWheel();
     }
 }
 
@@ -4,6 +4,7 @@
 #define TIMER_MANAGER_H
 
 #include <Arduino.h>
+#include "timer-wheel.h"
 
 enum TimerType {
     TIMER_ONESHOT,
@@ -18,6 +19,12 @@ class TimerManager {
 public:
     TimerManager();
     explicit TimerManager(unsigned long interval, TimerType type = TIMER_ONESHOT);
+    ~TimerManager();
+
+    // an attached timer is expired by wheel.tick() instead of its own update(); do not copy it while attached
+    bool attach(TimerWheel *wheel);
+    void detach();
+    bool isAttached() const;
 
     void start();
     void stop();
@@ -94,6 +101,8 @@ public:
 private:
     unsigned long getElapsedTime() const;
     void handleExpiry();
+    void syncWheel();
+    static void onWheelExpiry(void *owner, uint16_t tag);
 
     unsigned long _startTime;
     unsigned long _pausedTime;
@@ -110,6 +119,8 @@ private:
     } _flags;
 
     TimerCallback _callback;
+    TimerWheel *_wheel;
+    TimerHandle _wheelHandle;
 };
 
 #endif
@@ -0,0 +1,234 @@
+#include "timer-wheel.h"
+
+static unsigned long timerWheelDefaultClock() {
+    return millis();
+}
+
+TimerWheel::TimerWheel(uint16_t initialCapacity) {
+    _slots = nullptr;
+    _heap = nullptr;
+    _capacity = 0;
+    _heapSize = 0;
+    _freeHead = TIMER_WHEEL_INVALID;
+    _clock = timerWheelDefaultClock;
+
+    while (_capacity < initialCapacity && grow()) {
+    }
+}
+
+TimerWheel::~TimerWheel() {
+    free(_slots);
+    free(_heap);
+}
+
+bool TimerWheel::grow() {
+    uint16_t newCapacity = _capacity == 0 ? 8 : _capacity * 2;
+    if (newCapacity <= _capacity || newCapacity >= TIMER_WHEEL_INVALID) {
+        return false;
+    }
+
+    Slot *newSlots = (Slot *) realloc(_slots, newCapacity * sizeof(Slot));
+    if (newSlots == nullptr) {
+        return false;
+    }
+    _slots = newSlots;
+
+    uint16_t *newHeap = (uint16_t *) realloc(_heap, newCapacity * sizeof(uint16_t));
+    if (newHeap == nullptr) {
+        return false;
+    }
+    _heap = newHeap;
+
+    for (uint16_t i = newCapacity; i > _capacity; i--) {
+        Slot &slot = _slots[i - 1];
+        memset(&slot, 0, sizeof(Slot));
+        slot.heapIndex = TIMER_WHEEL_INVALID;
+        slot.nextFree = _freeHead;
+        _freeHead = i - 1;
+    }
+    _capacity = newCapacity;
+    return true;
+}
+
+TimerHandle TimerWheel::allocate(TimerWheelCallback callback, void *owner, uint16_t tag) {
+    if (_freeHead == TIMER_WHEEL_INVALID && !grow()) {
+        return TIMER_WHEEL_INVALID;
+    }
+
+    TimerHandle handle = _freeHead;
+    Slot &slot = _slots[handle];
+    _freeHead = slot.nextFree;
+
+    slot.deadline = 0;
+    slot.callback = callback;
+    slot.owner = owner;
+    slot.tag = tag;
+    slot.heapIndex = TIMER_WHEEL_INVALID;
+    slot.nextFree = handle;  // points at itself while allocated
+    return handle;
+}
+
+void TimerWheel::release(TimerHandle handle) {
+    if (!isValid(handle)) return;
+
+    cancel(handle);
+    _slots[handle].callback = nullptr;
+    _slots[handle].nextFree = _freeHead;
+    _freeHead = handle;
+}
+
+void TimerWheel::setTag(TimerHandle handle, uint16_t tag) {
+    if (isValid(handle)) {
+        _slots[handle].tag = tag;
+    }
+}
+
+bool TimerWheel::isValid(TimerHandle handle) const {
+    return handle < _capacity && _slots[handle].nextFree == handle;
+}
+
+bool TimerWheel::schedule(TimerHandle handle, unsigned long deadline) {
+    if (!isValid(handle)) return false;
+
+    Slot &slot = _slots[handle];
+    if (slot.heapIndex != TIMER_WHEEL_INVALID) {
+        slot.deadline = deadline;
+        siftUp(slot.heapIndex);
+        siftDown(slot.heapIndex);
+        return true;
+    }
+
+    slot.deadline = deadline;
+    slot.heapIndex = _heapSize;
+    _heap[_heapSize++] = handle;
+    siftUp(slot.heapIndex);
+    return true;
+}
+
+bool TimerWheel::scheduleIn(TimerHandle handle, unsigned long delay) {
+    return schedule(handle, now() + delay);
+}
+
+bool TimerWheel::cancel(TimerHandle handle) {
+    if (!isValid(handle) || _slots[handle].heapIndex == TIMER_WHEEL_INVALID) return false;
+
+    removeAt(_slots[handle].heapIndex);
+    return true;
+}
+
+bool TimerWheel::isPending(TimerHandle handle) const {
+    return isValid(handle) && _slots[handle].heapIndex != TIMER_WHEEL_INVALID;
+}
+
+unsigned long TimerWheel::getDeadline(TimerHandle handle) const {
+    return isValid(handle) ? _slots[handle].deadline : 0;
+}
+
+unsigned long TimerWheel::getRemaining(TimerHandle handle) const {
+    if (!isPending(handle)) return 0;
+
+    unsigned long current = now();
+    unsigned long deadline = _slots[handle].deadline;
+    return isDue(deadline, current) ? 0 : deadline - current;
+}
+
+uint16_t TimerWheel::tick() {
+    return tick(now());
+}
+
+uint16_t TimerWheel::tick(unsigned long now) {
+    // bounded by the entries pending on entry, a zero-delay reschedule fires on the next tick
+    uint16_t budget = _heapSize;
+    uint16_t fired = 0;
+
+    while (_heapSize > 0 && budget-- > 0) {
+        Slot &slot = _slots[_heap[0]];
+        if (!isDue(slot.deadline, now)) break;
+
+        // copied out, the callback may allocate and move the slot table
+        TimerWheelCallback callback = slot.callback;
+        void *owner = slot.owner;
+        uint16_t tag = slot.tag;
+
+        removeAt(0);
+        fired++;
+        if (callback != nullptr) {
+            callback(owner, tag);
+        }
+    }
+    return fired;
+}
+
+bool TimerWheel::hasPending() const {
+    return _heapSize > 0;
+}
+
+uint16_t TimerWheel::getPendingCount() const {
+    return _heapSize;
+}
+
+unsigned long TimerWheel::getNextDeadline() const {
+    return _heapSize > 0 ? _slots[_heap[0]].deadline : 0;
+}
+
+void TimerWheel::setClock(TimerWheelClock clock) {
+    _clock = clock != nullptr ? clock : timerWheelDefaultClock;
+}
+
+unsigned long TimerWheel::now() const {
+    return _clock();
+}
+
+bool TimerWheel::isDue(unsigned long deadline, unsigned long now) {
+    // signed distance keeps ordering correct across the millis() rollover for deadlines < 2^31 ms apart
+    return (long) (now - deadline) >= 0;
+}
+
+bool TimerWheel::before(uint16_t a, uint16_t b) const {
+    return (long) (_slots[_heap[a]].deadline - _slots[_heap[b]].deadline) < 0;
+}
+
+void TimerWheel::swap(uint16_t i, uint16_t j) {
+    uint16_t handle = _heap[i];
+    _heap[i] = _heap[j];
+    _heap[j] = handle;
+    _slots[_heap[i]].heapIndex = i;
+    _slots[_heap[j]].heapIndex = j;
+}
+
+void TimerWheel::siftUp(uint16_t index) {
+    while (index > 0) {
+        uint16_t parent = (index - 1) / 2;
+        if (!before(index, parent)) break;
+        swap(index, parent);
+        index = parent;
+    }
+}
+
+void TimerWheel::siftDown(uint16_t index) {
+    while (true) {
+        uint16_t left = index * 2 + 1;
+        uint16_t right = left + 1;
+        uint16_t smallest = index;
+
+        if (left < _heapSize && before(left, smallest)) smallest = left;
+        if (right < _heapSize && before(right, smallest)) smallest = right;
+        if (smallest == index) break;
+
+        swap(index, smallest);
+        index = smallest;
+    }
+}
+
+void TimerWheel::removeAt(uint16_t index) {
+    TimerHandle handle = _heap[index];
+    _heapSize--;
+
+    if (index != _heapSize) {
+        _heap[index] = _heap[_heapSize];
+        _slots[_heap[index]].heapIndex = index;
+        siftDown(index);
+        siftUp(index);
+    }
+    _slots[handle].heapIndex = TIMER_WHEEL_INVALID;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <Arduino.h>
+
+#define TIMER_WHEEL_INVALID 0xFFFF
+
+typedef uint16_t TimerHandle;
+typedef void (*TimerWheelCallback)(void *owner, uint16_t tag);
+typedef unsigned long (*TimerWheelClock)();
+
+// deadline queue shared by timer users: a binary min-heap keyed on wrap-safe millis() deadlines,
+// so tick() only looks at the earliest entry while nothing is due
+class TimerWheel {
+public:
+    explicit TimerWheel(uint16_t initialCapacity = 8);
+    ~TimerWheel();
+
+    TimerHandle allocate(TimerWheelCallback callback, void *owner, uint16_t tag = 0);
+    void release(TimerHandle handle);
+    void setTag(TimerHandle handle, uint16_t tag);
+
+    bool schedule(TimerHandle handle, unsigned long deadline);
+    bool scheduleIn(TimerHandle handle, unsigned long delay);
+    bool cancel(TimerHandle handle);
+
+    bool isPending(TimerHandle handle) const;
+    unsigned long getDeadline(TimerHandle handle) const;
+    unsigned long getRemaining(TimerHandle handle) const;
+
+    uint16_t tick();
+    uint16_t tick(unsigned long now);
+
+    bool hasPending() const;
+    uint16_t getPendingCount() const;
+    unsigned long getNextDeadline() const;
+
+    void setClock(TimerWheelClock clock);
+    unsigned long now() const;
+
+    static bool isDue(unsigned long deadline, unsigned long now);
+
+private:
+    struct Slot {
+        unsigned long deadline;
+        TimerWheelCallback callback;
+        void *owner;
+        uint16_t tag;
+        uint16_t heapIndex;
+        uint16_t nextFree;
+    };
+
+    TimerWheel(const TimerWheel &);
+    TimerWheel &operator=(const TimerWheel &);
+
+    bool grow();
+    bool isValid(TimerHandle handle) const;
+    bool before(uint16_t a, uint16_t b) const;
+    void swap(uint16_t i, uint16_t j);
+    void siftUp(uint16_t index);
+    void siftDown(uint16_t index);
+    void removeAt(uint16_t index);
+
+    Slot *_slots;
+    uint16_t *_heap;
+    uint16_t _capacity;
+    uint16_t _heapSize;
+    uint16_t _freeHead;
+    TimerWheelClock _clock;
+};
+
+#endif
\ No newline at end of file
@@ -16,7 +16,7 @@ EasyLogic::ConditionBuilder::ConditionBuilder(EasyLogic *p, const String &n)
           watchdogTimeout(0), useTransform(false), useFilter(false), useSmooth(false),
           useAverage(false), useNormalize(false), useClamp(false), useGuard(false),
           useUnless(false), useTimeRange(false), useConsecutive(false), useStable(false),
-          useHysteresis(false), useDeadzone(false) {
+          useHysteresis(false), useDeadzone(false), useCompiled(false) {
 }
 
 EasyLogic::ConditionBuilder &EasyLogic::ConditionBuilder::when(bool (*condition)()) {
@@ -449,7 +449,140 @@ EasyLogic::ConditionBuilder &EasyLogic::ConditionBuilder::withWatchdog(unsigned
     return *this;
 }
 
+EasyLogic::ConditionBuilder &EasyLogic::ConditionBuilder::compiled() {
+    useCompiled = true;
+    return *this;
+}
+
+bool EasyLogic::ConditionBuilder::needsProgram() const {
+    if (useCompiled || useGuard || useUnless || useConsecutive || useStable) {
+        return true;
+    }
+    if (!valueFunc && !valuePtr) {
+        return false;
+    }
+    return useTransform || useFilter || useSmooth || useAverage || useNormalize || useClamp ||
+           useHysteresis || useDeadzone || rateThreshold > 0 ||
+           comparison == "between" || comparison == "outside" ||
+           comparison == "approximately" || comparison == "deviates";
+}
+
+uint8_t EasyLogic::ConditionBuilder::compareCode() const {
+    if (comparison == "<") return RuleVM::CMP_LESS;
+    if (comparison == ">=") return RuleVM::CMP_GREATER_EQUAL;
+    if (comparison == "<=") return RuleVM::CMP_LESS_EQUAL;
+    if (comparison == "==") return RuleVM::CMP_EQUAL;
+    if (comparison == "!=") return RuleVM::CMP_NOT_EQUAL;
+    return RuleVM::CMP_GREATER;
+}
+
+int EasyLogic::ConditionBuilder::buildProgram() {
+    RuleVM *engine = parent->engine();
+    RuleAssembler program;
+
+    if (boolFunc || boolPtr) {
+        int source = boolFunc ? engine->bind(boolFunc) : engine->bind(boolPtr);
+        if (source < 0) return -1;
+        program.op(RuleVM::OP_FLAG).u8(source);
+    } else if (valueFunc || valuePtr) {
+        int source = valueFunc ? engine->bind(valueFunc) : engine->bind(valuePtr);
+        if (source < 0) return -1;
+        program.op(RuleVM::OP_VALUE).u8(source);
+
+        if (useTransform) {
+            int slot = engine->bind(transformer);
+            if (slot < 0) return -1;
+            program.op(RuleVM::OP_TRANSFORM).u8(slot);
+        }
+        if (useFilter) {
+            int slot = engine->bind(validator);
+            if (slot < 0) return -1;
+            program.op(RuleVM::OP_FILTER).u8(slot).u8(program.allocate());
+        }
+        if (useAverage && averageSamples > 1) {
+            program.op(RuleVM::OP_AVERAGE).u8(averageSamples > 255 ? 255 : averageSamples).u8(program.allocate(2));
+        }
+        if (useSmooth) {
+            program.op(RuleVM::OP_SMOOTH).f32(smoothFactor).u8(program.allocate());
+        }
+        if (useNormalize) {
+            program.op(RuleVM::OP_NORMALIZE).f32(normalizeMin).f32(normalizeMax);
+        }
+        if (useClamp) {
+            program.op(RuleVM::OP_CLAMP).f32(clampMin).f32(clampMax);
+        }
+        if (useDeadzone) {
+            program.op(RuleVM::OP_DEADZONE).f32(deadzone).u8(program.allocate());
+        }
+
+        if (rateThreshold > 0) {
+            program.op(RuleVM::OP_RATE).u8(program.allocate(2));
+            program.op(RuleVM::OP_COMPARE).u8(RuleVM::CMP_GREATER_EQUAL).f32(rateThreshold);
+        } else if (comparison == "between" || comparison == "outside") {
+            program.op(RuleVM::OP_BETWEEN).f32(threshold).f32(secondThreshold);
+            if (comparison == "outside") program.op(RuleVM::OP_NOT);
+        } else if (comparison == "approximately" || comparison == "deviates") {
+            program.op(RuleVM::OP_NEAR).f32(threshold).f32(secondThreshold);
+            if (comparison == "deviates") program.op(RuleVM::OP_NOT);
+        } else if (useHysteresis) {
+            program.op(RuleVM::OP_HYSTERESIS).u8(compareCode()).f32(threshold).f32(hysteresis).u8(program.allocate());
+        } else {
+            program.op(RuleVM::OP_COMPARE).u8(compareCode()).f32(threshold);
+        }
+    } else {
+        return -1;
+    }
+
+    if (useConsecutive && consecutiveCount > 1) {
+        program.op(RuleVM::OP_CONSECUTIVE).u8(consecutiveCount > 255 ? 255 : consecutiveCount).u8(program.allocate());
+    }
+    if (useStable) {
+        program.op(RuleVM::OP_STABLE).u32(stableDuration).u8(program.allocate(2));
+    }
+    if (useGuard && guardCondition) {
+        int slot = engine->bind(guardCondition);
+        if (slot < 0) return -1;
+        program.op(RuleVM::OP_FLAG).u8(slot).op(RuleVM::OP_AND);
+    }
+    if (useUnless && unlessCondition) {
+        int slot = engine->bind(unlessCondition);
+        if (slot < 0) return -1;
+        program.op(RuleVM::OP_FLAG).u8(slot).op(RuleVM::OP_NOT).op(RuleVM::OP_AND);
+    }
+    program.op(RuleVM::OP_END);
+
+    if (program.hasOverflowed()) {
+        return -1;
+    }
+    uint16_t length;
+    const uint8_t *code = program.finish(length);
+    return engine->load(code, length);
+}
+
 int EasyLogic::ConditionBuilder::build() {
+    if (!needsProgram()) {
+        return addToCore();
+    }
+
+    int programId = buildProgram();
+    if (programId < 0) {
+        // sources bound before the failure would otherwise hold their slots for good
+        parent->vm->releaseSources();
+        return -1;
+    }
+    boolPtr = parent->vm->getResultPointer(programId);
+    boolFunc = nullptr;
+    valueFunc = nullptr;
+    valuePtr = nullptr;
+
+    int id = addToCore();
+    if (id < 0) {
+        parent->vm->unload(programId);
+    }
+    return id;
+}
+
+int EasyLogic::ConditionBuilder::addToCore() {
     if (boolFunc) {
         if (actionDuration > 0) {
             if (paramAction) {
@@ -596,10 +729,12 @@ int EasyLogic::CompositeBuilder::asXOR(void (*action)()) {
 
 EasyLogic::EasyLogic(int capacity) {
     core = new LogicConditionManager(capacity);
+    vm = nullptr;
 }
 
 EasyLogic::~EasyLogic() {
     delete core;
+    delete vm;
 }
 
 int EasyLogic::button(const String &name, bool (*condition)(), void (*action)()) {
@@ -690,7 +825,23 @@ EasyLogic::CompositeBuilder EasyLogic::combine(const String &name) {
     return CompositeBuilder(this, name);
 }
 
+int EasyLogic::load(const String &name, const uint8_t *code, uint16_t length,
+                    LogicConditionManager::TriggerType trigger, void (*action)()) {
+    int programId = engine()->load(code, length);
+    if (programId < 0) {
+        return -1;
+    }
+    int id = core->addCondition(name, vm->getResultPointer(programId), trigger, action);
+    if (id < 0) {
+        vm->unload(programId);
+    }
+    return id;
+}
+
 void EasyLogic::run() {
+    if (vm != nullptr) {
+        vm->runAll();
+    }
     core->update();
 }
 
@@ -715,7 +866,18 @@ void EasyLogic::reset(const String &name) {
 }
 
 bool EasyLogic::remove(const String &name) {
-    return core->removeCondition(name);
+    bool *result = core->getConditionPointer(name);
+    if (!core->removeCondition(name)) {
+        return false;
+    }
+    // a compiled condition takes its program with it
+    if (vm != nullptr) {
+        int programId = vm->findProgram(result);
+        if (programId >= 0) {
+            vm->unload(programId);
+        }
+    }
+    return true;
 }
 
 bool EasyLogic::isActive(const String &name) {
@@ -760,4 +922,11 @@ bool EasyLogic::exists(const String &name) {
 
 LogicConditionManager *EasyLogic::advanced() {
     return core;
+}
+
+RuleVM *EasyLogic::engine() {
+    if (vm == nullptr) {
+        vm = new RuleVM();
+    }
+    return vm;
 }
\ No newline at end of file
@@ -3,10 +3,12 @@
 
 #include "Arduino.h"
 #include "LogicConditionManager.h"
+#include "RuleVM.h"
 
 class EasyLogic {
 private:
     LogicConditionManager *core;
+    RuleVM *vm;
 
 public:
     class ConditionBuilder {
@@ -83,6 +85,11 @@ public:
         bool useStable;
         bool useHysteresis;
         bool useDeadzone;
+        bool useCompiled;
+
+        bool needsProgram() const;
+        uint8_t compareCode() const;
+        int addToCore();
 
     public:
         ConditionBuilder(EasyLogic *p, const String &n);
@@ -168,7 +175,9 @@ public:
         ConditionBuilder &withName(const String &debugName);
         ConditionBuilder &reportEvery(int executions);
         ConditionBuilder &withWatchdog(unsigned long timeoutMs);
+        ConditionBuilder &compiled();
 
+        int buildProgram();
         int build();
     };
 
@@ -215,6 +224,10 @@ public:
     ConditionBuilder create(const String &name);
     CompositeBuilder combine(const String &name);
 
+    int load(const String &name, const uint8_t *code, uint16_t length,
+             LogicConditionManager::TriggerType trigger = LogicConditionManager::WHEN_TRUE,
+             void (*action)() = nullptr);
+
     void run();
 
     void enable(const String &name);
@@ -238,6 +251,7 @@ public:
     bool exists(const String &name);
 
     LogicConditionManager *advanced();
+    RuleVM *engine();
 };
 
 #endif
\ No newline at end of file
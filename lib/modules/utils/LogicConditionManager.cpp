@@ -1,42 +1,322 @@
 #include "LogicConditionManager.h"
 
 LogicConditionManager::LogicConditionManager(int initialCapacity) {
-    capacity = initialCapacity;
-    conditions = new Condition[capacity];
+    conditions.reserve(initialCapacity);
     conditionCount = 0;
-    lastNameLookup = "";
-    lastIdFound = -1;
+    evaluationOrder = NULL;
+    compiledCount = 0;
+    initializedCount = 0;
+    graphDirty = true;
+    evaluationPass = 0;
+    wheel = NULL;
 }
 
 LogicConditionManager::~LogicConditionManager() {
+    attachTimerWheel(NULL);
     for (int i = 0; i < conditionCount; i++) {
-        if (conditions[i].childConditions != NULL) {
-            delete[] conditions[i].childConditions;
+        if (hasChildren(conditions[i].type) && conditions[i].group.children != NULL) {
+            delete[] conditions[i].group.children;
         }
+        if (conditions[i].extension != NULL) {
+            delete conditions[i].extension;
+        }
+    }
+    if (evaluationOrder != NULL) {
+        delete[] evaluationOrder;
     }
-    delete[] conditions;
 }
 
 int LogicConditionManager::findConditionIdByName(const String &name) {
-    if (name.equals(lastNameLookup) && lastIdFound >= 0 && lastIdFound < conditionCount) {
-        return lastIdFound;
-    }
+    uint32_t nameHash = NameArena::hash(name.c_str());
     for (int i = 0; i < conditionCount; i++) {
-        if (conditions[i].name.equals(name)) {
-            lastNameLookup = name;
-            lastIdFound = i;
+        if (conditions[i].nameHash == nameHash && names.equals(conditions[i].nameOffset, name.c_str())) {
             return i;
         }
     }
     return -1;
 }
 
-void LogicConditionManager::expandCapacity() {
-    capacity *= 2;
-    Condition *newConditions = new Condition[capacity];
-    memcpy(newConditions, conditions, conditionCount * sizeof(Condition));
-    delete[] conditions;
-    conditions = newConditions;
+int LogicConditionManager::allocateCondition(const String &name, ConditionType type, TriggerType triggerType,
+                                             int repeatCount, unsigned long interval) {
+    if (!conditions.reserve(conditionCount + 1)) {
+        return -1;
+    }
+
+    uint16_t nameOffset;
+    int existingId = findConditionIdByName(name);
+    if (existingId >= 0) {
+        nameOffset = conditions[existingId].nameOffset;
+    } else {
+        nameOffset = names.add(name.c_str());
+        if (nameOffset == NAME_ARENA_INVALID) {
+            return -1;
+        }
+    }
+
+    int id = conditionCount++;
+    Condition &cond = conditions[id];
+    memset(&cond, 0, sizeof(Condition));
+    cond.nameHash = NameArena::hash(name.c_str());
+    cond.nameOffset = nameOffset;
+    cond.type = type;
+    cond.triggerType = triggerType;
+    cond.state = IDLE;
+    cond.enabled = true;
+    cond.repeatCount = repeatCount;
+    cond.interval = interval;
+    if (hasWindow(type)) {
+        cond.group.windowHandle = TIMER_WHEEL_INVALID;
+    }
+    return id;
+}
+
+void LogicConditionManager::setAction(int conditionId, void (*actionFunction)(),
+                                      void (*paramActionFunction)(void *), void *param) {
+    Condition &cond = conditions[conditionId];
+    if (paramActionFunction != NULL) {
+        cond.actionFunction = reinterpret_cast<void (*)()>(paramActionFunction);
+        cond.paramAction = true;
+        getExtension(conditionId)->actionParam = param;
+    } else {
+        cond.actionFunction = actionFunction;
+        cond.paramAction = false;
+    }
+}
+
+void LogicConditionManager::setActionTiming(int conditionId, unsigned long debounceTime, unsigned long actionDuration,
+                                            void (*stopActionFunction)(), unsigned long waitInterval) {
+    if (debounceTime == 0 && actionDuration == 0 && stopActionFunction == NULL && waitInterval == 0) {
+        return;
+    }
+
+    ActionExtension *ext = getExtension(conditionId);
+    ext->debounceTime = debounceTime;
+    ext->actionDuration = actionDuration;
+    ext->stopActionFunction = stopActionFunction;
+    ext->waitInterval = waitInterval;
+}
+
+void LogicConditionManager::setChildren(int conditionId, LogicOp logicOperator, int conditionIds[], int count) {
+    Condition &cond = conditions[conditionId];
+    cond.group.logicOp = logicOperator;
+    cond.group.childCount = count;
+    cond.group.children = new int16_t[count > 0 ? count : 1];
+    for (int i = 0; i < count; i++) {
+        cond.group.children[i] = conditionIds[i];
+    }
+}
+
+LogicConditionManager::ActionExtension *LogicConditionManager::getExtension(int conditionId) {
+    Condition &cond = conditions[conditionId];
+    if (cond.extension == NULL) {
+        cond.extension = new ActionExtension();
+        cond.extension->timerHandle = TIMER_WHEEL_INVALID;
+    }
+    return cond.extension;
+}
+
+void LogicConditionManager::attachTimerWheel(TimerWheel *timerWheel) {
+    for (int i = 0; i < conditionCount && wheel != NULL; i++) {
+        ActionExtension *ext = conditions[i].extension;
+        if (ext != NULL && ext->timerHandle != TIMER_WHEEL_INVALID) {
+            wheel->release(ext->timerHandle);
+            ext->timerHandle = TIMER_WHEEL_INVALID;
+        }
+        if (hasWindow(conditions[i].type) && conditions[i].group.windowHandle != TIMER_WHEEL_INVALID) {
+            wheel->release(conditions[i].group.windowHandle);
+            conditions[i].group.windowHandle = TIMER_WHEEL_INVALID;
+        }
+        // open windows are armed again on their next evaluation
+        conditions[i].windowOver = false;
+    }
+
+    wheel = timerWheel;
+    for (int i = 0; i < conditionCount && wheel != NULL; i++) {
+        scheduleAction(i);
+    }
+}
+
+void LogicConditionManager::scheduleAction(int conditionId) {
+    Condition &cond = conditions[conditionId];
+    ActionExtension *ext = cond.extension;
+    if (wheel == NULL || ext == NULL) {
+        return;
+    }
+
+    if (ext->timerHandle == TIMER_WHEEL_INVALID) {
+        if (!cond.actionActive && !cond.actionWaiting) {
+            return;
+        }
+        ext->timerHandle = wheel->allocate(onWheelExpiry, this, conditionId);
+    }
+
+    if (cond.actionActive) {
+        wheel->scheduleIn(ext->timerHandle, remainingTime(ext->actionStartTime, ext->actionDuration));
+    } else if (cond.actionWaiting) {
+        wheel->scheduleIn(ext->timerHandle, remainingTime(ext->waitStartTime, ext->waitInterval));
+    } else {
+        wheel->cancel(ext->timerHandle);
+    }
+}
+
+void LogicConditionManager::onWheelExpiry(void *owner, uint16_t tag) {
+    LogicConditionManager *manager = static_cast<LogicConditionManager *>(owner);
+    if (tag >= manager->conditionCount || manager->conditions[tag].extension == NULL) {
+        return;
+    }
+
+    manager->handleActionDuration(tag);
+    manager->scheduleAction(tag);
+}
+
+unsigned long LogicConditionManager::remainingTime(unsigned long startTime, unsigned long duration) {
+    // start times are millis() stamps, the wheel may run on its own clock
+    unsigned long elapsed = millis() - startTime;
+    return elapsed >= duration ? 0 : duration - elapsed;
+}
+
+void LogicConditionManager::armWindow(int conditionId) {
+    Condition &cond = conditions[conditionId];
+    cond.windowOver = false;
+    if (wheel == NULL) {
+        return;
+    }
+
+    GroupPayload &group = cond.group;
+    unsigned long remaining = remainingTime(group.startTime, group.duration);
+    if (group.duration == 0 || remaining == 0) {
+        wheel->cancel(group.windowHandle);
+        cond.windowOver = group.duration > 0;
+        return;
+    }
+    if (group.windowHandle == TIMER_WHEEL_INVALID) {
+        group.windowHandle = wheel->allocate(onWindowExpiry, this, conditionId);
+    }
+    wheel->scheduleIn(group.windowHandle, remaining);
+}
+
+bool LogicConditionManager::isWindowOver(int conditionId) {
+    Condition &cond = conditions[conditionId];
+    GroupPayload &group = cond.group;
+    if (group.duration == 0) {
+        return false;
+    }
+    if (wheel == NULL) {
+        return millis() - group.startTime >= group.duration;
+    }
+
+    // TIMER conditions have no point where their window opens, they are armed when first asked
+    if (!cond.windowOver && !wheel->isPending(group.windowHandle)) {
+        armWindow(conditionId);
+    }
+    return cond.windowOver;
+}
+
+void LogicConditionManager::onWindowExpiry(void *owner, uint16_t tag) {
+    LogicConditionManager *manager = static_cast<LogicConditionManager *>(owner);
+    if (tag >= manager->conditionCount || !hasWindow(manager->conditions[tag].type)) {
+        return;
+    }
+
+    // only flagged, the condition acts on it when update() evaluates it next
+    manager->conditions[tag].windowOver = true;
+}
+
+void LogicConditionManager::primeCondition(int conditionId) {
+    Condition &cond = conditions[conditionId];
+
+    if (cond.type == BOOLEAN_FUNCTION && cond.boolFunction) {
+        cond.lastBoolValue = cond.boolFunction();
+        cond.currentBoolValue = cond.lastBoolValue;
+    } else if (cond.type == BOOLEAN_POINTER && cond.boolPointer) {
+        cond.lastBoolValue = *cond.boolPointer;
+        cond.currentBoolValue = cond.lastBoolValue;
+    } else if (cond.type == VALUE_FUNCTION && cond.value.source.function) {
+        cond.value.currentValue = cond.value.source.function();
+        cond.lastBoolValue = evaluateValueCondition(cond.value.currentValue, cond.value.threshold,
+                                                    (ComparisonType) cond.value.comparison);
+        cond.currentBoolValue = cond.lastBoolValue;
+        cond.value.lastValue = cond.value.currentValue;
+        cond.hasValidFloatValue = true;
+    } else if (cond.type == VALUE_POINTER && cond.value.source.pointer) {
+        cond.value.currentValue = *cond.value.source.pointer;
+        cond.lastBoolValue = evaluateValueCondition(cond.value.currentValue, cond.value.threshold,
+                                                    (ComparisonType) cond.value.comparison);
+        cond.currentBoolValue = cond.lastBoolValue;
+        cond.value.lastValue = cond.value.currentValue;
+        cond.hasValidFloatValue = true;
+    }
+}
+
+void LogicConditionManager::runAction(Condition &cond) {
+    if (cond.actionFunction == NULL) {
+        return;
+    }
+    if (cond.paramAction) {
+        reinterpret_cast<void (*)(void *)>(cond.actionFunction)(cond.extension ? cond.extension->actionParam : NULL);
+    } else {
+        cond.actionFunction();
+    }
+}
+
+bool LogicConditionManager::hasChildren(uint8_t type) {
+    return type == COMPOSITE || type == SEQUENCE || type == EDGE_COUNTER;
+}
+
+bool LogicConditionManager::hasWindow(uint8_t type) {
+    return type == TIMER || type == SEQUENCE || type == EDGE_COUNTER;
+}
+
+void LogicConditionManager::compile() {
+    if (evaluationOrder != NULL) {
+        delete[] evaluationOrder;
+    }
+    evaluationOrder = new int[conditionCount > 0 ? conditionCount : 1];
+
+    uint8_t *marks = new uint8_t[conditionCount > 0 ? conditionCount : 1];
+    memset(marks, 0, conditionCount > 0 ? conditionCount : 1);
+
+    int orderIndex = 0;
+    for (int i = 0; i < conditionCount; i++) {
+        visitCondition(i, marks, orderIndex);
+    }
+    delete[] marks;
+
+    for (int i = initializedCount; i < conditionCount; i++) {
+        conditions[i].evalPass = 0;
+        conditions[i].changedPass = 0;
+        conditions[i].memoResult = false;
+    }
+    for (int i = 0; i < conditionCount; i++) {
+        if (conditions[i].type == COMPOSITE) {
+            conditions[i].group.computedPass = 0;
+        }
+    }
+
+    initializedCount = conditionCount;
+    compiledCount = conditionCount;
+    graphDirty = false;
+}
+
+void LogicConditionManager::visitCondition(int conditionId, uint8_t *marks, int &orderIndex) {
+    // 1 = on the current path, a back edge is skipped instead of recursing forever
+    if (marks[conditionId] != 0) {
+        return;
+    }
+    marks[conditionId] = 1;
+
+    Condition &cond = conditions[conditionId];
+    if (hasChildren(cond.type) && cond.group.children != NULL) {
+        for (int i = 0; i < cond.group.childCount; i++) {
+            int childId = cond.group.children[i];
+            if (childId >= 0 && childId < conditionCount) {
+                visitCondition(childId, marks, orderIndex);
+            }
+        }
+    }
+
+    marks[conditionId] = 2;
+    evaluationOrder[orderIndex++] = conditionId;
 }
 
 bool LogicConditionManager::evaluateCondition(int conditionId) {
@@ -44,6 +324,21 @@ bool LogicConditionManager::evaluateCondition(int conditionId) {
         return false;
     }
 
+    Condition &cond = conditions[conditionId];
+    if (cond.evalPass == evaluationPass) {
+        return cond.memoResult;
+    }
+    cond.evalPass = evaluationPass;
+
+    bool result = evaluateNode(conditionId);
+    if (result != cond.memoResult) {
+        cond.memoResult = result;
+        cond.changedPass = evaluationPass;
+    }
+    return result;
+}
+
+bool LogicConditionManager::evaluateNode(int conditionId) {
     Condition &cond = conditions[conditionId];
     bool result = false;
 
@@ -61,16 +356,18 @@ bool LogicConditionManager::evaluateCondition(int conditionId) {
             break;
 
         case VALUE_FUNCTION:
-            if (cond.valueFunction) {
-                cond.currentFloatValue = cond.valueFunction();
-                cond.currentBoolValue = evaluateValueCondition(cond.currentFloatValue, cond.threshold, cond.comparison);
+            if (cond.value.source.function) {
+                cond.value.currentValue = cond.value.source.function();
+                cond.currentBoolValue = evaluateValueCondition(cond.value.currentValue, cond.value.threshold,
+                                                               (ComparisonType) cond.value.comparison);
             }
             break;
 
         case VALUE_POINTER:
-            if (cond.valuePointer) {
-                cond.currentFloatValue = *cond.valuePointer;
-                cond.currentBoolValue = evaluateValueCondition(cond.currentFloatValue, cond.threshold, cond.comparison);
+            if (cond.value.source.pointer) {
+                cond.value.currentValue = *cond.value.source.pointer;
+                cond.currentBoolValue = evaluateValueCondition(cond.value.currentValue, cond.value.threshold,
+                                                               (ComparisonType) cond.value.comparison);
             }
             break;
 
@@ -78,18 +375,12 @@ bool LogicConditionManager::evaluateCondition(int conditionId) {
             cond.currentBoolValue = evaluateComposite(conditionId);
             break;
 
-        case TIMER: {
-            unsigned long currentTime = millis();
+        case TIMER:
             if (cond.state == IDLE) {
                 cond.currentBoolValue = false;
             } else if (cond.state == TRIGGERED || cond.state == EXECUTING) {
-                if (cond.duration > 0 && currentTime - cond.startTime >= cond.duration) {
-                    cond.currentBoolValue = true;
-                } else {
-                    cond.currentBoolValue = false;
-                }
+                cond.currentBoolValue = isWindowOver(conditionId);
             }
-        }
             break;
 
         case SEQUENCE:
@@ -97,25 +388,25 @@ bool LogicConditionManager::evaluateCondition(int conditionId) {
             break;
 
         case EDGE_COUNTER:
-            if (cond.childCount > 0 && cond.childConditions != NULL) {
-                int targetId = cond.childConditions[0];
+            if (cond.group.childCount > 0 && cond.group.children != NULL) {
+                int targetId = cond.group.children[0];
                 if (targetId >= 0 && targetId < conditionCount) {
                     bool targetTriggered = evaluateCondition(targetId);
-                    unsigned long currentTime = millis();
 
                     if (cond.state == IDLE && targetTriggered) {
-                        cond.startTime = currentTime;
-                        cond.occurrenceCount = 1;
+                        cond.group.startTime = millis();
+                        cond.group.occurrenceCount = 1;
                         cond.state = TRIGGERED;
+                        armWindow(conditionId);
                     } else if (cond.state == TRIGGERED || cond.state == EXECUTING) {
-                        if (targetTriggered && !conditions[targetId].wasTriggered) {
-                            cond.occurrenceCount++;
+                        if (targetTriggered && conditions[targetId].changedPass == evaluationPass) {
+                            cond.group.occurrenceCount++;
                         }
-                        if (cond.occurrenceCount >= cond.minOccurrences) {
+                        if (cond.group.occurrenceCount >= cond.group.minOccurrences) {
                             cond.currentBoolValue = true;
                         }
-                        if (cond.duration > 0 && currentTime - cond.startTime >= cond.duration) {
-                            if (cond.occurrenceCount < cond.minOccurrences) {
+                        if (isWindowOver(conditionId)) {
+                            if (cond.group.occurrenceCount < cond.group.minOccurrences) {
                                 resetCondition(conditionId);
                             }
                         }
@@ -143,12 +434,13 @@ bool LogicConditionManager::evaluateCondition(int conditionId) {
             break;
     }
 
-    if (cond.debounceTime > 0 && result) {
+    ActionExtension *ext = cond.extension;
+    if (ext != NULL && ext->debounceTime > 0 && result) {
         unsigned long currentTime = millis();
-        if (currentTime - cond.lastDebounceTime < cond.debounceTime) {
+        if (currentTime - ext->lastDebounceTime < ext->debounceTime) {
             result = false;
         } else {
-            cond.lastDebounceTime = currentTime;
+            ext->lastDebounceTime = currentTime;
         }
     }
 
@@ -170,14 +462,14 @@ bool LogicConditionManager::evaluateOnChange(int conditionId) {
         case VALUE_FUNCTION:
         case VALUE_POINTER: {
             if (!cond.hasValidFloatValue) {
-                cond.lastFloatValue = cond.currentFloatValue;
+                cond.value.lastValue = cond.value.currentValue;
                 cond.hasValidFloatValue = true;
                 return false;
             }
 
-            bool changed = (cond.currentFloatValue != cond.lastFloatValue);
+            bool changed = (cond.value.currentValue != cond.value.lastValue);
             if (changed) {
-                cond.lastFloatValue = cond.currentFloatValue;
+                cond.value.lastValue = cond.value.currentValue;
             }
             return changed;
         }
@@ -193,17 +485,33 @@ bool LogicConditionManager::evaluateComposite(int conditionId) {
     }
 
     Condition &cond = conditions[conditionId];
-    if (cond.type != COMPOSITE || cond.childConditions == NULL || cond.childCount <= 0) {
+    GroupPayload &group = cond.group;
+    if (cond.type != COMPOSITE || group.children == NULL || group.childCount <= 0) {
         return false;
     }
 
+    bool childChanged = (group.computedPass == 0);
+    for (int i = 0; i < group.childCount; i++) {
+        int childId = group.children[i];
+        if (childId >= 0 && childId < conditionCount) {
+            evaluateCondition(childId);
+            if (conditions[childId].changedPass > group.computedPass) {
+                childChanged = true;
+            }
+        }
+    }
+    if (!childChanged) {
+        return cond.currentBoolValue;
+    }
+    group.computedPass = evaluationPass;
+
     bool result = false;
 
-    switch (cond.logicOp) {
+    switch (group.logicOp) {
         case AND:
             result = true;
-            for (int i = 0; i < cond.childCount; i++) {
-                int childId = cond.childConditions[i];
+            for (int i = 0; i < group.childCount; i++) {
+                int childId = group.children[i];
                 if (childId >= 0 && childId < conditionCount) {
                     if (!evaluateCondition(childId)) {
                         result = false;
@@ -215,8 +523,8 @@ bool LogicConditionManager::evaluateComposite(int conditionId) {
 
         case OR:
             result = false;
-            for (int i = 0; i < cond.childCount; i++) {
-                int childId = cond.childConditions[i];
+            for (int i = 0; i < group.childCount; i++) {
+                int childId = group.children[i];
                 if (childId >= 0 && childId < conditionCount) {
                     if (evaluateCondition(childId)) {
                         result = true;
@@ -227,8 +535,8 @@ bool LogicConditionManager::evaluateComposite(int conditionId) {
             break;
 
         case NOT:
-            if (cond.childCount > 0) {
-                int childId = cond.childConditions[0];
+            if (group.childCount > 0) {
+                int childId = group.children[0];
                 if (childId >= 0 && childId < conditionCount) {
                     result = !evaluateCondition(childId);
                 }
@@ -237,8 +545,8 @@ bool LogicConditionManager::evaluateComposite(int conditionId) {
 
         case XOR: {
             int trueCount = 0;
-            for (int i = 0; i < cond.childCount; i++) {
-                int childId = cond.childConditions[i];
+            for (int i = 0; i < group.childCount; i++) {
+                int childId = group.children[i];
                 if (childId >= 0 && childId < conditionCount) {
                     if (evaluateCondition(childId)) {
                         trueCount++;
@@ -251,8 +559,8 @@ bool LogicConditionManager::evaluateComposite(int conditionId) {
 
         case NAND:
             result = true;
-            for (int i = 0; i < cond.childCount; i++) {
-                int childId = cond.childConditions[i];
+            for (int i = 0; i < group.childCount; i++) {
+                int childId = group.children[i];
                 if (childId >= 0 && childId < conditionCount) {
                     if (!evaluateCondition(childId)) {
                         result = false;
@@ -265,8 +573,8 @@ bool LogicConditionManager::evaluateComposite(int conditionId) {
 
         case NOR:
             result = true;
-            for (int i = 0; i < cond.childCount; i++) {
-                int childId = cond.childConditions[i];
+            for (int i = 0; i < group.childCount; i++) {
+                int childId = group.children[i];
                 if (childId >= 0 && childId < conditionCount) {
                     if (evaluateCondition(childId)) {
                         result = false;
@@ -286,37 +594,37 @@ bool LogicConditionManager::evaluateSequence(int conditionId) {
     }
 
     Condition &cond = conditions[conditionId];
-    if (cond.type != SEQUENCE || cond.childConditions == NULL || cond.childCount <= 0) {
+    GroupPayload &group = cond.group;
+    if (cond.type != SEQUENCE || group.children == NULL || group.childCount <= 0) {
         return false;
     }
 
-    unsigned long currentTime = millis();
-
     if (cond.state == IDLE) {
-        for (int i = 0; i < cond.childCount; i++) {
-            int childId = cond.childConditions[i];
+        for (int i = 0; i < group.childCount; i++) {
+            int childId = group.children[i];
             if (childId >= 0 && childId < conditionCount) {
                 if (evaluateCondition(childId)) {
-                    cond.startTime = currentTime;
-                    cond.occurrenceCount = 1;
+                    group.startTime = millis();
+                    group.occurrenceCount = 1;
                     cond.state = TRIGGERED;
+                    armWindow(conditionId);
                     break;
                 }
             }
         }
         return false;
     } else if (cond.state == TRIGGERED) {
-        if (cond.duration > 0 && currentTime - cond.startTime >= cond.duration) {
+        if (isWindowOver(conditionId)) {
             cond.state = IDLE;
             return false;
         }
 
-        for (int i = cond.occurrenceCount; i < cond.childCount; i++) {
-            int childId = cond.childConditions[i];
+        for (int i = group.occurrenceCount; i < group.childCount; i++) {
+            int childId = group.children[i];
             if (childId >= 0 && childId < conditionCount) {
                 if (evaluateCondition(childId)) {
-                    cond.occurrenceCount++;
-                    if (cond.occurrenceCount >= cond.childCount) {
+                    group.occurrenceCount++;
+                    if (group.occurrenceCount >= group.childCount) {
                         return true;
                     }
                     break;
@@ -334,9 +642,11 @@ void LogicConditionManager::updateConditionState(int conditionId, bool triggered
     }
 
     Condition &cond = conditions[conditionId];
+    ActionExtension *ext = cond.extension;
+    unsigned long actionDuration = ext != NULL ? ext->actionDuration : 0;
     unsigned long currentTime = millis();
 
-    if (cond.actionDuration > 0) {
+    if (actionDuration > 0 && wheel == NULL) {
         handleActionDuration(conditionId);
     }
 
@@ -349,26 +659,22 @@ void LogicConditionManager::updateConditionState(int conditionId, bool triggered
         cond.lastTriggerTime = currentTime;
         cond.wasTriggered = true;
 
-        if (cond.actionFunction || cond.paramActionFunction) {
+        if (cond.actionFunction) {
             cond.state = EXECUTING;
             cond.executionCount = 0;
             cond.lastExecutionTime = currentTime;
 
-            if (cond.actionDuration > 0) {
-                cond.actionStartTime = currentTime;
+            if (actionDuration > 0) {
+                ext->actionStartTime = currentTime;
                 cond.actionActive = true;
                 cond.state = ACTION_RUNNING;
+                scheduleAction(conditionId);
             }
 
-            if (cond.actionFunction) {
-                cond.actionFunction();
-            } else if (cond.paramActionFunction) {
-                cond.paramActionFunction(cond.actionParam);
-            }
-
+            runAction(cond);
             cond.executionCount++;
 
-            if (cond.repeatCount == 1 && cond.actionDuration == 0) {
+            if (cond.repeatCount == 1 && actionDuration == 0) {
                 cond.state = COMPLETED;
             }
         }
@@ -376,11 +682,7 @@ void LogicConditionManager::updateConditionState(int conditionId, bool triggered
         bool actionDue = (currentTime - cond.lastExecutionTime >= cond.interval);
 
         if (actionDue && cond.executionCount < cond.repeatCount) {
-            if (cond.actionFunction) {
-                cond.actionFunction();
-            } else if (cond.paramActionFunction) {
-                cond.paramActionFunction(cond.actionParam);
-            }
+            runAction(cond);
 
             cond.executionCount++;
             cond.lastExecutionTime = currentTime;
@@ -398,17 +700,18 @@ void LogicConditionManager::updateConditionState(int conditionId, bool triggered
 
 void LogicConditionManager::handleActionDuration(int conditionId) {
     Condition &cond = conditions[conditionId];
+    ActionExtension *ext = cond.extension;
     unsigned long currentTime = millis();
 
-    if (cond.actionActive && currentTime - cond.actionStartTime >= cond.actionDuration) {
-        if (cond.stopActionFunction) {
-            cond.stopActionFunction();
+    if (cond.actionActive && currentTime - ext->actionStartTime >= ext->actionDuration) {
+        if (ext->stopActionFunction) {
+            ext->stopActionFunction();
         }
         cond.actionActive = false;
 
-        if (cond.waitInterval > 0) {
+        if (ext->waitInterval > 0) {
             cond.actionWaiting = true;
-            cond.waitStartTime = currentTime;
+            ext->waitStartTime = currentTime;
             cond.state = ACTION_WAITING;
         } else {
             if (cond.repeatCount == 1) {
@@ -419,7 +722,7 @@ void LogicConditionManager::handleActionDuration(int conditionId) {
         }
     }
 
-    if (cond.actionWaiting && currentTime - cond.waitStartTime >= cond.waitInterval) {
+    if (cond.actionWaiting && currentTime - ext->waitStartTime >= ext->waitInterval) {
         cond.actionWaiting = false;
         if (cond.repeatCount == 1) {
             cond.state = COMPLETED;
@@ -452,50 +755,8 @@ int LogicConditionManager::addCondition(const String &name, bool (*conditionFunc
                                         TriggerType triggerType, void (*actionFunction)(),
                                         int repeatCount, unsigned long interval,
                                         unsigned long debounceTime) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
-    }
-
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = BOOLEAN_FUNCTION;
-    conditions[id].triggerType = triggerType;
-    conditions[id].boolFunction = conditionFunction;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = NULL;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = debounceTime;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = 0;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = 0;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = conditionFunction();
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
-    return id;
+    return addCondition(name, conditionFunction, triggerType, actionFunction, repeatCount, interval,
+                        debounceTime, 0, NULL, 0);
 }
 
 int LogicConditionManager::addCondition(const String &name, bool (*conditionFunction)(),
@@ -503,49 +764,15 @@ int LogicConditionManager::addCondition(const String &name, bool (*conditionFunc
                                         int repeatCount, unsigned long interval,
                                         unsigned long debounceTime, unsigned long actionDuration,
                                         void (*stopActionFunction)(), unsigned long waitInterval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
+    int id = allocateCondition(name, BOOLEAN_FUNCTION, triggerType, repeatCount, interval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = BOOLEAN_FUNCTION;
-    conditions[id].triggerType = triggerType;
     conditions[id].boolFunction = conditionFunction;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = stopActionFunction;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = debounceTime;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = actionDuration;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = waitInterval;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = conditionFunction();
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
+    setAction(id, actionFunction, NULL, NULL);
+    setActionTiming(id, debounceTime, actionDuration, stopActionFunction, waitInterval);
+    primeCondition(id);
     return id;
 }
 
@@ -553,50 +780,8 @@ int LogicConditionManager::addCondition(const String &name, bool *conditionPoint
                                         TriggerType triggerType, void (*actionFunction)(),
                                         int repeatCount, unsigned long interval,
                                         unsigned long debounceTime) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
-    }
-
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = BOOLEAN_POINTER;
-    conditions[id].triggerType = triggerType;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = conditionPointer;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = NULL;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = debounceTime;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = 0;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = 0;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = *conditionPointer;
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
-    return id;
+    return addCondition(name, conditionPointer, triggerType, actionFunction, repeatCount, interval,
+                        debounceTime, 0, NULL, 0);
 }
 
 int LogicConditionManager::addCondition(const String &name, bool *conditionPointer,
@@ -604,49 +789,15 @@ int LogicConditionManager::addCondition(const String &name, bool *conditionPoint
                                         int repeatCount, unsigned long interval,
                                         unsigned long debounceTime, unsigned long actionDuration,
                                         void (*stopActionFunction)(), unsigned long waitInterval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
+    int id = allocateCondition(name, BOOLEAN_POINTER, triggerType, repeatCount, interval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = BOOLEAN_POINTER;
-    conditions[id].triggerType = triggerType;
-    conditions[id].boolFunction = NULL;
     conditions[id].boolPointer = conditionPointer;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = stopActionFunction;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = debounceTime;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = actionDuration;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = waitInterval;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = *conditionPointer;
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
+    setAction(id, actionFunction, NULL, NULL);
+    setActionTiming(id, debounceTime, actionDuration, stopActionFunction, waitInterval);
+    primeCondition(id);
     return id;
 }
 
@@ -654,50 +805,8 @@ int LogicConditionManager::addCondition(const String &name, bool (*conditionFunc
                                         TriggerType triggerType, void (*actionFunction)(void *), void *param,
                                         int repeatCount, unsigned long interval,
                                         unsigned long debounceTime) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
-    }
-
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = BOOLEAN_FUNCTION;
-    conditions[id].triggerType = triggerType;
-    conditions[id].boolFunction = conditionFunction;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = NULL;
-    conditions[id].paramActionFunction = actionFunction;
-    conditions[id].actionParam = param;
-    conditions[id].stopActionFunction = NULL;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = debounceTime;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = 0;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = 0;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = conditionFunction();
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
-    return id;
+    return addCondition(name, conditionFunction, triggerType, actionFunction, param, repeatCount, interval,
+                        debounceTime, 0, NULL, 0);
 }
 
 int LogicConditionManager::addCondition(const String &name, bool (*conditionFunction)(),
@@ -705,49 +814,15 @@ int LogicConditionManager::addCondition(const String &name, bool (*conditionFunc
                                         int repeatCount, unsigned long interval,
                                         unsigned long debounceTime, unsigned long actionDuration,
                                         void (*stopActionFunction)(), unsigned long waitInterval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
+    int id = allocateCondition(name, BOOLEAN_FUNCTION, triggerType, repeatCount, interval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = BOOLEAN_FUNCTION;
-    conditions[id].triggerType = triggerType;
     conditions[id].boolFunction = conditionFunction;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = NULL;
-    conditions[id].paramActionFunction = actionFunction;
-    conditions[id].actionParam = param;
-    conditions[id].stopActionFunction = stopActionFunction;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = debounceTime;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = actionDuration;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = waitInterval;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = conditionFunction();
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
+    setAction(id, NULL, actionFunction, param);
+    setActionTiming(id, debounceTime, actionDuration, stopActionFunction, waitInterval);
+    primeCondition(id);
     return id;
 }
 
@@ -755,50 +830,8 @@ int LogicConditionManager::addCondition(const String &name, bool *conditionPoint
                                         TriggerType triggerType, void (*actionFunction)(void *), void *param,
                                         int repeatCount, unsigned long interval,
                                         unsigned long debounceTime) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
-    }
-
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = BOOLEAN_POINTER;
-    conditions[id].triggerType = triggerType;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = conditionPointer;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = NULL;
-    conditions[id].paramActionFunction = actionFunction;
-    conditions[id].actionParam = param;
-    conditions[id].stopActionFunction = NULL;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = debounceTime;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = 0;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = 0;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = *conditionPointer;
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
-    return id;
+    return addCondition(name, conditionPointer, triggerType, actionFunction, param, repeatCount, interval,
+                        debounceTime, 0, NULL, 0);
 }
 
 int LogicConditionManager::addCondition(const String &name, bool *conditionPointer,
@@ -806,49 +839,15 @@ int LogicConditionManager::addCondition(const String &name, bool *conditionPoint
                                         int repeatCount, unsigned long interval,
                                         unsigned long debounceTime, unsigned long actionDuration,
                                         void (*stopActionFunction)(), unsigned long waitInterval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
+    int id = allocateCondition(name, BOOLEAN_POINTER, triggerType, repeatCount, interval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = BOOLEAN_POINTER;
-    conditions[id].triggerType = triggerType;
-    conditions[id].boolFunction = NULL;
     conditions[id].boolPointer = conditionPointer;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = NULL;
-    conditions[id].paramActionFunction = actionFunction;
-    conditions[id].actionParam = param;
-    conditions[id].stopActionFunction = stopActionFunction;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = debounceTime;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = actionDuration;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = waitInterval;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = *conditionPointer;
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
+    setAction(id, NULL, actionFunction, param);
+    setActionTiming(id, debounceTime, actionDuration, stopActionFunction, waitInterval);
+    primeCondition(id);
     return id;
 }
 
@@ -856,50 +855,8 @@ int LogicConditionManager::addValueCondition(const String &name, float (*valueFu
                                              float threshold, ComparisonType comparison, TriggerType triggerType,
                                              void (*actionFunction)(), int repeatCount,
                                              unsigned long interval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
-    }
-
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = VALUE_FUNCTION;
-    conditions[id].triggerType = triggerType;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = valueFunction;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = threshold;
-    conditions[id].comparison = comparison;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = NULL;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = 0;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = 0;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = 0;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].currentFloatValue = valueFunction();
-    conditions[id].lastBoolValue = evaluateValueCondition(conditions[id].currentFloatValue, threshold, comparison);
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = conditions[id].currentFloatValue;
-    conditions[id].hasValidFloatValue = true;
-    conditions[id].state = IDLE;
-
-    return id;
+    return addValueCondition(name, valueFunction, threshold, comparison, triggerType, actionFunction,
+                             repeatCount, interval, 0, NULL, 0);
 }
 
 int LogicConditionManager::addValueCondition(const String &name, float (*valueFunction)(),
@@ -907,49 +864,17 @@ int LogicConditionManager::addValueCondition(const String &name, float (*valueFu
                                              void (*actionFunction)(), int repeatCount,
                                              unsigned long interval, unsigned long actionDuration,
                                              void (*stopActionFunction)(), unsigned long waitInterval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
+    int id = allocateCondition(name, VALUE_FUNCTION, triggerType, repeatCount, interval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = VALUE_FUNCTION;
-    conditions[id].triggerType = triggerType;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = valueFunction;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = threshold;
-    conditions[id].comparison = comparison;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = stopActionFunction;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = 0;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = actionDuration;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = waitInterval;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].currentFloatValue = valueFunction();
-    conditions[id].lastBoolValue = evaluateValueCondition(conditions[id].currentFloatValue, threshold, comparison);
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = conditions[id].currentFloatValue;
-    conditions[id].hasValidFloatValue = true;
-    conditions[id].state = IDLE;
-
+    conditions[id].value.source.function = valueFunction;
+    conditions[id].value.threshold = threshold;
+    conditions[id].value.comparison = comparison;
+    setAction(id, actionFunction, NULL, NULL);
+    setActionTiming(id, 0, actionDuration, stopActionFunction, waitInterval);
+    primeCondition(id);
     return id;
 }
 
@@ -957,50 +882,8 @@ int LogicConditionManager::addValueCondition(const String &name, float *valuePoi
                                              float threshold, ComparisonType comparison, TriggerType triggerType,
                                              void (*actionFunction)(), int repeatCount,
                                              unsigned long interval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
-    }
-
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = VALUE_POINTER;
-    conditions[id].triggerType = triggerType;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = valuePointer;
-    conditions[id].threshold = threshold;
-    conditions[id].comparison = comparison;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = NULL;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = 0;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = 0;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = 0;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].currentFloatValue = *valuePointer;
-    conditions[id].lastBoolValue = evaluateValueCondition(conditions[id].currentFloatValue, threshold, comparison);
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = conditions[id].currentFloatValue;
-    conditions[id].hasValidFloatValue = true;
-    conditions[id].state = IDLE;
-
-    return id;
+    return addValueCondition(name, valuePointer, threshold, comparison, triggerType, actionFunction,
+                             repeatCount, interval, 0, NULL, 0);
 }
 
 int LogicConditionManager::addValueCondition(const String &name, float *valuePointer,
@@ -1008,49 +891,17 @@ int LogicConditionManager::addValueCondition(const String &name, float *valuePoi
                                              void (*actionFunction)(), int repeatCount,
                                              unsigned long interval, unsigned long actionDuration,
                                              void (*stopActionFunction)(), unsigned long waitInterval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
+    int id = allocateCondition(name, VALUE_POINTER, triggerType, repeatCount, interval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = VALUE_POINTER;
-    conditions[id].triggerType = triggerType;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = valuePointer;
-    conditions[id].threshold = threshold;
-    conditions[id].comparison = comparison;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = stopActionFunction;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = 0;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = actionDuration;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = waitInterval;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].currentFloatValue = *valuePointer;
-    conditions[id].lastBoolValue = evaluateValueCondition(conditions[id].currentFloatValue, threshold, comparison);
-    conditions[id].currentBoolValue = conditions[id].lastBoolValue;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = conditions[id].currentFloatValue;
-    conditions[id].hasValidFloatValue = true;
-    conditions[id].state = IDLE;
-
+    conditions[id].value.source.pointer = valuePointer;
+    conditions[id].value.threshold = threshold;
+    conditions[id].value.comparison = comparison;
+    setAction(id, actionFunction, NULL, NULL);
+    setActionTiming(id, 0, actionDuration, stopActionFunction, waitInterval);
+    primeCondition(id);
     return id;
 }
 
@@ -1058,52 +909,8 @@ int LogicConditionManager::addCompositeCondition(const String &name, LogicOp log
                                                  int conditionIds[], int count,
                                                  void (*actionFunction)(), int repeatCount,
                                                  unsigned long interval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
-    }
-
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = COMPOSITE;
-    conditions[id].triggerType = WHEN_TRUE;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = NULL;
-    conditions[id].logicOp = logicOperator;
-    conditions[id].childCount = count;
-    conditions[id].childConditions = new int[count];
-    memcpy(conditions[id].childConditions, conditionIds, count * sizeof(int));
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = 0;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = 0;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = 0;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = false;
-    conditions[id].currentBoolValue = false;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
-    return id;
+    return addCompositeCondition(name, logicOperator, conditionIds, count, actionFunction, repeatCount,
+                                 interval, 0, NULL, 0);
 }
 
 int LogicConditionManager::addCompositeCondition(const String &name, LogicOp logicOperator,
@@ -1111,51 +918,14 @@ int LogicConditionManager::addCompositeCondition(const String &name, LogicOp log
                                                  void (*actionFunction)(), int repeatCount,
                                                  unsigned long interval, unsigned long actionDuration,
                                                  void (*stopActionFunction)(), unsigned long waitInterval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
+    int id = allocateCondition(name, COMPOSITE, WHEN_TRUE, repeatCount, interval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = COMPOSITE;
-    conditions[id].triggerType = WHEN_TRUE;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = stopActionFunction;
-    conditions[id].logicOp = logicOperator;
-    conditions[id].childCount = count;
-    conditions[id].childConditions = new int[count];
-    memcpy(conditions[id].childConditions, conditionIds, count * sizeof(int));
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = 0;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].actionDuration = actionDuration;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = waitInterval;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = false;
-    conditions[id].currentBoolValue = false;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
+    setChildren(id, logicOperator, conditionIds, count);
+    setAction(id, actionFunction, NULL, NULL);
+    setActionTiming(id, 0, actionDuration, stopActionFunction, waitInterval);
     return id;
 }
 
@@ -1181,173 +951,66 @@ int LogicConditionManager::addNotCondition(const String &name, int conditionId,
 int LogicConditionManager::addTimerCondition(const String &name, unsigned long duration,
                                              bool autoReset, void (*actionFunction)(),
                                              int repeatCount, unsigned long interval) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
+    int id = allocateCondition(name, TIMER, WHEN_TRUE, repeatCount, interval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = TIMER;
-    conditions[id].triggerType = WHEN_TRUE;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = NULL;
-    conditions[id].childConditions = NULL;
-    conditions[id].childCount = 0;
-    conditions[id].interval = interval;
-    conditions[id].debounceTime = 0;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].duration = duration;
-    conditions[id].startTime = 0;
-    conditions[id].actionDuration = 0;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = 0;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = false;
-    conditions[id].currentBoolValue = false;
-    conditions[id].wasTriggered = false;
+    conditions[id].group.duration = duration;
     conditions[id].autoReset = autoReset;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
+    setAction(id, actionFunction, NULL, NULL);
     return id;
 }
 
 int LogicConditionManager::addSequenceCondition(const String &name, int conditionIds[], int count,
                                                 unsigned long maxTimespan, int minOccurrences,
                                                 void (*actionFunction)(), int repeatCount) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
+    int id = allocateCondition(name, SEQUENCE, WHEN_TRUE, repeatCount, 0);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = SEQUENCE;
-    conditions[id].triggerType = WHEN_TRUE;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = NULL;
-    conditions[id].childCount = count;
-    conditions[id].childConditions = new int[count];
-    memcpy(conditions[id].childConditions, conditionIds, count * sizeof(int));
-    conditions[id].interval = 0;
-    conditions[id].debounceTime = 0;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].duration = maxTimespan;
-    conditions[id].startTime = 0;
-    conditions[id].actionDuration = 0;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = 0;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].minOccurrences = minOccurrences;
-    conditions[id].occurrenceCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = false;
-    conditions[id].currentBoolValue = false;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
+    setChildren(id, AND, conditionIds, count);
+    conditions[id].group.duration = maxTimespan;
+    conditions[id].group.minOccurrences = minOccurrences;
+    setAction(id, actionFunction, NULL, NULL);
     return id;
 }
 
 int LogicConditionManager::addEdgeCountCondition(const String &name, int conditionId,
                                                  int targetCount, unsigned long timeWindow,
                                                  void (*actionFunction)(), int repeatCount) {
-    if (conditionCount >= capacity) {
-        expandCapacity();
+    int id = allocateCondition(name, EDGE_COUNTER, TO_TRUE, repeatCount, 0);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = conditionCount++;
-    conditions[id].name = name;
-    conditions[id].type = EDGE_COUNTER;
-    conditions[id].triggerType = TO_TRUE;
-    conditions[id].boolFunction = NULL;
-    conditions[id].boolPointer = NULL;
-    conditions[id].valueFunction = NULL;
-    conditions[id].valuePointer = NULL;
-    conditions[id].threshold = 0;
-    conditions[id].comparison = GREATER_THAN;
-    conditions[id].actionFunction = actionFunction;
-    conditions[id].paramActionFunction = NULL;
-    conditions[id].actionParam = NULL;
-    conditions[id].stopActionFunction = NULL;
-    conditions[id].childCount = 1;
-    conditions[id].childConditions = new int[1];
-    conditions[id].childConditions[0] = conditionId;
-    conditions[id].interval = 0;
-    conditions[id].debounceTime = 0;
-    conditions[id].lastDebounceTime = 0;
-    conditions[id].lastTriggerTime = 0;
-    conditions[id].lastExecutionTime = 0;
-    conditions[id].duration = timeWindow;
-    conditions[id].startTime = 0;
-    conditions[id].actionDuration = 0;
-    conditions[id].actionStartTime = 0;
-    conditions[id].waitInterval = 0;
-    conditions[id].waitStartTime = 0;
-    conditions[id].repeatCount = repeatCount;
-    conditions[id].executionCount = 0;
-    conditions[id].minOccurrences = targetCount;
-    conditions[id].occurrenceCount = 0;
-    conditions[id].enabled = true;
-    conditions[id].lastBoolValue = false;
-    conditions[id].currentBoolValue = false;
-    conditions[id].wasTriggered = false;
-    conditions[id].autoReset = false;
-    conditions[id].actionActive = false;
-    conditions[id].actionWaiting = false;
-    conditions[id].lastFloatValue = 0.0;
-    conditions[id].currentFloatValue = 0.0;
-    conditions[id].hasValidFloatValue = false;
-    conditions[id].state = IDLE;
-
+    int ids[1] = {conditionId};
+    setChildren(id, AND, ids, 1);
+    conditions[id].group.duration = timeWindow;
+    conditions[id].group.minOccurrences = targetCount;
+    setAction(id, actionFunction, NULL, NULL);
     return id;
 }
 
 void LogicConditionManager::update() {
-    for (int i = 0; i < conditionCount; i++) {
-        if (!conditions[i].enabled || conditions[i].state == PAUSED) {
+    if (graphDirty || compiledCount != conditionCount) {
+        compile();
+    }
+    evaluationPass++;
+
+    for (int n = 0; n < conditionCount; n++) {
+        int i = evaluationOrder[n];
+        Condition &cond = conditions[i];
+        if (!cond.enabled || cond.state == PAUSED) {
             continue;
         }
 
         bool triggered = evaluateCondition(i);
         updateConditionState(i, triggered);
 
-        conditions[i].lastBoolValue = conditions[i].currentBoolValue;
-        conditions[i].wasTriggered = triggered;
+        cond.lastBoolValue = cond.currentBoolValue;
+        cond.wasTriggered = triggered;
     }
 }
 
@@ -1355,6 +1018,10 @@ bool LogicConditionManager::isConditionMet(int conditionId) {
     if (conditionId < 0 || conditionId >= conditionCount || !conditions[conditionId].enabled) {
         return false;
     }
+    if (graphDirty || compiledCount != conditionCount) {
+        compile();
+    }
+    evaluationPass++;
     return evaluateCondition(conditionId);
 }
 
@@ -1368,6 +1035,11 @@ bool LogicConditionManager::checkAndTrigger(int conditionId, void (*callbackFunc
         return false;
     }
 
+    if (graphDirty || compiledCount != conditionCount) {
+        compile();
+    }
+    evaluationPass++;
+
     bool triggered = evaluateCondition(conditionId);
     if (triggered) {
         if (callbackFunction) {
@@ -1387,7 +1059,7 @@ LogicConditionManager::ConditionState LogicConditionManager::getConditionState(i
     if (conditionId < 0 || conditionId >= conditionCount) {
         return IDLE;
     }
-    return conditions[conditionId].state;
+    return (ConditionState) conditions[conditionId].state;
 }
 
 LogicConditionManager::ConditionState LogicConditionManager::getConditionState(const String &conditionName) {
@@ -1439,33 +1111,24 @@ void LogicConditionManager::resetCondition(int conditionId) {
     Condition &cond = conditions[conditionId];
     cond.state = IDLE;
     cond.executionCount = 0;
-    cond.occurrenceCount = 0;
     cond.wasTriggered = false;
     cond.actionActive = false;
     cond.actionWaiting = false;
     cond.hasValidFloatValue = false;
-    cond.lastFloatValue = 0.0;
-    cond.currentFloatValue = 0.0;
+    cond.windowOver = false;
+    scheduleAction(conditionId);
+    if (wheel != NULL && hasWindow(cond.type)) {
+        wheel->cancel(cond.group.windowHandle);
+    }
 
-    if (cond.type == BOOLEAN_FUNCTION && cond.boolFunction) {
-        cond.lastBoolValue = cond.boolFunction();
-        cond.currentBoolValue = cond.lastBoolValue;
-    } else if (cond.type == BOOLEAN_POINTER && cond.boolPointer) {
-        cond.lastBoolValue = *cond.boolPointer;
-        cond.currentBoolValue = cond.lastBoolValue;
-    } else if (cond.type == VALUE_FUNCTION && cond.valueFunction) {
-        cond.currentFloatValue = cond.valueFunction();
-        cond.lastBoolValue = evaluateValueCondition(cond.currentFloatValue, cond.threshold, cond.comparison);
-        cond.currentBoolValue = cond.lastBoolValue;
-        cond.lastFloatValue = cond.currentFloatValue;
-        cond.hasValidFloatValue = true;
-    } else if (cond.type == VALUE_POINTER && cond.valuePointer) {
-        cond.currentFloatValue = *cond.valuePointer;
-        cond.lastBoolValue = evaluateValueCondition(cond.currentFloatValue, cond.threshold, cond.comparison);
-        cond.currentBoolValue = cond.lastBoolValue;
-        cond.lastFloatValue = cond.currentFloatValue;
-        cond.hasValidFloatValue = true;
+    if (hasChildren(cond.type)) {
+        cond.group.occurrenceCount = 0;
+    } else if (cond.type == VALUE_FUNCTION || cond.type == VALUE_POINTER) {
+        cond.value.lastValue = 0.0;
+        cond.value.currentValue = 0.0;
     }
+
+    primeCondition(conditionId);
 }
 
 void LogicConditionManager::resetCondition(const String &conditionName) {
@@ -1480,6 +1143,7 @@ void LogicConditionManager::setEnabled(int conditionId, bool enabled) {
         return;
     }
     conditions[conditionId].enabled = enabled;
+    conditions[conditionId].changedPass = evaluationPass + 1;
     if (enabled) {
         resetCondition(conditionId);
     }
@@ -1524,7 +1188,9 @@ void LogicConditionManager::setDebounceTime(int conditionId, unsigned long debou
     if (conditionId < 0 || conditionId >= conditionCount) {
         return;
     }
-    conditions[conditionId].debounceTime = debounceTime;
+    if (debounceTime > 0 || conditions[conditionId].extension != NULL) {
+        getExtension(conditionId)->debounceTime = debounceTime;
+    }
 }
 
 void LogicConditionManager::setDebounceTime(const String &conditionName, unsigned long debounceTime) {
@@ -1587,35 +1253,79 @@ bool LogicConditionManager::hasCondition(const String &conditionName) {
     return findConditionIdByName(conditionName) >= 0;
 }
 
+bool *LogicConditionManager::getConditionPointer(const String &conditionName) {
+    int id = findConditionIdByName(conditionName);
+    if (id < 0 || conditions[id].type != BOOLEAN_POINTER) {
+        return NULL;
+    }
+    return conditions[id].boolPointer;
+}
+
 bool LogicConditionManager::removeCondition(int conditionId) {
     if (conditionId < 0 || conditionId >= conditionCount) {
         return false;
     }
 
-    if (conditions[conditionId].childConditions != NULL) {
-        delete[] conditions[conditionId].childConditions;
+    Condition &removed = conditions[conditionId];
+    uint16_t nameOffset = removed.nameOffset;
+    bool nameShared = false;
+    for (int i = 0; i < conditionCount; i++) {
+        if (i != conditionId && conditions[i].nameOffset == nameOffset) {
+            nameShared = true;
+            break;
+        }
+    }
+    if (hasChildren(removed.type) && removed.group.children != NULL) {
+        delete[] removed.group.children;
+    }
+    if (removed.extension != NULL) {
+        if (wheel != NULL && removed.extension->timerHandle != TIMER_WHEEL_INVALID) {
+            wheel->release(removed.extension->timerHandle);
+        }
+        delete removed.extension;
+    }
+    if (wheel != NULL && hasWindow(removed.type)) {
+        wheel->release(removed.group.windowHandle);
     }
 
     for (int i = conditionId; i < conditionCount - 1; i++) {
         conditions[i] = conditions[i + 1];
+        if (wheel != NULL && conditions[i].extension != NULL) {
+            wheel->setTag(conditions[i].extension->timerHandle, i);
+        }
+        if (wheel != NULL && hasWindow(conditions[i].type)) {
+            wheel->setTag(conditions[i].group.windowHandle, i);
+        }
     }
 
     conditionCount--;
 
+    if (!nameShared) {
+        uint16_t nameLength = names.remove(nameOffset);
+        for (int i = 0; i < conditionCount; i++) {
+            if (conditions[i].nameOffset > nameOffset) {
+                conditions[i].nameOffset -= nameLength;
+            }
+        }
+    }
+
     for (int i = 0; i < conditionCount; i++) {
-        if (conditions[i].type == COMPOSITE || conditions[i].type == SEQUENCE || conditions[i].type == EDGE_COUNTER) {
-            for (int j = 0; j < conditions[i].childCount; j++) {
-                if (conditions[i].childConditions[j] > conditionId) {
-                    conditions[i].childConditions[j]--;
-                } else if (conditions[i].childConditions[j] == conditionId) {
-                    conditions[i].childConditions[j] = -1;
+        if (hasChildren(conditions[i].type)) {
+            GroupPayload &group = conditions[i].group;
+            for (int j = 0; j < group.childCount; j++) {
+                if (group.children[j] > conditionId) {
+                    group.children[j]--;
+                } else if (group.children[j] == conditionId) {
+                    group.children[j] = -1;
                 }
             }
         }
     }
 
-    lastNameLookup = "";
-    lastIdFound = -1;
+    if (initializedCount > conditionId) {
+        initializedCount--;
+    }
+    graphDirty = true;
     return true;
 }
 
@@ -1630,8 +1340,9 @@ void LogicConditionManager::printStatus(int conditionId) {
     }
 
     Condition &cond = conditions[conditionId];
+    ActionExtension *ext = cond.extension;
     Serial.print("Condition '");
-    Serial.print(cond.name);
+    Serial.print(names.get(cond.nameOffset));
     Serial.print("': State=");
 
     switch (cond.state) {
@@ -1668,22 +1379,22 @@ void LogicConditionManager::printStatus(int conditionId) {
         Serial.print(cond.repeatCount);
     }
 
-    if (cond.actionDuration > 0) {
+    if (ext != NULL && ext->actionDuration > 0) {
         Serial.print(", ActionDur=");
-        Serial.print(cond.actionDuration);
+        Serial.print(ext->actionDuration);
         Serial.print("ms");
         if (cond.actionActive) {
-            unsigned long elapsed = millis() - cond.actionStartTime;
+            unsigned long elapsed = millis() - ext->actionStartTime;
             Serial.print(", Remaining=");
-            Serial.print(cond.actionDuration - elapsed);
+            Serial.print(ext->actionDuration - elapsed);
             Serial.print("ms");
         }
     }
 
-    if (cond.waitInterval > 0 && cond.actionWaiting) {
-        unsigned long elapsed = millis() - cond.waitStartTime;
+    if (ext != NULL && ext->waitInterval > 0 && cond.actionWaiting) {
+        unsigned long elapsed = millis() - ext->waitStartTime;
         Serial.print(", WaitRemaining=");
-        Serial.print(cond.waitInterval - elapsed);
+        Serial.print(ext->waitInterval - elapsed);
         Serial.print("ms");
     }
 
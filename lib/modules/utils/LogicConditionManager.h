@@ -2,6 +2,16 @@
 #define LOGIC_CONDITION_MANAGER_H
 
 #include "Arduino.h"
+#include "RulePool.h"
+#include "../time/timer-wheel.h"
+
+#ifndef LOGIC_CONDITION_BLOCK_SIZE
+#if defined(__AVR__)
+#define LOGIC_CONDITION_BLOCK_SIZE 4
+#else
+#define LOGIC_CONDITION_BLOCK_SIZE 16
+#endif
+#endif
 
 class LogicConditionManager {
 public:
@@ -53,70 +63,106 @@ public:
     };
 
 private:
-    struct Condition {
-        String name;
-        ConditionType type;
-        TriggerType triggerType;
-
-        bool (*boolFunction)();
-        bool *boolPointer;
-        float (*valueFunction)();
-        float *valuePointer;
-        float threshold;
-        ComparisonType comparison;
-
-        void (*actionFunction)();
-        void (*paramActionFunction)(void *);
+    struct ActionExtension {
         void *actionParam;
         void (*stopActionFunction)();
-
-        LogicOp logicOp;
-        int *childConditions;
-        int childCount;
-
-        unsigned long interval;
-        unsigned long debounceTime;
-        unsigned long lastDebounceTime;
-        unsigned long lastTriggerTime;
-        unsigned long lastExecutionTime;
-        unsigned long duration;
-        unsigned long startTime;
-
         unsigned long actionDuration;
         unsigned long actionStartTime;
         unsigned long waitInterval;
         unsigned long waitStartTime;
+        unsigned long debounceTime;
+        unsigned long lastDebounceTime;
+        TimerHandle timerHandle;
+    };
 
-        int repeatCount;
-        int executionCount;
-        int minOccurrences;
-        int occurrenceCount;
+    struct ValuePayload {
+        union {
+            float (*function)();
+            float *pointer;
+        } source;
+        float threshold;
+        float currentValue;
+        float lastValue;
+        uint8_t comparison;
+    };
 
-        bool enabled;
-        bool lastBoolValue;
-        bool currentBoolValue;
-        bool wasTriggered;
-        bool autoReset;
-        bool actionActive;
-        bool actionWaiting;
+    struct GroupPayload {
+        int16_t *children;
+        uint8_t childCount;
+        uint8_t logicOp;
+        int16_t minOccurrences;
+        int16_t occurrenceCount;
+        unsigned long duration;
+        unsigned long startTime;
+        unsigned long computedPass;
+        TimerHandle windowHandle;
+    };
 
-        float lastFloatValue;
-        float currentFloatValue;
-        bool hasValidFloatValue;
+    // common fields first, then one payload per ConditionType; action timing and debounce live in the extension
+    struct Condition {
+        uint32_t nameHash;
+        uint16_t nameOffset;
+        uint8_t type;
+        uint8_t triggerType;
+        uint8_t state;
+
+        bool enabled : 1;
+        bool lastBoolValue : 1;
+        bool currentBoolValue : 1;
+        bool wasTriggered : 1;
+        bool autoReset : 1;
+        bool actionActive : 1;
+        bool actionWaiting : 1;
+        bool hasValidFloatValue : 1;
+        bool memoResult : 1;
+        bool paramAction : 1;
+        bool windowOver : 1;
+
+        int16_t repeatCount;
+        int16_t executionCount;
 
-        ConditionState state;
+        void (*actionFunction)();
+        ActionExtension *extension;
+
+        unsigned long interval;
+        unsigned long lastTriggerTime;
+        unsigned long lastExecutionTime;
+        unsigned long evalPass;
+        unsigned long changedPass;
+
+        union {
+            bool (*boolFunction)();
+            bool *boolPointer;
+            ValuePayload value;
+            GroupPayload group;
+        };
     };
 
-    Condition *conditions;
+    BlockPool<Condition, LOGIC_CONDITION_BLOCK_SIZE> conditions;
+    NameArena names;
     int conditionCount;
-    int capacity;
 
-    String lastNameLookup;
-    int lastIdFound;
+    int *evaluationOrder;
+    int compiledCount;
+    int initializedCount;
+    bool graphDirty;
+    unsigned long evaluationPass;
+
+    TimerWheel *wheel;
 
     int findConditionIdByName(const String &name);
-    void expandCapacity();
+    int allocateCondition(const String &name, ConditionType type, TriggerType triggerType,
+                          int repeatCount, unsigned long interval);
+    void setAction(int conditionId, void (*actionFunction)(), void (*paramActionFunction)(void *), void *param);
+    void setActionTiming(int conditionId, unsigned long debounceTime, unsigned long actionDuration,
+                         void (*stopActionFunction)(), unsigned long waitInterval);
+    void setChildren(int conditionId, LogicOp logicOperator, int conditionIds[], int count);
+    ActionExtension *getExtension(int conditionId);
+    void primeCondition(int conditionId);
+    void runAction(Condition &cond);
+    void visitCondition(int conditionId, uint8_t *marks, int &orderIndex);
     bool evaluateCondition(int conditionId);
+    bool evaluateNode(int conditionId);
     bool evaluateOnChange(int conditionId);
     bool evaluateComposite(int conditionId);
     bool evaluateSequence(int conditionId);
@@ -124,6 +170,15 @@ private:
     void handleActionDuration(int conditionId);
     bool evaluateValueCondition(float value, float threshold, ComparisonType comparison);
 
+    static bool hasChildren(uint8_t type);
+    static bool hasWindow(uint8_t type);
+    void scheduleAction(int conditionId);
+    static void onWheelExpiry(void *owner, uint16_t tag);
+    static unsigned long remainingTime(unsigned long startTime, unsigned long duration);
+    void armWindow(int conditionId);
+    bool isWindowOver(int conditionId);
+    static void onWindowExpiry(void *owner, uint16_t tag);
+
 public:
     LogicConditionManager(int initialCapacity = 10);
     ~LogicConditionManager();
@@ -229,6 +284,10 @@ public:
                               int targetCount, unsigned long timeWindow,
                               void (*actionFunction)() = NULL, int repeatCount = 1);
 
+    void compile();
+    // action duration and wait interval ends are then fired by wheel->tick() instead of being polled in update(),
+    // as are the TIMER duration and the SEQUENCE and EDGE_COUNTER time windows
+    void attachTimerWheel(TimerWheel *timerWheel);
     void update();
 
     bool isConditionMet(int conditionId);
@@ -274,6 +333,8 @@ public:
     void stopExecution(const String &conditionName);
 
     bool hasCondition(const String &conditionName);
+    // the flag a pointer condition reads, NULL for every other type
+    bool *getConditionPointer(const String &conditionName);
     bool removeCondition(int conditionId);
     bool removeCondition(const String &conditionName);
 
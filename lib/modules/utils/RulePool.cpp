@@ -0,0 +1,99 @@
+#include "RulePool.h"
+
+NameArena::NameArena()
+        : data(NULL), used(0), capacity(0) {
+}
+
+NameArena::~NameArena() {
+    clear();
+}
+
+uint16_t NameArena::add(const char *name) {
+    if (name == NULL) {
+        name = "";
+    }
+
+    size_t length = strlen(name) + 1;
+    if ((size_t) used + length >= NAME_ARENA_INVALID) {
+        return NAME_ARENA_INVALID;
+    }
+
+    if (used + length > capacity) {
+        // doubling keeps the number of reallocations logarithmic in the names added
+        size_t newCapacity = capacity > 0 ? (size_t) capacity * 2 : 32;
+        if (newCapacity < used + length) {
+            newCapacity = used + length;
+        }
+        if (newCapacity >= NAME_ARENA_INVALID) {
+            newCapacity = NAME_ARENA_INVALID - 1;
+        }
+        if (!resize(newCapacity)) {
+            return NAME_ARENA_INVALID;
+        }
+    }
+
+    uint16_t offset = used;
+    memcpy(data + offset, name, length);
+    used += length;
+    return offset;
+}
+
+uint16_t NameArena::remove(uint16_t offset) {
+    if (data == NULL || offset >= used) {
+        return 0;
+    }
+
+    uint16_t length = strlen(data + offset) + 1;
+    memmove(data + offset, data + offset + length, used - offset - length);
+    used -= length;
+
+    if (used == 0) {
+        clear();
+    } else if (capacity > 32 && used <= capacity / 4) {
+        resize(capacity / 2);
+    }
+    return length;
+}
+
+bool NameArena::resize(size_t newCapacity) {
+    char *newData = (char *) realloc(data, newCapacity);
+    if (newData == NULL) {
+        return false;
+    }
+    data = newData;
+    capacity = newCapacity;
+    return true;
+}
+
+const char *NameArena::get(uint16_t offset) const {
+    if (data == NULL || offset >= used) {
+        return "";
+    }
+    return data + offset;
+}
+
+bool NameArena::equals(uint16_t offset, const char *name) const {
+    return strcmp(get(offset), name) == 0;
+}
+
+uint16_t NameArena::getUsed() const {
+    return used;
+}
+
+void NameArena::clear() {
+    if (data != NULL) {
+        free(data);
+    }
+    data = NULL;
+    used = 0;
+    capacity = 0;
+}
+
+uint32_t NameArena::hash(const char *name) {
+    uint32_t hash = 2166136261UL;  // FNV-1a
+    while (*name) {
+        hash ^= (uint8_t) *name++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
\ No newline at end of file
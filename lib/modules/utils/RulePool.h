@@ -0,0 +1,101 @@
+#pragma once
+
+#ifndef RULE_POOL_H
+#define RULE_POOL_H
+
+#include "Arduino.h"
+
+#define NAME_ARENA_INVALID 0xFFFF
+
+// packed buffer of NUL-terminated names, a name is referenced by its 16-bit offset
+class NameArena {
+private:
+    char *data;
+    uint16_t used;
+    uint16_t capacity;
+
+    bool resize(size_t newCapacity);
+
+public:
+    NameArena();
+    ~NameArena();
+
+    uint16_t add(const char *name);
+    // closes the gap the name leaves and returns its length, the owner moves every offset above
+    // the removed one down by that much
+    uint16_t remove(uint16_t offset);
+    const char *get(uint16_t offset) const;
+    bool equals(uint16_t offset, const char *name) const;
+    uint16_t getUsed() const;
+    void clear();
+
+    static uint32_t hash(const char *name);
+};
+
+// storage in fixed-size blocks, growing never moves an element that is already in use
+template<typename T, uint8_t BlockSize>
+class BlockPool {
+private:
+    T **blocks;
+    uint8_t blockCount;
+
+    BlockPool(const BlockPool &);
+    BlockPool &operator=(const BlockPool &);
+
+public:
+    BlockPool() : blocks(NULL), blockCount(0) {}
+
+    ~BlockPool() {
+        clear();
+    }
+
+    bool reserve(int count) {
+        int needed = (count + BlockSize - 1) / BlockSize;
+        if (needed <= blockCount) {
+            return true;
+        }
+        if (needed > 255) {
+            return false;
+        }
+
+        T **newBlocks = (T **) realloc(blocks, needed * sizeof(T *));
+        if (newBlocks == NULL) {
+            return false;
+        }
+        blocks = newBlocks;
+
+        while (blockCount < needed) {
+            T *block = new T[BlockSize];
+            if (block == NULL) {
+                return false;
+            }
+            blocks[blockCount++] = block;
+        }
+        return true;
+    }
+
+    T &operator[](int index) {
+        return blocks[index / BlockSize][index % BlockSize];
+    }
+
+    const T &operator[](int index) const {
+        return blocks[index / BlockSize][index % BlockSize];
+    }
+
+    int getCapacity() const {
+        return blockCount * BlockSize;
+    }
+
+    void clear() {
+        for (uint8_t i = 0; i < blockCount; i++) {
+            delete[] blocks[i];
+        }
+        if (blocks != NULL) {
+            free(blocks);
+        }
+        blocks = NULL;
+        blockCount = 0;
+    }
+};
+
+#endif  // RULE_POOL_H
\ No newline at end of file
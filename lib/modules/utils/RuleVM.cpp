@@ -0,0 +1,734 @@
+#include "RuleVM.h"
+
+RuleVM::RuleVM()
+        : programCount(0), registersUsed(0), codeArena(NULL), codeUsed(0) {
+    memset(sources, 0, sizeof(sources));
+    memset(registers, 0, sizeof(registers));
+    memset(programs, 0, sizeof(programs));
+    memset(results, 0, sizeof(results));
+}
+
+RuleVM::~RuleVM() {
+    if (codeArena != NULL) {
+        free(codeArena);
+    }
+}
+
+int RuleVM::bindSource(uint8_t kind, void *raw) {
+    int freeSlot = -1;
+    for (int i = 0; i < RULE_VM_SOURCES; i++) {
+        if (sources[i].kind == kind && sources[i].raw == raw) {
+            return i;
+        }
+        if (sources[i].kind == SOURCE_NONE && freeSlot < 0) {
+            freeSlot = i;
+        }
+    }
+    if (freeSlot < 0 || raw == NULL) {
+        return -1;
+    }
+
+    sources[freeSlot].kind = kind;
+    sources[freeSlot].pinned = false;
+    sources[freeSlot].raw = raw;
+    return freeSlot;
+}
+
+bool RuleVM::bindSourceAt(uint8_t slot, uint8_t kind, void *raw) {
+    if (slot >= RULE_VM_SOURCES) {
+        return false;
+    }
+    if (raw != NULL) {
+        sources[slot].kind = kind;
+    } else {
+        sources[slot].kind = SOURCE_NONE;
+    }
+    sources[slot].pinned = raw != NULL;
+    sources[slot].raw = raw;
+    return true;
+}
+
+int RuleVM::bind(float *pointer) {
+    return bindSource(SOURCE_FLOAT_POINTER, (void *) pointer);
+}
+
+int RuleVM::bind(float (*function)()) {
+    return bindSource(SOURCE_FLOAT_FUNCTION, (void *) function);
+}
+
+int RuleVM::bind(bool *pointer) {
+    return bindSource(SOURCE_BOOL_POINTER, (void *) pointer);
+}
+
+int RuleVM::bind(bool (*function)()) {
+    return bindSource(SOURCE_BOOL_FUNCTION, (void *) function);
+}
+
+int RuleVM::bind(float (*transformer)(float)) {
+    return bindSource(SOURCE_TRANSFORM, (void *) transformer);
+}
+
+int RuleVM::bind(bool (*validator)(float)) {
+    return bindSource(SOURCE_VALIDATOR, (void *) validator);
+}
+
+bool RuleVM::bindAt(uint8_t slot, float *pointer) {
+    return bindSourceAt(slot, SOURCE_FLOAT_POINTER, (void *) pointer);
+}
+
+bool RuleVM::bindAt(uint8_t slot, float (*function)()) {
+    return bindSourceAt(slot, SOURCE_FLOAT_FUNCTION, (void *) function);
+}
+
+bool RuleVM::bindAt(uint8_t slot, bool *pointer) {
+    return bindSourceAt(slot, SOURCE_BOOL_POINTER, (void *) pointer);
+}
+
+bool RuleVM::bindAt(uint8_t slot, bool (*function)()) {
+    return bindSourceAt(slot, SOURCE_BOOL_FUNCTION, (void *) function);
+}
+
+bool RuleVM::bindAt(uint8_t slot, float (*transformer)(float)) {
+    return bindSourceAt(slot, SOURCE_TRANSFORM, (void *) transformer);
+}
+
+bool RuleVM::bindAt(uint8_t slot, bool (*validator)(float)) {
+    return bindSourceAt(slot, SOURCE_VALIDATOR, (void *) validator);
+}
+
+uint8_t RuleVM::operandSize(uint8_t op) {
+    switch (op) {
+        case OP_VALUE:
+        case OP_FLAG:
+        case OP_TRANSFORM:
+        case OP_RATE:
+            return 1;
+        case OP_FILTER:
+        case OP_AVERAGE:
+        case OP_EDGE:
+        case OP_CONSECUTIVE:
+            return 2;
+        case OP_CONST:
+            return 4;
+        case OP_SMOOTH:
+        case OP_DEADZONE:
+        case OP_COMPARE:
+        case OP_STABLE:
+            return 5;
+        case OP_NORMALIZE:
+        case OP_CLAMP:
+        case OP_BETWEEN:
+        case OP_NEAR:
+            return 8;
+        case OP_HYSTERESIS:
+            return 10;
+        default:
+            return 0;
+    }
+}
+
+bool RuleVM::validate(const uint8_t *code, uint16_t length) const {
+    if (code == NULL || length <= RULE_VM_HEADER_SIZE || code[0] != RULE_VM_MAGIC || code[1] != RULE_VM_VERSION) {
+        return false;
+    }
+
+    uint8_t registerCount = code[2];
+    int depth = 0;
+    uint16_t pc = RULE_VM_HEADER_SIZE;
+
+    while (pc < length) {
+        uint8_t op = code[pc++];
+        if (op >= OP_COUNT) {
+            return false;
+        }
+        if (op == OP_END) {
+            return depth == 1 && pc == length;
+        }
+
+        uint8_t size = operandSize(op);
+        if (pc + size > length) {
+            return false;
+        }
+        const uint8_t *operand = code + pc;
+
+        uint8_t source = 0xFF;
+        uint8_t reg = 0;
+        uint8_t regSpan = 0;
+        switch (op) {
+            case OP_VALUE:
+            case OP_FLAG:
+            case OP_TRANSFORM:
+                source = operand[0];
+                break;
+            case OP_FILTER:
+                source = operand[0];
+                reg = operand[1];
+                regSpan = 1;
+                break;
+            case OP_AVERAGE:
+                if (operand[0] == 0) return false;
+                reg = operand[1];
+                regSpan = 2;
+                break;
+            case OP_SMOOTH:
+            case OP_DEADZONE:
+                reg = operand[4];
+                regSpan = 1;
+                break;
+            case OP_RATE:
+                reg = operand[0];
+                regSpan = 2;
+                break;
+            case OP_COMPARE:
+                if (operand[0] > CMP_NOT_EQUAL) return false;
+                break;
+            case OP_HYSTERESIS:
+                if (operand[0] > CMP_NOT_EQUAL) return false;
+                reg = operand[9];
+                regSpan = 1;
+                break;
+            case OP_EDGE:
+                if (operand[0] > 2) return false;
+                reg = operand[1];
+                regSpan = 1;
+                break;
+            case OP_CONSECUTIVE:
+                reg = operand[1];
+                regSpan = 1;
+                break;
+            case OP_STABLE:
+                reg = operand[4];
+                regSpan = 2;
+                break;
+            default:
+                break;
+        }
+
+        if (source != 0xFF && source >= RULE_VM_SOURCES) {
+            return false;
+        }
+        if (regSpan > 0 && reg + regSpan > registerCount) {
+            return false;
+        }
+
+        if (op == OP_VALUE || op == OP_FLAG || op == OP_CONST) {
+            depth++;
+        } else if (op == OP_AND || op == OP_OR || op == OP_XOR) {
+            if (depth < 2) return false;
+            depth--;
+        } else if (depth < 1) {
+            return false;
+        }
+        if (depth > RULE_VM_STACK_SIZE) {
+            return false;
+        }
+
+        pc += size;
+    }
+    return false;
+}
+
+int RuleVM::load(const uint8_t *code, uint16_t length) {
+    int id = programCount;
+    for (int i = 0; i < programCount; i++) {
+        if (!isLoaded(i)) {
+            id = i;
+            break;
+        }
+    }
+    if (id >= RULE_VM_PROGRAMS || !validate(code, length)) {
+        return -1;
+    }
+
+    uint8_t registerCount = code[2];
+    if (registersUsed + registerCount > RULE_VM_REGISTERS) {
+        return -1;
+    }
+    if ((uint32_t) codeUsed + length > 0xFFFF) {
+        return -1;
+    }
+
+    uint8_t *newArena = (uint8_t *) realloc(codeArena, codeUsed + length);
+    if (newArena == NULL) {
+        return -1;
+    }
+    codeArena = newArena;
+    memcpy(codeArena + codeUsed, code, length);
+
+    if (id == programCount) {
+        programCount++;
+    }
+    programs[id].offset = codeUsed;
+    programs[id].length = length;
+    programs[id].registerBase = registersUsed;
+    programs[id].registerCount = registerCount;
+    codeUsed += length;
+    registersUsed += registerCount;
+
+    reset(id);
+    run(id);
+    return id;
+}
+
+bool RuleVM::unload(int programId) {
+    if (!isLoaded(programId)) {
+        return false;
+    }
+
+    // code and registers are packed, everything behind the program moves down into its place
+    Program removed = programs[programId];
+    memmove(codeArena + removed.offset, codeArena + removed.offset + removed.length,
+            codeUsed - removed.offset - removed.length);
+    codeUsed -= removed.length;
+    memmove(registers + removed.registerBase, registers + removed.registerBase + removed.registerCount,
+            (registersUsed - removed.registerBase - removed.registerCount) * sizeof(Register));
+    registersUsed -= removed.registerCount;
+
+    memset(&programs[programId], 0, sizeof(Program));
+    results[programId] = false;
+    for (int i = 0; i < programCount; i++) {
+        if (!isLoaded(i)) {
+            continue;
+        }
+        if (programs[i].offset > removed.offset) {
+            programs[i].offset -= removed.length;
+        }
+        if (programs[i].registerBase > removed.registerBase) {
+            programs[i].registerBase -= removed.registerCount;
+        }
+    }
+    while (programCount > 0 && !isLoaded(programCount - 1)) {
+        programCount--;
+    }
+
+    if (codeUsed == 0) {
+        free(codeArena);
+        codeArena = NULL;
+    } else {
+        uint8_t *newArena = (uint8_t *) realloc(codeArena, codeUsed);
+        if (newArena != NULL) {
+            codeArena = newArena;
+        }
+    }
+
+    releaseSources();
+    return true;
+}
+
+void RuleVM::clear() {
+    free(codeArena);
+    codeArena = NULL;
+    codeUsed = 0;
+    programCount = 0;
+    registersUsed = 0;
+    memset(programs, 0, sizeof(programs));
+    memset(results, 0, sizeof(results));
+    releaseSources();
+}
+
+void RuleVM::releaseSources() {
+    bool used[RULE_VM_SOURCES];
+    memset(used, 0, sizeof(used));
+
+    for (int i = 0; i < programCount; i++) {
+        if (!isLoaded(i)) {
+            continue;
+        }
+        const uint8_t *code = codeArena + programs[i].offset;
+        uint16_t pc = RULE_VM_HEADER_SIZE;
+        while (pc < programs[i].length) {
+            uint8_t op = code[pc++];
+            if (op == OP_VALUE || op == OP_FLAG || op == OP_TRANSFORM || op == OP_FILTER) {
+                used[code[pc]] = true;
+            }
+            pc += operandSize(op);
+        }
+    }
+
+    for (int i = 0; i < RULE_VM_SOURCES; i++) {
+        if (!used[i] && !sources[i].pinned) {
+            sources[i].kind = SOURCE_NONE;
+            sources[i].raw = NULL;
+        }
+    }
+}
+
+bool RuleVM::isLoaded(int programId) const {
+    return programId >= 0 && programId < programCount && programs[programId].length > 0;
+}
+
+int RuleVM::findProgram(const bool *resultPointer) const {
+    if (resultPointer < results || resultPointer >= results + programCount) {
+        return -1;
+    }
+    int programId = resultPointer - results;
+    return isLoaded(programId) ? programId : -1;
+}
+
+const uint8_t *RuleVM::getCode(int programId, uint16_t &length) const {
+    if (!isLoaded(programId)) {
+        length = 0;
+        return NULL;
+    }
+    length = programs[programId].length;
+    return codeArena + programs[programId].offset;
+}
+
+int RuleVM::getProgramCount() const {
+    return programCount;
+}
+
+void RuleVM::reset(int programId) {
+    if (!isLoaded(programId)) {
+        return;
+    }
+
+    Register *regs = registers + programs[programId].registerBase;
+    for (uint8_t i = 0; i < programs[programId].registerCount; i++) {
+        regs[i].f = NAN;
+    }
+    results[programId] = false;
+}
+
+float RuleVM::readValue(uint8_t slot) const {
+    const Source &source = sources[slot];
+    switch (source.kind) {
+        case SOURCE_FLOAT_POINTER:
+            return *source.floatPointer;
+        case SOURCE_FLOAT_FUNCTION:
+            return source.floatFunction();
+        case SOURCE_BOOL_POINTER:
+            return *source.boolPointer ? 1.0f : 0.0f;
+        case SOURCE_BOOL_FUNCTION:
+            return source.boolFunction() ? 1.0f : 0.0f;
+        default:
+            return 0.0f;
+    }
+}
+
+bool RuleVM::readFlag(uint8_t slot) const {
+    return readValue(slot) != 0.0f;
+}
+
+bool RuleVM::compare(float value, uint8_t comparison, float threshold) {
+    switch (comparison) {
+        case CMP_GREATER:
+            return value > threshold;
+        case CMP_LESS:
+            return value < threshold;
+        case CMP_GREATER_EQUAL:
+            return value >= threshold;
+        case CMP_LESS_EQUAL:
+            return value <= threshold;
+        case CMP_EQUAL:
+            return value == threshold;
+        case CMP_NOT_EQUAL:
+            return value != threshold;
+        default:
+            return false;
+    }
+}
+
+float RuleVM::readFloat(const uint8_t *at) {
+    float value;
+    memcpy(&value, at, sizeof(float));
+    return value;
+}
+
+uint32_t RuleVM::readU32(const uint8_t *at) {
+    return (uint32_t) at[0] | ((uint32_t) at[1] << 8) | ((uint32_t) at[2] << 16) | ((uint32_t) at[3] << 24);
+}
+
+bool RuleVM::run(int programId) {
+    if (!isLoaded(programId)) {
+        return false;
+    }
+
+    const Program &program = programs[programId];
+    const uint8_t *code = codeArena + program.offset;
+    Register *regs = registers + program.registerBase;
+    float stack[RULE_VM_STACK_SIZE];
+    int sp = 0;
+    uint16_t pc = RULE_VM_HEADER_SIZE;
+
+    // operands and depth were checked by validate(), the loop trusts them
+    while (true) {
+        uint8_t op = code[pc++];
+        const uint8_t *operand = code + pc;
+        pc += operandSize(op);
+
+        switch (op) {
+            case OP_END:
+                results[programId] = stack[0] != 0.0f;
+                return results[programId];
+
+            case OP_VALUE:
+                stack[sp++] = readValue(operand[0]);
+                break;
+
+            case OP_FLAG:
+                stack[sp++] = readFlag(operand[0]) ? 1.0f : 0.0f;
+                break;
+
+            case OP_CONST:
+                stack[sp++] = readFloat(operand);
+                break;
+
+            case OP_TRANSFORM:
+                if (sources[operand[0]].kind == SOURCE_TRANSFORM) {
+                    stack[sp - 1] = sources[operand[0]].transformer(stack[sp - 1]);
+                }
+                break;
+
+            case OP_FILTER: {
+                Register &last = regs[operand[1]];
+                bool valid = sources[operand[0]].kind != SOURCE_VALIDATOR ||
+                             sources[operand[0]].validator(stack[sp - 1]);
+                if (valid) {
+                    last.f = stack[sp - 1];
+                } else if (!isnan(last.f)) {
+                    stack[sp - 1] = last.f;
+                }
+            }
+                break;
+
+            case OP_AVERAGE: {
+                Register &mean = regs[operand[1]];
+                Register &count = regs[operand[1] + 1];
+                if (isnan(mean.f)) {
+                    mean.f = stack[sp - 1];
+                    count.u = 1;
+                } else {
+                    if (count.u < operand[0]) count.u++;
+                    mean.f += (stack[sp - 1] - mean.f) / (float) count.u;
+                }
+                stack[sp - 1] = mean.f;
+            }
+                break;
+
+            case OP_SMOOTH: {
+                Register &smoothed = regs[operand[4]];
+                if (isnan(smoothed.f)) {
+                    smoothed.f = stack[sp - 1];
+                } else {
+                    smoothed.f += readFloat(operand) * (stack[sp - 1] - smoothed.f);
+                }
+                stack[sp - 1] = smoothed.f;
+            }
+                break;
+
+            case OP_NORMALIZE: {
+                float low = readFloat(operand);
+                float high = readFloat(operand + 4);
+                stack[sp - 1] = high != low ? (stack[sp - 1] - low) / (high - low) : 0.0f;
+            }
+                break;
+
+            case OP_CLAMP: {
+                float low = readFloat(operand);
+                float high = readFloat(operand + 4);
+                if (stack[sp - 1] < low) stack[sp - 1] = low;
+                if (stack[sp - 1] > high) stack[sp - 1] = high;
+            }
+                break;
+
+            case OP_DEADZONE: {
+                Register &held = regs[operand[4]];
+                if (isnan(held.f) || fabs(stack[sp - 1] - held.f) > readFloat(operand)) {
+                    held.f = stack[sp - 1];
+                }
+                stack[sp - 1] = held.f;
+            }
+                break;
+
+            case OP_RATE: {
+                Register &previous = regs[operand[0]];
+                Register &previousTime = regs[operand[0] + 1];
+                unsigned long now = millis();
+                float rate = 0.0f;
+                if (!isnan(previous.f)) {
+                    unsigned long elapsed = now - previousTime.u;
+                    if (elapsed > 0) {
+                        rate = fabs(stack[sp - 1] - previous.f) * 1000.0f / (float) elapsed;
+                    }
+                }
+                previous.f = stack[sp - 1];
+                previousTime.u = now;
+                stack[sp - 1] = rate;
+            }
+                break;
+
+            case OP_COMPARE:
+                stack[sp - 1] = compare(stack[sp - 1], operand[0], readFloat(operand + 1)) ? 1.0f : 0.0f;
+                break;
+
+            case OP_HYSTERESIS: {
+                Register &state = regs[operand[9]];
+                float threshold = readFloat(operand + 1);
+                float band = readFloat(operand + 5);
+                bool active = !isnan(state.f) && state.f != 0.0f;
+                if (active) {
+                    if (operand[0] == CMP_GREATER || operand[0] == CMP_GREATER_EQUAL) {
+                        threshold -= band;
+                    } else if (operand[0] == CMP_LESS || operand[0] == CMP_LESS_EQUAL) {
+                        threshold += band;
+                    }
+                }
+                active = compare(stack[sp - 1], operand[0], threshold);
+                state.f = active ? 1.0f : 0.0f;
+                stack[sp - 1] = state.f;
+            }
+                break;
+
+            case OP_BETWEEN: {
+                float value = stack[sp - 1];
+                stack[sp - 1] = (value >= readFloat(operand) && value <= readFloat(operand + 4)) ? 1.0f : 0.0f;
+            }
+                break;
+
+            case OP_NEAR:
+                stack[sp - 1] = fabs(stack[sp - 1] - readFloat(operand)) <= readFloat(operand + 4) ? 1.0f : 0.0f;
+                break;
+
+            case OP_NOT:
+                stack[sp - 1] = stack[sp - 1] != 0.0f ? 0.0f : 1.0f;
+                break;
+
+            case OP_AND:
+                sp--;
+                stack[sp - 1] = (stack[sp - 1] != 0.0f && stack[sp] != 0.0f) ? 1.0f : 0.0f;
+                break;
+
+            case OP_OR:
+                sp--;
+                stack[sp - 1] = (stack[sp - 1] != 0.0f || stack[sp] != 0.0f) ? 1.0f : 0.0f;
+                break;
+
+            case OP_XOR:
+                sp--;
+                stack[sp - 1] = ((stack[sp - 1] != 0.0f) != (stack[sp] != 0.0f)) ? 1.0f : 0.0f;
+                break;
+
+            case OP_EDGE: {
+                Register &previous = regs[operand[1]];
+                bool current = stack[sp - 1] != 0.0f;
+                bool last = !isnan(previous.f) && previous.f != 0.0f;
+                bool edge;
+                if (operand[0] == 0) {
+                    edge = current && !last;
+                } else if (operand[0] == 1) {
+                    edge = !current && last;
+                } else {
+                    edge = !isnan(previous.f) && current != last;
+                }
+                previous.f = current ? 1.0f : 0.0f;
+                stack[sp - 1] = edge ? 1.0f : 0.0f;
+            }
+                break;
+
+            case OP_CONSECUTIVE: {
+                Register &count = regs[operand[1]];
+                if (isnan(count.f) || stack[sp - 1] == 0.0f) {
+                    count.f = 0.0f;
+                }
+                if (stack[sp - 1] != 0.0f && count.f < 255.0f) {
+                    count.f += 1.0f;
+                }
+                stack[sp - 1] = count.f >= operand[0] ? 1.0f : 0.0f;
+            }
+                break;
+
+            case OP_STABLE: {
+                Register &since = regs[operand[4]];
+                Register &holding = regs[operand[4] + 1];
+                unsigned long now = millis();
+                if (stack[sp - 1] == 0.0f) {
+                    holding.f = 0.0f;
+                } else {
+                    if (isnan(holding.f) || holding.f == 0.0f) {
+                        since.u = now;
+                        holding.f = 1.0f;
+                    }
+                    stack[sp - 1] = (now - since.u >= readU32(operand)) ? 1.0f : 0.0f;
+                }
+            }
+                break;
+
+            default:
+                results[programId] = false;
+                return false;
+        }
+    }
+}
+
+void RuleVM::runAll() {
+    for (uint8_t i = 0; i < programCount; i++) {
+        run(i);
+    }
+}
+
+bool RuleVM::getResult(int programId) const {
+    if (programId < 0 || programId >= programCount) {
+        return false;
+    }
+    return results[programId];
+}
+
+bool *RuleVM::getResultPointer(int programId) {
+    if (!isLoaded(programId)) {
+        return NULL;
+    }
+    return &results[programId];
+}
+
+RuleAssembler::RuleAssembler()
+        : used(RULE_VM_HEADER_SIZE), registerCount(0), overflow(false) {
+    buffer[0] = RULE_VM_MAGIC;
+    buffer[1] = RULE_VM_VERSION;
+    buffer[2] = 0;
+}
+
+RuleAssembler &RuleAssembler::op(uint8_t opcode) {
+    return u8(opcode);
+}
+
+RuleAssembler &RuleAssembler::u8(uint8_t value) {
+    if (used >= RULE_VM_ASSEMBLER_SIZE) {
+        overflow = true;
+        return *this;
+    }
+    buffer[used++] = value;
+    return *this;
+}
+
+RuleAssembler &RuleAssembler::u32(uint32_t value) {
+    u8(value & 0xFF);
+    u8((value >> 8) & 0xFF);
+    u8((value >> 16) & 0xFF);
+    return u8((value >> 24) & 0xFF);
+}
+
+RuleAssembler &RuleAssembler::f32(float value) {
+    uint8_t bytes[sizeof(float)];
+    memcpy(bytes, &value, sizeof(float));
+    for (uint8_t i = 0; i < sizeof(float); i++) {
+        u8(bytes[i]);
+    }
+    return *this;
+}
+
+uint8_t RuleAssembler::allocate(uint8_t count) {
+    uint8_t first = registerCount;
+    registerCount += count;
+    return first;
+}
+
+const uint8_t *RuleAssembler::finish(uint16_t &length) {
+    buffer[2] = registerCount;
+    length = used;
+    return buffer;
+}
+
+bool RuleAssembler::hasOverflowed() const {
+    return overflow;
+}
\ No newline at end of file
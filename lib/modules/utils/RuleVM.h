@@ -0,0 +1,186 @@
+#pragma once
+
+#ifndef RULE_VM_H
+#define RULE_VM_H
+
+#include "Arduino.h"
+
+#if defined(__AVR__)
+#define RULE_VM_PROGRAMS 8
+#define RULE_VM_REGISTERS 32
+#define RULE_VM_SOURCES 16
+#define RULE_VM_ASSEMBLER_SIZE 64
+#else
+#define RULE_VM_PROGRAMS 32
+#define RULE_VM_REGISTERS 128
+#define RULE_VM_SOURCES 32
+#define RULE_VM_ASSEMBLER_SIZE 128
+#endif
+
+#define RULE_VM_STACK_SIZE 8
+#define RULE_VM_MAGIC 0x52
+#define RULE_VM_VERSION 1
+#define RULE_VM_HEADER_SIZE 3
+
+class RuleVM {
+public:
+    // one byte opcode followed by its operands: s = source slot, r = register, u8/u32/f32 little-endian immediates
+    enum Opcode {
+        OP_END = 0,
+        OP_VALUE,        // s        push float source
+        OP_FLAG,         // s        push bool source as 0/1
+        OP_CONST,        // f32      push constant
+        OP_TRANSFORM,    // s        x = transform(x)
+        OP_FILTER,       // s r      x = validator(x) ? x : last valid x
+        OP_AVERAGE,      // u8 r     running mean over the last n samples, uses r and r+1
+        OP_SMOOTH,       // f32 r    exponential smoothing
+        OP_NORMALIZE,    // f32 f32  (x - min) / (max - min)
+        OP_CLAMP,        // f32 f32
+        OP_DEADZONE,     // f32 r    hold x until it moves more than the zone
+        OP_RATE,         // r        x = |dx/dt| per second, uses r and r+1
+        OP_COMPARE,      // u8 f32   x = x <cmp> threshold
+        OP_HYSTERESIS,   // u8 f32 f32 r  compare, releasing only past threshold -/+ band
+        OP_BETWEEN,      // f32 f32  lo <= x <= hi
+        OP_NEAR,         // f32 f32  |x - ref| <= tolerance
+        OP_NOT,
+        OP_AND,
+        OP_OR,
+        OP_XOR,
+        OP_EDGE,         // u8 r     0 rising, 1 falling, 2 any change
+        OP_CONSECUTIVE,  // u8 r     true after n consecutive true passes
+        OP_STABLE,       // u32 r    true once true for at least ms, uses r and r+1
+        OP_COUNT
+    };
+
+    enum Compare {
+        CMP_GREATER,
+        CMP_LESS,
+        CMP_GREATER_EQUAL,
+        CMP_LESS_EQUAL,
+        CMP_EQUAL,
+        CMP_NOT_EQUAL
+    };
+
+    RuleVM();
+    ~RuleVM();
+
+    int bind(float *pointer);
+    int bind(float (*function)());
+    int bind(bool *pointer);
+    int bind(bool (*function)());
+    int bind(float (*transformer)(float));
+    int bind(bool (*validator)(float));
+
+    bool bindAt(uint8_t slot, float *pointer);
+    bool bindAt(uint8_t slot, float (*function)());
+    bool bindAt(uint8_t slot, bool *pointer);
+    bool bindAt(uint8_t slot, bool (*function)());
+    bool bindAt(uint8_t slot, float (*transformer)(float));
+    bool bindAt(uint8_t slot, bool (*validator)(float));
+
+    int load(const uint8_t *code, uint16_t length);
+    // frees the program's code and registers; the ids and result pointers of the others stay valid
+    // and the freed id is handed out again by the next load()
+    bool unload(int programId);
+    void clear();
+    // drops the sources bound with bind() that no loaded program reads, bindAt() slots are kept
+    void releaseSources();
+
+    const uint8_t *getCode(int programId, uint16_t &length) const;
+    // one past the highest loaded id, unloaded ids below it included
+    int getProgramCount() const;
+    int findProgram(const bool *resultPointer) const;
+
+    bool run(int programId);
+    void runAll();
+    void reset(int programId);
+
+    bool getResult(int programId) const;
+    bool *getResultPointer(int programId);
+
+private:
+    enum SourceKind {
+        SOURCE_NONE,
+        SOURCE_FLOAT_POINTER,
+        SOURCE_FLOAT_FUNCTION,
+        SOURCE_BOOL_POINTER,
+        SOURCE_BOOL_FUNCTION,
+        SOURCE_TRANSFORM,
+        SOURCE_VALIDATOR
+    };
+
+    struct Source {
+        uint8_t kind;
+        bool pinned;
+        union {
+            float *floatPointer;
+            float (*floatFunction)();
+            bool *boolPointer;
+            bool (*boolFunction)();
+            float (*transformer)(float);
+            bool (*validator)(float);
+            void *raw;
+        };
+    };
+
+    union Register {
+        float f;
+        uint32_t u;
+    };
+
+    // length 0 marks a free id
+    struct Program {
+        uint16_t offset;
+        uint16_t length;
+        uint8_t registerBase;
+        uint8_t registerCount;
+    };
+
+    Source sources[RULE_VM_SOURCES];
+    Register registers[RULE_VM_REGISTERS];
+    Program programs[RULE_VM_PROGRAMS];
+    bool results[RULE_VM_PROGRAMS];
+    uint8_t programCount;
+    uint8_t registersUsed;
+
+    uint8_t *codeArena;
+    uint16_t codeUsed;
+
+    RuleVM(const RuleVM &);
+    RuleVM &operator=(const RuleVM &);
+
+    int bindSource(uint8_t kind, void *raw);
+    bool bindSourceAt(uint8_t slot, uint8_t kind, void *raw);
+    bool validate(const uint8_t *code, uint16_t length) const;
+    bool isLoaded(int programId) const;
+    float readValue(uint8_t slot) const;
+    bool readFlag(uint8_t slot) const;
+
+    static uint8_t operandSize(uint8_t op);
+    static bool compare(float value, uint8_t comparison, float threshold);
+    static float readFloat(const uint8_t *at);
+    static uint32_t readU32(const uint8_t *at);
+};
+
+// emits a RuleVM program into a fixed buffer, register numbers are relative to the program
+class RuleAssembler {
+public:
+    RuleAssembler();
+
+    RuleAssembler &op(uint8_t opcode);
+    RuleAssembler &u8(uint8_t value);
+    RuleAssembler &u32(uint32_t value);
+    RuleAssembler &f32(float value);
+    uint8_t allocate(uint8_t count = 1);
+
+    const uint8_t *finish(uint16_t &length);
+    bool hasOverflowed() const;
+
+private:
+    uint8_t buffer[RULE_VM_ASSEMBLER_SIZE];
+    uint16_t used;
+    uint8_t registerCount;
+    bool overflow;
+};
+
+#endif  // RULE_VM_H
\ No newline at end of file
@@ -1,658 +1,469 @@
 #include "StateActionManager.h"
 
 StateActionManager::StateActionManager(int initialCapacity) {
-    capacity = initialCapacity;
-    monitors = new Monitor[capacity];
+    monitors.reserve(initialCapacity);
     monitorCount = 0;
+    wheel = NULL;
 }
 
 StateActionManager::~StateActionManager() {
-    delete[] monitors;
+    attachTimerWheel(NULL);
 }
 
-int StateActionManager::addThresholdMonitor(String name, float (*valueFunction)(), float threshold, TriggerEvent triggerEvent, void (*actionFunction)(), int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+int StateActionManager::allocateMonitor(const String &name, MonitorType type, TriggerEvent triggerEvent,
+                                        float (*valueFunction)(), float *valuePointer, int repeatCount,
+                                        unsigned long interval) {
+    if (!monitors.reserve(monitorCount + 1)) {
+        return -1;
+    }
+
+    uint16_t nameOffset = names.add(name.c_str());
+    if (nameOffset == NAME_ARENA_INVALID) {
+        return -1;
     }
 
     int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = THRESHOLD;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = valueFunction;
-    monitors[id].valuePointer = NULL;
-    monitors[id].actionFunction = actionFunction;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].threshold = threshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = valueFunction();
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasAboveThreshold = (monitors[id].lastValue > threshold);
-    monitors[id].state = IDLE;
+    Monitor &monitor = monitors[id];
+    memset(&monitor, 0, sizeof(Monitor));
+    monitor.nameOffset = nameOffset;
+    monitor.type = type;
+    monitor.triggerEvent = triggerEvent;
+    monitor.state = IDLE;
+    monitor.enabled = true;
+    monitor.repeatCount = repeatCount;
+    monitor.interval = interval;
+    monitor.timerHandle = wheel != NULL ? wheel->allocate(onWheelExpiry, this, id) : TIMER_WHEEL_INVALID;
+
+    if (valuePointer != NULL) {
+        monitor.pointerSource = true;
+        monitor.source.pointer = valuePointer;
+    } else {
+        monitor.source.function = valueFunction;
+    }
+    return id;
+}
+
+void StateActionManager::setAction(int monitorId, void (*actionFunction)(), void (*paramActionFunction)(void *),
+                                   void *param) {
+    Monitor &monitor = monitors[monitorId];
+    if (paramActionFunction != NULL) {
+        monitor.actionFunction = reinterpret_cast<void (*)()>(paramActionFunction);
+        monitor.paramAction = true;
+        monitor.actionParam = param;
+    } else {
+        monitor.actionFunction = actionFunction;
+        monitor.paramAction = false;
+        monitor.actionParam = NULL;
+    }
+}
+
+void StateActionManager::readValue(Monitor &monitor) {
+    if (monitor.pointerSource) {
+        if (monitor.source.pointer) {
+            monitor.currentValue = *monitor.source.pointer;
+        }
+    } else if (monitor.source.function) {
+        monitor.currentValue = monitor.source.function();
+    }
+}
+
+void StateActionManager::primeMonitor(Monitor &monitor) {
+    if (monitor.type == TIME_BASED) {
+        return;
+    }
+
+    readValue(monitor);
+    monitor.lastValue = monitor.currentValue;
+    if (monitor.type == THRESHOLD || monitor.type == RANGE) {
+        monitor.wasActive = isActive(monitor);
+    }
+}
+
+bool StateActionManager::isActive(Monitor &monitor) {
+    if (monitor.type == RANGE) {
+        return monitor.currentValue >= monitor.limit.range.lower && monitor.currentValue <= monitor.limit.range.upper;
+    }
+    return monitor.currentValue > monitor.limit.threshold;
+}
+
+bool StateActionManager::evaluateMonitor(Monitor &monitor, bool consumeChange) {
+    bool triggered = false;
+
+    switch (monitor.type) {
+        case THRESHOLD:
+        case RANGE: {
+            bool active = isActive(monitor);
+
+            switch (monitor.triggerEvent) {
+                case TRIG_RISING:
+                    triggered = (active && !monitor.wasActive);
+                    break;
+                case TRIG_FALLING:
+                    triggered = (!active && monitor.wasActive);
+                    break;
+                case TRIG_BOTH_WAYS:
+                    triggered = (active != monitor.wasActive);
+                    break;
+                case TRIG_VALUE_CHANGE:
+                    break;
+            }
+
+            monitor.wasActive = active;
+        }
+            break;
+
+        case CHANGE_VALUE: {
+            float delta = abs(monitor.currentValue - monitor.lastValue);
+            triggered = (delta >= monitor.limit.minChange);
+            if (consumeChange) {
+                monitor.lastValue = monitor.currentValue;
+            }
+        }
+            break;
+
+        case TIME_BASED:
+            triggered = (millis() - monitor.lastExecutionTime >= monitor.interval);
+            break;
+    }
+
+    return triggered;
+}
+
+void StateActionManager::runAction(Monitor &monitor) {
+    if (monitor.actionFunction == NULL) {
+        return;
+    }
+    if (monitor.paramAction) {
+        reinterpret_cast<void (*)(void *)>(monitor.actionFunction)(monitor.actionParam);
+    } else {
+        monitor.actionFunction();
+    }
+}
+
+int StateActionManager::addThresholdMonitor(String name, float (*valueFunction)(), float threshold, TriggerEvent triggerEvent, void (*actionFunction)(), int repeatCount, unsigned long actionInterval) {
+    int id = allocateMonitor(name, THRESHOLD, triggerEvent, valueFunction, NULL, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
+    }
+
+    monitors[id].limit.threshold = threshold;
+    setAction(id, actionFunction, NULL, NULL);
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addThresholdMonitor(String name, float (*valueFunction)(), float threshold, TriggerEvent triggerEvent, void (*actionFunction)(void *), void *param, int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, THRESHOLD, triggerEvent, valueFunction, NULL, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = THRESHOLD;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = valueFunction;
-    monitors[id].valuePointer = NULL;
-    monitors[id].actionFunction = NULL;
-    monitors[id].paramActionFunction = actionFunction;
-    monitors[id].actionParam = param;
-    monitors[id].threshold = threshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = valueFunction();
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasAboveThreshold = (monitors[id].lastValue > threshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.threshold = threshold;
+    setAction(id, NULL, actionFunction, param);
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addThresholdMonitor(String name, float (*valueFunction)(), float threshold, TriggerEvent triggerEvent, int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, THRESHOLD, triggerEvent, valueFunction, NULL, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = THRESHOLD;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = valueFunction;
-    monitors[id].valuePointer = NULL;
-    monitors[id].actionFunction = NULL;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].threshold = threshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = valueFunction();
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasAboveThreshold = (monitors[id].lastValue > threshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.threshold = threshold;
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addThresholdMonitor(String name, float *valuePointer, float threshold, TriggerEvent triggerEvent, void (*actionFunction)(), int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, THRESHOLD, triggerEvent, NULL, valuePointer, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = VALUE_POINTER;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = NULL;
-    monitors[id].valuePointer = valuePointer;
-    monitors[id].actionFunction = actionFunction;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].threshold = threshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = *valuePointer;
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasAboveThreshold = (monitors[id].lastValue > threshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.threshold = threshold;
+    setAction(id, actionFunction, NULL, NULL);
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addThresholdMonitor(String name, float *valuePointer, float threshold, TriggerEvent triggerEvent, void (*actionFunction)(void *), void *param, int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, THRESHOLD, triggerEvent, NULL, valuePointer, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = VALUE_POINTER;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = NULL;
-    monitors[id].valuePointer = valuePointer;
-    monitors[id].actionFunction = NULL;
-    monitors[id].paramActionFunction = actionFunction;
-    monitors[id].actionParam = param;
-    monitors[id].threshold = threshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = *valuePointer;
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasAboveThreshold = (monitors[id].lastValue > threshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.threshold = threshold;
+    setAction(id, NULL, actionFunction, param);
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addThresholdMonitor(String name, float *valuePointer, float threshold, TriggerEvent triggerEvent, int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, THRESHOLD, triggerEvent, NULL, valuePointer, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = VALUE_POINTER;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = NULL;
-    monitors[id].valuePointer = valuePointer;
-    monitors[id].actionFunction = NULL;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].threshold = threshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = *valuePointer;
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasAboveThreshold = (monitors[id].lastValue > threshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.threshold = threshold;
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addRangeMonitor(String name, float (*valueFunction)(), float lowerThreshold, float upperThreshold, TriggerEvent triggerEvent, void (*actionFunction)(), int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, RANGE, triggerEvent, valueFunction, NULL, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = RANGE;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = valueFunction;
-    monitors[id].valuePointer = NULL;
-    monitors[id].actionFunction = actionFunction;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].lowerThreshold = lowerThreshold;
-    monitors[id].upperThreshold = upperThreshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = valueFunction();
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasInRange = (monitors[id].lastValue >= lowerThreshold &&
-                               monitors[id].lastValue <= upperThreshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.range.lower = lowerThreshold;
+    monitors[id].limit.range.upper = upperThreshold;
+    setAction(id, actionFunction, NULL, NULL);
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addRangeMonitor(String name, float (*valueFunction)(), float lowerThreshold, float upperThreshold, TriggerEvent triggerEvent, void (*actionFunction)(void *), void *param, int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, RANGE, triggerEvent, valueFunction, NULL, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = RANGE;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = valueFunction;
-    monitors[id].valuePointer = NULL;
-    monitors[id].actionFunction = NULL;
-    monitors[id].paramActionFunction = actionFunction;
-    monitors[id].actionParam = param;
-    monitors[id].lowerThreshold = lowerThreshold;
-    monitors[id].upperThreshold = upperThreshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = valueFunction();
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasInRange = (monitors[id].lastValue >= lowerThreshold &&
-                               monitors[id].lastValue <= upperThreshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.range.lower = lowerThreshold;
+    monitors[id].limit.range.upper = upperThreshold;
+    setAction(id, NULL, actionFunction, param);
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addRangeMonitor(String name, float (*valueFunction)(), float lowerThreshold, float upperThreshold, TriggerEvent triggerEvent, int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, RANGE, triggerEvent, valueFunction, NULL, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = RANGE;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = valueFunction;
-    monitors[id].valuePointer = NULL;
-    monitors[id].actionFunction = NULL;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].lowerThreshold = lowerThreshold;
-    monitors[id].upperThreshold = upperThreshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = valueFunction();
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasInRange = (monitors[id].lastValue >= lowerThreshold &&
-                               monitors[id].lastValue <= upperThreshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.range.lower = lowerThreshold;
+    monitors[id].limit.range.upper = upperThreshold;
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addRangeMonitor(String name, float *valuePointer, float lowerThreshold, float upperThreshold, TriggerEvent triggerEvent, void (*actionFunction)(), int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, RANGE, triggerEvent, NULL, valuePointer, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = VALUE_POINTER;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = NULL;
-    monitors[id].valuePointer = valuePointer;
-    monitors[id].actionFunction = actionFunction;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].lowerThreshold = lowerThreshold;
-    monitors[id].upperThreshold = upperThreshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = *valuePointer;
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasInRange = (monitors[id].lastValue >= lowerThreshold &&
-                               monitors[id].lastValue <= upperThreshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.range.lower = lowerThreshold;
+    monitors[id].limit.range.upper = upperThreshold;
+    setAction(id, actionFunction, NULL, NULL);
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addRangeMonitor(String name, float *valuePointer, float lowerThreshold, float upperThreshold, TriggerEvent triggerEvent, void (*actionFunction)(void *), void *param, int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, RANGE, triggerEvent, NULL, valuePointer, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = VALUE_POINTER;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = NULL;
-    monitors[id].valuePointer = valuePointer;
-    monitors[id].actionFunction = NULL;
-    monitors[id].paramActionFunction = actionFunction;
-    monitors[id].actionParam = param;
-    monitors[id].lowerThreshold = lowerThreshold;
-    monitors[id].upperThreshold = upperThreshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = *valuePointer;
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasInRange = (monitors[id].lastValue >= lowerThreshold &&
-                               monitors[id].lastValue <= upperThreshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.range.lower = lowerThreshold;
+    monitors[id].limit.range.upper = upperThreshold;
+    setAction(id, NULL, actionFunction, param);
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addRangeMonitor(String name, float *valuePointer, float lowerThreshold, float upperThreshold, TriggerEvent triggerEvent, int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, RANGE, triggerEvent, NULL, valuePointer, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = VALUE_POINTER;
-    monitors[id].triggerEvent = triggerEvent;
-    monitors[id].valueFunction = NULL;
-    monitors[id].valuePointer = valuePointer;
-    monitors[id].actionFunction = NULL;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].lowerThreshold = lowerThreshold;
-    monitors[id].upperThreshold = upperThreshold;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = *valuePointer;
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasInRange = (monitors[id].lastValue >= lowerThreshold &&
-                               monitors[id].lastValue <= upperThreshold);
-    monitors[id].state = IDLE;
+    monitors[id].limit.range.lower = lowerThreshold;
+    monitors[id].limit.range.upper = upperThreshold;
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addChangeMonitor(String name, float (*valueFunction)(), float minChange, void (*actionFunction)(), int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, CHANGE_VALUE, TRIG_VALUE_CHANGE, valueFunction, NULL, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = CHANGE_VALUE;
-    monitors[id].valueFunction = valueFunction;
-    monitors[id].valuePointer = NULL;
-    monitors[id].actionFunction = actionFunction;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].minChange = minChange;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = valueFunction();
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasChanged = false;
-    monitors[id].state = IDLE;
+    monitors[id].limit.minChange = minChange;
+    setAction(id, actionFunction, NULL, NULL);
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addChangeMonitor(String name, float *valuePointer, float minChange, void (*actionFunction)(), int repeatCount, unsigned long actionInterval) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, CHANGE_VALUE, TRIG_VALUE_CHANGE, NULL, valuePointer, repeatCount, actionInterval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = VALUE_POINTER;
-    monitors[id].valueFunction = NULL;
-    monitors[id].valuePointer = valuePointer;
-    monitors[id].actionFunction = actionFunction;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].minChange = minChange;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].interval = actionInterval;
-    monitors[id].executionCount = 0;
-    monitors[id].lastExecutionTime = 0;
-    monitors[id].triggerTime = 0;
-    monitors[id].lastValueTime = 0;
-    monitors[id].lastValue = *valuePointer;
-    monitors[id].currentValue = monitors[id].lastValue;
-    monitors[id].enabled = true;
-    monitors[id].wasChanged = false;
-    monitors[id].state = IDLE;
+    monitors[id].limit.minChange = minChange;
+    setAction(id, actionFunction, NULL, NULL);
+    primeMonitor(monitors[id]);
 
     return id;
 }
 
 int StateActionManager::addTimeBasedMonitor(String name, unsigned long interval, void (*actionFunction)(), int repeatCount) {
-    if (monitorCount >= capacity) {
-        capacity *= 2;
-        Monitor *newMonitors = new Monitor[capacity];
-        memcpy(newMonitors, monitors, monitorCount * sizeof(Monitor));
-        delete[] monitors;
-        monitors = newMonitors;
+    int id = allocateMonitor(name, TIME_BASED, TRIG_RISING, NULL, NULL, repeatCount, interval);
+    if (id < 0) {
+        return -1;
     }
 
-    int id = monitorCount++;
-    monitors[id].name = name;
-    monitors[id].type = TIME_BASED;
-    monitors[id].actionFunction = actionFunction;
-    monitors[id].paramActionFunction = NULL;
-    monitors[id].actionParam = NULL;
-    monitors[id].interval = interval;
-    monitors[id].repeatCount = repeatCount;
-    monitors[id].executionCount = 0;
+    setAction(id, actionFunction, NULL, NULL);
     monitors[id].lastExecutionTime = millis();
-    monitors[id].triggerTime = 0;
-    monitors[id].enabled = true;
-    monitors[id].state = IDLE;
+    scheduleMonitor(id);
 
     return id;
 }
 
-void StateActionManager::update() {
-    unsigned long currentTime = millis();
+void StateActionManager::startExecution(Monitor &monitor, unsigned long currentTime) {
+    monitor.triggerTime = currentTime;
+    monitor.state = EXECUTING;
+    monitor.executionCount = 0;
+    monitor.lastExecutionTime = currentTime;
 
-    for (int i = 0; i < monitorCount; i++) {
-        if (!monitors[i].enabled || monitors[i].state == PAUSED) {
-            continue;
-        }
+    runAction(monitor);
+    monitor.executionCount++;
 
-        if (monitors[i].state == EXECUTING) {
-            bool actionDue = (currentTime - monitors[i].lastExecutionTime >= monitors[i].interval);
+    if (monitor.repeatCount == 1) {
+        monitor.state = COMPLETED;
+    }
+}
 
-            if (actionDue && monitors[i].executionCount < monitors[i].repeatCount) {
-                if (monitors[i].actionFunction) {
-                    monitors[i].actionFunction();
-                } else if (monitors[i].paramActionFunction) {
-                    monitors[i].paramActionFunction(monitors[i].actionParam);
-                }
+void StateActionManager::stepExecution(Monitor &monitor, unsigned long currentTime) {
+    bool actionDue = (currentTime - monitor.lastExecutionTime >= monitor.interval);
 
-                monitors[i].executionCount++;
-                monitors[i].lastExecutionTime = currentTime;
+    if (actionDue && monitor.executionCount < monitor.repeatCount) {
+        runAction(monitor);
 
-                if (monitors[i].executionCount >= monitors[i].repeatCount && monitors[i].repeatCount > 0) {
-                    monitors[i].state = COMPLETED;
-                }
-            }
-            continue;
+        monitor.executionCount++;
+        monitor.lastExecutionTime = currentTime;
+
+        if (monitor.executionCount >= monitor.repeatCount && monitor.repeatCount > 0) {
+            monitor.state = COMPLETED;
         }
+    }
+}
 
-        if (monitors[i].type == TIME_BASED) {
-            if (currentTime - monitors[i].lastExecutionTime >= monitors[i].interval) {
-                monitors[i].triggerTime = currentTime;
-                monitors[i].state = EXECUTING;
-                monitors[i].executionCount = 0;
-                monitors[i].lastExecutionTime = currentTime;
+void StateActionManager::attachTimerWheel(TimerWheel *timerWheel) {
+    for (int i = 0; i < monitorCount && wheel != NULL; i++) {
+        wheel->release(monitors[i].timerHandle);
+        monitors[i].timerHandle = TIMER_WHEEL_INVALID;
+    }
 
-                if (monitors[i].actionFunction) {
-                    monitors[i].actionFunction();
-                } else if (monitors[i].paramActionFunction) {
-                    monitors[i].paramActionFunction(monitors[i].actionParam);
-                }
+    wheel = timerWheel;
+    for (int i = 0; i < monitorCount && wheel != NULL; i++) {
+        monitors[i].timerHandle = wheel->allocate(onWheelExpiry, this, i);
+        scheduleMonitor(i);
+    }
+}
 
-                monitors[i].executionCount++;
+void StateActionManager::scheduleMonitor(int monitorId) {
+    Monitor &monitor = monitors[monitorId];
+    if (wheel == NULL || monitor.timerHandle == TIMER_WHEEL_INVALID) {
+        return;
+    }
 
-                if (monitors[i].repeatCount == 1) {
-                    monitors[i].state = COMPLETED;
-                }
-            }
-            continue;
-        }
+    // lastExecutionTime is a millis() stamp, the wheel may run on its own clock
+    unsigned long elapsed = millis() - monitor.lastExecutionTime;
+    unsigned long remaining = elapsed >= monitor.interval ? 0 : monitor.interval - elapsed;
 
-        if (monitors[i].valueFunction) {
-            monitors[i].currentValue = monitors[i].valueFunction();
-        } else if (monitors[i].valuePointer) {
-            monitors[i].currentValue = *monitors[i].valuePointer;
-        }
+    if (!monitor.enabled || monitor.state == PAUSED) {
+        wheel->cancel(monitor.timerHandle);
+    } else if (monitor.state == EXECUTING && monitor.executionCount < monitor.repeatCount) {
+        wheel->scheduleIn(monitor.timerHandle, remaining);
+    } else if (monitor.type == TIME_BASED && monitor.state != EXECUTING) {
+        wheel->scheduleIn(monitor.timerHandle, remaining);
+    } else {
+        wheel->cancel(monitor.timerHandle);
+    }
+}
 
-        bool triggered = false;
+bool StateActionManager::isWheelDriven(Monitor &monitor) {
+    return monitor.timerHandle != TIMER_WHEEL_INVALID && (monitor.type == TIME_BASED || monitor.state == EXECUTING);
+}
 
-        if (monitors[i].type == THRESHOLD || (monitors[i].type == VALUE_POINTER && monitors[i].threshold > 0)) {
-            bool isAboveThreshold = (monitors[i].currentValue > monitors[i].threshold);
+void StateActionManager::onWheelExpiry(void *owner, uint16_t tag) {
+    StateActionManager *manager = static_cast<StateActionManager *>(owner);
+    if (tag >= manager->monitorCount) {
+        return;
+    }
 
-            switch (monitors[i].triggerEvent) {
-                case TRIG_RISING:
-                    triggered = (isAboveThreshold && !monitors[i].wasAboveThreshold);
-                    break;
-                case TRIG_FALLING:
-                    triggered = (!isAboveThreshold && monitors[i].wasAboveThreshold);
-                    break;
-                case TRIG_BOTH_WAYS:
-                    triggered = (isAboveThreshold != monitors[i].wasAboveThreshold);
-                    break;
-                case TRIG_VALUE_CHANGE:
-                    break;
-            }
+    Monitor &monitor = manager->monitors[tag];
+    if (!monitor.enabled || monitor.state == PAUSED) {
+        return;
+    }
 
-            monitors[i].wasAboveThreshold = isAboveThreshold;
-        } else if (monitors[i].type == RANGE || (monitors[i].type == VALUE_POINTER &&
-                                                 monitors[i].lowerThreshold < monitors[i].upperThreshold)) {
-            bool isInRange = (monitors[i].currentValue >= monitors[i].lowerThreshold &&
-                              monitors[i].currentValue <= monitors[i].upperThreshold);
+    unsigned long currentTime = millis();
+    if (monitor.state == EXECUTING) {
+        manager->stepExecution(monitor, currentTime);
+    } else if (monitor.type == TIME_BASED) {
+        manager->startExecution(monitor, currentTime);
+    }
+    manager->scheduleMonitor(tag);
+}
 
-            switch (monitors[i].triggerEvent) {
-                case TRIG_RISING:
-                    triggered = (isInRange && !monitors[i].wasInRange);
-                    break;
-                case TRIG_FALLING:
-                    triggered = (!isInRange && monitors[i].wasInRange);
-                    break;
-                case TRIG_BOTH_WAYS:
-                    triggered = (isInRange != monitors[i].wasInRange);
-                    break;
-                case TRIG_VALUE_CHANGE:
-                    break;
-            }
+void StateActionManager::update() {
+    unsigned long currentTime = millis();
 
-            monitors[i].wasInRange = isInRange;
-        } else if (monitors[i].type == CHANGE_VALUE || (monitors[i].type == VALUE_POINTER && monitors[i].minChange > 0)) {
-            float delta = abs(monitors[i].currentValue - monitors[i].lastValue);
-            triggered = (delta >= monitors[i].minChange);
-            monitors[i].lastValue = monitors[i].currentValue;
+    for (int i = 0; i < monitorCount; i++) {
+        Monitor &monitor = monitors[i];
+        if (!monitor.enabled || monitor.state == PAUSED || isWheelDriven(monitor)) {
+            continue;
         }
 
-        if (triggered && (monitors[i].state == IDLE || monitors[i].state == COMPLETED)) {
-            monitors[i].triggerTime = currentTime;
-            monitors[i].state = EXECUTING;
-            monitors[i].executionCount = 0;
-            monitors[i].lastExecutionTime = currentTime;
+        if (monitor.state == EXECUTING) {
+            stepExecution(monitor, currentTime);
+            continue;
+        }
 
-            if (monitors[i].actionFunction) {
-                monitors[i].actionFunction();
-            } else if (monitors[i].paramActionFunction) {
-                monitors[i].paramActionFunction(monitors[i].actionParam);
+        if (monitor.type == TIME_BASED) {
+            if (currentTime - monitor.lastExecutionTime >= monitor.interval) {
+                startExecution(monitor, currentTime);
             }
+            continue;
+        }
 
-            monitors[i].executionCount++;
+        readValue(monitor);
+        bool triggered = evaluateMonitor(monitor, true);
 
-            if (monitors[i].repeatCount == 1) {
-                monitors[i].state = COMPLETED;
-            }
+        if (triggered && (monitor.state == IDLE || monitor.state == COMPLETED)) {
+            startExecution(monitor, currentTime);
+            scheduleMonitor(i);
         }
 
-        monitors[i].lastValueTime = currentTime;
+        monitor.lastValueTime = currentTime;
     }
 }
 
 float StateActionManager::getCurrentValue(int monitorId) {
     if (monitorId >= 0 && monitorId < monitorCount) {
-        if (monitors[monitorId].valueFunction) {
-            return monitors[monitorId].currentValue;
-        } else if (monitors[monitorId].valuePointer) {
-            return *monitors[monitorId].valuePointer;
+        Monitor &monitor = monitors[monitorId];
+        if (monitor.pointerSource) {
+            return monitor.source.pointer ? *monitor.source.pointer : 0;
+        } else if (monitor.source.function) {
+            return monitor.currentValue;
         }
     }
     return 0;
@@ -667,7 +478,7 @@ bool StateActionManager::isActionRunning(int monitorId) {
 
 StateActionManager::MonitorState StateActionManager::getMonitorState(int monitorId) {
     if (monitorId >= 0 && monitorId < monitorCount) {
-        return monitors[monitorId].state;
+        return (MonitorState) monitors[monitorId].state;
     }
     return IDLE;
 }
@@ -688,7 +499,7 @@ unsigned long StateActionManager::getLastTriggerTime(int monitorId) {
 
 String StateActionManager::getMonitorName(int monitorId) {
     if (monitorId >= 0 && monitorId < monitorCount) {
-        return monitors[monitorId].name;
+        return String(names.get(monitors[monitorId].nameOffset));
     }
     return "";
 }
@@ -698,64 +509,11 @@ bool StateActionManager::isConditionTriggered(int monitorId) {
         return false;
     }
 
-    if (monitors[monitorId].valueFunction) {
-        monitors[monitorId].currentValue = monitors[monitorId].valueFunction();
-    } else if (monitors[monitorId].valuePointer) {
-        monitors[monitorId].currentValue = *monitors[monitorId].valuePointer;
-    }
-
-    bool triggered = false;
-
-    if (monitors[monitorId].type == THRESHOLD ||
-        (monitors[monitorId].type == VALUE_POINTER && monitors[monitorId].threshold > 0)) {
-        bool isAboveThreshold = (monitors[monitorId].currentValue > monitors[monitorId].threshold);
-
-        switch (monitors[monitorId].triggerEvent) {
-            case TRIG_RISING:
-                triggered = (isAboveThreshold && !monitors[monitorId].wasAboveThreshold);
-                break;
-            case TRIG_FALLING:
-                triggered = (!isAboveThreshold && monitors[monitorId].wasAboveThreshold);
-                break;
-            case TRIG_BOTH_WAYS:
-                triggered = (isAboveThreshold != monitors[monitorId].wasAboveThreshold);
-                break;
-            case TRIG_VALUE_CHANGE:
-                break;
-        }
-
-        monitors[monitorId].wasAboveThreshold = isAboveThreshold;
-    } else if (monitors[monitorId].type == RANGE ||
-               (monitors[monitorId].type == VALUE_POINTER &&
-                monitors[monitorId].lowerThreshold < monitors[monitorId].upperThreshold)) {
-        bool isInRange = (monitors[monitorId].currentValue >= monitors[monitorId].lowerThreshold &&
-                          monitors[monitorId].currentValue <= monitors[monitorId].upperThreshold);
-
-        switch (monitors[monitorId].triggerEvent) {
-            case TRIG_RISING:
-                triggered = (isInRange && !monitors[monitorId].wasInRange);
-                break;
-            case TRIG_FALLING:
-                triggered = (!isInRange && monitors[monitorId].wasInRange);
-                break;
-            case TRIG_BOTH_WAYS:
-                triggered = (isInRange != monitors[monitorId].wasInRange);
-                break;
-            case TRIG_VALUE_CHANGE:
-                break;
-        }
-
-        monitors[monitorId].wasInRange = isInRange;
-    } else if (monitors[monitorId].type == CHANGE_VALUE ||
-               (monitors[monitorId].type == VALUE_POINTER && monitors[monitorId].minChange > 0)) {
-        float delta = abs(monitors[monitorId].currentValue - monitors[monitorId].lastValue);
-        triggered = (delta >= monitors[monitorId].minChange);
-    } else if (monitors[monitorId].type == TIME_BASED) {
-        unsigned long currentTime = millis();
-        triggered = (currentTime - monitors[monitorId].lastExecutionTime >= monitors[monitorId].interval);
+    Monitor &monitor = monitors[monitorId];
+    if (monitor.type != TIME_BASED) {
+        readValue(monitor);
     }
-
-    return triggered;
+    return evaluateMonitor(monitor, false);
 }
 
 bool StateActionManager::checkAndTrigger(int monitorId, void (*callbackFunction)()) {
@@ -766,15 +524,14 @@ bool StateActionManager::checkAndTrigger(int monitorId, void (*callbackFunction)
     bool triggered = isConditionTriggered(monitorId);
 
     if (triggered) {
+        Monitor &monitor = monitors[monitorId];
         unsigned long currentTime = millis();
 
-        if (monitors[monitorId].state == EXECUTING &&
-            currentTime - monitors[monitorId].lastExecutionTime < monitors[monitorId].interval) {
+        if (monitor.state == EXECUTING && currentTime - monitor.lastExecutionTime < monitor.interval) {
             return false;
         }
 
-        if (monitors[monitorId].repeatCount > 0 &&
-            monitors[monitorId].executionCount >= monitors[monitorId].repeatCount) {
+        if (monitor.repeatCount > 0 && monitor.executionCount >= monitor.repeatCount) {
             return false;
         }
 
@@ -782,18 +539,18 @@ bool StateActionManager::checkAndTrigger(int monitorId, void (*callbackFunction)
             callbackFunction();
         }
 
-        if (monitors[monitorId].state != EXECUTING) {
-            monitors[monitorId].state = EXECUTING;
-            monitors[monitorId].triggerTime = currentTime;
+        if (monitor.state != EXECUTING) {
+            monitor.state = EXECUTING;
+            monitor.triggerTime = currentTime;
         }
 
-        monitors[monitorId].executionCount++;
-        monitors[monitorId].lastExecutionTime = currentTime;
+        monitor.executionCount++;
+        monitor.lastExecutionTime = currentTime;
 
-        if (monitors[monitorId].repeatCount > 0 &&
-            monitors[monitorId].executionCount >= monitors[monitorId].repeatCount) {
-            monitors[monitorId].state = COMPLETED;
+        if (monitor.repeatCount > 0 && monitor.executionCount >= monitor.repeatCount) {
+            monitor.state = COMPLETED;
         }
+        scheduleMonitor(monitorId);
 
         return true;
     }
@@ -805,26 +562,8 @@ void StateActionManager::resetMonitor(int monitorId) {
     if (monitorId >= 0 && monitorId < monitorCount) {
         monitors[monitorId].state = IDLE;
         monitors[monitorId].executionCount = 0;
-
-        if (monitors[monitorId].valueFunction) {
-            monitors[monitorId].currentValue = monitors[monitorId].valueFunction();
-            monitors[monitorId].lastValue = monitors[monitorId].currentValue;
-        } else if (monitors[monitorId].valuePointer) {
-            monitors[monitorId].currentValue = *monitors[monitorId].valuePointer;
-            monitors[monitorId].lastValue = monitors[monitorId].currentValue;
-        }
-
-        if (monitors[monitorId].type == THRESHOLD ||
-            (monitors[monitorId].type == VALUE_POINTER && monitors[monitorId].threshold > 0)) {
-            monitors[monitorId].wasAboveThreshold =
-                    (monitors[monitorId].currentValue > monitors[monitorId].threshold);
-        } else if (monitors[monitorId].type == RANGE ||
-                   (monitors[monitorId].type == VALUE_POINTER &&
-                    monitors[monitorId].lowerThreshold < monitors[monitorId].upperThreshold)) {
-            monitors[monitorId].wasInRange =
-                    (monitors[monitorId].currentValue >= monitors[monitorId].lowerThreshold &&
-                     monitors[monitorId].currentValue <= monitors[monitorId].upperThreshold);
-        }
+        primeMonitor(monitors[monitorId]);
+        scheduleMonitor(monitorId);
     }
 }
 
@@ -833,66 +572,45 @@ void StateActionManager::setEnabled(int monitorId, bool enabled) {
         monitors[monitorId].enabled = enabled;
 
         if (enabled) {
-            if (monitors[monitorId].valueFunction) {
-                monitors[monitorId].currentValue = monitors[monitorId].valueFunction();
-                monitors[monitorId].lastValue = monitors[monitorId].currentValue;
-            } else if (monitors[monitorId].valuePointer) {
-                monitors[monitorId].currentValue = *monitors[monitorId].valuePointer;
-                monitors[monitorId].lastValue = monitors[monitorId].currentValue;
-            }
-
-            if (monitors[monitorId].type == THRESHOLD ||
-                (monitors[monitorId].type == VALUE_POINTER && monitors[monitorId].threshold > 0)) {
-                monitors[monitorId].wasAboveThreshold =
-                        (monitors[monitorId].currentValue > monitors[monitorId].threshold);
-            } else if (monitors[monitorId].type == RANGE ||
-                       (monitors[monitorId].type == VALUE_POINTER &&
-                        monitors[monitorId].lowerThreshold < monitors[monitorId].upperThreshold)) {
-                monitors[monitorId].wasInRange =
-                        (monitors[monitorId].currentValue >= monitors[monitorId].lowerThreshold &&
-                         monitors[monitorId].currentValue <= monitors[monitorId].upperThreshold);
-            }
+            primeMonitor(monitors[monitorId]);
         }
+        scheduleMonitor(monitorId);
     }
 }
 
 void StateActionManager::setThreshold(int monitorId, float threshold) {
-    if (monitorId >= 0 && monitorId < monitorCount &&
-        (monitors[monitorId].type == THRESHOLD || monitors[monitorId].type == VALUE_POINTER)) {
-        monitors[monitorId].threshold = threshold;
-
-        monitors[monitorId].wasAboveThreshold =
-                (monitors[monitorId].currentValue > threshold);
+    if (monitorId >= 0 && monitorId < monitorCount && monitors[monitorId].type == THRESHOLD) {
+        monitors[monitorId].limit.threshold = threshold;
+        monitors[monitorId].wasActive = isActive(monitors[monitorId]);
     }
 }
 
 void StateActionManager::setRange(int monitorId, float lowerThreshold, float upperThreshold) {
-    if (monitorId >= 0 && monitorId < monitorCount &&
-        (monitors[monitorId].type == RANGE || monitors[monitorId].type == VALUE_POINTER)) {
-        monitors[monitorId].lowerThreshold = lowerThreshold;
-        monitors[monitorId].upperThreshold = upperThreshold;
-
-        monitors[monitorId].wasInRange =
-                (monitors[monitorId].currentValue >= lowerThreshold &&
-                 monitors[monitorId].currentValue <= upperThreshold);
+    if (monitorId >= 0 && monitorId < monitorCount && monitors[monitorId].type == RANGE) {
+        monitors[monitorId].limit.range.lower = lowerThreshold;
+        monitors[monitorId].limit.range.upper = upperThreshold;
+        monitors[monitorId].wasActive = isActive(monitors[monitorId]);
     }
 }
 
 void StateActionManager::setRepeatCount(int monitorId, int repeatCount) {
     if (monitorId >= 0 && monitorId < monitorCount) {
         monitors[monitorId].repeatCount = repeatCount;
+        scheduleMonitor(monitorId);
     }
 }
 
 void StateActionManager::setInterval(int monitorId, unsigned long interval) {
     if (monitorId >= 0 && monitorId < monitorCount) {
         monitors[monitorId].interval = interval;
+        scheduleMonitor(monitorId);
     }
 }
 
 void StateActionManager::pauseAction(int monitorId) {
     if (monitorId >= 0 && monitorId < monitorCount && monitors[monitorId].state == EXECUTING) {
         monitors[monitorId].state = PAUSED;
+        scheduleMonitor(monitorId);
     }
 }
 
@@ -900,6 +618,7 @@ void StateActionManager::resumeAction(int monitorId) {
     if (monitorId >= 0 && monitorId < monitorCount && monitors[monitorId].state == PAUSED) {
         monitors[monitorId].state = EXECUTING;
         monitors[monitorId].lastExecutionTime = millis();
+        scheduleMonitor(monitorId);
     }
 }
 
@@ -907,13 +626,14 @@ void StateActionManager::stopAction(int monitorId) {
     if (monitorId >= 0 && monitorId < monitorCount &&
         (monitors[monitorId].state == EXECUTING || monitors[monitorId].state == PAUSED)) {
         monitors[monitorId].state = COMPLETED;
+        scheduleMonitor(monitorId);
     }
 }
 
 void StateActionManager::printStatus(int monitorId) {
     if (monitorId >= 0 && monitorId < monitorCount) {
         Serial.print("Monitor '");
-        Serial.print(monitors[monitorId].name);
+        Serial.print(names.get(monitors[monitorId].nameOffset));
         Serial.print("': State=");
 
         switch (monitors[monitorId].state) {
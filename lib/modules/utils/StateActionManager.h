@@ -2,6 +2,16 @@
 #define STATE_ACTION_MANAGER_H
 
 #include "Arduino.h"
+#include "RulePool.h"
+#include "../time/timer-wheel.h"
+
+#ifndef STATE_ACTION_BLOCK_SIZE
+#if defined(__AVR__)
+#define STATE_ACTION_BLOCK_SIZE 4
+#else
+#define STATE_ACTION_BLOCK_SIZE 16
+#endif
+#endif
 
 class StateActionManager {
 public:
@@ -29,44 +39,66 @@ public:
     };
 
 private:
+    // type is always the logical kind, a pointer source is flagged by pointerSource instead of VALUE_POINTER
     struct Monitor {
-        String name;
-        MonitorType type;
-        TriggerEvent triggerEvent;
+        uint16_t nameOffset;
+        uint8_t type;
+        uint8_t triggerEvent;
+        uint8_t state;
+
+        bool enabled : 1;
+        bool pointerSource : 1;
+        bool paramAction : 1;
+        bool wasActive : 1;
+
+        int16_t repeatCount;
+        int16_t executionCount;
+        TimerHandle timerHandle;
+
+        union {
+            float (*function)();
+            float *pointer;
+        } source;
 
-        float (*valueFunction)();
-        float *valuePointer;
         void (*actionFunction)();
-        void (*paramActionFunction)(void *);
         void *actionParam;
 
-        float threshold;
-        float lowerThreshold;
-        float upperThreshold;
-        float minChange;
+        union {
+            float threshold;
+            struct {
+                float lower;
+                float upper;
+            } range;
+            float minChange;
+        } limit;
+
+        float lastValue;
+        float currentValue;
 
         unsigned long interval;
         unsigned long triggerTime;
         unsigned long lastExecutionTime;
         unsigned long lastValueTime;
-
-        int repeatCount;
-        int executionCount;
-
-        float lastValue;
-        float currentValue;
-
-        bool enabled;
-        bool wasAboveThreshold;
-        bool wasInRange;
-        bool wasChanged;
-
-        MonitorState state;
     };
 
-    Monitor *monitors;
+    BlockPool<Monitor, STATE_ACTION_BLOCK_SIZE> monitors;
+    NameArena names;
     int monitorCount;
-    int capacity;
+    TimerWheel *wheel;
+
+    int allocateMonitor(const String &name, MonitorType type, TriggerEvent triggerEvent,
+                        float (*valueFunction)(), float *valuePointer, int repeatCount, unsigned long interval);
+    void setAction(int monitorId, void (*actionFunction)(), void (*paramActionFunction)(void *), void *param);
+    void primeMonitor(Monitor &monitor);
+    void readValue(Monitor &monitor);
+    bool isActive(Monitor &monitor);
+    bool evaluateMonitor(Monitor &monitor, bool consumeChange);
+    void runAction(Monitor &monitor);
+    void startExecution(Monitor &monitor, unsigned long currentTime);
+    void stepExecution(Monitor &monitor, unsigned long currentTime);
+    void scheduleMonitor(int monitorId);
+    bool isWheelDriven(Monitor &monitor);
+    static void onWheelExpiry(void *owner, uint16_t tag);
 
 public:
     StateActionManager(int initialCapacity = 10);
@@ -88,6 +120,8 @@ public:
     int addChangeMonitor(String name, float *valuePointer, float minChange, void (*actionFunction)(), int repeatCount = 1, unsigned long actionInterval = 0);
     int addTimeBasedMonitor(String name, unsigned long interval, void (*actionFunction)(), int repeatCount = 0);
 
+    // TIME_BASED monitors and repeat intervals are then fired by wheel->tick() instead of being polled in update()
+    void attachTimerWheel(TimerWheel *timerWheel);
     void update();
 
     float getCurrentValue(int monitorId);
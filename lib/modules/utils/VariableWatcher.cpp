@@ -1,61 +1,224 @@
 #include "VariableWatcher.h"
 
 VariableWatcher::VariableWatcher(int initialCapacity) {
-    capacity = initialCapacity;
-    variables = new VarInfo[capacity];
+    variables = NULL;
     count = 0;
+    capacity = 0;
+    shadow = NULL;
+    shadowUsed = 0;
+    shadowCapacity = 0;
+    dirty = NULL;
+    pending = NULL;
+    changedCount = 0;
+
+    reserve(initialCapacity > 0 ? initialCapacity : 1);
 }
 
 VariableWatcher::~VariableWatcher() {
+    delete[] variables;
+    free(shadow);
+    free(dirty);
+    free(pending);
+}
+
+bool VariableWatcher::reserve(int newCapacity) {
+    if (newCapacity <= capacity) return true;
+
+    int oldWords = (capacity + 31) / 32;
+    int newWords = (newCapacity + 31) / 32;
+    if (newWords != oldWords) {
+        uint32_t *newDirty = (uint32_t *) realloc(dirty, newWords * sizeof(uint32_t));
+        if (newDirty == NULL) return false;
+        dirty = newDirty;
+
+        uint32_t *newPending = (uint32_t *) realloc(pending, newWords * sizeof(uint32_t));
+        if (newPending == NULL) return false;
+        pending = newPending;
+
+        memset(dirty + oldWords, 0, (newWords - oldWords) * sizeof(uint32_t));
+        memset(pending + oldWords, 0, (newWords - oldWords) * sizeof(uint32_t));
+    }
+
+    VarInfo *newVars = new VarInfo[newCapacity];
+    if (newVars == NULL) return false;
+
+    // assigned rather than memcpy'd, the names own heap buffers
     for (int i = 0; i < count; i++) {
-        delete[] (byte *) variables[i].lastValue;
+        newVars[i] = variables[i];
     }
     delete[] variables;
+    variables = newVars;
+    capacity = newCapacity;
+    return true;
+}
+
+bool VariableWatcher::reserveShadow(uint16_t bytes) {
+    if ((uint32_t) shadowUsed + bytes > 0xFFFF) return false;
+    if (shadowUsed + bytes <= shadowCapacity) return true;
+
+    uint32_t newCapacity = shadowCapacity == 0 ? 32 : shadowCapacity;
+    while (newCapacity < (uint32_t) shadowUsed + bytes) {
+        newCapacity *= 2;
+    }
+    if (newCapacity > 0xFFFF) newCapacity = 0xFFFF;
+
+    uint8_t *newShadow = (uint8_t *) realloc(shadow, newCapacity);
+    if (newShadow == NULL) return false;
+
+    shadow = newShadow;
+    shadowCapacity = newCapacity;
+    return true;
+}
+
+int VariableWatcher::addEntry(void *ptr, uint16_t size, uint8_t type, float deadband, String name,
+                              void (*callbackFn)(void *)) {
+    if (ptr == NULL) return -1;
+    if (count >= capacity && !reserve(capacity * 2)) return -1;
+
+    uint16_t bytes = shadowSize(type, size);
+    if (!reserveShadow(bytes)) return -1;
+
+    VarInfo &var = variables[count];
+    var.ptr = ptr;
+    var.name = name;
+    var.nameHash = hashBytes((const uint8_t *) name.c_str(), name.length());
+    var.callback = callbackFn;
+    var.deadband = deadband;
+    var.offset = shadowUsed;
+    var.size = size;
+    var.type = type;
+    shadowUsed += bytes;
+
+    if (type == WATCH_STRING) {
+        const String &value = *(const String *) ptr;
+        uint32_t hash = hashBytes((const uint8_t *) value.c_str(), value.length());
+        memcpy(shadow + var.offset, &hash, sizeof(hash));
+    } else {
+        memcpy(shadow + var.offset, ptr, size);
+    }
+
+    return count++;
 }
 
-void VariableWatcher::checkAll() {
+uint16_t VariableWatcher::shadowSize(uint8_t type, uint16_t size) {
+    return type == WATCH_STRING ? sizeof(uint32_t) : size;
+}
+
+uint32_t VariableWatcher::hashBytes(const uint8_t *data, size_t length) {
+    uint32_t hash = 2166136261UL;  // FNV-1a
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+double VariableWatcher::readNumber(uint8_t type, uint16_t size, const void *value) {
+    // copied out first, shadow entries are packed and may be unaligned
+    union {
+        bool b;
+        int8_t i8;
+        int16_t i16;
+        int32_t i32;
+        int64_t i64;
+        uint8_t u8;
+        uint16_t u16;
+        uint32_t u32;
+        uint64_t u64;
+        float f;
+        double d;
+    } v;
+    if (size > sizeof(v)) return 0.0;
+    memcpy(&v, value, size);
+
+    switch (type) {
+        case WATCH_BOOL:
+            return v.b ? 1.0 : 0.0;
+        case WATCH_SIGNED:
+            switch (size) {
+                case 1: return v.i8;
+                case 2: return v.i16;
+                case 4: return v.i32;
+                case 8: return (double) v.i64;
+            }
+            break;
+        case WATCH_UNSIGNED:
+            switch (size) {
+                case 1: return v.u8;
+                case 2: return v.u16;
+                case 4: return v.u32;
+                case 8: return (double) v.u64;
+            }
+            break;
+        case WATCH_FLOAT:
+            return v.f;
+        case WATCH_DOUBLE:
+            return size == sizeof(float) ? v.f : v.d;
+    }
+    return 0.0;
+}
+
+bool VariableWatcher::updateShadow(VarInfo &var) {
+    uint8_t *last = shadow + var.offset;
+
+    if (var.type == WATCH_STRING) {
+        const String &value = *(const String *) var.ptr;
+        uint32_t hash = hashBytes((const uint8_t *) value.c_str(), value.length());
+        if (memcmp(&hash, last, sizeof(hash)) == 0) return false;
+        memcpy(last, &hash, sizeof(hash));
+        return true;
+    }
+
+    if (memcmp(var.ptr, last, var.size) == 0) return false;
+
+    if (var.deadband > 0 && var.type != WATCH_RAW) {
+        // shadow only follows reported values, so slow drift still accumulates past the band
+        double delta = readNumber(var.type, var.size, var.ptr) - readNumber(var.type, var.size, last);
+        if (delta < 0) delta = -delta;
+        if (delta <= var.deadband) return false;
+    }
+
+    memcpy(last, var.ptr, var.size);
+    return true;
+}
+
+int VariableWatcher::checkAll() {
+    int words = (count + 31) / 32;
+    memset(dirty, 0, words * sizeof(uint32_t));
+    changedCount = 0;
+
     for (int i = 0; i < count; i++) {
         checkIndex(i);
     }
+    return changedCount;
 }
 
 bool VariableWatcher::checkIndex(int index) {
     if (index < 0 || index >= count) return false;
 
-    void *currentValue = variables[index].ptr;
-    void *lastValue = variables[index].lastValue;
-    size_t size = variables[index].size;
+    VarInfo &var = variables[index];
+    if (!updateShadow(var)) return false;
 
-    if (memcmp(currentValue, lastValue, size) != 0) {
-        memcpy(lastValue, currentValue, size);
-        variables[index].changed = true;
-
-        if (variables[index].callback != NULL) {
-            variables[index].callback(currentValue);
-        }
+    uint32_t mask = 1UL << (index & 31);
+    if (!(dirty[index >> 5] & mask)) {
+        dirty[index >> 5] |= mask;
+        changedCount++;
+    }
+    pending[index >> 5] |= mask;
 
-        return true;
+    if (var.callback != NULL) {
+        var.callback(var.ptr);
     }
 
-    return false;
+    return true;
 }
 
 bool VariableWatcher::isChange(String name) {
-    int index = findVariableIndex(name);
-    if (index >= 0) {
-        return variables[index].changed;
-    }
-    return false;
+    return isChange(findVariableIndex(name));
 }
 
 bool VariableWatcher::hasChanged(String name) {
-    int index = findVariableIndex(name);
-    if (index >= 0) {
-        bool changed = variables[index].changed;
-        variables[index].changed = false;
-        return changed;
-    }
-    return false;
+    return hasChanged(findVariableIndex(name));
 }
 
 void *VariableWatcher::getValue(String name) {
@@ -66,6 +229,70 @@ void *VariableWatcher::getValue(String name) {
     return NULL;
 }
 
+bool VariableWatcher::isChange(int index) const {
+    if (index < 0 || index >= count) return false;
+    return (pending[index >> 5] >> (index & 31)) & 1;
+}
+
+bool VariableWatcher::hasChanged(int index) {
+    if (!isChange(index)) return false;
+    pending[index >> 5] &= ~(1UL << (index & 31));
+    return true;
+}
+
+bool VariableWatcher::isDirty(int index) const {
+    if (index < 0 || index >= count) return false;
+    return (dirty[index >> 5] >> (index & 31)) & 1;
+}
+
+int VariableWatcher::nextChanged(int after) const {
+    int index = after + 1;
+    if (index < 0) index = 0;
+
+    // whole clean words are skipped, so a pass costs one load per 32 entries plus one step per change
+    while (index < count) {
+        uint32_t word = dirty[index >> 5] >> (index & 31);
+        if (word != 0) {
+            index += __builtin_ctzl(word);
+            return index < count ? index : -1;
+        }
+        index = (index | 31) + 1;
+    }
+    return -1;
+}
+
+int VariableWatcher::getChangedCount() const {
+    return changedCount;
+}
+
+const uint32_t *VariableWatcher::getDirtyBits() const {
+    return dirty;
+}
+
+int VariableWatcher::indexOf(String name) {
+    return findVariableIndex(name);
+}
+
+int VariableWatcher::getCount() const {
+    return count;
+}
+
+String VariableWatcher::getName(int index) const {
+    if (index < 0 || index >= count) return "";
+    return variables[index].name;
+}
+
+uint8_t VariableWatcher::getType(int index) const {
+    if (index < 0 || index >= count) return WATCH_RAW;
+    return variables[index].type;
+}
+
+void VariableWatcher::setDeadband(int index, float deadband) {
+    if (index >= 0 && index < count) {
+        variables[index].deadband = deadband;
+    }
+}
+
 int VariableWatcher::getValueInt(String name) {
     void *value = getValue(name);
     if (value != NULL) {
@@ -115,42 +342,49 @@ long VariableWatcher::getValueLong(String name) {
 }
 
 void VariableWatcher::resetChanges() {
-    for (int i = 0; i < count; i++) {
-        variables[i].changed = false;
+    memset(pending, 0, ((count + 31) / 32) * sizeof(uint32_t));
+}
+
+void VariableWatcher::printValue(int index) {
+    const VarInfo &var = variables[index];
+
+    switch (var.type) {
+        case WATCH_BOOL:
+            Serial.println(*(bool *) var.ptr ? "true" : "false");
+            break;
+        case WATCH_SIGNED:
+            Serial.println((long) readNumber(var.type, var.size, var.ptr));
+            break;
+        case WATCH_UNSIGNED:
+            Serial.println((unsigned long) readNumber(var.type, var.size, var.ptr));
+            break;
+        case WATCH_FLOAT:
+        case WATCH_DOUBLE:
+            Serial.println(readNumber(var.type, var.size, var.ptr));
+            break;
+        case WATCH_STRING:
+            Serial.println(*(String *) var.ptr);
+            break;
+        default:
+            Serial.println("[data]");
+            break;
     }
 }
 
 void VariableWatcher::printChanges() {
     for (int i = 0; i < count; i++) {
-        if (variables[i].changed) {
-            void *currentValue = variables[i].ptr;
-            size_t size = variables[i].size;
-
+        if (isChange(i)) {
             Serial.print(variables[i].name);
             Serial.print(" change: ");
-
-            if (size == sizeof(int)) {
-                Serial.println(*(int *) currentValue);
-            } else if (size == sizeof(float)) {
-                Serial.println(*(float *) currentValue);
-            } else if (size == sizeof(bool)) {
-                Serial.println(*(bool *) currentValue ? "true" : "false");
-            } else if (size == sizeof(long)) {
-                Serial.println(*(long *) currentValue);
-            } else if (size == sizeof(double)) {
-                Serial.println(*(double *) currentValue);
-            } else if (size == sizeof(String)) {
-                Serial.println(*(String *) currentValue);
-            } else {
-                Serial.println("[data]");
-            }
+            printValue(i);
         }
     }
 }
 
 int VariableWatcher::findVariableIndex(String name) {
+    uint32_t hash = hashBytes((const uint8_t *) name.c_str(), name.length());
     for (int i = 0; i < count; i++) {
-        if (variables[i].name == name) {
+        if (variables[i].nameHash == hash && variables[i].name == name) {
             return i;
         }
     }
@@ -3,55 +3,115 @@
 
 #include "Arduino.h"
 
+enum VariableWatcherType {
+    WATCH_RAW,
+    WATCH_BOOL,
+    WATCH_SIGNED,
+    WATCH_UNSIGNED,
+    WATCH_FLOAT,
+    WATCH_DOUBLE,
+    WATCH_STRING
+};
+
+template<typename T> struct VariableWatcherTypeOf { static const uint8_t value = WATCH_RAW; };
+template<> struct VariableWatcherTypeOf<bool> { static const uint8_t value = WATCH_BOOL; };
+template<> struct VariableWatcherTypeOf<char> { static const uint8_t value = WATCH_SIGNED; };
+template<> struct VariableWatcherTypeOf<signed char> { static const uint8_t value = WATCH_SIGNED; };
+template<> struct VariableWatcherTypeOf<short> { static const uint8_t value = WATCH_SIGNED; };
+template<> struct VariableWatcherTypeOf<int> { static const uint8_t value = WATCH_SIGNED; };
+template<> struct VariableWatcherTypeOf<long> { static const uint8_t value = WATCH_SIGNED; };
+template<> struct VariableWatcherTypeOf<long long> { static const uint8_t value = WATCH_SIGNED; };
+template<> struct VariableWatcherTypeOf<unsigned char> { static const uint8_t value = WATCH_UNSIGNED; };
+template<> struct VariableWatcherTypeOf<unsigned short> { static const uint8_t value = WATCH_UNSIGNED; };
+template<> struct VariableWatcherTypeOf<unsigned int> { static const uint8_t value = WATCH_UNSIGNED; };
+template<> struct VariableWatcherTypeOf<unsigned long> { static const uint8_t value = WATCH_UNSIGNED; };
+template<> struct VariableWatcherTypeOf<unsigned long long> { static const uint8_t value = WATCH_UNSIGNED; };
+template<> struct VariableWatcherTypeOf<float> { static const uint8_t value = WATCH_FLOAT; };
+template<> struct VariableWatcherTypeOf<double> { static const uint8_t value = WATCH_DOUBLE; };
+template<> struct VariableWatcherTypeOf<String> { static const uint8_t value = WATCH_STRING; };
+
 class VariableWatcher {
 private:
     struct VarInfo {
         void *ptr;
-        void *lastValue;
-        size_t size;
         String name;
-        bool changed;
+        uint32_t nameHash;
         void (*callback)(void *);
+        float deadband;
+        uint16_t offset;
+        uint16_t size;
+        uint8_t type;
     };
 
     VarInfo *variables;
     int count;
     int capacity;
 
+    // shadow copies of every entry packed back to back, strings keep a 4 byte content hash
+    uint8_t *shadow;
+    uint16_t shadowUsed;
+    uint16_t shadowCapacity;
+
+    // dirty: changed in the last checkAll() pass, pending: changed since last consumed
+    uint32_t *dirty;
+    uint32_t *pending;
+    int changedCount;
+
+    VariableWatcher(const VariableWatcher &);
+    VariableWatcher &operator=(const VariableWatcher &);
+
     int findVariableIndex(String name);
+    int addEntry(void *ptr, uint16_t size, uint8_t type, float deadband, String name, void (*callbackFn)(void *));
+    bool reserve(int newCapacity);
+    bool reserveShadow(uint16_t bytes);
+    bool updateShadow(VarInfo &var);
+    void printValue(int index);
+
+    static uint16_t shadowSize(uint8_t type, uint16_t size);
+    static double readNumber(uint8_t type, uint16_t size, const void *value);
+    static uint32_t hashBytes(const uint8_t *data, size_t length);
 
 public:
     VariableWatcher(int initialCapacity = 5);
     ~VariableWatcher();
 
     template<typename T>
-    int addVariable(T *var, String name = "", void (*callbackFn)(void *) = NULL) {
-        if (count >= capacity) {
-            capacity *= 2;
-            VarInfo *newVars = new VarInfo[capacity];
-            memcpy(newVars, variables, count * sizeof(VarInfo));
-            delete[] variables;
-            variables = newVars;
-        }
-
-        variables[count].ptr = (void *) var;
-        variables[count].size = sizeof(T);
-        variables[count].name = name;
-        variables[count].callback = callbackFn;
-        variables[count].changed = false;
-
-        variables[count].lastValue = new byte[sizeof(T)];
-        memcpy(variables[count].lastValue, var, sizeof(T));
+    int watch(T *var, String name = "", float deadband = 0, void (*callbackFn)(void *) = NULL) {
+        return addEntry((void *) var, sizeof(T), VariableWatcherTypeOf<T>::value, deadband, name, callbackFn);
+    }
 
-        return count++;
+    template<typename T>
+    int addVariable(T *var, String name = "", void (*callbackFn)(void *) = NULL) {
+        return watch(var, name, 0, callbackFn);
     }
 
-    void checkAll();
+    int checkAll();
     bool checkIndex(int index);
     bool isChange(String name);
     bool hasChanged(String name);
     void *getValue(String name);
 
+    bool isChange(int index) const;
+    bool hasChanged(int index);
+    bool isDirty(int index) const;
+    int nextChanged(int after = -1) const;
+    int getChangedCount() const;
+    const uint32_t *getDirtyBits() const;
+
+    int indexOf(String name);
+    int getCount() const;
+    String getName(int index) const;
+    uint8_t getType(int index) const;
+    void setDeadband(int index, float deadband);
+
+    template<typename T>
+    T get(int index) const {
+        if (index >= 0 && index < count && variables[index].size == sizeof(T)) {
+            return *(T *) variables[index].ptr;
+        }
+        return T();
+    }
+
     template<typename T>
     T getValueAs(String name) {
         void *value = getValue(name);
@@ -0,0 +1,375 @@
+/*
+ *  pulse-capture.cpp
+ *
+ *  pulse capture c
+ *  Created on: 2026. 10. 18
+ */
+
+#include "Arduino.h"
+#include "pulse-capture.h"
+
+PulseCapture *PulseCapture::channels[PULSE_CAPTURE_MAX_CHANNELS] = {nullptr};
+
+#ifdef PULSE_CAPTURE_USE_PCNT
+uint8_t PulseCapture::pcntUnitsUsed = 0;
+bool PulseCapture::pcntServiceInstalled = false;
+#endif
+
+template<uint8_t N>
+void PULSE_CAPTURE_ISR_ATTR PulseCapture::isrSlot() {
+    PulseCapture *channel = channels[N];
+    if (channel != nullptr) channel->handleEdge();
+}
+
+typedef void (*PulseCaptureIsr)();
+
+static const PulseCaptureIsr pulseCaptureIsrTable[] = {
+        PulseCapture::isrSlot<0>, PulseCapture::isrSlot<1>, PulseCapture::isrSlot<2>, PulseCapture::isrSlot<3>,
+        PulseCapture::isrSlot<4>, PulseCapture::isrSlot<5>, PulseCapture::isrSlot<6>, PulseCapture::isrSlot<7>,
+};
+
+PulseCapture::PulseCapture(uint8_t _pin, uint8_t _edge, bool _pullup)
+        : pin(_pin),
+          edge(_edge),
+          pullup(_pullup),
+          slot(-1),
+          running(false),
+          hardware(false),
+          mode(PULSE_CAPTURE_COUNT_WINDOW),
+          windowUs(1000000UL),
+          timeoutUs(2000000UL),
+          prescaler(1),
+          filter(0),
+          edgeCount(0),
+          prescaleCount(0),
+          ringHead(0),
+          ringOverruns(0),
+          ringTail(0),
+          lastEdgeUs(0),
+          hasLastEdge(false),
+          windowStartUs(0),
+          windowStartCount(0),
+          takenCount(0),
+          averaging(1),
+          historyIndex(0),
+          historyCount(0),
+          frequency(0.0f) {
+#ifdef PULSE_CAPTURE_USE_PCNT
+    pcntUnit = PCNT_UNIT_0;
+    pcntOverflow = 0;
+    pcntLastCount = 0;
+#endif
+}
+
+PulseCapture::~PulseCapture() {
+    end();
+}
+
+bool PulseCapture::begin(bool useHardware) {
+    if (running) return true;
+    pinMode(pin, pullup ? INPUT_PULLUP : INPUT);
+    hardware = false;
+#ifdef PULSE_CAPTURE_USE_PCNT
+    if (useHardware) hardware = beginHardware();
+#endif
+    if (!hardware && !beginInterrupt()) return false;
+    running = true;
+    reset();
+    return true;
+}
+
+void PulseCapture::end() {
+    if (!running) return;
+#ifdef PULSE_CAPTURE_USE_PCNT
+    if (hardware) endHardware();
+#endif
+    if (!hardware) {
+        detachInterrupt(digitalPinToInterrupt(pin));
+        if (slot >= 0) channels[slot] = nullptr;
+        slot = -1;
+    }
+    running = false;
+}
+
+bool PulseCapture::beginInterrupt() {
+#if PULSE_CAPTURE_MAX_CHANNELS > 8
+#error "PulseCapture: extend pulseCaptureIsrTable for more than 8 channels"
+#endif
+    slot = -1;
+    for (uint8_t i = 0; i < PULSE_CAPTURE_MAX_CHANNELS; i++) {
+        if (channels[i] == nullptr || channels[i] == this) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) return false;
+    channels[slot] = this;
+    attachInterrupt(digitalPinToInterrupt(pin), pulseCaptureIsrTable[slot], edge);
+    return true;
+}
+
+#ifdef PULSE_CAPTURE_USE_PCNT
+bool PulseCapture::beginHardware() {
+    // the unit from the last run if it is still free, otherwise the first free one
+    int unit = -1;
+    if (!(pcntUnitsUsed & (1 << pcntUnit))) {
+        unit = pcntUnit;
+    } else {
+        for (int i = 0; i < PCNT_UNIT_MAX; i++) {
+            if (!(pcntUnitsUsed & (1 << i))) {
+                unit = i;
+                break;
+            }
+        }
+    }
+    if (unit < 0) return false;
+    pcntUnit = (pcnt_unit_t) unit;
+
+    pcnt_config_t config = {};
+    config.pulse_gpio_num = pin;
+    config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+    config.channel = PCNT_CHANNEL_0;
+    config.unit = pcntUnit;
+    config.pos_mode = (edge == FALLING) ? PCNT_COUNT_DIS : PCNT_COUNT_INC;
+    config.neg_mode = (edge == RISING) ? PCNT_COUNT_DIS : PCNT_COUNT_INC;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    config.counter_h_lim = PULSE_CAPTURE_PCNT_LIMIT;
+    config.counter_l_lim = 0;
+    if (pcnt_unit_config(&config) != ESP_OK) return false;
+
+    if (filter > 0) {
+        pcnt_set_filter_value(pcntUnit, filter > 1023 ? 1023 : filter);
+        pcnt_filter_enable(pcntUnit);
+    } else {
+        pcnt_filter_disable(pcntUnit);
+    }
+
+    pcnt_event_enable(pcntUnit, PCNT_EVT_H_LIM);
+    pcnt_counter_pause(pcntUnit);
+    pcnt_counter_clear(pcntUnit);
+
+    pcntUnitsUsed |= (1 << pcntUnit);
+    if (!pcntServiceInstalled) {
+        if (pcnt_isr_service_install(0) != ESP_OK) {
+            endHardware();
+            return false;
+        }
+        pcntServiceInstalled = true;
+    }
+    pcnt_isr_handler_add(pcntUnit, pcntIsr, this);
+    pcnt_counter_resume(pcntUnit);
+    return true;
+}
+
+void PulseCapture::endHardware() {
+    pcnt_counter_pause(pcntUnit);
+    pcnt_isr_handler_remove(pcntUnit);
+    pcnt_event_disable(pcntUnit, PCNT_EVT_H_LIM);
+
+    // the driver has no way to free a unit, detach it from the pin so it stops counting
+    pcnt_config_t config = {};
+    config.pulse_gpio_num = PCNT_PIN_NOT_USED;
+    config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+    config.channel = PCNT_CHANNEL_0;
+    config.unit = pcntUnit;
+    config.pos_mode = PCNT_COUNT_DIS;
+    config.neg_mode = PCNT_COUNT_DIS;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    config.counter_h_lim = PULSE_CAPTURE_PCNT_LIMIT;
+    config.counter_l_lim = 0;
+    pcnt_unit_config(&config);
+    pcnt_counter_clear(pcntUnit);
+
+    pcntUnitsUsed &= ~(1 << pcntUnit);
+}
+
+void PULSE_CAPTURE_ISR_ATTR PulseCapture::pcntIsr(void *arg) {
+    auto *capture = (PulseCapture *) arg;
+    capture->pcntOverflow++;
+}
+#endif
+
+void PULSE_CAPTURE_ISR_ATTR PulseCapture::handleEdge() {
+    edgeCount++;
+    if (mode != PULSE_CAPTURE_PERIOD) return;
+    if (++prescaleCount < prescaler) return;
+    prescaleCount = 0;
+    uint8_t next = (ringHead + 1) & PULSE_CAPTURE_RING_MASK;
+    if (next == ringTail) {
+        ringOverruns++;
+        return;
+    }
+    ring[ringHead] = micros();
+    ringHead = next;
+}
+
+uint32_t PulseCapture::readCount() const {
+#ifdef PULSE_CAPTURE_USE_PCNT
+    if (hardware) {
+        int16_t value = 0;
+        uint32_t overflow;
+        do {
+            overflow = pcntOverflow;
+            pcnt_get_counter_value(pcntUnit, &value);
+        } while (overflow != pcntOverflow);
+        uint32_t count = overflow * (uint32_t) PULSE_CAPTURE_PCNT_LIMIT + (uint32_t) value;
+        // the counter is back at 0 before pcntIsr() counted the wrap, the count never goes down
+        if (count < pcntLastCount) count += PULSE_CAPTURE_PCNT_LIMIT;
+        pcntLastCount = count;
+        return count;
+    }
+#endif
+    noInterrupts();
+    uint32_t count = edgeCount;
+    interrupts();
+    return count;
+}
+
+void PulseCapture::pushFrequency(float value) {
+    history[historyIndex] = value;
+    historyIndex = (historyIndex + 1) % averaging;
+    if (historyCount < averaging) historyCount++;
+    float sum = 0.0f;
+    for (uint8_t i = 0; i < historyCount; i++) sum += history[i];
+    frequency = sum / historyCount;
+}
+
+bool PulseCapture::update() {
+    if (!running) return false;
+    if (mode == PULSE_CAPTURE_PERIOD && !hardware) return updatePeriod();
+    return updateCountWindow();
+}
+
+bool PulseCapture::updateCountWindow() {
+    uint32_t now = micros();
+    uint32_t elapsed = now - windowStartUs;
+    if (elapsed < windowUs) return false;
+    uint32_t count = readCount();
+    uint32_t delta = count - windowStartCount;
+    pushFrequency((float) delta * 1000000.0f / (float) elapsed);
+    windowStartCount = count;
+    windowStartUs = now;
+    return true;
+}
+
+bool PulseCapture::updatePeriod() {
+    uint32_t periodSum = 0;
+    uint16_t periods = 0;
+    uint8_t head = ringHead;
+    while (ringTail != head) {
+        uint32_t stamp = ring[ringTail];
+        ringTail = (ringTail + 1) & PULSE_CAPTURE_RING_MASK;
+        if (hasLastEdge) {
+            periodSum += stamp - lastEdgeUs;
+            periods++;
+        }
+        lastEdgeUs = stamp;
+        hasLastEdge = true;
+    }
+    if (periods > 0 && periodSum > 0) {
+        pushFrequency((float) periods * prescaler * 1000000.0f / (float) periodSum);
+        return true;
+    }
+    if (hasLastEdge && micros() - lastEdgeUs >= timeoutUs && frequency != 0.0f) {
+        historyCount = 0;
+        historyIndex = 0;
+        hasLastEdge = false;
+        frequency = 0.0f;
+        return true;
+    }
+    return false;
+}
+
+void PulseCapture::reset() {
+#ifdef PULSE_CAPTURE_USE_PCNT
+    if (hardware) {
+        pcnt_counter_pause(pcntUnit);
+        pcnt_counter_clear(pcntUnit);
+        pcntOverflow = 0;
+        pcntLastCount = 0;
+        pcnt_counter_resume(pcntUnit);
+    }
+#endif
+    noInterrupts();
+    edgeCount = 0;
+    prescaleCount = 0;
+    ringTail = ringHead;
+    interrupts();
+    hasLastEdge = false;
+    windowStartUs = micros();
+    windowStartCount = 0;
+    takenCount = 0;
+    historyIndex = 0;
+    historyCount = 0;
+    frequency = 0.0f;
+}
+
+void PulseCapture::setMode(PulseCaptureMode _mode) {
+    mode = _mode;
+    hasLastEdge = false;
+    ringTail = ringHead;
+}
+
+void PulseCapture::setWindow(uint32_t windowMs) {
+    windowUs = (windowMs == 0 ? 1 : windowMs) * 1000UL;
+}
+
+void PulseCapture::setTimeout(uint32_t timeoutMs) {
+    timeoutUs = timeoutMs * 1000UL;
+}
+
+void PulseCapture::setAveraging(uint8_t samples) {
+    if (samples == 0) samples = 1;
+    if (samples > PULSE_CAPTURE_MAX_AVERAGE) samples = PULSE_CAPTURE_MAX_AVERAGE;
+    averaging = samples;
+    historyIndex = 0;
+    historyCount = 0;
+}
+
+void PulseCapture::setPrescaler(uint8_t divider) {
+    prescaler = divider == 0 ? 1 : divider;
+}
+
+void PulseCapture::setFilter(uint16_t filterValue) {
+    filter = filterValue;
+}
+
+float PulseCapture::getFrequency() const {
+    return frequency;
+}
+
+uint32_t PulseCapture::getCount() const {
+    return readCount();
+}
+
+uint32_t PulseCapture::takeCount() {
+    uint32_t count = readCount();
+    uint32_t delta = count - takenCount;
+    takenCount = count;
+    return delta;
+}
+
+uint32_t PulseCapture::getOverruns() const {
+    return ringOverruns;
+}
+
+uint8_t PulseCapture::getPin() const {
+    return pin;
+}
+
+bool PulseCapture::isHardware() const {
+    return hardware;
+}
+
+bool PulseCapture::isRunning() const {
+    return running;
+}
+
+PulseCapture *PulseCapture::findByPin(uint8_t _pin) {
+    for (uint8_t i = 0; i < PULSE_CAPTURE_MAX_CHANNELS; i++) {
+        if (channels[i] != nullptr && channels[i]->pin == _pin) return channels[i];
+    }
+    return nullptr;
+}
\ No newline at end of file
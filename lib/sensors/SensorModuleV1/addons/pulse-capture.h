@@ -0,0 +1,136 @@
+/*
+ *  pulse-capture.h
+ *
+ *  pulse capture lib
+ *  Created on: 2026. 10. 18
+ */
+
+#pragma once
+
+#ifndef PULSE_CAPTURE_H
+#define PULSE_CAPTURE_H
+
+#pragma message("[COMPILED]: pulse-capture.h")
+
+#include "Arduino.h"
+
+#if defined(ESP32) && !defined(PULSE_CAPTURE_DISABLE_PCNT) && __has_include("driver/pcnt.h")
+#define PULSE_CAPTURE_USE_PCNT
+#include "driver/pcnt.h"
+#endif
+
+#if defined(ESP32) || defined(ESP8266)
+#define PULSE_CAPTURE_ISR_ATTR IRAM_ATTR
+#else
+#define PULSE_CAPTURE_ISR_ATTR
+#endif
+
+#ifndef PULSE_CAPTURE_MAX_CHANNELS
+#define PULSE_CAPTURE_MAX_CHANNELS 8
+#endif
+
+#ifndef PULSE_CAPTURE_RING_SIZE
+#define PULSE_CAPTURE_RING_SIZE 32  // must be a power of two, <= 128
+#endif
+
+#ifndef PULSE_CAPTURE_MAX_AVERAGE
+#define PULSE_CAPTURE_MAX_AVERAGE 16
+#endif
+
+#define PULSE_CAPTURE_RING_MASK (PULSE_CAPTURE_RING_SIZE - 1)
+#define PULSE_CAPTURE_PCNT_LIMIT 32000
+
+enum PulseCaptureMode {
+    PULSE_CAPTURE_COUNT_WINDOW = 0,   // edges per window, best for high frequencies
+    PULSE_CAPTURE_PERIOD = 1          // time between edges, best for low frequencies (ISR backend only)
+};
+
+class PulseCapture {
+private:
+    static PulseCapture *channels[PULSE_CAPTURE_MAX_CHANNELS];
+
+    uint8_t pin;
+    uint8_t edge;
+    bool pullup;
+    int8_t slot;
+    bool running;
+    bool hardware;
+
+    PulseCaptureMode mode;
+    uint32_t windowUs;
+    uint32_t timeoutUs;
+    uint8_t prescaler;
+    uint16_t filter;
+
+    /*isr side, single producer*/
+    volatile uint32_t edgeCount;
+    volatile uint8_t prescaleCount;
+    volatile uint8_t ringHead;
+    volatile uint32_t ringOverruns;
+    volatile uint32_t ring[PULSE_CAPTURE_RING_SIZE];
+
+    /*task side, single consumer*/
+    uint8_t ringTail;
+    uint32_t lastEdgeUs;
+    bool hasLastEdge;
+    uint32_t windowStartUs;
+    uint32_t windowStartCount;
+    uint32_t takenCount;
+
+    float history[PULSE_CAPTURE_MAX_AVERAGE];
+    uint8_t averaging;
+    uint8_t historyIndex;
+    uint8_t historyCount;
+    float frequency;
+
+#ifdef PULSE_CAPTURE_USE_PCNT
+    // bit n set while PCNT unit n belongs to a running capture
+    static uint8_t pcntUnitsUsed;
+    static bool pcntServiceInstalled;
+    pcnt_unit_t pcntUnit;
+    volatile uint32_t pcntOverflow;
+    mutable uint32_t pcntLastCount;
+
+    bool beginHardware();
+    void endHardware();
+    static void PULSE_CAPTURE_ISR_ATTR pcntIsr(void *arg);
+#endif
+
+    bool beginInterrupt();
+    uint32_t readCount() const;
+    void pushFrequency(float value);
+    bool updateCountWindow();
+    bool updatePeriod();
+
+public:
+    explicit PulseCapture(uint8_t _pin, uint8_t _edge = RISING, bool _pullup = false);
+    ~PulseCapture();
+
+    bool begin(bool useHardware = true);
+    void end();
+    bool update();
+    void reset();
+
+    void setMode(PulseCaptureMode _mode);
+    void setWindow(uint32_t windowMs);
+    void setTimeout(uint32_t timeoutMs);
+    void setAveraging(uint8_t samples);
+    void setPrescaler(uint8_t divider);
+    void setFilter(uint16_t filterValue);
+
+    float getFrequency() const;
+    uint32_t getCount() const;
+    uint32_t takeCount();
+    uint32_t getOverruns() const;
+    uint8_t getPin() const;
+    bool isHardware() const;
+    bool isRunning() const;
+
+    void handleEdge();
+    static PulseCapture *findByPin(uint8_t _pin);
+
+    template<uint8_t N>
+    static void PULSE_CAPTURE_ISR_ATTR isrSlot();
+};
+
+#endif  // PULSE_CAPTURE_H
\ No newline at end of file
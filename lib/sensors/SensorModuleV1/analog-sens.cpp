@@ -15,6 +15,8 @@ AnalogSens::AnalogSens(uint8_t _pin, float _vref, int _adcRange,
           voltageReference(_vref),
           adcRange(_adcRange),
           sensorPin(_pin),
+          adcChannel(CONTINUOUS_ADC_NO_CHANNEL),
+          adcSamples(0),
           onCustomData(_onCustomData) {
 }
 
@@ -32,7 +34,7 @@ bool AnalogSens::init() {
 }
 
 bool AnalogSens::update() {
-    int analogValue = analogRead(sensorPin);
+    int analogValue = (int) ContinuousADC::readAverage(adcChannel, sensorPin, adcSamples);
     float voltageValue = analogValue * (voltageReference / adcRange);
     (*doc)[name]["raw"] = analogValue;
     (*doc)[name]["volt"] = voltageValue;
@@ -58,6 +60,11 @@ JsonVariant AnalogSens::getVariant(const char *searchName) {
     return (*doc)[searchName];
 }
 
+void AnalogSens::setContinuousADC(uint8_t samples, uint32_t intervalUs) {
+    adcChannel = ContinuousADC::instance().addChannel(sensorPin, intervalUs);
+    adcSamples = samples;
+}
+
 float AnalogSens::getValueAnalogSens() const {
     return (*doc)[name].as<float>();
 }
@@ -14,6 +14,7 @@
 
 #include "Arduino.h"
 #include "base/sensor-module.h"
+#include "../../modules/io/continuous-adc.h"
 
 class AnalogSens : public BaseSens {
 private:
@@ -25,6 +26,8 @@ private:
 
     uint8_t sensorPin;
     uint32_t sensorTimer;
+    int8_t adcChannel;
+    uint8_t adcSamples;
 
     void (*onCustomData)(JsonVariant sensorRef, int analogValue, float voltage);
 
@@ -40,6 +43,7 @@ public:
     JsonDocument getDocument() override;
     JsonVariant getVariant(const char *searchName) override;
 
+    void setContinuousADC(uint8_t samples = 8, uint32_t intervalUs = 1000);
     float getValueAnalogSens() const;
     void setPins(uint8_t _pin);
 };
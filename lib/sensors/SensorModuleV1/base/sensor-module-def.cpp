@@ -35,6 +35,10 @@ JsonVariant BaseSens::getVariant(const char *searchName) {
     return JsonVariant();
 }
 
+JsonVariantConst BaseSens::getView(const char *searchName) {
+    return getVariant(searchName);
+}
+
 void BaseSens::process() {
     /*not implemented yet*/
 }
\ No newline at end of file
@@ -9,13 +9,16 @@
 #include "sensor-module.h"
 
 SensorModule::SensorModule()
-        : base(nullptr),
+        : doc(nullptr),
+          base(nullptr),
           name(nullptr),
           len(0),
           lenName(0),
           sensorInit(nullptr),
           sensorEnable(false),
-          sensorReady(false) {
+          sensorReady(false),
+          nameIndex(nullptr),
+          nameIndexMask(0) {
 }
 
 SensorModule::~SensorModule() {
@@ -28,6 +31,7 @@ SensorModule::~SensorModule() {
         delete doc;
         doc = nullptr;
     }
+    clearNameIndex();
 }
 
 void SensorModule::init(void (*initializeCallback)(void)) {
@@ -50,6 +54,7 @@ void SensorModule::init(void (*initializeCallback)(void)) {
             Serial.println();
         }
     }
+    buildNameIndex();
     this->enable();
     if (!this->sensorInit) return;
     if (initializeCallback != nullptr) initializeCallback();
@@ -73,6 +78,7 @@ void SensorModule::update(void (*updateCallback)(void)) {
 void SensorModule::update(const char *searchName) {
     if (base == nullptr || !sensorEnable) return;
     BaseSens *module = getModuleByNamePtr(searchName);
+    if (module == nullptr) return;
     module->update();
     if (!sensorReady) sensorReady = true;
 }
@@ -103,6 +109,7 @@ void SensorModule::addModule(BaseSens *sensModule) {
     base = newBase;
     base[len] = sensModule;  // assign to correct index
     len++;
+    clearNameIndex();
 }
 
 void SensorModule::addName(const char *newName) {
@@ -142,19 +149,73 @@ void SensorModule::removeModule(uint8_t index) {
     if (newBase != nullptr) {
         base = newBase;
     }
+    if (index < lenName) {
+        free(name[index]);
+        for (uint8_t i = index; i < lenName - 1; i++) {
+            name[i] = name[i + 1];
+        }
+        lenName--;
+    }
+    buildNameIndex();
 }
 
 JsonVariant SensorModule::operator[](const char *searchName) {
     auto module = getModuleByNamePtr(searchName);
+    if (module == nullptr) return JsonVariant();
     return module->getVariant(searchName);
 }
 
 JsonDocument SensorModule::operator()(const char *searchName) {
     auto module = getModuleByNamePtr(searchName);
+    if (module == nullptr) return JsonDocument();
     return module->getDocument();
 }
 
+JsonVariantConst SensorModule::view(const char *searchName) const {
+    if (doc != nullptr) return (*(const JsonDocument *) doc)[searchName];
+    int index = findIndex(searchName);
+    if (index < 0) return JsonVariantConst();
+    return base[index]->getView(searchName);
+}
+
+JsonVariantConst SensorModule::view(const char *searchName, const char *key) const {
+    JsonVariantConst variant = view(searchName);
+    if (key == nullptr) return variant;
+    return variant[key];
+}
+
+float SensorModule::getFloat(const char *searchName, const char *key, float defaultValue) const {
+    JsonVariantConst variant = view(searchName, key);
+    if (variant.isNull()) return defaultValue;
+    return variant.as<float>();
+}
+
+int SensorModule::getInt(const char *searchName, const char *key, int defaultValue) const {
+    JsonVariantConst variant = view(searchName, key);
+    if (variant.isNull()) return defaultValue;
+    return variant.as<int>();
+}
+
+int SensorModule::getIndex(const char *searchName) const {
+    return findIndex(searchName);
+}
+
+namespace {
+    // what the reference getters hand out for an unknown name or index, reads as an empty sensor
+    class MissingSens : public BaseSens {
+    public:
+        bool init() override { return false; }
+        bool update() override { return false; }
+    };
+}
+
+BaseSens &SensorModule::missingModule() {
+    static MissingSens missing;
+    return missing;
+}
+
 BaseSens &SensorModule::getModule(uint8_t index) {
+    if (base == nullptr || index >= len) return missingModule();
     return *(base[index]);
 }
 
@@ -164,21 +225,15 @@ BaseSens * SensorModule::getModulePtr(uint8_t index) const {
 }
 
 BaseSens &SensorModule::getModuleByName(const char *searchName) {
-    int count = 0;
-    for (int i = 0; i < lenName; ++i) {
-        if (strcmp(name[i], searchName) == 0) return *(base[i]);
-        count++;
-    }
-    return *(base[count]);
+    int index = findIndex(searchName);
+    if (index < 0) return missingModule();
+    return *(base[index]);
 }
 
 BaseSens *SensorModule::getModuleByNamePtr(const char *searchName) {
-    int count = 0;
-    for (int i = 0; i < lenName; ++i) {
-        if (strcmp(name[i], searchName) == 0) return base[i];
-        count++;
-    }
-    return base[count];
+    int index = findIndex(searchName);
+    if (index < 0) return nullptr;
+    return base[index];
 }
 
 char * SensorModule::getName(uint8_t index) const {
@@ -211,6 +266,7 @@ void SensorModule::clearModules() {
         delete doc;
         doc = nullptr;
     }
+    clearNameIndex();
 }
 
 uint8_t SensorModule::getModuleCount() const {
@@ -228,6 +284,12 @@ void SensorModule::swapModules(uint8_t index1, uint8_t index2) {
     BaseSens *temp = base[index1];
     base[index1] = base[index2];
     base[index2] = temp;
+    if (index1 < lenName && index2 < lenName) {
+        char *tempName = name[index1];
+        name[index1] = name[index2];
+        name[index2] = tempName;
+    }
+    buildNameIndex();
 }
 
 bool SensorModule::isModulePresent(BaseSens *sensModule) {
@@ -245,6 +307,57 @@ bool SensorModule::isModulePresent(uint8_t index) {
     return true;
 }
 
+uint32_t SensorModule::hashName(const char *str) {
+    uint32_t hash = 2166136261UL;  // FNV-1a
+    while (*str) {
+        hash ^= (uint8_t) *str++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+void SensorModule::buildNameIndex() {
+    clearNameIndex();
+    uint8_t count = len < lenName ? len : lenName;
+    if (count == 0) return;
+    uint16_t size = 4;
+    while (size < (uint16_t) count * 2) size <<= 1;
+    nameIndex = (uint8_t *) malloc(size);
+    if (nameIndex == nullptr) return;
+    memset(nameIndex, SENSOR_MODULE_INDEX_EMPTY, size);
+    nameIndexMask = size - 1;
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t slot = hashName(name[i]) & nameIndexMask;
+        while (nameIndex[slot] != SENSOR_MODULE_INDEX_EMPTY) slot = (slot + 1) & nameIndexMask;
+        nameIndex[slot] = i;
+    }
+}
+
+void SensorModule::clearNameIndex() {
+    if (nameIndex != nullptr) {
+        free(nameIndex);
+        nameIndex = nullptr;
+    }
+    nameIndexMask = 0;
+}
+
+int SensorModule::findIndex(const char *searchName) const {
+    if (searchName == nullptr || base == nullptr) return -1;
+    if (nameIndex != nullptr) {
+        uint16_t slot = hashName(searchName) & nameIndexMask;
+        while (nameIndex[slot] != SENSOR_MODULE_INDEX_EMPTY) {
+            uint8_t index = nameIndex[slot];
+            if (strcmp(name[index], searchName) == 0) return index;
+            slot = (slot + 1) & nameIndexMask;
+        }
+        return -1;
+    }
+    for (int i = 0; i < lenName && i < len; ++i) {
+        if (strcmp(name[i], searchName) == 0) return i;
+    }
+    return -1;
+}
+
 void SensorModule::debug(const char *searchName, bool showHeapMemory, bool endl) {
     if (!isReady() || searchName == nullptr) return;
 
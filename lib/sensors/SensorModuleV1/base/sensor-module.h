@@ -36,6 +36,7 @@ public:
     virtual void setDocumentValue(JsonDocument *docBase);
     virtual JsonDocument getDocument();
     virtual JsonVariant getVariant(const char *searchName);
+    virtual JsonVariantConst getView(const char *searchName);
 
     /*additional function*/
     virtual void process();
@@ -44,6 +45,8 @@ public:
     BaseSens &operator=(BaseSens &&) = default;
 };
 
+#define SENSOR_MODULE_INDEX_EMPTY 0xFF
+
 class SensorModule {
 private:
     JsonDocument *doc;
@@ -54,6 +57,16 @@ private:
     bool *sensorInit;
     bool sensorEnable;
     bool sensorReady;
+
+    /*name -> index open addressing table, built at init()*/
+    uint8_t *nameIndex;
+    uint16_t nameIndexMask;
+
+    static uint32_t hashName(const char *str);
+    void buildNameIndex();
+    void clearNameIndex();
+    int findIndex(const char *searchName) const;
+    static BaseSens &missingModule();
 public:
     SensorModule();
     ~SensorModule();
@@ -76,7 +89,13 @@ public:
     void removeModule(uint8_t index);
 
     JsonVariant operator[](const char *searchName);
-    JsonDocument operator()(const char *searchName);
+    JsonDocument operator()(const char *searchName);  // deep copy, prefer view()
+
+    JsonVariantConst view(const char *searchName) const;
+    JsonVariantConst view(const char *searchName, const char *key) const;
+    float getFloat(const char *searchName, const char *key = nullptr, float defaultValue = 0.0f) const;
+    int getInt(const char *searchName, const char *key = nullptr, int defaultValue = 0) const;
+    int getIndex(const char *searchName) const;
 
     BaseSens &getModule(uint8_t index);
     BaseSens * getModulePtr(uint8_t index) const;
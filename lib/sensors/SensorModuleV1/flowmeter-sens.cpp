@@ -81,6 +81,12 @@ void FlowMeter::count() {
     this->_currentPulses++;                                                 //!< this should be called from an interrupt service routine
 }
 
+void FlowMeter::addPulses(unsigned long pulses) {
+    noInterrupts();                                                         //!< going to change interrupt variable(s)
+    this->_currentPulses += pulses;                                         //!< fed from a pulse capture channel instead of an ISR
+    interrupts();                                                           //!< done changing interrupt variable(s)
+}
+
 void FlowMeter::reset() {
     noInterrupts();                                                         //!< going to change interrupt variable(s)
     this->_currentPulses = 0;                                               //!< reset pulse counter
@@ -144,11 +150,15 @@ FlowSensorProperties FS400A = {60.0f, 4.8f, {1, 1, 1, 1, 1, 1, 1, 1, 1, 1}};
 
 
 FlowmeterSens::FlowmeterSens(uint8_t _pin, void (*_callback)(), FlowSensorProperties _properties, uint32_t _sensorUpdateTimer)
-        : sensorTimer(0), sensorUpdateTimer(_sensorUpdateTimer) {
+        : sensorTimer(0), sensorUpdateTimer(_sensorUpdateTimer), capture(nullptr) {
     sensorClass = new FlowMeter(digitalPinToInterrupt(_pin), _properties, _callback, RISING);
+    if (_callback == nullptr) capture = new PulseCapture(_pin, RISING, true);
 }
 
-FlowmeterSens::~FlowmeterSens() = default;
+FlowmeterSens::~FlowmeterSens() {
+    delete capture;
+    delete sensorClass;
+}
 
 bool FlowmeterSens::init() {
     if (strcmp(name, "") == 0 && doc == nullptr) {
@@ -159,11 +169,13 @@ bool FlowmeterSens::init() {
     (*doc)[name]["currentVolume"] = 0;
     (*doc)[name]["totalRate"] = 0;
     (*doc)[name]["totalVolume"] = 0;
+    if (capture != nullptr) capture->begin();
     return true;
 }
 
 bool FlowmeterSens::update() {
     if (millis() - sensorTimer >= sensorUpdateTimer) {
+        if (capture != nullptr) sensorClass->addPulses(capture->takeCount());
         sensorClass->tick(sensorUpdateTimer);
         (*doc)[name]["currentRate"] = (float) sensorClass->getCurrentFlowrate();
         (*doc)[name]["currentVolume"] = (float) sensorClass->getCurrentVolume();
@@ -96,6 +96,8 @@ public:
     void
     count();                                //!< Increments the internal pulse counter. Serves as an interrupt callback routine.
     void
+    addPulses(unsigned long pulses);        //!< Adds externally captured pulses (e.g. from PulseCapture) to the current tick.
+    void
     reset();                                //!< Prepares the flow meter for a fresh measurement. Resets all current values, but not the totals.
 
     /*
@@ -200,6 +202,7 @@ protected:
 #pragma message("[COMPILED]: flowmeter-sens.h")
 
 #include "base/sensor-module.h"
+#include "addons/pulse-capture.h"
 
 class FlowmeterSens : public BaseSens {
 private:
@@ -207,11 +210,12 @@ private:
     const char *name;
 
     FlowMeter *sensorClass;
+    PulseCapture *capture;
     uint32_t sensorUpdateTimer;
     uint32_t sensorTimer;
 
 public:
-    explicit FlowmeterSens(uint8_t _pin, void (*_callback)(), FlowSensorProperties _properties = UncalibratedSensor, uint32_t _sensorUpdateTimer = 1000);
+    explicit FlowmeterSens(uint8_t _pin, void (*_callback)() = nullptr, FlowSensorProperties _properties = UncalibratedSensor, uint32_t _sensorUpdateTimer = 1000);
     ~FlowmeterSens();
 
     bool init() override;
@@ -36,6 +36,10 @@ void FlowSensor::count() {
     this->_pulse++;
 }
 
+void FlowSensor::addPulses(unsigned long pulses) {
+    this->_pulse += pulses;
+}
+
 void FlowSensor::setInterval(unsigned long interval) {
     this->_interval = interval;
 }
@@ -90,13 +94,17 @@ void FlowSensor::resetVolume() {
 //////////////////////////////////////////////////////////////////////////////////////////
 
 FlowMeterV2Sens::FlowMeterV2Sens(uint16_t type, uint8_t pin, uint32_t interval, void (*callback)(void))
-        : FlowSensor(type, pin) {
-    FlowSensor::begin(callback);
+        : FlowSensor(type, pin),
+          capture(nullptr) {
+    if (callback != nullptr) FlowSensor::begin(callback);
+    else capture = new PulseCapture(pin, RISING, true);
     FlowSensor::setInterval(interval);
     FlowSensor::resetVolume();
 }
 
-FlowMeterV2Sens::~FlowMeterV2Sens() = default;
+FlowMeterV2Sens::~FlowMeterV2Sens() {
+    delete capture;
+}
 
 bool FlowMeterV2Sens::init() {
     if (strcmp(name, "") == 0 && doc == nullptr) {
@@ -105,10 +113,12 @@ bool FlowMeterV2Sens::init() {
     }
     (*doc)[name]["rate"] = 0.0;
     (*doc)[name]["volume"] = 0.0;
+    if (capture != nullptr) capture->begin();
     return true;
 }
 
 bool FlowMeterV2Sens::update() {
+    if (capture != nullptr) FlowSensor::addPulses(capture->takeCount());
     FlowSensor::read();
     (*doc)[name]["rate"] = FlowSensor::getFlowRate_m();
     (*doc)[name]["volume"] = FlowSensor::getVolume();
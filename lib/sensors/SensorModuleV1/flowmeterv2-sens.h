@@ -14,6 +14,7 @@
 
 #include "Arduino.h"
 #include "base/sensor-module.h"
+#include "addons/pulse-capture.h"
 
 #ifndef FLOW_SENSOR_V2
 #define FLOW_SENSOR_V2
@@ -38,6 +39,7 @@ public:
     FlowSensor(uint16_t type, uint8_t pin);
     void begin(void (*userFunc)(void), bool pullup = false);
     void count();
+    void addPulses(unsigned long pulses);
     bool read(long calibration = 0);
     void setType(uint16_t type);
     void setPin(uint8_t pin);
@@ -62,11 +64,12 @@ private:
 
     uint8_t sensorPin;
     uint32_t sensorTimer;
+    PulseCapture *capture;
 
     using FlowSensor::FlowSensor;
 
 public:
-    FlowMeterV2Sens(uint16_t type, uint8_t pin, uint32_t interval, void (*callback)(void));
+    FlowMeterV2Sens(uint16_t type, uint8_t pin, uint32_t interval, void (*callback)(void) = nullptr);
     virtual ~FlowMeterV2Sens();
     bool init() override;
     bool update() override;
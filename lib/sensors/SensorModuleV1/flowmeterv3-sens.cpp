@@ -26,6 +26,10 @@ void FlowSensor::count() {
     this->_pulse++;
 }
 
+void FlowSensor::addPulses(unsigned long pulses) {
+    this->_pulse += pulses;
+}
+
 bool FlowSensor::_isTimeToRead() {
     return (millis() - this->_timebefore >= this->_interval);
 }
@@ -80,132 +84,49 @@ void FlowSensor::resetVolume() {
     this->_volume = 0;
 }
 
-FlowSensorNode *FlowMeterV3Sens::sensorList = nullptr;
-
-#if defined(PLATFORM_ARDUINO)
-void IRAM_ATTR handleFlowSensorISR0() { FlowMeterV3Sens::handleInterrupt(0); }
-void IRAM_ATTR handleFlowSensorISR1() { FlowMeterV3Sens::handleInterrupt(1); }
-void IRAM_ATTR handleFlowSensorISR2() { FlowMeterV3Sens::handleInterrupt(2); }
-void IRAM_ATTR handleFlowSensorISR3() { FlowMeterV3Sens::handleInterrupt(3); }
-typedef void (*FlowISRFunction)();
-const FlowISRFunction flowIsrFunctions[] = {
-    handleFlowSensorISR0,
-    handleFlowSensorISR1,
-    handleFlowSensorISR2,
-    handleFlowSensorISR3,
-};
-
-#elif defined(PLATFORM_ESP32)
-
-void IRAM_ATTR FlowMeterV3Sens::isr(void *arg) {
-    uint8_t pin = *((uint8_t *) arg);
-    handleInterrupt(pin);
-}
-
-#elif defined(PLATFORM_ESP8266)
-void ICACHE_RAM_ATTR handleFlowSensorESP8266_ISR0() { FlowMeterV3Sens::handleInterrupt(0); }
-void ICACHE_RAM_ATTR handleFlowSensorESP8266_ISR1() { FlowMeterV3Sens::handleInterrupt(1); }
-void ICACHE_RAM_ATTR handleFlowSensorESP8266_ISR2() { FlowMeterV3Sens::handleInterrupt(2); }
-void ICACHE_RAM_ATTR handleFlowSensorESP8266_ISR3() { FlowMeterV3Sens::handleInterrupt(3); }
-const FlowISRFunction flowEsp8266IsrFunctions[] = {
-    handleFlowSensorESP8266_ISR0,
-    handleFlowSensorESP8266_ISR1,
-    handleFlowSensorESP8266_ISR2,
-    handleFlowSensorESP8266_ISR3,
-};
-#endif
-
 void FlowMeterV3Sens::handleInterrupt(uint8_t pin) {
-    FlowSensorNode *current = sensorList;
-    while (current != nullptr) {
-        if (current->pin == pin) {
-            current->instance->readInterrupt();
-            return;
-        }
-        current = current->next;
-    }
-}
-
-bool FlowMeterV3Sens::registerInstance() {
-    FlowSensorNode *current = sensorList;
-    while (current != nullptr) {
-        if (current->pin == sensorPin) {
-            current->instance = this;
-            return true;
-        }
-        current = current->next;
-    }
-
-    FlowSensorNode *newNode = new FlowSensorNode(sensorPin, this);
-
-    if (sensorList == nullptr) {
-        sensorList = newNode;
-    } else {
-        newNode->next = sensorList;
-        sensorList = newNode;
-    }
-
-    return true;
+    PulseCapture *channel = PulseCapture::findByPin(pin);
+    if (channel != nullptr) channel->handleEdge();
 }
 
 FlowMeterV3Sens::FlowMeterV3Sens(uint16_t type, uint8_t pin, uint32_t interval, bool pullup, InterruptCallback callback)
-        : FlowSensor(type, pin) {
-
-    sensorPin = pin;
-    usePullup = pullup;
-    userCallback = callback;
-
-    if (usePullup) {
-        pinMode(pin, INPUT_PULLUP);
-    } else {
-        pinMode(pin, INPUT);
-    }
-
+        : FlowSensor(type, pin),
+          doc(nullptr),
+          name(nullptr),
+          sensorPin(pin),
+          sensorTimer(0),
+          usePullup(pullup),
+          userCallback(callback),
+          capture(nullptr),
+          attached(false) {
     FlowSensor::setInterval(interval);
     FlowSensor::resetVolume();
+}
+
+FlowMeterV3Sens::~FlowMeterV3Sens() {
+    detach();
+}
 
+void FlowMeterV3Sens::attach() {
     if (userCallback == nullptr) {
-        registerInstance();
-
-#if defined(PLATFORM_ARDUINO)
-        if (pin < sizeof(flowIsrFunctions)/sizeof(flowIsrFunctions[0])) {
-                attachInterrupt(digitalPinToInterrupt(pin), flowIsrFunctions[pin], RISING);
-            }
-#elif defined(PLATFORM_ESP32)
-        attachInterruptArg(digitalPinToInterrupt(pin), isr, &sensorPin, RISING);
-#elif defined(PLATFORM_ESP8266)
-        if (pin < sizeof(flowEsp8266IsrFunctions)/sizeof(flowEsp8266IsrFunctions[0])) {
-                attachInterrupt(digitalPinToInterrupt(pin), flowEsp8266IsrFunctions[pin], RISING);
-            }
-#endif
+        if (capture == nullptr) capture = new PulseCapture(sensorPin, RISING, usePullup);
+        capture->begin();
     } else {
-        attachInterrupt(digitalPinToInterrupt(pin), userCallback, RISING);
+        pinMode(sensorPin, usePullup ? INPUT_PULLUP : INPUT);
+        attachInterrupt(digitalPinToInterrupt(sensorPin), userCallback, RISING);
     }
+    attached = true;
 }
 
-FlowMeterV3Sens::~FlowMeterV3Sens() {
-#if defined(PLATFORM_ARDUINO) || defined(PLATFORM_ESP8266) || defined(PLATFORM_ESP32)
-    detachInterrupt(digitalPinToInterrupt(sensorPin));
-#endif
-
-    if (userCallback == nullptr) {
-        FlowSensorNode *current = sensorList;
-        FlowSensorNode *prev = nullptr;
-
-        while (current != nullptr) {
-            if (current->pin == sensorPin && current->instance == this) {
-                if (prev == nullptr) {
-                    sensorList = current->next;
-                } else {
-                    prev->next = current->next;
-                }
-                delete current;
-                break;
-            }
-            prev = current;
-            current = current->next;
-        }
+void FlowMeterV3Sens::detach() {
+    if (!attached) return;
+    if (capture != nullptr) {
+        delete capture;
+        capture = nullptr;
+    } else {
+        detachInterrupt(digitalPinToInterrupt(sensorPin));
     }
+    attached = false;
 }
 
 bool FlowMeterV3Sens::init() {
@@ -219,10 +140,12 @@ bool FlowMeterV3Sens::init() {
 
     (*doc)[name]["rate"] = 0.0;
     (*doc)[name]["volume"] = 0.0;
+    attach();
     return true;
 }
 
 bool FlowMeterV3Sens::update() {
+    if (capture != nullptr) FlowSensor::addPulses(capture->takeCount());
     FlowSensor::read();
     (*doc)[name]["rate"] = FlowSensor::getFlowRate_m();
     (*doc)[name]["volume"] = FlowSensor::getVolume();
@@ -250,110 +173,33 @@ float FlowMeterV3Sens::getValueFlowMeterV3Sens() const {
 }
 
 void FlowMeterV3Sens::setPins(uint8_t _pin) {
-#if defined(PLATFORM_ARDUINO) || defined(PLATFORM_ESP8266) || defined(PLATFORM_ESP32)
-    detachInterrupt(digitalPinToInterrupt(sensorPin));
-#endif
-
-    if (userCallback == nullptr) {
-        FlowSensorNode *current = sensorList;
-        FlowSensorNode *prev = nullptr;
-
-        while (current != nullptr) {
-            if (current->pin == sensorPin && current->instance == this) {
-                if (prev == nullptr) {
-                    sensorList = current->next;
-                } else {
-                    prev->next = current->next;
-                }
-                delete current;
-                break;
-            }
-            prev = current;
-            current = current->next;
-        }
-    }
-
+    bool wasAttached = attached;
+    detach();
     sensorPin = _pin;
     FlowSensor::setPin(_pin);
-
-    if (usePullup) {
-        pinMode(_pin, INPUT_PULLUP);
-    } else {
-        pinMode(_pin, INPUT);
-    }
-
-    if (userCallback == nullptr) {
-        registerInstance();
-
-#if defined(PLATFORM_ARDUINO)
-        if (_pin < sizeof(flowIsrFunctions)/sizeof(flowIsrFunctions[0])) {
-                attachInterrupt(digitalPinToInterrupt(_pin), flowIsrFunctions[_pin], RISING);
-            }
-#elif defined(PLATFORM_ESP32)
-        attachInterruptArg(digitalPinToInterrupt(_pin), isr, &sensorPin, RISING);
-#elif defined(PLATFORM_ESP8266)
-        if (_pin < sizeof(flowEsp8266IsrFunctions)/sizeof(flowEsp8266IsrFunctions[0])) {
-                attachInterrupt(digitalPinToInterrupt(_pin), flowEsp8266IsrFunctions[_pin], RISING);
-            }
-#endif
-    } else {
-        attachInterrupt(digitalPinToInterrupt(_pin), userCallback, RISING);
-    }
+    if (wasAttached) attach();
 }
 
 void FlowMeterV3Sens::setPullup(bool pullup) {
+    // the capture takes the pull-up at construction, so it is rebuilt like in setPins()
+    bool wasAttached = attached;
+    detach();
     usePullup = pullup;
-
-    if (usePullup) {
-        pinMode(sensorPin, INPUT_PULLUP);
-    } else {
-        pinMode(sensorPin, INPUT);
-    }
+    pinMode(sensorPin, usePullup ? INPUT_PULLUP : INPUT);
+    if (wasAttached) attach();
 }
 
 void FlowMeterV3Sens::setCallback(InterruptCallback callback) {
-    detachInterrupt(digitalPinToInterrupt(sensorPin));
-
-    if (userCallback == nullptr && callback != nullptr) {
-        FlowSensorNode *current = sensorList;
-        FlowSensorNode *prev = nullptr;
-
-        while (current != nullptr) {
-            if (current->pin == sensorPin && current->instance == this) {
-                if (prev == nullptr) {
-                    sensorList = current->next;
-                } else {
-                    prev->next = current->next;
-                }
-                delete current;
-                break;
-            }
-            prev = current;
-            current = current->next;
-        }
-    } else if (userCallback != nullptr && callback == nullptr) {
-        registerInstance();
-    }
-
+    bool wasAttached = attached;
+    detach();
     userCallback = callback;
-
-    if (userCallback == nullptr) {
-#if defined(PLATFORM_ARDUINO)
-        if (sensorPin < sizeof(flowIsrFunctions)/sizeof(flowIsrFunctions[0])) {
-                attachInterrupt(digitalPinToInterrupt(sensorPin), flowIsrFunctions[sensorPin], RISING);
-            }
-#elif defined(PLATFORM_ESP32)
-        attachInterruptArg(digitalPinToInterrupt(sensorPin), isr, &sensorPin, RISING);
-#elif defined(PLATFORM_ESP8266)
-        if (sensorPin < sizeof(flowEsp8266IsrFunctions)/sizeof(flowEsp8266IsrFunctions[0])) {
-                attachInterrupt(digitalPinToInterrupt(sensorPin), flowEsp8266IsrFunctions[sensorPin], RISING);
-            }
-#endif
-    } else {
-        attachInterrupt(digitalPinToInterrupt(sensorPin), userCallback, RISING);
-    }
+    if (wasAttached) attach();
 }
 
 void FlowMeterV3Sens::readInterrupt() {
     FlowSensor::count();
+}
+
+PulseCapture *FlowMeterV3Sens::getCapture() const {
+    return capture;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "Arduino.h"
 #include "base/sensor-module.h"
+#include "addons/pulse-capture.h"
 
 #if defined(ESP32)
 #define PLATFORM_ESP32
@@ -14,17 +15,6 @@
 #define PLATFORM_ARDUINO
 #endif
 
-class FlowMeterV3Sens;
-
-struct FlowSensorNode {
-    uint8_t pin;
-    FlowMeterV3Sens *instance;
-    FlowSensorNode *next;
-
-    FlowSensorNode(uint8_t _pin, FlowMeterV3Sens *_instance) :
-            pin(_pin), instance(_instance), next(nullptr) {}
-};
-
 #ifndef FLOW_SENSOR_V3
 #define FLOW_SENSOR_V3
 
@@ -51,6 +41,7 @@ public:
     void setPin(uint8_t pin);
     void setInterval(unsigned long interval);
     void count();
+    void addPulses(unsigned long pulses);
     bool read(long calibration = 0);
     unsigned long getPulse();
     float getFlowRate_h();
@@ -74,14 +65,11 @@ private:
     uint32_t sensorTimer;
     bool usePullup;
     InterruptCallback userCallback;
+    PulseCapture *capture;
+    bool attached;
 
-    static FlowSensorNode *sensorList;
-
-    bool registerInstance();
-
-#ifdef PLATFORM_ESP32
-    static void IRAM_ATTR isr(void *arg);
-#endif
+    void attach();
+    void detach();
 
     using FlowSensor::FlowSensor;
 
@@ -104,6 +92,7 @@ public:
 
     void setPullup(bool pullup);
     void setCallback(InterruptCallback callback);
+    PulseCapture *getCapture() const;
 };
 
 #endif
\ No newline at end of file
@@ -15,7 +15,9 @@ PhSens::PhSens(uint8_t sensorPin, float voltage, float resolution, float *calibr
           resolution(resolution),
           calibrationValue(calibrationValue),
           sensorPin(sensorPin),
-          bufferSize(bufferSize) {
+          bufferSize(bufferSize),
+          adcChannel(CONTINUOUS_ADC_NO_CHANNEL),
+          adcSampleCount(0) {
     bufferAnalog = new uint32_t[bufferSize];
 }
 
@@ -30,10 +32,24 @@ bool PhSens::init() {
     }
     (*doc)[name]["volt"] = 0;
     (*doc)[name]["ph"] = 0;
+    adcChannel = ContinuousADC::instance().addChannel(sensorPin, 30000UL);
     return true;
 }
 
 bool PhSens::update() {
+    if (adcChannel != CONTINUOUS_ADC_NO_CHANNEL) {
+        ContinuousADC &adc = ContinuousADC::instance();
+        adc.update();
+        uint32_t sampleCount = adc.getSampleCount(adcChannel);
+        if (sampleCount == adcSampleCount) return false;
+        adcSampleCount = sampleCount;
+        uint8_t samples = bufferSize < CONTINUOUS_ADC_BUFFER_SIZE ? bufferSize : CONTINUOUS_ADC_BUFFER_SIZE;
+        double phVoltageValue = adc.getTrimmedAverage(adcChannel, samples) * voltage / resolution;
+        (*doc)[name]["volt"] = phVoltageValue;
+        (*doc)[name]["ph"] = -5.70f * phVoltageValue + *calibrationValue;
+        return true;
+    }
+
     for (int i = 0; i < bufferSize; i++) {
         bufferAnalog[i] = analogRead(sensorPin);
         delay(30);
@@ -82,6 +98,10 @@ JsonVariant PhSens::getVariant(const char *searchName) {
     return (*doc)[searchName];
 }
 
+void PhSens::setSampleInterval(uint32_t intervalMs) {
+    ContinuousADC::instance().setInterval(adcChannel, intervalMs * 1000UL);
+}
+
 float PhSens::getValuePhSens() const {
     return (*doc)[name].as<float>();
 }
@@ -14,6 +14,7 @@
 
 #include "Arduino.h"
 #include "base/sensor-module.h"
+#include "../../modules/io/continuous-adc.h"
 
 class PhSens : public BaseSens {
 private:
@@ -25,6 +26,8 @@ private:
     float *calibrationValue;
     uint32_t *bufferAnalog;
     uint8_t bufferSize;
+    int8_t adcChannel;
+    uint32_t adcSampleCount;
 
     uint8_t sensorPin;
     uint32_t sensorTimer;
@@ -40,6 +43,7 @@ public:
     JsonDocument getDocument() override;
     JsonVariant getVariant(const char *searchName) override;
 
+    void setSampleInterval(uint32_t intervalMs);
     float getValuePhSens() const;
     void setPins(uint8_t _pin);
 };
@@ -15,25 +15,41 @@ RPMSens::RPMSens(int _encoderPin, void (*_interruptCallback)(), int _mode)
           interval(100),
           encoderPin(_encoderPin),
           interruptCallback(_interruptCallback),
-          mode(_mode) {
+          mode(_mode),
+          capture(nullptr),
+          pulsesPerRevolution(20),
+          sensorTimer(0) {
 }
 
-RPMSens::~RPMSens() = default;
+RPMSens::~RPMSens() {
+    delete capture;
+}
 
 bool RPMSens::init() {
     if (strcmp(name, "") == 0 && doc == nullptr) {
         name = "RPMSens";
         doc = new JsonDocument;
     }
-    pinMode(encoderPin, INPUT_PULLUP);
-    attachInterrupt(digitalPinToInterrupt(encoderPin), interruptCallback, mode);
+    if (interruptCallback == nullptr || capture != nullptr) {
+        if (capture == nullptr) capture = new PulseCapture(encoderPin, mode, true);
+        capture->setWindow(interval);
+        capture->begin();
+    } else {
+        pinMode(encoderPin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(encoderPin), interruptCallback, mode);
+    }
     (*doc)[name] = 0;
     return true;
 }
 
 bool RPMSens::update() {
+    if (capture != nullptr) {
+        if (!capture->update()) return false;
+        (*doc)[name] = capture->getFrequency() * 60.0f / pulsesPerRevolution;
+        return true;
+    }
     if (millis() - sensorTimer >= interval) {
-        float rpmValue = (encoderCount / 20.0) * 60 * 10;
+        float rpmValue = (encoderCount / pulsesPerRevolution) * 60 * (1000.0f / interval);
         rpmValue = rpmValue < 0 ? 0 : rpmValue;
         (*doc)[name] = rpmValue;
         encoderCount = 0;
@@ -47,6 +63,20 @@ void RPMSens::count() {
     this->encoderCount++;
 }
 
+void RPMSens::setPulsesPerRevolution(float ppr) {
+    if (ppr > 0) pulsesPerRevolution = ppr;
+}
+
+void RPMSens::setCaptureMode(PulseCaptureMode captureMode, uint8_t averaging) {
+    if (capture == nullptr) capture = new PulseCapture(encoderPin, mode, true);
+    capture->setMode(captureMode);
+    capture->setAveraging(averaging);
+}
+
+PulseCapture *RPMSens::getCapture() const {
+    return capture;
+}
+
 void RPMSens::setDocument(const char *objName) {
     name = objName;
 }
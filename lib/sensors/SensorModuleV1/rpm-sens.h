@@ -14,6 +14,7 @@
 
 #include "Arduino.h"
 #include "base/sensor-module.h"
+#include "addons/pulse-capture.h"
 
 class RPMSens : public BaseSens {
 private:
@@ -27,6 +28,9 @@ private:
     void (*interruptCallback)();
     int mode;
 
+    PulseCapture *capture;
+    float pulsesPerRevolution;
+
     uint8_t sensorPin;
     uint32_t sensorTimer;
 
@@ -38,6 +42,10 @@ public:
 
     void count();
 
+    void setPulsesPerRevolution(float ppr);
+    void setCaptureMode(PulseCaptureMode captureMode, uint8_t averaging = 1);
+    PulseCapture *getCapture() const;
+
     void setDocument(const char *objName) override;
     void setDocumentValue(JsonDocument *docBase) override;
     JsonDocument getDocument() override;
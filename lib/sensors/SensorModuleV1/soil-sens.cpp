@@ -10,7 +10,9 @@
 
 SoilMoistureSens::SoilMoistureSens(uint8_t _pin)
         : sensorPin(_pin),
-          sensorTimer(0) {
+          sensorTimer(0),
+          adcChannel(CONTINUOUS_ADC_NO_CHANNEL),
+          adcSamples(0) {
 }
 
 SoilMoistureSens::~SoilMoistureSens() = default;
@@ -28,8 +30,9 @@ bool SoilMoistureSens::init() {
 }
 
 bool SoilMoistureSens::update() {
+    if (adcChannel != CONTINUOUS_ADC_NO_CHANNEL) ContinuousADC::instance().update();
     if (millis() - sensorTimer >= 500) {
-        int value = analogRead(sensorPin);
+        int value = (int) ContinuousADC::readAverage(adcChannel, sensorPin, adcSamples);
 #if defined(ESP32)
         (*doc)[name]["raw"] = value;
         (*doc)[name]["val"] = (100 - ((value / 4095.0) * 100));
@@ -65,6 +68,11 @@ JsonVariant SoilMoistureSens::getVariant(const char *searchName) {
     return (*doc)[searchName];
 }
 
+void SoilMoistureSens::setContinuousADC(uint8_t samples, uint32_t intervalUs) {
+    adcChannel = ContinuousADC::instance().addChannel(sensorPin, intervalUs);
+    adcSamples = samples;
+}
+
 float SoilMoistureSens::getValueSoilMoistureSens() const {
     return (*doc)[name].as<float>();
 }
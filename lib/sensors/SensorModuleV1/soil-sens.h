@@ -14,6 +14,7 @@
 
 #include "Arduino.h"
 #include "base/sensor-module.h"
+#include "../../modules/io/continuous-adc.h"
 
 class SoilMoistureSens : public BaseSens {
 private:
@@ -22,6 +23,8 @@ private:
 
     uint8_t sensorPin;
     uint32_t sensorTimer;
+    int8_t adcChannel;
+    uint8_t adcSamples;
 
 public:
     explicit SoilMoistureSens(uint8_t _pin);
@@ -37,6 +40,7 @@ public:
     JsonDocument getDocument() override;
     JsonVariant getVariant(const char *searchName) override;
 
+    void setContinuousADC(uint8_t samples = 8, uint32_t intervalUs = 10000);
     float getValueSoilMoistureSens() const;
     void setPins(uint8_t _pin);
 };
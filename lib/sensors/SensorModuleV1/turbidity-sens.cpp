@@ -13,7 +13,9 @@
 TurbiditySens::TurbiditySens(int _sensorPin)
         : doc(nullptr),
           name(""),
-          sensorPin(_sensorPin) {}
+          sensorPin(_sensorPin),
+          sensorTimer(0),
+          adcChannel(CONTINUOUS_ADC_NO_CHANNEL) {}
 
 TurbiditySens::~TurbiditySens() = default;
 
@@ -25,16 +27,23 @@ bool TurbiditySens::init() {
     }
     (*doc)[name]["volt"] = 0;
     (*doc)[name]["ntu"] = 0;
+    adcChannel = ContinuousADC::instance().addChannel(sensorPin, 500000UL / CONTINUOUS_ADC_BUFFER_SIZE);
+    return true;
 }
 
 bool TurbiditySens::update() {
+    if (adcChannel != CONTINUOUS_ADC_NO_CHANNEL) ContinuousADC::instance().update();
     if (millis() - sensorTimer >= 500) {
         float voltage = 0.0;
         double ntu = 0.0;
-        for (int i = 0; i < SAMPLE; i++) {
-            voltage += ((float) analogRead(sensorPin) / 1023) * 5;
+        if (adcChannel != CONTINUOUS_ADC_NO_CHANNEL) {
+            voltage = (ContinuousADC::readAverage(adcChannel, sensorPin) / 1023) * 5;
+        } else {
+            for (int i = 0; i < SAMPLE; i++) {
+                voltage += ((float) analogRead(sensorPin) / 1023) * 5;
+            }
+            voltage = voltage / SAMPLE;
         }
-        voltage = voltage / SAMPLE;
         voltage = roundToDp(voltage, 2);
         if (voltage < 2.5) {
             ntu = 3000;
@@ -14,6 +14,7 @@
 
 #include "Arduino.h"
 #include "base/sensor-module.h"
+#include "../../modules/io/continuous-adc.h"
 
 class TurbiditySens : public BaseSens {
 private:
@@ -22,6 +23,7 @@ private:
 
     uint8_t sensorPin;
     uint32_t sensorTimer;
+    int8_t adcChannel;
 
 public:
     TurbiditySens(int _sensorPin);
@@ -15,7 +15,9 @@ VoltageSens::VoltageSens()
           sensorRes1(30000.0),
           sensorRes2(7500.0),
           sensorRefVoltage(5.0),
-          sensorResolution(1024.0) {
+          sensorResolution(1024.0),
+          adcChannel(CONTINUOUS_ADC_NO_CHANNEL),
+          adcSamples(0) {
 }
 
 VoltageSens::VoltageSens(uint8_t _pin, float _res1, float _res2, float _ref_voltage, float _resolution)
@@ -25,7 +27,9 @@ VoltageSens::VoltageSens(uint8_t _pin, float _res1, float _res2, float _ref_volt
           sensorRes1(_res1),
           sensorRes2(_res2),
           sensorRefVoltage(_ref_voltage),
-          sensorResolution(_resolution) {
+          sensorResolution(_resolution),
+          adcChannel(CONTINUOUS_ADC_NO_CHANNEL),
+          adcSamples(0) {
 }
 
 VoltageSens::~VoltageSens() = default;
@@ -35,8 +39,9 @@ bool VoltageSens::init() {
 }
 
 bool VoltageSens::update() {
+    if (adcChannel != CONTINUOUS_ADC_NO_CHANNEL) ContinuousADC::instance().update();
     if (millis() - sensorTimer >= 500) {
-        sensorValue = analogRead(sensorPin);
+        sensorValue = ContinuousADC::readAverage(adcChannel, sensorPin, adcSamples);
         sensorValue = (sensorValue * sensorRefVoltage) / sensorResolution;
         sensorValue = sensorValue / (sensorRes2 / (sensorRes1 + sensorRes2));
         sensorTimer = millis();
@@ -47,6 +52,11 @@ void VoltageSens::getValue(float *output) {
     *output = sensorValue;
 }
 
+void VoltageSens::setContinuousADC(uint8_t samples, uint32_t intervalUs) {
+    adcChannel = ContinuousADC::instance().addChannel(sensorPin, intervalUs);
+    adcSamples = samples;
+}
+
 float VoltageSens::getValueVoltage() const {
     return sensorValue;
 }
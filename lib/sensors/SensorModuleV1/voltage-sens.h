@@ -14,6 +14,7 @@
 
 #include "Arduino.h"
 #include "base/sensor-module.h"
+#include "../../modules/io/continuous-adc.h"
 
 class VoltageSens : public BaseSens {
 private:
@@ -27,6 +28,9 @@ private:
     float sensorRefVoltage;
     float sensorResolution;
 
+    int8_t adcChannel;
+    uint8_t adcSamples;
+
 public:
     VoltageSens();
     explicit VoltageSens(uint8_t _pin, float _res1 = 30000.0, float _res2 = 7500.0, float _ref_voltage = 5.0, float _resolution = 1024.0);
@@ -34,6 +38,7 @@ public:
     bool init() override;
     bool update() override;
     void getValue(float *output) override;
+    void setContinuousADC(uint8_t samples = 8, uint32_t intervalUs = 10000);
     float getValueVoltage() const;
     void setPins(uint8_t _pin);
 };
@@ -8,6 +8,8 @@ AnalogSensV2::AnalogSensV2(uint8_t pin, float vref, int adcRange, CustomDataCall
           _updateTimer(0),
           _updateInterval(100),
           _lastUpdateStatus(false),
+          _adcChannel(CONTINUOUS_ADC_NO_CHANNEL),
+          _adcSamples(0),
           _onCustomData(onCustomData) {
     addValueInfo("raw", "Raw Value", "", 0, false);
     addValueInfo("volt", "Voltage", "V", 3, true);
@@ -26,9 +28,10 @@ bool AnalogSensV2::init() {
 }
 
 bool AnalogSensV2::update() {
+    if (_adcChannel != CONTINUOUS_ADC_NO_CHANNEL) ContinuousADC::instance().update();
     unsigned long currentTime = millis();
     if ((currentTime - _updateTimer) >= _updateInterval) {
-        int analogValue = analogRead(_sensorPin);
+        int analogValue = (int) ContinuousADC::readAverage(_adcChannel, _sensorPin, _adcSamples);
         float voltageValue = analogValue * (_voltageReference / _adcRange);
 
         updateValue("raw", analogValue);
@@ -58,6 +61,11 @@ void AnalogSensV2::setPins(uint8_t pin) {
     _sensorPin = pin;
 }
 
+void AnalogSensV2::setContinuousADC(uint8_t samples, uint32_t intervalUs) {
+    _adcChannel = ContinuousADC::instance().addChannel(_sensorPin, intervalUs);
+    _adcSamples = samples;
+}
+
 void AnalogSensV2::setCustomDataCallback(CustomDataCallback callback) {
     _onCustomData = callback;
 }
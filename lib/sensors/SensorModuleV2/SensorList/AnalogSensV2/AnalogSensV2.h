@@ -7,6 +7,7 @@
 
 #include "Arduino.h"
 #include "../../SensorModule/SensorModuleV2.h"
+#include "../../../../modules/io/continuous-adc.h"
 
 class AnalogSensV2 : public BaseSensV2 {
 private:
@@ -16,6 +17,8 @@ private:
     uint32_t _updateTimer;
     uint32_t _updateInterval;
     bool _lastUpdateStatus;
+    int8_t _adcChannel;
+    uint8_t _adcSamples;
 
     typedef void (*CustomDataCallback)(BaseSensV2 *sensor, int analogValue, float voltageValue);
     CustomDataCallback _onCustomData;
@@ -30,6 +33,7 @@ public:
 
     void setUpdateInterval(uint32_t interval);
     void setPins(uint8_t pin);
+    void setContinuousADC(uint8_t samples = 8, uint32_t intervalUs = 1000);
 
     void setCustomDataCallback(CustomDataCallback callback);
 
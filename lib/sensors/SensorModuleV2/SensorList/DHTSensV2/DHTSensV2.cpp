@@ -4,9 +4,13 @@
 DHTSensV2::DHTSensV2(uint8_t pin, uint8_t type)
         : DHT(pin, type),
           _sensorPin(pin),
+          _sensorType(type),
           _updateTimer(0),
           _updateInterval(2000),
-          _lastUpdateStatus(false) {
+          _lastUpdateStatus(false),
+          _waking(false),
+          _wakeTimer(0),
+          _data{0, 0, 0, 0, 0} {
     addValueInfo("temp", "Temperature", "°C", 1, true);
     addValueInfo("hum", "Humidity", "%", 0, true);
 }
@@ -24,25 +28,70 @@ bool DHTSensV2::init() {
 }
 
 bool DHTSensV2::update() {
+    _lastUpdateStatus = false;
     unsigned long currentTime = millis();
-    if ((currentTime - _updateTimer) >= _updateInterval) {
-        float temp = DHT::readTemperature();
-        float hum = DHT::readHumidity();
-
-        if (isnan(temp) || isnan(hum)) {
-            _updateTimer = currentTime;
-            _lastUpdateStatus = false;
-            return false;
-        }
-
-        updateValue("temp", temp);
-        updateValue("hum", hum);
+
+    if (!_waking) {
+        if ((currentTime - _updateTimer) < _updateInterval) return false;
+        // hold the start signal low across passes instead of delay()-ing through it
+        pinMode(_sensorPin, OUTPUT);
+        digitalWrite(_sensorPin, LOW);
+        _wakeTimer = micros();
         _updateTimer = currentTime;
-        _lastUpdateStatus = true;
-        return true;
+        _waking = true;
+        return false;
     }
-    _lastUpdateStatus = false;
-    return false;
+
+    if ((micros() - _wakeTimer) < getWakeTime()) return false;
+    _waking = false;
+
+    if (!readFrame()) return false;
+
+    float temp;
+    float hum;
+    if (_sensorType == DHT11) {
+        hum = _data[0] + _data[1] * 0.1f;
+        temp = _data[2];
+        if (_data[3] & 0x80) temp = -1 - temp;
+        temp += (_data[3] & 0x0f) * 0.1f;
+    } else if (_sensorType == DHT12) {
+        hum = _data[0] + _data[1] * 0.1f;
+        temp = _data[2] + (_data[3] & 0x0f) * 0.1f;
+        if (_data[2] & 0x80) temp = -temp;
+    } else {
+        hum = (((uint16_t) _data[0] << 8) | _data[1]) * 0.1f;
+        temp = (((uint16_t) (_data[2] & 0x7f) << 8) | _data[3]) * 0.1f;
+        if (_data[2] & 0x80) temp = -temp;
+    }
+
+    updateValue("temp", temp);
+    updateValue("hum", hum);
+    _lastUpdateStatus = true;
+    return true;
+}
+
+uint32_t DHTSensV2::getWakeTime() const {
+    return (_sensorType == DHT21 || _sensorType == DHT22) ? 1100 : 20000;
+}
+
+bool DHTSensV2::readFrame() {
+    for (uint8_t i = 0; i < 5; i++) _data[i] = 0;
+
+    // only the ~4 ms bit transfer itself is timing critical
+    noInterrupts();
+    pinMode(_sensorPin, INPUT_PULLUP);
+    delayMicroseconds(55);
+    bool valid = pulseIn(_sensorPin, HIGH, 200) != 0;
+    for (uint8_t i = 0; valid && i < 40; i++) {
+        unsigned long high = pulseIn(_sensorPin, HIGH, 200);
+        if (high == 0) valid = false;
+        _data[i / 8] <<= 1;
+        if (high > 40) _data[i / 8] |= 1;
+    }
+    interrupts();
+
+    if (!valid) return false;
+    return _data[4] == ((_data[0] + _data[1] + _data[2] + _data[3]) & 0xff);
 }
 
 void DHTSensV2::setUpdateInterval(uint32_t interval) {
@@ -59,5 +108,10 @@ bool DHTSensV2::isUpdated() const {
 }
 
 void DHTSensV2::reinitializeSensor() {
+    _waking = false;
     DHT::begin();
+}
+
+bool DHTSensV2::isWaking() const {
+    return _waking;
 }
\ No newline at end of file
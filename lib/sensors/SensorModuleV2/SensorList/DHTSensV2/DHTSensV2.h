@@ -12,10 +12,18 @@
 class DHTSensV2 : public BaseSensV2, public DHT {
 private:
     uint8_t _sensorPin;
+    uint8_t _sensorType;
     uint32_t _updateTimer;
     uint32_t _updateInterval;
     bool _lastUpdateStatus;
 
+    bool _waking;
+    uint32_t _wakeTimer;
+    uint8_t _data[5];
+
+    uint32_t getWakeTime() const;
+    bool readFrame();
+
     using DHT::DHT;
 
 public:
@@ -29,6 +37,7 @@ public:
     void setUpdateInterval(uint32_t interval);
     void setPins(uint8_t pin);
     void reinitializeSensor();
+    bool isWaking() const;
 };
 
 #endif  // DHT_SENS_V2_H
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "DS18B20SensV2.h"
+#include "Arduino.h"
+
+DS18B20SensV2::DS18B20SensV2(uint8_t pin)
+        : _wire(new OneWire(pin)),
+          _ownsWire(true),
+          _hasAddress(false),
+          _updateTimer(0),
+          _updateInterval(2000),
+          _conversionTimer(0),
+          _conversionTime(750),
+          _converting(false),
+          _lastUpdateStatus(false) {
+    DallasTemperature::setOneWire(_wire);
+    addValueInfo("temp", "Temperature", "°C", 2, true);
+}
+
+DS18B20SensV2::DS18B20SensV2(OneWire *wire)
+        : DallasTemperature(wire),
+          _wire(wire),
+          _ownsWire(false),
+          _hasAddress(false),
+          _updateTimer(0),
+          _updateInterval(2000),
+          _conversionTimer(0),
+          _conversionTime(750),
+          _converting(false),
+          _lastUpdateStatus(false) {
+    addValueInfo("temp", "Temperature", "°C", 2, true);
+}
+
+DS18B20SensV2::~DS18B20SensV2() {
+    if (_ownsWire) delete _wire;
+}
+
+bool DS18B20SensV2::init() {
+    DallasTemperature::begin();
+    DallasTemperature::setWaitForConversion(false);
+    _hasAddress = DallasTemperature::getAddress(_address, 0);
+    updateValue("temp", 0.0f);
+    return _hasAddress;
+}
+
+bool DS18B20SensV2::update() {
+    _lastUpdateStatus = false;
+    unsigned long currentTime = millis();
+
+    if (!_converting) {
+        if ((currentTime - _updateTimer) < _updateInterval) return false;
+        if (!_hasAddress) {
+            _hasAddress = DallasTemperature::getAddress(_address, 0);
+            _updateTimer = currentTime;
+            if (!_hasAddress) return false;
+        }
+        // returns right away; the bus is free while the sensor converts
+        DallasTemperature::requestTemperaturesByAddress(_address);
+        _conversionTime = DallasTemperature::millisToWaitForConversion(DallasTemperature::getResolution());
+        _conversionTimer = currentTime;
+        _updateTimer = currentTime;
+        _converting = true;
+        return false;
+    }
+
+    if ((currentTime - _conversionTimer) < _conversionTime) return false;
+    _converting = false;
+
+    float temp = DallasTemperature::getTempC(_address);
+    if (temp == DEVICE_DISCONNECTED_C) {
+        _hasAddress = false;
+        return false;
+    }
+
+    updateValue("temp", temp);
+    _lastUpdateStatus = true;
+    return true;
+}
+
+bool DS18B20SensV2::isUpdated() const {
+    return _lastUpdateStatus;
+}
+
+void DS18B20SensV2::setUpdateInterval(uint32_t interval) {
+    _updateInterval = interval;
+}
+
+bool DS18B20SensV2::isConverting() const {
+    return _converting;
+}
\ No newline at end of file
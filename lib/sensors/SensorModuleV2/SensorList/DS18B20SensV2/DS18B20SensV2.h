@@ -0,0 +1,42 @@
+#pragma once
+
+#ifndef DS18B20_SENS_V2_H
+#define DS18B20_SENS_V2_H
+
+#pragma message("[COMPILED]: DS18B20SensV2.h")
+
+#include "Arduino.h"
+#include "../../SensorModule/SensorModuleV2.h"
+#include "OneWire.h"
+#include "DallasTemperature.h"
+
+class DS18B20SensV2 : public BaseSensV2, public DallasTemperature {
+private:
+    OneWire *_wire;
+    bool _ownsWire;
+    DeviceAddress _address;
+    bool _hasAddress;
+
+    uint32_t _updateTimer;
+    uint32_t _updateInterval;
+    uint32_t _conversionTimer;
+    uint32_t _conversionTime;
+    bool _converting;
+    bool _lastUpdateStatus;
+
+    using DallasTemperature::DallasTemperature;
+
+public:
+    explicit DS18B20SensV2(uint8_t pin);
+    explicit DS18B20SensV2(OneWire *wire);
+    virtual ~DS18B20SensV2();
+
+    bool init() override;
+    bool update() override;
+    bool isUpdated() const override;
+
+    void setUpdateInterval(uint32_t interval);
+    bool isConverting() const;
+};
+
+#endif  // DS18B20_SENS_V2_H
\ No newline at end of file
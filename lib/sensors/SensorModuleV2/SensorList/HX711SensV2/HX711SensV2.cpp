@@ -0,0 +1,147 @@
+#include "HX711SensV2.h"
+#include "Arduino.h"
+
+HX711SensV2::HX711SensV2(uint8_t doutPin, uint8_t sckPin, float format)
+        : _doutPin(doutPin),
+          _sckPin(sckPin),
+          _format(format),
+          _updateTimer(0),
+          _updateInterval(500),
+          _lastUpdateStatus(false),
+          _state(HX711_STATE_IDLE),
+          _job(HX711_JOB_NONE),
+          _stateTimer(0),
+          _settleTime(0),
+          _sampleSum(0),
+          _sampleCount(0),
+          _sampleTarget(0),
+          _knownWeight(0.0f),
+          _jobSucceeded(false) {
+    addValueInfo("weight", "Weight", "g", 2, true);
+}
+
+HX711SensV2::~HX711SensV2() = default;
+
+bool HX711SensV2::init() {
+    HX711::begin(_doutPin, _sckPin);
+    updateValue("weight", 0.0f);
+    return true;
+}
+
+bool HX711SensV2::update() {
+    _lastUpdateStatus = false;
+
+    switch (_state) {
+        case HX711_STATE_SETTLE:
+            if (millis() - _stateTimer < _settleTime) return false;
+            _state = HX711_STATE_SAMPLE;
+            return false;
+
+        case HX711_STATE_SAMPLE:
+            // one conversion per pass; read() returns immediately once DOUT is low
+            if (!HX711::is_ready()) return false;
+            _sampleSum += HX711::read();
+            if (++_sampleCount >= _sampleTarget) finishJob();
+            return false;
+
+        case HX711_STATE_IDLE:
+        default:
+            break;
+    }
+
+    unsigned long currentTime = millis();
+    if ((currentTime - _updateTimer) < _updateInterval) return false;
+    if (!HX711::is_ready()) return false;
+
+    float scale = HX711::get_scale();
+    if (scale == 0.0f) scale = 1.0f;
+    float weight = (float) (HX711::read() - HX711::get_offset()) / scale / _format;
+
+    updateValue("weight", weight);
+    _updateTimer = currentTime;
+    _lastUpdateStatus = true;
+    return true;
+}
+
+bool HX711SensV2::isUpdated() const {
+    return _lastUpdateStatus;
+}
+
+void HX711SensV2::setUpdateInterval(uint32_t interval) {
+    _updateInterval = interval;
+}
+
+void HX711SensV2::setFormat(float format) {
+    _format = format == 0.0f ? HX711SensV2::G : format;
+}
+
+void HX711SensV2::setPins(uint8_t doutPin, uint8_t sckPin) {
+    _doutPin = doutPin;
+    _sckPin = sckPin;
+}
+
+bool HX711SensV2::startTare(uint8_t samples, uint32_t settleTime) {
+    return startJob(HX711_JOB_TARE, samples, settleTime);
+}
+
+bool HX711SensV2::startCalibration(float knownWeight, uint8_t samples, uint32_t settleTime) {
+    if (knownWeight == 0.0f) return false;
+    _knownWeight = knownWeight;
+    return startJob(HX711_JOB_CALIBRATE, samples, settleTime);
+}
+
+bool HX711SensV2::startJob(HX711JobV2 job, uint8_t samples, uint32_t settleTime) {
+    if (_state != HX711_STATE_IDLE) return false;
+    _job = job;
+    _sampleSum = 0;
+    _sampleCount = 0;
+    _sampleTarget = samples == 0 ? 1 : samples;
+    _settleTime = settleTime;
+    _stateTimer = millis();
+    _jobSucceeded = false;
+    _state = settleTime > 0 ? HX711_STATE_SETTLE : HX711_STATE_SAMPLE;
+    return true;
+}
+
+void HX711SensV2::finishJob() {
+    long average = (long) (_sampleSum / _sampleCount);
+
+    if (_job == HX711_JOB_TARE) {
+        HX711::set_offset(average);
+        _jobSucceeded = true;
+    } else if (_job == HX711_JOB_CALIBRATE) {
+        float factor = (float) (average - HX711::get_offset()) / (_knownWeight * _format);
+        if (factor != 0.0f) {
+            HX711::set_scale(factor);
+            _jobSucceeded = true;
+        }
+    }
+
+    _job = HX711_JOB_NONE;
+    _state = HX711_STATE_IDLE;
+}
+
+void HX711SensV2::cancel() {
+    _job = HX711_JOB_NONE;
+    _state = HX711_STATE_IDLE;
+}
+
+bool HX711SensV2::isBusy() const {
+    return _state != HX711_STATE_IDLE;
+}
+
+bool HX711SensV2::isJobSucceeded() const {
+    return _jobSucceeded;
+}
+
+HX711StateV2 HX711SensV2::getState() const {
+    return _state;
+}
+
+float HX711SensV2::getCalibrationFactor() {
+    return HX711::get_scale();
+}
+
+long HX711SensV2::getTareOffset() {
+    return HX711::get_offset();
+}
\ No newline at end of file
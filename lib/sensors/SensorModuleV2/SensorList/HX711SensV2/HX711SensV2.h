@@ -0,0 +1,75 @@
+#pragma once
+
+#ifndef HX711_SENS_V2_H
+#define HX711_SENS_V2_H
+
+#pragma message("[COMPILED]: HX711SensV2.h")
+
+#include "Arduino.h"
+#include "../../SensorModule/SensorModuleV2.h"
+#include "HX711.h"
+
+enum HX711StateV2 {
+    HX711_STATE_IDLE = 0,
+    HX711_STATE_SETTLE = 1,
+    HX711_STATE_SAMPLE = 2
+};
+
+enum HX711JobV2 {
+    HX711_JOB_NONE = 0,
+    HX711_JOB_TARE = 1,
+    HX711_JOB_CALIBRATE = 2
+};
+
+class HX711SensV2 : public BaseSensV2, public HX711 {
+private:
+    uint8_t _doutPin;
+    uint8_t _sckPin;
+    float _format;
+    uint32_t _updateTimer;
+    uint32_t _updateInterval;
+    bool _lastUpdateStatus;
+
+    HX711StateV2 _state;
+    HX711JobV2 _job;
+    uint32_t _stateTimer;
+    uint32_t _settleTime;
+    int64_t _sampleSum;
+    uint8_t _sampleCount;
+    uint8_t _sampleTarget;
+    float _knownWeight;
+    bool _jobSucceeded;
+
+    bool startJob(HX711JobV2 job, uint8_t samples, uint32_t settleTime);
+    void finishJob();
+
+    using HX711::HX711;
+
+public:
+    HX711SensV2(uint8_t doutPin, uint8_t sckPin, float format = HX711SensV2::G);
+    virtual ~HX711SensV2();
+
+    bool init() override;
+    bool update() override;
+    bool isUpdated() const override;
+
+    void setUpdateInterval(uint32_t interval);
+    void setFormat(float format);
+    void setPins(uint8_t doutPin, uint8_t sckPin);
+
+    bool startTare(uint8_t samples = 10, uint32_t settleTime = 0);
+    bool startCalibration(float knownWeight, uint8_t samples = 10, uint32_t settleTime = 0);
+    void cancel();
+    bool isBusy() const;
+    bool isJobSucceeded() const;
+    HX711StateV2 getState() const;
+
+    float getCalibrationFactor();
+    long getTareOffset();
+
+    constexpr static const float G = 1.0;
+    constexpr static const float KG = 1000.0;
+    constexpr static const float POUND = 453.6;
+};
+
+#endif  // HX711_SENS_V2_H
\ No newline at end of file
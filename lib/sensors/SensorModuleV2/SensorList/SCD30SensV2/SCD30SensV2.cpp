@@ -0,0 +1,103 @@
+#include "SCD30SensV2.h"
+#include "Arduino.h"
+
+SCD30SensV2::SCD30SensV2(TwoWire *wire, uint8_t address)
+        : _wire(wire),
+          _address(address),
+          _ambientPressure(0),
+          _state(SCD30_STATE_BOOT),
+          _stateTimer(0),
+          _bootTime(2000),
+          _updateTimer(0),
+          _updateInterval(2000),
+          _lastUpdateStatus(false),
+          _error(NO_ERROR) {
+    addValueInfo("co2", "CO2", "ppm", 0, true);
+    addValueInfo("temp", "Temperature", "°C", 1, true);
+    addValueInfo("hum", "Humidity", "%", 1, true);
+}
+
+SCD30SensV2::~SCD30SensV2() = default;
+
+bool SCD30SensV2::init() {
+    _wire->begin();
+    SensirionI2cScd30::begin(*_wire, _address);
+    SensirionI2cScd30::stopPeriodicMeasurement();
+    _error = SensirionI2cScd30::softReset();
+
+    // the sensor needs ~2 s after a reset, update() waits it out
+    _state = SCD30_STATE_BOOT;
+    _stateTimer = millis();
+
+    updateValue("co2", 0.0f);
+    updateValue("temp", 0.0f);
+    updateValue("hum", 0.0f);
+    return _error == NO_ERROR;
+}
+
+bool SCD30SensV2::update() {
+    _lastUpdateStatus = false;
+    unsigned long currentTime = millis();
+
+    if (_state == SCD30_STATE_BOOT) {
+        if ((currentTime - _stateTimer) < _bootTime) return false;
+        if (!startMeasurement()) {
+            _stateTimer = currentTime;
+            return false;
+        }
+        _state = SCD30_STATE_MEASURE;
+        _updateTimer = currentTime;
+        return false;
+    }
+
+    if ((currentTime - _updateTimer) < _updateInterval) return false;
+    _updateTimer = currentTime;
+
+    uint16_t dataReady = 0;
+    _error = SensirionI2cScd30::getDataReady(dataReady);
+    if (_error != NO_ERROR || !dataReady) return false;
+
+    float co2 = 0.0f;
+    float temp = 0.0f;
+    float hum = 0.0f;
+    _error = SensirionI2cScd30::readMeasurementData(co2, temp, hum);
+    if (_error != NO_ERROR) return false;
+
+    updateValue("co2", co2);
+    updateValue("temp", temp);
+    updateValue("hum", hum);
+    _lastUpdateStatus = true;
+    return true;
+}
+
+bool SCD30SensV2::startMeasurement() {
+    uint8_t major = 0;
+    uint8_t minor = 0;
+    _error = SensirionI2cScd30::readFirmwareVersion(major, minor);
+    if (_error != NO_ERROR) return false;
+    _error = SensirionI2cScd30::startPeriodicMeasurement(_ambientPressure);
+    return _error == NO_ERROR;
+}
+
+bool SCD30SensV2::isUpdated() const {
+    return _lastUpdateStatus;
+}
+
+void SCD30SensV2::setUpdateInterval(uint32_t interval) {
+    _updateInterval = interval;
+}
+
+void SCD30SensV2::setAmbientPressure(uint16_t pressureMbar) {
+    _ambientPressure = pressureMbar;
+    if (_state == SCD30_STATE_MEASURE) {
+        _error = SensirionI2cScd30::startPeriodicMeasurement(_ambientPressure);
+    }
+}
+
+bool SCD30SensV2::isMeasuring() const {
+    return _state == SCD30_STATE_MEASURE;
+}
+
+int16_t SCD30SensV2::getLastError() const {
+    return _error;
+}
\ No newline at end of file
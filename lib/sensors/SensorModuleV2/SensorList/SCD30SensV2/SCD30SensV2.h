@@ -0,0 +1,50 @@
+#pragma once
+
+#ifndef SCD30_SENS_V2_H
+#define SCD30_SENS_V2_H
+
+#pragma message("[COMPILED]: SCD30SensV2.h")
+
+#include "Arduino.h"
+#include "../../SensorModule/SensorModuleV2.h"
+#include "SensirionI2cScd30.h"
+#include "Wire.h"
+
+enum SCD30StateV2 {
+    SCD30_STATE_BOOT = 0,
+    SCD30_STATE_MEASURE = 1
+};
+
+class SCD30SensV2 : public BaseSensV2, public SensirionI2cScd30 {
+private:
+    TwoWire *_wire;
+    uint8_t _address;
+    uint16_t _ambientPressure;
+
+    SCD30StateV2 _state;
+    uint32_t _stateTimer;
+    uint32_t _bootTime;
+    uint32_t _updateTimer;
+    uint32_t _updateInterval;
+    bool _lastUpdateStatus;
+    int16_t _error;
+
+    bool startMeasurement();
+
+    using SensirionI2cScd30::SensirionI2cScd30;
+
+public:
+    explicit SCD30SensV2(TwoWire *wire = &Wire, uint8_t address = SCD30_I2C_ADDR_61);
+    virtual ~SCD30SensV2();
+
+    bool init() override;
+    bool update() override;
+    bool isUpdated() const override;
+
+    void setUpdateInterval(uint32_t interval);
+    void setAmbientPressure(uint16_t pressureMbar);
+    bool isMeasuring() const;
+    int16_t getLastError() const;
+};
+
+#endif  // SCD30_SENS_V2_H
\ No newline at end of file
@@ -15,6 +15,7 @@ SensorCalibrationModuleV2::SensorCalibrationModuleV2()
           _lastCalibrationActivity(0),
           _autoSaveCalibration(true),
           _eepromStartAddress(0),
+          _recordStore(nullptr),
           _timeout(10000) {
 
     _entryCapacity = 16;
@@ -217,6 +218,7 @@ bool SensorCalibrationModuleV2::addCalibrationEntry(BaseSensV2 *sensor, const ch
 
     int eepromAddr = _eepromStartAddress + (_entryCount * 50);
     calibrator->setEEPROMAddress(eepromAddr);
+    calibrator->setRecordStore(_recordStore);
     calibrator->setSensorValueContext(sensor, valueKey);
     calibrator->setCompletedCallback(calibrationCompletedCallback, this);
 
@@ -448,6 +450,12 @@ CalibrationLoadResult SensorCalibrationModuleV2::loadAllCalibrationsWithStatus(i
 
             if (success) {
                 result.successCount++;
+            } else if (_recordStore) {
+                if (_recordStore->contains(addr)) {
+                    result.errorCount++;
+                } else {
+                    result.notCalibratedCount++;
+                }
             } else {
                 uint8_t calType = EEPROM.read(addr);
                 if (calType > CALIBRATION_MULTI_POINT) {
@@ -485,6 +493,16 @@ int SensorCalibrationModuleV2::getEEPROMStartAddress() const {
     return _eepromStartAddress;
 }
 
+void SensorCalibrationModuleV2::setRecordStore(RecordStore *store) {
+    _recordStore = store;
+
+    for (uint16_t i = 0; i < _entryCount; i++) {
+        if (_entries[i].isActive && _entries[i].calibrator) {
+            _entries[i].calibrator->setRecordStore(store);
+        }
+    }
+}
+
 void SensorCalibrationModuleV2::setCalibrationTimeout(unsigned long timeout) {
     _timeout = timeout;
 }
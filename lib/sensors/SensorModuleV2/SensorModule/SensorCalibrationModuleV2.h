@@ -43,6 +43,7 @@ private:
     uint32_t _lastCalibrationActivity;
     bool _autoSaveCalibration;
     int _eepromStartAddress;
+    RecordStore *_recordStore;
     unsigned long _timeout;
 
     void clearSerialBuffer() const;
@@ -127,6 +128,7 @@ public:
     bool getAutoSaveCalibration() const;
     void setEEPROMStartAddress(int address);
     int getEEPROMStartAddress() const;
+    void setRecordStore(RecordStore *store);
 
     void setCalibrationTimeout(unsigned long timeout);
     unsigned long getCalibrationTimeout() const;
@@ -723,6 +723,41 @@ void SensorModuleV2::setDefaultDebounceTime(uint32_t debounceTime) {
     _alertSystem->setDefaultDebounceTime(debounceTime);
 }
 
+void SensorModuleV2::setDeferredAlertDispatch(bool deferred) {
+    if (_alertSystem == nullptr) {
+        _alertSystem = new SensorAlertSystemV2();
+    }
+    _alertSystem->setDeferredDispatch(deferred);
+}
+
+void SensorModuleV2::setAlertNotifyOnClear(bool notify) {
+    if (_alertSystem == nullptr) {
+        _alertSystem = new SensorAlertSystemV2();
+    }
+    _alertSystem->setNotifyOnClear(notify);
+}
+
+uint8_t SensorModuleV2::dispatchAlerts(uint8_t maxEvents) {
+    if (_alertSystem == nullptr) {
+        return 0;
+    }
+    return _alertSystem->dispatchAlerts(maxEvents);
+}
+
+uint8_t SensorModuleV2::getPendingAlertCount() const {
+    if (_alertSystem == nullptr) {
+        return 0;
+    }
+    return _alertSystem->getPendingAlertCount();
+}
+
+uint32_t SensorModuleV2::getDroppedAlertCount() const {
+    if (_alertSystem == nullptr) {
+        return 0;
+    }
+    return _alertSystem->getDroppedAlertCount();
+}
+
 void SensorModuleV2::enableAlertSystem(bool enable) {
     if (enable) {
         if (_alertSystem == nullptr) {
@@ -232,6 +232,12 @@ public:
     void setDefaultHysteresis(uint32_t hysteresis);
     void setDefaultDebounceTime(uint32_t debounceTime);
 
+    void setDeferredAlertDispatch(bool deferred = true);
+    void setAlertNotifyOnClear(bool notify = true);
+    uint8_t dispatchAlerts(uint8_t maxEvents = 0);
+    uint8_t getPendingAlertCount() const;
+    uint32_t getDroppedAlertCount() const;
+
     void enableAlertSystem(bool enable = true);
     bool hasAlertSystem() const;
 
@@ -3,6 +3,10 @@
 
 SensorAlertSystemV2::SensorAlertSystemV2()
         : _thresholds(nullptr), _thresholdCount(0), _thresholdCapacity(0),
+          _handles(nullptr), _handleCapacity(0), _compiled(false),
+          _compiledSensorCount(0), _compiledDocument(nullptr),
+          _eventHead(0), _eventCount(0), _droppedEvents(0),
+          _deferredDispatch(false), _notifyOnClear(false),
           _globalCallback(nullptr), _sensorCallbacks(nullptr), _sensorCallbackNames(nullptr),
           _callbackCount(0), _callbackCapacity(0),
           _defaultHysteresis(5000), _defaultDebounceTime(0) {
@@ -21,7 +25,7 @@ bool SensorAlertSystemV2::setThreshold(const char *sensorName, const char *value
 
     int existingIndex = findThresholdIndex(sensorName, valueKey);
     if (existingIndex >= 0) {
-        AlertThreshold *threshold = _thresholds[existingIndex];
+        AlertThreshold *threshold = &_thresholds[existingIndex];
         threshold->lowThreshold = lowThreshold;
         threshold->highThreshold = highThreshold;
         threshold->type = type;
@@ -29,10 +33,28 @@ bool SensorAlertSystemV2::setThreshold(const char *sensorName, const char *value
         return true;
     }
 
-    AlertThreshold *newThreshold = new AlertThreshold();
+    if (_thresholdCount >= _thresholdCapacity) {
+        uint16_t newCapacity = _thresholdCapacity + 4;
+        AlertThreshold *newArray = (AlertThreshold *) realloc(_thresholds, newCapacity * sizeof(AlertThreshold));
+
+        if (!newArray) {
+            return false;
+        }
+
+        _thresholds = newArray;
+        _thresholdCapacity = newCapacity;
+    }
+
+    AlertThreshold *newThreshold = &_thresholds[_thresholdCount];
 
     newThreshold->sensorName = strdup(sensorName);
     newThreshold->valueKey = strdup(valueKey);
+    if (!newThreshold->sensorName || !newThreshold->valueKey) {
+        if (newThreshold->sensorName) free(newThreshold->sensorName);
+        if (newThreshold->valueKey) free(newThreshold->valueKey);
+        return false;
+    }
+
     newThreshold->lowThreshold = lowThreshold;
     newThreshold->highThreshold = highThreshold;
     newThreshold->type = type;
@@ -43,21 +65,11 @@ bool SensorAlertSystemV2::setThreshold(const char *sensorName, const char *value
     newThreshold->debounceTime = _defaultDebounceTime;
     newThreshold->conditionMetTime = 0;
     newThreshold->debouncing = false;
+    newThreshold->keyHash = hashKey(sensorName, valueKey);
+    newThreshold->callbackIndex = -1;
 
-    if (_thresholdCount >= _thresholdCapacity) {
-        uint16_t newCapacity = _thresholdCapacity + 4;
-        AlertThreshold **newArray = (AlertThreshold **) realloc(_thresholds, newCapacity * sizeof(AlertThreshold *));
-
-        if (!newArray) {
-            delete newThreshold;
-            return false;
-        }
-
-        _thresholds = newArray;
-        _thresholdCapacity = newCapacity;
-    }
-
-    _thresholds[_thresholdCount++] = newThreshold;
+    _thresholdCount++;
+    _compiled = false;
     return true;
 }
 
@@ -68,8 +80,8 @@ bool SensorAlertSystemV2::setThresholdParams(const char *sensorName, const char
         return false;
     }
 
-    _thresholds[index]->hysteresis = hysteresis;
-    _thresholds[index]->debounceTime = debounceTime;
+    _thresholds[index].hysteresis = hysteresis;
+    _thresholds[index].debounceTime = debounceTime;
     return true;
 }
 
@@ -79,20 +91,22 @@ bool SensorAlertSystemV2::removeThreshold(const char *sensorName, const char *va
         return false;
     }
 
-    cleanupThreshold(_thresholds[index]);
+    cleanupThreshold(&_thresholds[index]);
+    dropEvents(index);
 
     for (uint16_t i = index; i < _thresholdCount - 1; i++) {
         _thresholds[i] = _thresholds[i + 1];
     }
 
     _thresholdCount--;
+    _compiled = false;
     return true;
 }
 
 void SensorAlertSystemV2::removeAllThresholds() {
     if (_thresholds) {
         for (uint16_t i = 0; i < _thresholdCount; i++) {
-            cleanupThreshold(_thresholds[i]);
+            cleanupThreshold(&_thresholds[i]);
         }
 
         free(_thresholds);
@@ -100,6 +114,16 @@ void SensorAlertSystemV2::removeAllThresholds() {
         _thresholdCount = 0;
         _thresholdCapacity = 0;
     }
+
+    if (_handles) {
+        delete[] _handles;
+        _handles = nullptr;
+        _handleCapacity = 0;
+    }
+
+    _eventHead = 0;
+    _eventCount = 0;
+    _compiled = false;
 }
 
 AlertState SensorAlertSystemV2::getAlertState(const char *sensorName, const char *valueKey) {
@@ -108,7 +132,7 @@ AlertState SensorAlertSystemV2::getAlertState(const char *sensorName, const char
         return ALERT_INACTIVE;
     }
 
-    return _thresholds[index]->state;
+    return _thresholds[index].state;
 }
 
 bool SensorAlertSystemV2::isAlertActive(const char *sensorName, const char *valueKey) {
@@ -117,15 +141,15 @@ bool SensorAlertSystemV2::isAlertActive(const char *sensorName, const char *valu
 
 void SensorAlertSystemV2::acknowledgeAlert(const char *sensorName, const char *valueKey) {
     int index = findThresholdIndex(sensorName, valueKey);
-    if (index >= 0 && _thresholds[index]->state == ALERT_ACTIVE) {
-        _thresholds[index]->state = ALERT_ACKNOWLEDGED;
+    if (index >= 0 && _thresholds[index].state == ALERT_ACTIVE) {
+        _thresholds[index].state = ALERT_ACKNOWLEDGED;
     }
 }
 
 void SensorAlertSystemV2::acknowledgeAllAlerts() {
     for (uint16_t i = 0; i < _thresholdCount; i++) {
-        if (_thresholds[i]->state == ALERT_ACTIVE) {
-            _thresholds[i]->state = ALERT_ACKNOWLEDGED;
+        if (_thresholds[i].state == ALERT_ACTIVE) {
+            _thresholds[i].state = ALERT_ACKNOWLEDGED;
         }
     }
 }
@@ -133,21 +157,21 @@ void SensorAlertSystemV2::acknowledgeAllAlerts() {
 void SensorAlertSystemV2::resetAlert(const char *sensorName, const char *valueKey) {
     int index = findThresholdIndex(sensorName, valueKey);
     if (index >= 0) {
-        _thresholds[index]->state = ALERT_INACTIVE;
-        _thresholds[index]->lastTriggeredTime = 0;
-        _thresholds[index]->repeatCount = 0;
-        _thresholds[index]->conditionMetTime = 0;
-        _thresholds[index]->debouncing = false;
+        _thresholds[index].state = ALERT_INACTIVE;
+        _thresholds[index].lastTriggeredTime = 0;
+        _thresholds[index].repeatCount = 0;
+        _thresholds[index].conditionMetTime = 0;
+        _thresholds[index].debouncing = false;
     }
 }
 
 void SensorAlertSystemV2::resetAllAlerts() {
     for (uint16_t i = 0; i < _thresholdCount; i++) {
-        _thresholds[i]->state = ALERT_INACTIVE;
-        _thresholds[i]->lastTriggeredTime = 0;
-        _thresholds[i]->repeatCount = 0;
-        _thresholds[i]->conditionMetTime = 0;
-        _thresholds[i]->debouncing = false;
+        _thresholds[i].state = ALERT_INACTIVE;
+        _thresholds[i].lastTriggeredTime = 0;
+        _thresholds[i].repeatCount = 0;
+        _thresholds[i].conditionMetTime = 0;
+        _thresholds[i].debouncing = false;
     }
 }
 
@@ -169,13 +193,15 @@ bool SensorAlertSystemV2::setSensorAlertCallback(const char *sensorName, AlertCa
     if (_callbackCount >= _callbackCapacity) {
         uint16_t newCapacity = _callbackCapacity + 4;
         AlertCallback *newCallbacks = (AlertCallback *) realloc(_sensorCallbacks, newCapacity * sizeof(AlertCallback));
-        char **newNames = (char **) realloc(_sensorCallbackNames, newCapacity * sizeof(char *));
-
-        if (!newCallbacks || !newNames) {
+        if (!newCallbacks) {
             return false;
         }
-
         _sensorCallbacks = newCallbacks;
+
+        char **newNames = (char **) realloc(_sensorCallbackNames, newCapacity * sizeof(char *));
+        if (!newNames) {
+            return false;
+        }
         _sensorCallbackNames = newNames;
         _callbackCapacity = newCapacity;
     }
@@ -184,6 +210,7 @@ bool SensorAlertSystemV2::setSensorAlertCallback(const char *sensorName, AlertCa
     _sensorCallbackNames[_callbackCount] = strdup(sensorName);
     _callbackCount++;
 
+    _compiled = false;
     return true;
 }
 
@@ -208,6 +235,10 @@ void SensorAlertSystemV2::clearCallbacks() {
 
     _callbackCount = 0;
     _callbackCapacity = 0;
+
+    for (uint16_t i = 0; i < _thresholdCount; i++) {
+        _thresholds[i].callbackIndex = -1;
+    }
 }
 
 void SensorAlertSystemV2::setDefaultHysteresis(uint32_t hysteresis) {
@@ -218,38 +249,101 @@ void SensorAlertSystemV2::setDefaultDebounceTime(uint32_t debounceTime) {
     _defaultDebounceTime = debounceTime;
 }
 
+void SensorAlertSystemV2::setDeferredDispatch(bool deferred) {
+    _deferredDispatch = deferred;
+}
+
+bool SensorAlertSystemV2::isDeferredDispatch() const {
+    return _deferredDispatch;
+}
+
+void SensorAlertSystemV2::setNotifyOnClear(bool notify) {
+    _notifyOnClear = notify;
+}
+
 void SensorAlertSystemV2::checkAlerts(SensorModuleV2 *module) {
     if (!module || !_thresholds || _thresholdCount == 0) {
         return;
     }
 
-    for (uint16_t i = 0; i < _thresholdCount; i++) {
-        AlertThreshold *threshold = _thresholds[i];
-        BaseSensV2 *sensor = module->getSensorByName(threshold->sensorName);
+    if (!_compiled ||
+        _compiledSensorCount != module->getSensorCount() ||
+        _compiledDocument != module->getDocument()) {
+        if (!compile(module)) return;
+    }
 
-        if (sensor) {
-            float value = sensor->getFloatValue(threshold->valueKey);
-            checkThresholdCondition(threshold, sensor, value);
+    uint32_t currentTime = millis();
+    for (uint16_t i = 0; i < _thresholdCount; i++) {
+        if (_handles[i].isNull() && !resolveHandle(module, i)) {
+            continue;
         }
+        checkThresholdCondition(i, _handles[i].as<float>(), currentTime);
+    }
+
+    if (!_deferredDispatch) {
+        dispatchAlerts();
+    }
+}
+
+uint8_t SensorAlertSystemV2::dispatchAlerts(uint8_t maxEvents) {
+    uint8_t dispatched = 0;
+
+    while (_eventCount > 0 && (maxEvents == 0 || dispatched < maxEvents)) {
+        AlertEvent event = _events[_eventHead];
+        _eventHead = (_eventHead + 1) % ALERT_EVENT_QUEUE_SIZE;
+        _eventCount--;
+
+        const AlertThreshold &threshold = _thresholds[event.thresholdIndex];
+
+        AlertInfo info;
+        info.sensorName = threshold.sensorName;
+        info.valueKey = threshold.valueKey;
+        info.currentValue = event.value;
+        info.lowThreshold = threshold.lowThreshold;
+        info.highThreshold = threshold.highThreshold;
+        info.type = threshold.type;
+        info.state = event.state;
+        info.timeTriggered = event.time;
+        info.repeatCount = event.repeatCount;
+
+        callCallbacks(info, threshold.callbackIndex);
+        dispatched++;
     }
+
+    return dispatched;
+}
+
+uint8_t SensorAlertSystemV2::getPendingAlertCount() const {
+    return _eventCount;
+}
+
+uint32_t SensorAlertSystemV2::getDroppedAlertCount() const {
+    return _droppedEvents;
+}
+
+void SensorAlertSystemV2::invalidate() {
+    _compiled = false;
 }
 
 void SensorAlertSystemV2::cleanupThreshold(AlertThreshold *threshold) {
     if (threshold) {
         if (threshold->sensorName) free(threshold->sensorName);
         if (threshold->valueKey) free(threshold->valueKey);
-        delete threshold;
+        threshold->sensorName = nullptr;
+        threshold->valueKey = nullptr;
     }
 }
 
 int SensorAlertSystemV2::findThresholdIndex(const char *sensorName, const char *valueKey) {
-    if (!_thresholds) {
+    if (!_thresholds || !sensorName || !valueKey) {
         return -1;
     }
 
+    uint32_t keyHash = hashKey(sensorName, valueKey);
     for (uint16_t i = 0; i < _thresholdCount; i++) {
-        if (strcmp(_thresholds[i]->sensorName, sensorName) == 0 &&
-            strcmp(_thresholds[i]->valueKey, valueKey) == 0) {
+        if (_thresholds[i].keyHash == keyHash &&
+            strcmp(_thresholds[i].sensorName, sensorName) == 0 &&
+            strcmp(_thresholds[i].valueKey, valueKey) == 0) {
             return i;
         }
     }
@@ -257,7 +351,43 @@ int SensorAlertSystemV2::findThresholdIndex(const char *sensorName, const char *
     return -1;
 }
 
-void SensorAlertSystemV2::checkThresholdCondition(AlertThreshold *threshold, BaseSensV2* /*sensor*/, float value) {
+bool SensorAlertSystemV2::compile(SensorModuleV2 *module) {
+    if (_handleCapacity < _thresholdCount) {
+        JsonVariant *newHandles = new JsonVariant[_thresholdCapacity];
+        if (!newHandles) {
+            return false;
+        }
+
+        if (_handles) delete[] _handles;
+        _handles = newHandles;
+        _handleCapacity = _thresholdCapacity;
+    }
+
+    for (uint16_t i = 0; i < _thresholdCount; i++) {
+        _handles[i] = JsonVariant();
+        resolveHandle(module, i);
+        _thresholds[i].callbackIndex = (int16_t) findCallbackIndex(_thresholds[i].sensorName);
+    }
+
+    _compiledSensorCount = module->getSensorCount();
+    _compiledDocument = module->getDocument();
+    _compiled = true;
+    return true;
+}
+
+bool SensorAlertSystemV2::resolveHandle(SensorModuleV2 *module, uint16_t index) {
+    BaseSensV2 *sensor = module->getSensorByName(_thresholds[index].sensorName);
+    if (!sensor) {
+        return false;
+    }
+
+    // the document keeps a value in the same slot across updateValue(), so the variant stays valid
+    _handles[index] = sensor->getVariant(_thresholds[index].valueKey);
+    return !_handles[index].isNull();
+}
+
+void SensorAlertSystemV2::checkThresholdCondition(uint16_t index, float value, uint32_t currentTime) {
+    AlertThreshold *threshold = &_thresholds[index];
     bool conditionMet = false;
 
     switch (threshold->type) {
@@ -278,84 +408,78 @@ void SensorAlertSystemV2::checkThresholdCondition(AlertThreshold *threshold, Bas
             break;
     }
 
-    uint32_t currentTime = millis();
-    
-    bool timeValid = true;
-    if (threshold->lastTriggeredTime > 0 && currentTime < threshold->lastTriggeredTime) {
-        timeValid = false;
-    }
-    if (threshold->conditionMetTime > 0 && currentTime < threshold->conditionMetTime) {
-        timeValid = false;
-    }
+    bool hysteresisElapsed = threshold->lastTriggeredTime == 0 ||
+                             currentTime - threshold->lastTriggeredTime >= threshold->hysteresis;
 
     if (threshold->debounceTime > 0) {
         if (conditionMet && !threshold->debouncing) {
             threshold->debouncing = true;
             threshold->conditionMetTime = currentTime;
-        } else if (conditionMet && threshold->debouncing && timeValid) {
-            uint32_t elapsed = currentTime >= threshold->conditionMetTime ? 
-                currentTime - threshold->conditionMetTime : 
-                (0xFFFFFFFF - threshold->conditionMetTime) + currentTime + 1;
-            
-            if (elapsed >= threshold->debounceTime) {
-                uint32_t hysteresisElapsed = threshold->lastTriggeredTime == 0 ? 
-                    threshold->hysteresis : 
-                    (currentTime >= threshold->lastTriggeredTime ? 
-                        currentTime - threshold->lastTriggeredTime : 
-                        (0xFFFFFFFF - threshold->lastTriggeredTime) + currentTime + 1);
-                
-                if (threshold->state != ALERT_ACTIVE &&
-                    (threshold->lastTriggeredTime == 0 || hysteresisElapsed >= threshold->hysteresis)) {
-                    triggerAlert(threshold, value);
-                }
+        } else if (conditionMet) {
+            if (currentTime - threshold->conditionMetTime >= threshold->debounceTime &&
+                threshold->state != ALERT_ACTIVE && hysteresisElapsed) {
+                triggerAlert(index, value, currentTime);
             }
-        } else if (!conditionMet) {
+        } else {
             threshold->debouncing = false;
         }
     } else {
-        uint32_t hysteresisElapsed = threshold->lastTriggeredTime == 0 ? 
-            threshold->hysteresis : 
-            (timeValid && currentTime >= threshold->lastTriggeredTime ? 
-                currentTime - threshold->lastTriggeredTime : 
-                (0xFFFFFFFF - threshold->lastTriggeredTime) + currentTime + 1);
-        
-        if (conditionMet &&
-            threshold->state != ALERT_ACTIVE &&
-            (threshold->lastTriggeredTime == 0 || hysteresisElapsed >= threshold->hysteresis)) {
-            triggerAlert(threshold, value);
+        if (conditionMet && threshold->state != ALERT_ACTIVE && hysteresisElapsed) {
+            triggerAlert(index, value, currentTime);
         } else if (!conditionMet && threshold->state == ALERT_ACTIVE) {
             threshold->state = ALERT_INACTIVE;
+            if (_notifyOnClear) {
+                pushEvent(index, ALERT_INACTIVE, value, currentTime);
+            }
         }
     }
 }
 
-void SensorAlertSystemV2::triggerAlert(AlertThreshold *threshold, float value) {
+void SensorAlertSystemV2::triggerAlert(uint16_t index, float value, uint32_t currentTime) {
+    AlertThreshold *threshold = &_thresholds[index];
     threshold->state = ALERT_ACTIVE;
-    threshold->lastTriggeredTime = millis();
+    threshold->lastTriggeredTime = currentTime;
     threshold->repeatCount++;
 
-    AlertInfo info;
-    info.sensorName = threshold->sensorName;
-    info.valueKey = threshold->valueKey;
-    info.currentValue = value;
-    info.lowThreshold = threshold->lowThreshold;
-    info.highThreshold = threshold->highThreshold;
-    info.type = threshold->type;
-    info.state = ALERT_ACTIVE;
-    info.timeTriggered = threshold->lastTriggeredTime;
-    info.repeatCount = threshold->repeatCount;
+    pushEvent(index, ALERT_ACTIVE, value, currentTime);
+}
 
-    callCallbacks(info);
+void SensorAlertSystemV2::pushEvent(uint16_t index, AlertState state, float value, uint32_t currentTime) {
+    if (_eventCount >= ALERT_EVENT_QUEUE_SIZE) {
+        _droppedEvents++;
+        return;
+    }
+
+    AlertEvent &event = _events[(_eventHead + _eventCount) % ALERT_EVENT_QUEUE_SIZE];
+    event.thresholdIndex = index;
+    event.state = state;
+    event.value = value;
+    event.time = currentTime;
+    event.repeatCount = _thresholds[index].repeatCount;
+    _eventCount++;
 }
 
-void SensorAlertSystemV2::callCallbacks(AlertInfo info) {
+void SensorAlertSystemV2::dropEvents(uint16_t index) {
+    uint8_t kept = 0;
+
+    for (uint8_t i = 0; i < _eventCount; i++) {
+        AlertEvent event = _events[(_eventHead + i) % ALERT_EVENT_QUEUE_SIZE];
+        if (event.thresholdIndex == index) continue;
+        if (event.thresholdIndex > index) event.thresholdIndex--;
+        _events[(_eventHead + kept) % ALERT_EVENT_QUEUE_SIZE] = event;
+        kept++;
+    }
+
+    _eventCount = kept;
+}
+
+void SensorAlertSystemV2::callCallbacks(const AlertInfo &info, int16_t callbackIndex) {
     if (_globalCallback) {
         _globalCallback(info);
     }
 
-    int index = findCallbackIndex(info.sensorName);
-    if (index >= 0 && _sensorCallbacks[index]) {
-        _sensorCallbacks[index](info);
+    if (callbackIndex >= 0 && callbackIndex < _callbackCount && _sensorCallbacks[callbackIndex]) {
+        _sensorCallbacks[callbackIndex](info);
     }
 }
 
@@ -371,4 +495,18 @@ int SensorAlertSystemV2::findCallbackIndex(const char *sensorName) {
     }
 
     return -1;
+}
+
+uint32_t SensorAlertSystemV2::hashKey(const char *sensorName, const char *valueKey) {
+    uint32_t hash = 2166136261UL;  // FNV-1a over "sensor\0key"
+    while (*sensorName) {
+        hash ^= (uint8_t) *sensorName++;
+        hash *= 16777619UL;
+    }
+    hash *= 16777619UL;
+    while (*valueKey) {
+        hash ^= (uint8_t) *valueKey++;
+        hash *= 16777619UL;
+    }
+    return hash;
 }
\ No newline at end of file
@@ -2,6 +2,15 @@
 #define SENSOR_ALERT_SYSTEM_V2_H
 
 #include "Arduino.h"
+#include "ArduinoJson.h"
+
+#ifndef ALERT_EVENT_QUEUE_SIZE
+#if defined(__AVR__)
+#define ALERT_EVENT_QUEUE_SIZE 8
+#else
+#define ALERT_EVENT_QUEUE_SIZE 32
+#endif
+#endif
 
 enum AlertType {
     ALERT_ABOVE,
@@ -43,6 +52,16 @@ struct AlertThreshold {
     uint32_t debounceTime;
     uint32_t conditionMetTime;
     bool debouncing;
+    uint32_t keyHash;
+    int16_t callbackIndex;
+};
+
+struct AlertEvent {
+    uint16_t thresholdIndex;
+    AlertState state;
+    float value;
+    uint32_t time;
+    uint8_t repeatCount;
 };
 
 class SensorModuleV2;
@@ -51,10 +70,23 @@ class BaseSensV2;
 
 class SensorAlertSystemV2 {
 private:
-    AlertThreshold **_thresholds;
+    AlertThreshold *_thresholds;
     uint16_t _thresholdCount;
     uint16_t _thresholdCapacity;
 
+    JsonVariant *_handles;
+    uint16_t _handleCapacity;
+    bool _compiled;
+    uint8_t _compiledSensorCount;
+    JsonDocument *_compiledDocument;
+
+    AlertEvent _events[ALERT_EVENT_QUEUE_SIZE];
+    uint8_t _eventHead;
+    uint8_t _eventCount;
+    uint32_t _droppedEvents;
+    bool _deferredDispatch;
+    bool _notifyOnClear;
+
     AlertCallback _globalCallback;
     AlertCallback *_sensorCallbacks;
     char **_sensorCallbackNames;
@@ -66,11 +98,17 @@ private:
 
     void cleanupThreshold(AlertThreshold *threshold);
     int findThresholdIndex(const char *sensorName, const char *valueKey);
-    void checkThresholdCondition(AlertThreshold *threshold, BaseSensV2 *sensor, float value);
-    void triggerAlert(AlertThreshold *threshold, float value);
-    void callCallbacks(AlertInfo info);
+    bool compile(SensorModuleV2 *module);
+    bool resolveHandle(SensorModuleV2 *module, uint16_t index);
+    void checkThresholdCondition(uint16_t index, float value, uint32_t currentTime);
+    void triggerAlert(uint16_t index, float value, uint32_t currentTime);
+    void pushEvent(uint16_t index, AlertState state, float value, uint32_t currentTime);
+    void dropEvents(uint16_t index);
+    void callCallbacks(const AlertInfo &info, int16_t callbackIndex);
     int findCallbackIndex(const char *sensorName);
 
+    static uint32_t hashKey(const char *sensorName, const char *valueKey);
+
 public:
     SensorAlertSystemV2();
     ~SensorAlertSystemV2();
@@ -100,7 +138,15 @@ public:
     void setDefaultHysteresis(uint32_t hysteresis);
     void setDefaultDebounceTime(uint32_t debounceTime);
 
+    void setDeferredDispatch(bool deferred = true);
+    bool isDeferredDispatch() const;
+    void setNotifyOnClear(bool notify = true);
+
     void checkAlerts(SensorModuleV2 *module);
+    uint8_t dispatchAlerts(uint8_t maxEvents = 0);
+    uint8_t getPendingAlertCount() const;
+    uint32_t getDroppedAlertCount() const;
+    void invalidate();
 };
 
 #endif
\ No newline at end of file
@@ -4,7 +4,10 @@ CalibrationEngine::CalibrationEngine()
     : _calibPoints(nullptr), _maxCalibPoints(10), _numCalibPoints(0),
       _calibrationType(CALIBRATION_NONE), _isCalibrated(false),
       _scale(1.0f), _slope(1.0f), _offset(0.0f),
-      _interpolationMethod(0), _polynomialDegree(2), _polynomialCoeffs(nullptr) {
+      _interpolationMethod(0), _polynomialDegree(2), _polynomialCoeffs(nullptr),
+      _compiledForm(CALIBRATION_FORM_IDENTITY), _gain(1.0f), _bias(0.0f),
+      _fitDegree(0), _fitCenter(0.0f), _fitInvSpan(1.0f), _segments(nullptr), _segmentCount(0),
+      _lutMin(0.0f), _lutMax(0.0f), _lutInvStep(0.0f), _lutFirstValue(0.0f), _lutLastValue(0.0f) {
     initializeBuffers();
 }
 
@@ -40,7 +43,7 @@ bool CalibrationEngine::calibrateOnePoint(float knownValue, float rawValue) {
     _calibrationType = CALIBRATION_ONE_POINT;
     _scale = knownValue / rawValue;
     _isCalibrated = true;
-    return true;
+    return compile();
 }
 
 bool CalibrationEngine::calibrateTwoPoint(float knownValue1, float rawValue1, float knownValue2, float rawValue2) {
@@ -50,7 +53,7 @@ bool CalibrationEngine::calibrateTwoPoint(float knownValue1, float rawValue1, fl
         _slope = (knownValue2 - knownValue1) / (rawValue2 - rawValue1);
         _offset = knownValue1 - _slope * rawValue1;
         _isCalibrated = true;
-        return true;
+        return compile();
     }
     return false;
 }
@@ -59,6 +62,8 @@ void CalibrationEngine::startCalibration(uint8_t calibrationType) {
     _calibrationType = calibrationType;
     _numCalibPoints = 0;
     _isCalibrated = false;
+    _fitDegree = 0;
+    resetCompiled();
 }
 
 bool CalibrationEngine::addCalibrationPoint(float knownValue, float rawValue) {
@@ -86,18 +91,54 @@ bool CalibrationEngine::calculateCalibration() {
                 _calibPoints[1].knownValue, _calibPoints[1].rawValue
             );
         }
-    } else {
-        return calculatePolynomialRegression();
+    } else if (!calculatePolynomialRegression()) {
+        return false;
     }
     
     _isCalibrated = true;
-    return true;
+    return compile();
+}
+
+bool CalibrationEngine::compile() {
+    resetCompiled();
+    if (!_isCalibrated) {
+        return false;
+    }
+
+    switch (_calibrationType) {
+        case CALIBRATION_ONE_POINT:
+            _gain = _scale;
+            _bias = 0.0f;
+            _compiledForm = CALIBRATION_FORM_LINEAR;
+            return true;
+
+        case CALIBRATION_TWO_POINT:
+            _gain = _slope;
+            _bias = _offset;
+            _compiledForm = CALIBRATION_FORM_LINEAR;
+            return true;
+
+        case CALIBRATION_MULTI_POINT:
+            if (_interpolationMethod == 0) {
+                return compilePiecewise();
+            }
+            if (_fitDegree == 0) {
+                return false;
+            }
+            _compiledForm = CALIBRATION_FORM_HORNER;
+            return true;
+
+        default:
+            return false;
+    }
 }
 
 void CalibrationEngine::cancelCalibration() {
     _numCalibPoints = 0;
     _isCalibrated = false;
     _calibrationType = CALIBRATION_NONE;
+    _fitDegree = 0;
+    resetCompiled();
 }
 
 bool CalibrationEngine::clearCalibrationPoints() {
@@ -107,28 +148,38 @@ bool CalibrationEngine::clearCalibrationPoints() {
     _scale = 1.0f;
     _slope = 1.0f;
     _offset = 0.0f;
+    _fitDegree = 0;
+    resetCompiled();
     return true;
 }
 
 float CalibrationEngine::readCalibratedValue(float rawValue) {
-    if (!_isCalibrated) {
-        return rawValue;
-    }
-    
-    switch (_calibrationType) {
-        case CALIBRATION_ONE_POINT:
-            return rawValue * _scale;
-            
-        case CALIBRATION_TWO_POINT:
-            return _slope * rawValue + _offset;
-            
-        case CALIBRATION_MULTI_POINT:
-            if (_interpolationMethod == 0) {
-                return linearInterpolate(rawValue);
-            } else {
-                return polynomialInterpolate(rawValue);
+    switch (_compiledForm) {
+        case CALIBRATION_FORM_LINEAR:
+            return _gain * rawValue + _bias;
+
+        case CALIBRATION_FORM_HORNER: {
+            float t = (rawValue - _fitCenter) * _fitInvSpan;
+            float result = _hornerCoeffs[_fitDegree];
+            for (int8_t i = _fitDegree - 1; i >= 0; i--) {
+                result = result * t + _hornerCoeffs[i];
             }
-            
+            return result;
+        }
+
+        case CALIBRATION_FORM_LUT: {
+            if (rawValue <= _lutMin) return _lutFirstValue;
+            if (rawValue >= _lutMax) return _lutLastValue;
+            uint16_t bucket = (uint16_t) ((rawValue - _lutMin) * _lutInvStep);
+            if (bucket >= CALIBRATION_LUT_SIZE) bucket = CALIBRATION_LUT_SIZE - 1;
+            // a bucket starts at the segment covering its left edge, breakpoints inside it are rare
+            uint8_t segment = _lutSegment[bucket];
+            while (segment + 1 < _segmentCount && rawValue > _segments[segment].end) {
+                segment++;
+            }
+            return _segments[segment].slope * rawValue + _segments[segment].intercept;
+        }
+
         default:
             return rawValue;
     }
@@ -170,11 +221,18 @@ uint8_t CalibrationEngine::getPolynomialDegree() const {
     return _polynomialDegree;
 }
 
+uint8_t CalibrationEngine::getCompiledForm() const {
+    return _compiledForm;
+}
+
 void CalibrationEngine::initializeBuffers() {
     cleanupMemory();
     
     _calibPoints = new CalibrationPoint[_maxCalibPoints];
+    _segments = new CalibrationSegment[_maxCalibPoints];
     _polynomialCoeffs = new float[_polynomialDegree + 1];
+    _fitDegree = 0;
+    resetCompiled();
     
     for (uint8_t i = 0; i <= _polynomialDegree; i++) {
         _polynomialCoeffs[i] = 0.0f;
@@ -186,49 +244,178 @@ void CalibrationEngine::cleanupMemory() {
         delete[] _calibPoints;
         _calibPoints = nullptr;
     }
+    if (_segments) {
+        delete[] _segments;
+        _segments = nullptr;
+    }
     if (_polynomialCoeffs) {
         delete[] _polynomialCoeffs;
         _polynomialCoeffs = nullptr;
     }
 }
 
-float CalibrationEngine::linearInterpolate(float rawValue) {
-    if (_numCalibPoints < 2) {
-        return rawValue;
+void CalibrationEngine::resetCompiled() {
+    _compiledForm = CALIBRATION_FORM_IDENTITY;
+    _segmentCount = 0;
+}
+
+bool CalibrationEngine::compilePiecewise() {
+    if (!_segments || _numCalibPoints < 2) {
+        return false;
     }
-    
-    for (uint8_t i = 0; i < _numCalibPoints - 1; i++) {
-        if (rawValue >= _calibPoints[i].rawValue && rawValue <= _calibPoints[i + 1].rawValue) {
-            float ratio = (rawValue - _calibPoints[i].rawValue) / 
-                         (_calibPoints[i + 1].rawValue - _calibPoints[i].rawValue);
-            return _calibPoints[i].knownValue + 
-                   ratio * (_calibPoints[i + 1].knownValue - _calibPoints[i].knownValue);
+
+    uint8_t last = _numCalibPoints - 1;
+    _lutMin = _calibPoints[0].rawValue;
+    _lutMax = _calibPoints[last].rawValue;
+    if (_lutMax <= _lutMin) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < last; i++) {
+        float dx = _calibPoints[i + 1].rawValue - _calibPoints[i].rawValue;
+        float dy = _calibPoints[i + 1].knownValue - _calibPoints[i].knownValue;
+        if (dx == 0.0f) {
+            _segments[i].slope = 0.0f;
+            _segments[i].intercept = _calibPoints[i + 1].knownValue;
+        } else {
+            _segments[i].slope = dy / dx;
+            _segments[i].intercept = _calibPoints[i].knownValue - _segments[i].slope * _calibPoints[i].rawValue;
         }
+        _segments[i].end = _calibPoints[i + 1].rawValue;
     }
-    
-    if (rawValue < _calibPoints[0].rawValue) {
-        return _calibPoints[0].knownValue;
+    _segmentCount = last;
+
+    _lutInvStep = CALIBRATION_LUT_SIZE / (_lutMax - _lutMin);
+    _lutFirstValue = _calibPoints[0].knownValue;
+    _lutLastValue = _calibPoints[last].knownValue;
+
+    uint8_t segment = 0;
+    for (uint16_t bucket = 0; bucket < CALIBRATION_LUT_SIZE; bucket++) {
+        float start = _lutMin + bucket / _lutInvStep;
+        while (segment + 1 < _segmentCount && start > _segments[segment].end) {
+            segment++;
+        }
+        _lutSegment[bucket] = segment;
     }
-    return _calibPoints[_numCalibPoints - 1].knownValue;
+
+    _compiledForm = CALIBRATION_FORM_LUT;
+    return true;
 }
 
-float CalibrationEngine::polynomialInterpolate(float rawValue) {
-    if (!_polynomialCoeffs) {
-        return rawValue;
+bool CalibrationEngine::calculatePolynomialRegression() {
+    if (_numCalibPoints < 2 || !_polynomialCoeffs) {
+        return false;
     }
-    
-    float result = 0.0f;
-    float xPower = 1.0f;
-    
+
+    uint8_t degree = _polynomialDegree < _numCalibPoints - 1 ? _polynomialDegree : _numCalibPoints - 1;
+    uint8_t cols = degree + 1;
+    float minRaw = _calibPoints[0].rawValue;
+    float maxRaw = _calibPoints[_numCalibPoints - 1].rawValue;
+    if (maxRaw <= minRaw) {
+        return false;
+    }
+
+    // fit in t = (x - center) / halfSpan, keeps the Vandermonde columns well conditioned in float
+    float center = 0.5f * (minRaw + maxRaw);
+    float invSpan = 2.0f / (maxRaw - minRaw);
+
+    float *matrix = new float[_numCalibPoints * cols];
+    float *target = new float[_numCalibPoints];
+    for (uint8_t i = 0; i < _numCalibPoints; i++) {
+        float t = (_calibPoints[i].rawValue - center) * invSpan;
+        float power = 1.0f;
+        for (uint8_t j = 0; j < cols; j++) {
+            matrix[i * cols + j] = power;
+            power *= t;
+        }
+        target[i] = _calibPoints[i].knownValue;
+    }
+
+    float solution[CALIBRATION_MAX_POLYNOMIAL_DEGREE + 1];
+    bool solved = solveLeastSquares(matrix, target, _numCalibPoints, cols, solution);
+    delete[] matrix;
+    delete[] target;
+    if (!solved) {
+        return false;
+    }
+
+    _fitDegree = degree;
+    _fitCenter = center;
+    _fitInvSpan = invSpan;
+    for (uint8_t j = 0; j < cols; j++) {
+        _hornerCoeffs[j] = solution[j];
+    }
+
+    // expand back to raw-domain monomials for getPolynomialCoeffs()
+    float shift = -center * invSpan;
     for (uint8_t i = 0; i <= _polynomialDegree; i++) {
-        result += _polynomialCoeffs[i] * xPower;
-        xPower *= rawValue;
+        _polynomialCoeffs[i] = 0.0f;
     }
-    
-    return result;
+    _polynomialCoeffs[0] = solution[degree];
+    for (int8_t k = degree - 1; k >= 0; k--) {
+        for (int8_t j = degree - k; j >= 0; j--) {
+            float carried = j > 0 ? _polynomialCoeffs[j - 1] * invSpan : 0.0f;
+            _polynomialCoeffs[j] = carried + _polynomialCoeffs[j] * shift;
+        }
+        _polynomialCoeffs[0] += solution[k];
+    }
+    return true;
 }
 
-bool CalibrationEngine::calculatePolynomialRegression() {
+bool CalibrationEngine::solveLeastSquares(float *matrix, float *target, uint8_t rows, uint8_t cols, float *solution) {
+    if (rows < cols) {
+        return false;
+    }
+
+    // householder QR in place, R above the diagonal, reflectors below
+    float diagonal[CALIBRATION_MAX_POLYNOMIAL_DEGREE + 1];
+    for (uint8_t k = 0; k < cols; k++) {
+        float norm = 0.0f;
+        for (uint8_t i = k; i < rows; i++) {
+            norm += matrix[i * cols + k] * matrix[i * cols + k];
+        }
+        norm = sqrtf(norm);
+        if (norm < 1e-5f) {
+            return false;
+        }
+
+        float alpha = matrix[k * cols + k] > 0.0f ? -norm : norm;
+        matrix[k * cols + k] -= alpha;
+        diagonal[k] = alpha;
+
+        float reflectorNorm = 0.0f;
+        for (uint8_t i = k; i < rows; i++) {
+            reflectorNorm += matrix[i * cols + k] * matrix[i * cols + k];
+        }
+
+        for (uint8_t j = k + 1; j < cols; j++) {
+            float dot = 0.0f;
+            for (uint8_t i = k; i < rows; i++) {
+                dot += matrix[i * cols + k] * matrix[i * cols + j];
+            }
+            float factor = 2.0f * dot / reflectorNorm;
+            for (uint8_t i = k; i < rows; i++) {
+                matrix[i * cols + j] -= factor * matrix[i * cols + k];
+            }
+        }
+
+        float dot = 0.0f;
+        for (uint8_t i = k; i < rows; i++) {
+            dot += matrix[i * cols + k] * target[i];
+        }
+        float factor = 2.0f * dot / reflectorNorm;
+        for (uint8_t i = k; i < rows; i++) {
+            target[i] -= factor * matrix[i * cols + k];
+        }
+    }
+
+    for (int8_t k = cols - 1; k >= 0; k--) {
+        float sum = target[k];
+        for (uint8_t j = k + 1; j < cols; j++) {
+            sum -= matrix[k * cols + j] * solution[j];
+        }
+        solution[k] = sum / diagonal[k];
+    }
     return true;
 }
 
@@ -8,6 +8,21 @@
 #define CALIBRATION_TWO_POINT 2
 #define CALIBRATION_MULTI_POINT 3
 
+#define CALIBRATION_FORM_IDENTITY 0
+#define CALIBRATION_FORM_LINEAR 1
+#define CALIBRATION_FORM_HORNER 2
+#define CALIBRATION_FORM_LUT 3
+
+#define CALIBRATION_MAX_POLYNOMIAL_DEGREE 6
+
+#ifndef CALIBRATION_LUT_SIZE
+#if defined(__AVR__)
+#define CALIBRATION_LUT_SIZE 16
+#else
+#define CALIBRATION_LUT_SIZE 64
+#endif
+#endif
+
 class CalibrationEngine {
 public:
     struct CalibrationPoint {
@@ -15,6 +30,12 @@ public:
         float knownValue;
     };
 
+    struct CalibrationSegment {
+        float slope;
+        float intercept;
+        float end;
+    };
+
     CalibrationEngine();
     ~CalibrationEngine();
 
@@ -28,6 +49,7 @@ public:
     void startCalibration(uint8_t calibrationType);
     bool addCalibrationPoint(float knownValue, float rawValue);
     bool calculateCalibration();
+    bool compile();
     void cancelCalibration();
     bool clearCalibrationPoints();
     
@@ -43,6 +65,7 @@ public:
     float getScale() const;
     const float* getPolynomialCoeffs() const;
     uint8_t getPolynomialDegree() const;
+    uint8_t getCompiledForm() const;
 
 private:
     CalibrationPoint *_calibPoints;
@@ -57,12 +80,24 @@ private:
     uint8_t _interpolationMethod;
     uint8_t _polynomialDegree;
     float *_polynomialCoeffs;
+
+    uint8_t _compiledForm;
+    float _gain, _bias;
+    uint8_t _fitDegree;
+    float _fitCenter, _fitInvSpan;
+    float _hornerCoeffs[CALIBRATION_MAX_POLYNOMIAL_DEGREE + 1];
+    CalibrationSegment *_segments;
+    uint8_t _segmentCount;
+    float _lutMin, _lutMax, _lutInvStep;
+    float _lutFirstValue, _lutLastValue;
+    uint8_t _lutSegment[CALIBRATION_LUT_SIZE];
     
     void initializeBuffers();
     void cleanupMemory();
-    float linearInterpolate(float rawValue);
-    float polynomialInterpolate(float rawValue);
+    void resetCompiled();
+    bool compilePiecewise();
     bool calculatePolynomialRegression();
+    bool solveLeastSquares(float *matrix, float *target, uint8_t rows, uint8_t cols, float *solution);
     bool sortCalibrationPoints();
 };
 
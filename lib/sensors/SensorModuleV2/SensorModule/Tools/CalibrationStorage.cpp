@@ -1,7 +1,7 @@
 #include "CalibrationStorage.h"
 
 CalibrationStorage::CalibrationStorage()
-    : _eepromAddress(0), _displayPrecision(2) {
+    : _eepromAddress(0), _displayPrecision(2), _recordStore(nullptr) {
     strcpy(_displayUnits, "units");
 }
 
@@ -16,10 +16,19 @@ int CalibrationStorage::getEEPROMAddress() const {
     return _eepromAddress;
 }
 
+void CalibrationStorage::setRecordStore(RecordStore *store) {
+    _recordStore = store;
+}
+
+RecordStore *CalibrationStorage::getRecordStore() const {
+    return _recordStore;
+}
+
 bool CalibrationStorage::saveCalibration(const CalibrationEngine* engine, int eepromAddress) {
     if (!engine) return false;
     
     int addr = (eepromAddress == -1) ? _eepromAddress : eepromAddress;
+    if (_recordStore) return saveCalibrationRecord(engine, addr);
     
     EEPROM.put(addr, engine->getCalibrationMethod());
     addr += sizeof(uint8_t);
@@ -57,6 +66,7 @@ bool CalibrationStorage::loadCalibration(CalibrationEngine* engine, int eepromAd
     if (!engine) return false;
     
     int addr = (eepromAddress == -1) ? _eepromAddress : eepromAddress;
+    if (_recordStore) return loadCalibrationRecord(engine, addr);
     
     uint8_t calibMethod;
     EEPROM.get(addr, calibMethod);
@@ -117,8 +127,12 @@ void CalibrationStorage::listCalibrationProfiles(Stream* serial) {
     serial->println("\nCalibration Profiles:");
     for (uint8_t i = 0; i < 8; i++) {
         uint16_t addr = getEepromProfileAddress(i);
-        uint8_t calibMethod;
-        EEPROM.get(addr, calibMethod);
+        uint8_t calibMethod = CALIBRATION_NONE;
+        if (_recordStore) {
+            _recordStore->read(addr, &calibMethod, 1);
+        } else {
+            EEPROM.get(addr, calibMethod);
+        }
         
         serial->print("Profile ");
         serial->print(i);
@@ -134,12 +148,28 @@ void CalibrationStorage::listCalibrationProfiles(Stream* serial) {
 }
 
 bool CalibrationStorage::loadPreferences(int eepromAddress) {
+    if (_recordStore) {
+        uint8_t record[1 + sizeof(_displayUnits)];
+        if (_recordStore->read(eepromAddress, record, sizeof(record)) != sizeof(record)) return false;
+        _displayPrecision = record[0];
+        memcpy(_displayUnits, record + 1, sizeof(_displayUnits));
+        _displayUnits[sizeof(_displayUnits) - 1] = '\0';
+        return true;
+    }
+
     EEPROM.get(eepromAddress, _displayPrecision);
     EEPROM.get(eepromAddress + sizeof(uint8_t), _displayUnits);
     return true;
 }
 
 bool CalibrationStorage::savePreferences(int eepromAddress) {
+    if (_recordStore) {
+        uint8_t record[1 + sizeof(_displayUnits)];
+        record[0] = _displayPrecision;
+        memcpy(record + 1, _displayUnits, sizeof(_displayUnits));
+        return _recordStore->write(eepromAddress, record, sizeof(record));
+    }
+
     EEPROM.put(eepromAddress, _displayPrecision);
     EEPROM.put(eepromAddress + sizeof(uint8_t), _displayUnits);
     
@@ -176,4 +206,84 @@ uint8_t CalibrationStorage::getDisplayPrecision() const {
 
 uint16_t CalibrationStorage::getEepromProfileAddress(uint8_t profileNumber) const {
     return 100 + (profileNumber * 64);
+}
+
+// record layout mirrors the raw EEPROM one: method, scale, slope, offset, count, points
+bool CalibrationStorage::saveCalibrationRecord(const CalibrationEngine* engine, uint16_t key) {
+    const uint8_t headerSize = sizeof(uint8_t) + 3 * sizeof(float) + sizeof(uint8_t);
+    const uint8_t pointSize = 2 * sizeof(float);
+
+    uint8_t count = engine->getCalibrationPointCount();
+    const CalibrationEngine::CalibrationPoint* points = engine->getCalibrationPoints();
+    if (!points) count = 0;
+    if (count > (RECORD_STORE_MAX_PAYLOAD - headerSize) / pointSize) {
+        count = (RECORD_STORE_MAX_PAYLOAD - headerSize) / pointSize;
+    }
+
+    uint8_t length = headerSize + count * pointSize;
+    uint8_t *record = new uint8_t[length];
+    uint8_t method = engine->getCalibrationMethod();
+    float scale = engine->getScale();
+    float slope = engine->getSlope();
+    float offset = engine->getOffset();
+
+    uint8_t *cursor = record;
+    memcpy(cursor, &method, sizeof(method));
+    cursor += sizeof(method);
+    memcpy(cursor, &scale, sizeof(float));
+    cursor += sizeof(float);
+    memcpy(cursor, &slope, sizeof(float));
+    cursor += sizeof(float);
+    memcpy(cursor, &offset, sizeof(float));
+    cursor += sizeof(float);
+    memcpy(cursor, &count, sizeof(count));
+    cursor += sizeof(count);
+    for (uint8_t i = 0; i < count; i++) {
+        memcpy(cursor, &points[i].rawValue, sizeof(float));
+        cursor += sizeof(float);
+        memcpy(cursor, &points[i].knownValue, sizeof(float));
+        cursor += sizeof(float);
+    }
+
+    bool success = _recordStore->write(key, record, length);
+    delete[] record;
+    return success;
+}
+
+bool CalibrationStorage::loadCalibrationRecord(CalibrationEngine* engine, uint16_t key) {
+    const uint8_t headerSize = sizeof(uint8_t) + 3 * sizeof(float) + sizeof(uint8_t);
+    const uint8_t pointSize = 2 * sizeof(float);
+
+    uint8_t length = _recordStore->getLength(key);
+    if (length < headerSize) {
+        return false;
+    }
+
+    uint8_t *record = new uint8_t[length];
+    _recordStore->read(key, record, length);
+
+    uint8_t calibMethod = record[0];
+    uint8_t pointCount = record[headerSize - 1];
+    if (calibMethod == CALIBRATION_NONE || headerSize + pointCount * pointSize > length) {
+        delete[] record;
+        return false;
+    }
+
+    engine->clearCalibrationPoints();
+    engine->startCalibration(calibMethod);
+
+    const uint8_t *cursor = record + headerSize;
+    for (uint8_t i = 0; i < pointCount; i++) {
+        float rawValue, knownValue;
+        memcpy(&rawValue, cursor, sizeof(float));
+        cursor += sizeof(float);
+        memcpy(&knownValue, cursor, sizeof(float));
+        cursor += sizeof(float);
+
+        engine->addCalibrationPoint(knownValue, rawValue);
+    }
+    delete[] record;
+
+    engine->calculateCalibration();
+    return true;
 }
\ No newline at end of file
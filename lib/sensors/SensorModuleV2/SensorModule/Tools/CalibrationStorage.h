@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <EEPROM.h>
 #include "CalibrationEngine.h"
+#include "../../../../modules/file/RecordStore.h"
 
 class CalibrationStorage {
 public:
@@ -12,6 +13,8 @@ public:
 
     void setEEPROMAddress(int address);
     int getEEPROMAddress() const;
+    void setRecordStore(RecordStore *store);
+    RecordStore *getRecordStore() const;
 
     bool saveCalibration(const CalibrationEngine* engine, int eepromAddress = -1);
     bool loadCalibration(CalibrationEngine* engine, int eepromAddress = -1);
@@ -33,8 +36,11 @@ private:
     int _eepromAddress;
     char _displayUnits[8];
     uint8_t _displayPrecision;
+    RecordStore *_recordStore;
     
     uint16_t getEepromProfileAddress(uint8_t profileNumber) const;
+    bool saveCalibrationRecord(const CalibrationEngine* engine, uint16_t key);
+    bool loadCalibrationRecord(CalibrationEngine* engine, uint16_t key);
 };
 
 #endif
\ No newline at end of file
@@ -72,6 +72,10 @@ int InteractiveCalibrator::getEEPROMAddress() const {
     return _storage ? _storage->getEEPROMAddress() : 0;
 }
 
+void InteractiveCalibrator::setRecordStore(RecordStore *store) {
+    if (_storage) _storage->setRecordStore(store);
+}
+
 float InteractiveCalibrator::readRawValue() {
     return _dataInterface ? _dataInterface->readRawValue() : 0.0f;
 }
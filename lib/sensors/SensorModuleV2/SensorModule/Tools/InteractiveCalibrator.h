@@ -29,6 +29,7 @@ public:
     void setCompletedCallback(CalibrationCompletedCallback callback, void *callbackContext);
     void setEEPROMAddress(int address);
     int getEEPROMAddress() const;
+    void setRecordStore(RecordStore *store);
 
     float readRawValue();
     float readCalibratedValue();
@@ -9,6 +9,10 @@
 
 #include "Arduino.h"
 
+#ifdef ENABLE_MODULE_FRAME_CODEC
+#include "../lib/modules/communication/codec/frame-codec.h"
+#endif
+
 #ifdef ENABLE_MODULE_I2C_EXPANDER
 #include "../lib/modules/communication/wired/i2c/i2c-expander.h"
 #include "../lib/modules/communication/wired/i2c/i2c-expander.cpp"
@@ -26,12 +30,21 @@
 
 #ifdef ENABLE_MODULE_MODBUS
 #include "../lib/modules/communication/wired/modbus/modbus.h"
+#include "../lib/modules/communication/wired/modbus/modbusCrc.h"
 #include "../lib/modules/communication/wired/modbus/modbusDevice.h"
 #include "../lib/modules/communication/wired/modbus/modbusRegBank.h"
 #include "../lib/modules/communication/wired/modbus/modbusSlave.h"
+#include "../lib/modules/communication/wired/modbus/modbusMaster.h"
+#include "../lib/modules/communication/wired/modbus/modbusPdu.h"
+#include "../lib/modules/communication/wired/modbus/modbusTcpServer.h"
+#include "../lib/modules/communication/wired/modbus/modbusTcpClient.h"
 #include "../lib/modules/communication/wired/modbus/modbusDevice.cpp"
 #include "../lib/modules/communication/wired/modbus/modbusRegBank.cpp"
+#include "../lib/modules/communication/wired/modbus/modbusPdu.cpp"
 #include "../lib/modules/communication/wired/modbus/modbusSlave.cpp"
+#include "../lib/modules/communication/wired/modbus/modbusMaster.cpp"
+#include "../lib/modules/communication/wired/modbus/modbusTcpServer.cpp"
+#include "../lib/modules/communication/wired/modbus/modbusTcpClient.cpp"
 #endif
 
 #ifdef ENABLE_MODULE_SERIAL_ENHANCED
@@ -93,6 +106,15 @@
 #include "../lib/modules/communication/wireless/now/esp-now.cpp"
 #endif
 
+#ifdef ENABLE_MODULE_ESP_NOW_TRANSPORT
+#ifndef ENABLE_MODULE_ESP_NOW
+#include "../lib/modules/communication/wireless/now/esp-now.h"
+#include "../lib/modules/communication/wireless/now/esp-now.cpp"
+#endif
+#include "../lib/modules/communication/wireless/now/esp-now-transport.h"
+#include "../lib/modules/communication/wireless/now/esp-now-transport.cpp"
+#endif
+
 #ifdef ENABLE_MODULE_DECISION_TREE
 #include "../lib/modules/control/DecisionTree.h"
 #include "../lib/modules/control/DecisionTree.cpp"
@@ -153,6 +175,21 @@
 #include "../lib/modules/debug/SerialDebuggerV2.cpp"
 #endif
 
+#if defined(ENABLE_MODULE_TIMER_WHEEL) || defined(ENABLE_MODULE_TIMER_MANAGER) || defined(ENABLE_MODULE_EASY_LOGIC) || defined(ENABLE_MODULE_LOGIC_CONDITION_MANAGER) || defined(ENABLE_MODULE_STATE_ACTION_MANAGER)
+#include "../lib/modules/time/timer-wheel.h"
+#include "../lib/modules/time/timer-wheel.cpp"
+#endif
+
+#if defined(ENABLE_MODULE_EASY_LOGIC) || defined(ENABLE_MODULE_LOGIC_CONDITION_MANAGER) || defined(ENABLE_MODULE_STATE_ACTION_MANAGER)
+#include "../lib/modules/utils/RulePool.h"
+#include "../lib/modules/utils/RulePool.cpp"
+#endif
+
+#if defined(ENABLE_MODULE_RULE_VM) || defined(ENABLE_MODULE_EASY_LOGIC)
+#include "../lib/modules/utils/RuleVM.h"
+#include "../lib/modules/utils/RuleVM.cpp"
+#endif
+
 #ifdef ENABLE_MODULE_EASY_LOGIC
 #include "../lib/modules/utils/EasyLogic.h"
 #include "../lib/modules/utils/EasyLogic.cpp"
@@ -314,6 +351,11 @@
 #include "../lib/modules/file/EEPROMLibESP8266.cpp"
 #endif
 
+#if defined(ENABLE_MODULE_RECORD_STORE) || defined(ENABLE_MODULE_PID_CONTROLLER)
+#include "../lib/modules/file/RecordStore.h"
+#include "../lib/modules/file/RecordStore.cpp"
+#endif
+
 #ifdef ENABLE_MODULE_SD_ARDUINO
 #include "../lib/modules/file/SDArduino.h"
 #include "../lib/modules/file/SDArduino.cpp"
@@ -394,6 +436,11 @@
 #include "../lib/modules/filter/DynamicTypeBandStopFilter.cpp"
 #endif
 
+#ifdef ENABLE_MODULE_CONTINUOUS_ADC
+#include "../lib/modules/io/continuous-adc.h"
+#include "../lib/modules/io/continuous-adc.cpp"
+#endif
+
 #ifdef ENABLE_MODULE_DIGITAL_INPUT
 #include "../lib/modules/io/input-module.h"
 #include "../lib/modules/io/input-module.cpp"
@@ -419,6 +466,10 @@
 #include "../lib/modules/io/pcf8574-output-module.cpp"
 #endif
 
+#ifdef ENABLE_MODULE_PCF8574_PORT_CACHE
+#include "../lib/modules/io/pcf8574-port-cache.h"
+#endif
+
 #ifdef ENABLE_MODULE_ROTARY_ENCODER
 #include "../lib/modules/io/rotary-module.h"
 #include "../lib/modules/io/rotary-module.cpp"
@@ -454,6 +505,20 @@
 #include "../lib/modules/task/Task.cpp"
 #endif
 
+#ifdef ENABLE_MODULE_TASK_SCHEDULER
+#include "../lib/modules/task/TaskScheduler.h"
+#include "../lib/modules/task/TaskScheduler.cpp"
+#endif
+
+#ifdef ENABLE_MODULE_SPSC_RING
+#include "../lib/modules/task/SpscRing.h"
+#endif
+
+#ifdef ENABLE_MODULE_WORKER_POOL
+#include "../lib/modules/task/WorkerPool.h"
+#include "../lib/modules/task/WorkerPool.cpp"
+#endif
+
 #ifdef ENABLE_MODULE_TIMER_DURATION
 #include "../lib/modules/time/timer-duration.h"
 #include "../lib/modules/time/timer-duration.cpp"
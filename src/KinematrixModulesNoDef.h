@@ -7,6 +7,10 @@
 
 #pragma once
 
+#ifdef ENABLE_MODULE_NODEF_FRAME_CODEC
+#include "../lib/modules/communication/codec/frame-codec.h"
+#endif
+
 #ifdef ENABLE_MODULE_NODEF_I2C_EXPANDER
 #include "../lib/modules/communication/wired/i2c/i2c-expander.h"
 #endif
@@ -21,9 +25,14 @@
 
 #ifdef ENABLE_MODULE_NODEF_MODBUS
 #include "../lib/modules/communication/wired/modbus/modbus.h"
+#include "../lib/modules/communication/wired/modbus/modbusCrc.h"
 #include "../lib/modules/communication/wired/modbus/modbusDevice.h"
 #include "../lib/modules/communication/wired/modbus/modbusRegBank.h"
 #include "../lib/modules/communication/wired/modbus/modbusSlave.h"
+#include "../lib/modules/communication/wired/modbus/modbusMaster.h"
+#include "../lib/modules/communication/wired/modbus/modbusPdu.h"
+#include "../lib/modules/communication/wired/modbus/modbusTcpServer.h"
+#include "../lib/modules/communication/wired/modbus/modbusTcpClient.h"
 #endif
 
 #ifdef ENABLE_MODULE_NODEF_SERIAL_ENHANCED
@@ -72,6 +81,10 @@
 #include "../lib/modules/communication/wireless/now/esp-now.h"
 #endif
 
+#ifdef ENABLE_MODULE_NODEF_ESP_NOW_TRANSPORT
+#include "../lib/modules/communication/wireless/now/esp-now-transport.h"
+#endif
+
 #ifdef ENABLE_MODULE_NODEF_DECISION_TREE
 #include "../lib/modules/control/DecisionTree.h"
 #endif
@@ -120,6 +133,10 @@
 #include "../lib/modules/debug/SerialDebuggerV2.h"
 #endif
 
+#ifdef ENABLE_MODULE_NODEF_RULE_VM
+#include "../lib/modules/utils/RuleVM.h"
+#endif
+
 #ifdef ENABLE_MODULE_NODEF_EASY_LOGIC
 #include "../lib/modules/utils/EasyLogic.h"
 #endif
@@ -241,6 +258,10 @@
 #include "../lib/modules/file/EEPROMLibESP8266.h"
 #endif
 
+#ifdef ENABLE_MODULE_NODEF_RECORD_STORE
+#include "../lib/modules/file/RecordStore.h"
+#endif
+
 #ifdef ENABLE_MODULE_NODEF_SD_ARDUINO
 #include "../lib/modules/file/SDArduino.h"
 #endif
@@ -305,6 +326,10 @@
 #include "../lib/modules/filter/DynamicTypeBandStopFilter.h"
 #endif
 
+#ifdef ENABLE_MODULE_NODEF_CONTINUOUS_ADC
+#include "../lib/modules/io/continuous-adc.h"
+#endif
+
 #ifdef ENABLE_MODULE_NODEF_DIGITAL_INPUT
 #include "../lib/modules/io/input-module.h"
 #endif
@@ -325,6 +350,10 @@
 #include "../lib/modules/io/pcf8574-output-module.h"
 #endif
 
+#ifdef ENABLE_MODULE_NODEF_PCF8574_PORT_CACHE
+#include "../lib/modules/io/pcf8574-port-cache.h"
+#endif
+
 #ifdef ENABLE_MODULE_NODEF_ROTARY_ENCODER
 #include "../lib/modules/io/rotary-module.h"
 #endif
@@ -353,6 +382,18 @@
 #include "../lib/modules/task/Task.h"
 #endif
 
+#ifdef ENABLE_MODULE_NODEF_TASK_SCHEDULER
+#include "../lib/modules/task/TaskScheduler.h"
+#endif
+
+#ifdef ENABLE_MODULE_NODEF_SPSC_RING
+#include "../lib/modules/task/SpscRing.h"
+#endif
+
+#ifdef ENABLE_MODULE_NODEF_WORKER_POOL
+#include "../lib/modules/task/WorkerPool.h"
+#endif
+
 #ifdef ENABLE_MODULE_NODEF_TIMER_DURATION
 #include "../lib/modules/time/timer-duration.h"
 #endif
@@ -361,6 +402,10 @@
 #include "../lib/modules/time/timer-manager.h"
 #endif
 
+#ifdef ENABLE_MODULE_NODEF_TIMER_WHEEL
+#include "../lib/modules/time/timer-wheel.h"
+#endif
+
 #ifdef ENABLE_MODULE_NODEF_TIMER_TASK
 #include "../lib/modules/time/timer-task.h"
 #endif
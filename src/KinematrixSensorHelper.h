@@ -25,6 +25,21 @@
 #include "../lib/sensors/SensorModuleV1/addons/sensor-filter.cpp"
 #endif
 
+#if defined(ENABLE_SENSOR_HELPER_PULSE_CAPTURE) || defined(ENABLE_SENSOR_HELPER_FLOWMETER) || defined(ENABLE_SENSOR_HELPER_FLOWMETERV2) || defined(ENABLE_SENSOR_HELPER_FLOWMETERV3) || defined(ENABLE_SENSOR_HELPER_RPM)
+#include "../lib/sensors/SensorModuleV1/addons/pulse-capture.h"
+#include "../lib/sensors/SensorModuleV1/addons/pulse-capture.cpp"
+#endif
+
+#if !defined(ENABLE_MODULE_HELPER_CONTINUOUS_ADC) && (defined(ENABLE_SENSOR_HELPER_ANALOG) || defined(ENABLE_SENSOR_HELPER_PH) || defined(ENABLE_SENSOR_HELPER_SOIL) || defined(ENABLE_SENSOR_HELPER_TURBIDITY) || defined(ENABLE_SENSOR_HELPER_VOLTAGE) || defined(ENABLE_SENSOR_HELPER_ANALOG_V2))
+#include "../lib/modules/io/continuous-adc.h"
+#include "../lib/modules/io/continuous-adc.cpp"
+#endif
+
+#if !defined(ENABLE_MODULE_HELPER_RECORD_STORE) && !defined(ENABLE_MODULE_HELPER_PID_CONTROLLER) && defined(ENABLE_HELPER_INTERACTIVE_SERIAL_GENERAL_SENSOR_CALIBRATOR_V2)
+#include "../lib/modules/file/RecordStore.h"
+#include "../lib/modules/file/RecordStore.cpp"
+#endif
+
 #ifdef ENABLE_HELPER_ANALOG_SENSOR_CALIBRATOR
 #include "../lib/sensors/SensorModuleV1/calibration/AnalogSensorCalibrator.h"
 #include "../lib/sensors/SensorModuleV1/calibration/AnalogSensorCalibrator.cpp"
@@ -355,3 +370,18 @@
 #include "../lib/sensors/SensorModuleV2/SensorList/MHRTCSensV2/MHRTCSensV2.h"
 #include "../lib/sensors/SensorModuleV2/SensorList/MHRTCSensV2/MHRTCSensV2.cpp"
 #endif
+
+#ifdef ENABLE_SENSOR_HELPER_DS18B20_V2
+#include "../lib/sensors/SensorModuleV2/SensorList/DS18B20SensV2/DS18B20SensV2.h"
+#include "../lib/sensors/SensorModuleV2/SensorList/DS18B20SensV2/DS18B20SensV2.cpp"
+#endif
+
+#ifdef ENABLE_SENSOR_HELPER_HX711_V2
+#include "../lib/sensors/SensorModuleV2/SensorList/HX711SensV2/HX711SensV2.h"
+#include "../lib/sensors/SensorModuleV2/SensorList/HX711SensV2/HX711SensV2.cpp"
+#endif
+
+#ifdef ENABLE_SENSOR_HELPER_SCD30_V2
+#include "../lib/sensors/SensorModuleV2/SensorList/SCD30SensV2/SCD30SensV2.h"
+#include "../lib/sensors/SensorModuleV2/SensorList/SCD30SensV2/SCD30SensV2.cpp"
+#endif
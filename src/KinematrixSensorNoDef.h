@@ -19,6 +19,10 @@
 #include "../lib/sensors/SensorModuleV1/addons/sensor-filter.h"
 #endif
 
+#ifdef ENABLE_SENSOR_NODEF_PULSE_CAPTURE
+#include "../lib/sensors/SensorModuleV1/addons/pulse-capture.h"
+#endif
+
 #ifdef ENABLE_NODEF_ANALOG_SENSOR_CALIBRATOR
 #include "../lib/sensors/SensorModuleV1/calibration/AnalogSensorCalibrator.h"
 #endif
@@ -271,3 +275,15 @@
 #ifdef ENABLE_SENSOR_NODEF_MHRTC_V2
 #include "../lib/sensors/SensorModuleV2/SensorList/MHRTCSensV2/MHRTCSensV2.h"
 #endif
+
+#ifdef ENABLE_SENSOR_NODEF_DS18B20_V2
+#include "../lib/sensors/SensorModuleV2/SensorList/DS18B20SensV2/DS18B20SensV2.h"
+#endif
+
+#ifdef ENABLE_SENSOR_NODEF_HX711_V2
+#include "../lib/sensors/SensorModuleV2/SensorList/HX711SensV2/HX711SensV2.h"
+#endif
+
+#ifdef ENABLE_SENSOR_NODEF_SCD30_V2
+#include "../lib/sensors/SensorModuleV2/SensorList/SCD30SensV2/SCD30SensV2.h"
+#endif